@@ -0,0 +1,24 @@
+#version 430
+
+layout(location = 0) in vec2 inUV;
+layout(location = 0) out vec3 outColor;
+
+uniform layout(binding = 0) sampler2D s_Image;
+
+// Must match SeparableFilter::MAX_TAPS
+#define MAX_TAPS 8
+
+// The size of a texel along the direction of this pass
+uniform vec2 u_Step;
+uniform int u_TapCount;
+// Offsets are in texels, and may be fractional to take advantage of linear filtering
+uniform float u_Offsets[MAX_TAPS];
+uniform float u_Weights[MAX_TAPS];
+
+void main() {
+    vec3 accumulator = vec3(0);
+    for (int ix = 0; ix < u_TapCount; ix++) {
+        accumulator += texture(s_Image, inUV + u_Step * u_Offsets[ix]).rgb * u_Weights[ix];
+    }
+    outColor = accumulator;
+}
@@ -0,0 +1,11 @@
+// Fused version of post_effects/color_correction.glsl
+// $ is replaced with the effect prefix, $TEX0 with the LUT's texture slot
+
+uniform layout(binding = $TEX0) sampler3D $s_Lut;
+
+uniform float $u_Strength;
+
+vec4 $Apply(vec4 color, vec2 uv) {
+    color.rgb = mix(color.rgb, texture($s_Lut, color.rgb).rgb, clamp($u_Strength, 0, 1));
+    return color;
+}
@@ -0,0 +1,35 @@
+// Fused version of post_effects/night_vision.glsl
+// $ is replaced with the effect prefix. This samples the input at pixelated UVs,
+// so it can only follow per pixel effects in a fused pass
+
+uniform vec3 $u_nvVec = vec3(0.8, 0.3, 0.1);
+
+uniform float $loadTime = 0.0f;
+
+uniform float $isToggleOn = 0.0f;
+
+const float $goggleTime = 3.0f;
+
+vec4 $Apply(vec4 inColor, vec2 uv) {
+    vec4 nvColor = inColor;
+
+    float u_lum = dot(inColor.rgb, $u_nvVec);
+    nvColor.rgb = vec3(0.0, u_lum, 0.0);
+
+    if ($loadTime > 0.1f) {
+        float IncPercent = ($goggleTime - $loadTime) / $goggleTime;
+
+        vec2 pixelUV = floor(uv * (IncPercent * 300)) / (IncPercent * 300);
+        vec4 pixelColor = $SampleInput(pixelUV);
+        nvColor.g = u_lum * IncPercent;
+
+        if ($isToggleOn == 1.0f) {
+            float lum_pix = dot(pixelColor.rgb, $u_nvVec);
+            pixelColor.rgb = vec3(0.0f, IncPercent * lum_pix, 0.0f);
+            return mix(pixelColor, nvColor, IncPercent);
+        }
+        return mix(nvColor, pixelColor, IncPercent);
+    }
+
+    return $isToggleOn == 1.0f ? nvColor : inColor;
+}
@@ -1,12 +1,22 @@
 
-// Vertex inputs
-layout(location = 0) in vec3 inPosition;
+// Vertex inputs, these may be float or packed (see VertexPacker), the GL unpacks
+// everything except for positions and bitangents for us
+layout(location = 0) in vec3 inPackedPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec3 inNormal;
 layout(location = 3) in vec2 inUV;
 
-layout(location = 4) in vec3 inTangent;
-layout(location = 5) in vec3 inBiTangent;
+layout(location = 4) in vec4 inPackedTangent;
+layout(location = 5) in vec3 inPackedBiTangent;
+
+// Constant attribute set by the VAO, xyz is the offset and w is the scale for packed
+// positions. Float meshes use (0, 0, 0, 1)
+layout(location = 15) in vec4 inPositionDequantize;
+
+#define inPosition (inPackedPosition * inPositionDequantize.w + inPositionDequantize.xyz)
+#define inTangent (inPackedTangent.xyz)
+// Packed meshes don't store the bitangent, so we rebuild it from the sign in the tangent's w
+#define inBiTangent (dot(inPackedBiTangent, inPackedBiTangent) > 0.0 ? inPackedBiTangent : cross(inNormal, inPackedTangent.xyz) * inPackedTangent.w)
 
 // Standard vertex shader outputs
 layout(location = 0) out vec3 outViewPos;
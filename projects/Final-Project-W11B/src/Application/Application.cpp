@@ -7,11 +7,15 @@
 #include "Logging.h"
 #include "Gameplay/InputEngine.h"
 #include "Application/Timing.h"
+#include "Application/Profiler.h"
+#include "Application/Benchmark.h"
+#include "Utils/FrameMemory.h"
 #include <filesystem>
 #include "Layers/GLAppLayer.h"
 #include "Utils/FileHelpers.h"
 #include "Utils/ResourceManager/ResourceManager.h"
 #include "Utils/ImGuiHelper.h"
+#include "Utils/ThreadPool.h"
 
 // Graphics
 #include "Graphics/Buffers/IndexBuffer.h"
@@ -132,7 +136,8 @@ bool Application::LoadScene(const std::string& path) {
 		std::string manifestPath = std::filesystem::path(path).stem().string() + "-manifest.json";
 		if (std::filesystem::exists(manifestPath)) {
 			LOG_INFO("Loading manifest from \"{}\"", manifestPath);
-			ResourceManager::LoadManifest(manifestPath);
+			// Resources are loaded lazily unless the app opts in to loading the whole manifest (and decoding all of it's images in parallel) up front
+			ResourceManager::LoadManifest(manifestPath, JsonGet(_appSettings, "preload_scene_resources", false));
 		}
 
 		Gameplay::Scene::Sptr scene = Gameplay::Scene::Load(path);
@@ -160,6 +165,14 @@ void Application::SaveSettings()
 
 void Application::_Run()
 {
+	// Register the main thread first, so it's always the first track in the profiler
+	Profiler::SetThreadName("Main Thread");
+
+	// Benchmarks run the game as a player would see it, without the editor
+	if (Benchmark::IsActive()) {
+		_isEditor = false;
+	}
+
 	// TODO: Register layers
 	_layers.push_back(std::make_shared<GLAppLayer>());
 	_layers.push_back(std::make_shared<LogicUpdateLayer>());
@@ -173,7 +186,10 @@ void Application::_Run()
 		_layers.push_back(std::make_shared<ImGuiDebugLayer>());
 	}
 
-	_layers.push_back(std::make_shared<DefaultSceneLayer>());
+	// Benchmarks of a scene file don't need the default scene built
+	if (!Benchmark::IsActive() || Benchmark::GetSettings().ScenePath.empty()) {
+		_layers.push_back(std::make_shared<DefaultSceneLayer>());
+	}
 
 	// Either load the settings, or use the defaults
 	_ConfigureSettings();
@@ -182,12 +198,18 @@ void Application::_Run()
 	_windowSize.x = JsonGet(_appSettings, "window_width", DEFAULT_WINDOW_WIDTH);
 	_windowSize.y = JsonGet(_appSettings, "window_height", DEFAULT_WINDOW_HEIGHT);
 
+	if (Benchmark::IsActive()) {
+		_windowSize = Benchmark::GetSettings().Resolution;
+	}
+
 	// By default, we want our viewport to be the whole screen
 	_primaryViewport = { 0, 0, _windowSize.x, _windowSize.y };
 
 	// Register all component and resource types
 	_RegisterClasses();
 
+	// Spin up our worker threads for background jobs like image decoding
+	ThreadPool::Init();
 
 	// Load all layers
 	_Load();
@@ -198,8 +220,17 @@ void Application::_Run()
 	// Done loading, app is now running!
 	_isRunning = true;
 
+	if (Benchmark::IsActive() && !Benchmark::GetSettings().ScenePath.empty()) {
+		if (!LoadScene(Benchmark::GetSettings().ScenePath)) {
+			LOG_ERROR("Failed to load benchmark scene \"{}\"", Benchmark::GetSettings().ScenePath);
+			_isRunning = false;
+		}
+	}
+
 	// Infinite loop as long as the application is running
 	while (_isRunning) {
+		Profiler::BeginFrame();
+
 		// Handle scene switching
 		if (_targetScene != nullptr) {
 			_HandleSceneChange();
@@ -219,6 +250,11 @@ void Application::_Run()
 		// Figure out the current time, and the time since the last frame
 		double thisFrame = glfwGetTime();
 		float dt = static_cast<float>(thisFrame - lastFrame);
+
+		// Benchmarks use a fixed timestep so that every run simulates the same thing
+		if (Benchmark::IsActive()) {
+			dt = Benchmark::GetSettings().DeltaTime;
+		}
 		float scaledDt = dt * timing._timeScale;
 
 		// Update all timing values
@@ -233,6 +269,7 @@ void Application::_Run()
 
 		// Core update loop
 		if (_currentScene != nullptr) {
+			PROFILE_SCOPE("Frame");
 			_Update();
 			_LateUpdate();
 			_PreRender();
@@ -244,14 +281,35 @@ void Application::_Run()
 		lastFrame = thisFrame;
 
 		InputEngine::EndFrame();
-		ImGuiHelper::EndFrame();
+		{
+			PROFILE_GPU_SCOPE("ImGui");
+			ImGuiHelper::EndFrame();
+		}
+
+		{
+			PROFILE_SCOPE("Swap Buffers");
+			glfwSwapBuffers(_window);
+		}
+
+		Profiler::EndFrame();
 
-		glfwSwapBuffers(_window);
+		// Nothing should be holding on to scratch memory past this point
+		FrameMemory::EndFrame();
 
+		if (Benchmark::IsActive() && Benchmark::EndFrame()) {
+			_isRunning = false;
+		}
+	}
+
+	if (Benchmark::IsActive()) {
+		Benchmark::WriteResults();
 	}
 
 	// Unload all our layers
 	_Unload();
+
+	// Let any outstanding background jobs finish
+	ThreadPool::Shutdown();
 }
 
 void Application::_RegisterClasses()
@@ -321,16 +379,20 @@ void Application::_Load() {
 }
 
 void Application::_Update() {
+	PROFILE_SCOPE("Update");
 	for (const auto& layer : _layers) {
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnUpdate)) {
+			PROFILE_SCOPE(layer->Name.c_str());
 			layer->OnUpdate();
 		}
 	}
 }
 
 void Application::_LateUpdate() {
+	PROFILE_SCOPE("Late Update");
 	for (const auto& layer : _layers) {
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnLateUpdate)) {
+			PROFILE_SCOPE(layer->Name.c_str());
 			layer->OnLateUpdate();
 		}
 	}
@@ -338,6 +400,7 @@ void Application::_LateUpdate() {
 
 void Application::_PreRender()
 {
+	PROFILE_GPU_SCOPE("Pre Render");
 	glm::ivec2 size ={ 0, 0 };
 	glfwGetWindowSize(_window, &size.x, &size.y);
 	glViewport(0, 0, size.x, size.y);
@@ -348,32 +411,40 @@ void Application::_PreRender()
 
 	for (const auto& layer : _layers) {
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnPreRender)) {
+			PROFILE_GPU_SCOPE(layer->Name.c_str());
 			layer->OnPreRender();
 		}
 	}
 }
 
 void Application::_RenderScene() {
+	PROFILE_GPU_SCOPE("Render");
 
 	Framebuffer::Sptr result = nullptr;
 	for (const auto& layer : _layers) {
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnRender)) {
+			PROFILE_GPU_SCOPE(layer->Name.c_str());
 			layer->OnRender(result);
 		}
 	}
 }
 
 void Application::_PostRender() {
+	PROFILE_GPU_SCOPE("Post Render");
 	// Note that we use a reverse iterator for post render
 	for (auto it = _layers.begin(); it != _layers.end(); it++) {
 		const auto& layer = *it;
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnPostRender)) {
+			PROFILE_GPU_SCOPE(layer->Name.c_str());
 			layer->OnPostRender();
 		}
 	}
 }
 
 void Application::_Unload() {
+	// Release our timer queries while we still have a GL context
+	Profiler::Shutdown();
+
 	// Note that we use a reverse iterator for unloading
 	for (auto it = _layers.crbegin(); it != _layers.crend(); it++) {
 		const auto& layer = *it;
@@ -467,6 +538,7 @@ nlohmann::json Application::_GetDefaultAppSettings()
 
 	result["window_width"]  = DEFAULT_WINDOW_WIDTH;
 	result["window_height"] = DEFAULT_WINDOW_HEIGHT;
+	result["preload_scene_resources"] = false;
 	return result;
 }
 
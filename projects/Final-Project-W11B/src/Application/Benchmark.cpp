@@ -0,0 +1,272 @@
+#include "Application/Benchmark.h"
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <Psapi.h>
+#include <glad/glad.h>
+#include <json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Logging.h"
+#include "Application/Profiler.h"
+#include "Utils/FileHelpers.h"
+
+bool                Benchmark::_active          = false;
+Benchmark::Settings Benchmark::_settings        = Benchmark::Settings();
+uint64_t            Benchmark::_firstFrame      = 0;
+uint64_t            Benchmark::_lastCollected   = 0;
+uint32_t            Benchmark::_framesRun       = 0;
+uint32_t            Benchmark::_framesCollected = 0;
+uint64_t            Benchmark::_peakWorkingSet  = 0;
+uint32_t            Benchmark::_allocationFrames = 0;
+FrameMemoryStats    Benchmark::_allocationTotals;
+
+std::vector<double>                           Benchmark::_cpuFrameTimes;
+std::vector<double>                           Benchmark::_gpuFrameTimes;
+std::map<std::string, Benchmark::ScopeStats>  Benchmark::_cpuScopes;
+std::map<std::string, Benchmark::ScopeStats>  Benchmark::_gpuScopes;
+
+nlohmann::json Benchmark::SummarizeTimes(std::vector<double> times) {
+	if (times.empty()) {
+		return nullptr;
+	}
+	std::sort(times.begin(), times.end());
+
+	double sum = 0.0;
+	for (double t : times) {
+		sum += t;
+	}
+	double mean = sum / times.size();
+
+	double variance = 0.0;
+	for (double t : times) {
+		variance += (t - mean) * (t - mean);
+	}
+	variance /= times.size();
+
+	// Nearest rank percentiles
+	auto percentile = [&](double p) {
+		size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * times.size()));
+		return times[std::min(std::max<size_t>(rank, 1), times.size()) - 1];
+	};
+
+	return {
+		{ "samples", times.size() },
+		{ "mean", mean },
+		{ "stddev", std::sqrt(variance) },
+		{ "min", times.front() },
+		{ "max", times.back() },
+		{ "p50", percentile(50.0) },
+		{ "p90", percentile(90.0) },
+		{ "p95", percentile(95.0) },
+		{ "p99", percentile(99.0) }
+	};
+}
+
+bool Benchmark::ParseArguments(int argCount, char** arguments, Settings& settings) {
+	bool found = false;
+	for (int ix = 1; ix < argCount; ix++) {
+		const char* arg = arguments[ix];
+		// Looks at the next argument for flags that take a value
+		const char* value = ix + 1 < argCount ? arguments[ix + 1] : nullptr;
+
+		if (strcmp(arg, "--benchmark") == 0) {
+			found = true;
+			// The scene path is optional
+			if (value != nullptr && strncmp(value, "--", 2) != 0) {
+				settings.ScenePath = value;
+				ix++;
+			}
+		} else if (strcmp(arg, "--frames") == 0 && value != nullptr) {
+			settings.Frames = std::max(std::stoi(value), 1);
+			ix++;
+		} else if (strcmp(arg, "--warmup") == 0 && value != nullptr) {
+			settings.WarmupFrames = std::max(std::stoi(value), 0);
+			ix++;
+		} else if (strcmp(arg, "--dt") == 0 && value != nullptr) {
+			settings.DeltaTime = std::stof(value);
+			ix++;
+		} else if (strcmp(arg, "--resolution") == 0 && value != nullptr) {
+			int width = 0, height = 0;
+			if (sscanf(value, "%dx%d", &width, &height) == 2 && width > 0 && height > 0) {
+				settings.Resolution = { width, height };
+			} else {
+				LOG_WARN("Invalid resolution \"{}\", expected WIDTHxHEIGHT", value);
+			}
+			ix++;
+		} else if (strcmp(arg, "--out") == 0 && value != nullptr) {
+			settings.OutputPath = value;
+			ix++;
+		} else if (strcmp(arg, "--context") == 0 && value != nullptr) {
+			settings.ContextApi = value;
+			ix++;
+		} else if (strcmp(arg, "--show-window") == 0) {
+			settings.ShowWindow = true;
+		}
+	}
+	return found;
+}
+
+void Benchmark::Begin(const Settings& settings) {
+	_settings = settings;
+	_active = true;
+
+	// We pull all our timings from the profiler
+	Profiler::SetEnabled(true);
+	Profiler::SetPaused(false);
+
+	LOG_INFO("Benchmarking \"{}\" for {} frames ({} warmup) at dt = {}s",
+			 _settings.ScenePath.empty() ? "default scene" : _settings.ScenePath,
+			 _settings.Frames, _settings.WarmupFrames, _settings.DeltaTime);
+}
+
+bool Benchmark::EndFrame() {
+	const std::deque<ProfileFrame>& history = Profiler::GetHistory();
+	if (history.empty()) {
+		return false;
+	}
+
+	if (_framesRun == 0) {
+		_firstFrame = history.back().Index;
+		_lastCollected = _firstFrame + _settings.WarmupFrames - 1;
+	}
+	_framesRun++;
+
+	// Frames get their GPU results GPU_LATENCY frames later, so we collect that far behind the newest frame
+	uint64_t lastMeasured = _firstFrame + _settings.WarmupFrames + _settings.Frames - 1;
+	uint64_t ready = history.back().Index >= Profiler::GPU_LATENCY ? history.back().Index - Profiler::GPU_LATENCY : 0;
+	for (const ProfileFrame& frame : history) {
+		if (frame.Index > _lastCollected && frame.Index <= ready && frame.Index <= lastMeasured) {
+			_CollectFrame(frame);
+			_lastCollected = frame.Index;
+		}
+	}
+
+	if (_framesRun > _settings.WarmupFrames) {
+		_SampleMemory();
+		if (_framesRun <= _settings.WarmupFrames + _settings.Frames) {
+			_SampleAllocations();
+		}
+	}
+
+	// Keep running until the last measured frame's GPU results have come in
+	return _framesRun >= _settings.WarmupFrames + _settings.Frames + Profiler::GPU_LATENCY;
+}
+
+bool Benchmark::WriteResults() {
+	if (_framesCollected == 0) {
+		LOG_ERROR("Benchmark did not collect any frames, not writing results");
+		return false;
+	}
+
+	auto scopesToJson = [&](const std::map<std::string, ScopeStats>& scopes) {
+		nlohmann::json result = nlohmann::json::object();
+		for (const auto& [path, stats] : scopes) {
+			result[path] = {
+				{ "mean_ms", stats.TotalMs / _framesCollected },
+				{ "max_ms", stats.MaxMs },
+				{ "calls_per_frame", stats.Calls / (double)_framesCollected }
+			};
+		}
+		return result;
+	};
+
+	PROCESS_MEMORY_COUNTERS_EX memory = PROCESS_MEMORY_COUNTERS_EX();
+	GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&memory, sizeof(memory));
+	const double toMb = 1.0 / (1024.0 * 1024.0);
+	const double perFrame = _allocationFrames > 0 ? 1.0 / _allocationFrames : 0.0;
+
+	nlohmann::json result = {
+		{ "scene", _settings.ScenePath.empty() ? "default" : _settings.ScenePath },
+		{ "frames", _framesCollected },
+		{ "warmup_frames", _settings.WarmupFrames },
+		{ "delta_time", _settings.DeltaTime },
+		{ "resolution", { _settings.Resolution.x, _settings.Resolution.y } },
+		{ "context_api", _settings.ContextApi },
+		{ "renderer", (const char*)glGetString(GL_RENDERER) },
+		{ "gl_version", (const char*)glGetString(GL_VERSION) },
+		{ "cpu_frame_ms", SummarizeTimes(_cpuFrameTimes) },
+		{ "gpu_frame_ms", SummarizeTimes(_gpuFrameTimes) },
+		{ "cpu_scopes", scopesToJson(_cpuScopes) },
+		{ "gpu_scopes", scopesToJson(_gpuScopes) },
+		{ "memory", {
+			{ "working_set_mb", memory.WorkingSetSize * toMb },
+			{ "peak_working_set_mb", std::max<uint64_t>(_peakWorkingSet, memory.PeakWorkingSetSize) * toMb },
+			{ "private_mb", memory.PrivateUsage * toMb }
+		}},
+		{ "allocations", {
+			{ "heap_per_frame", _allocationTotals.HeapAllocations * perFrame },
+			{ "heap_kb_per_frame", _allocationTotals.HeapBytes * perFrame / 1024.0 },
+			{ "frame_allocator_per_frame", _allocationTotals.FrameAllocations * perFrame },
+			{ "frame_allocator_peak_kb", _allocationTotals.FrameBytes / 1024.0 },
+			{ "pool_per_frame", _allocationTotals.PoolAllocations * perFrame }
+		}}
+	};
+
+	FileHelpers::WriteContentsToFile(_settings.OutputPath, result.dump(1, '\t'));
+	LOG_INFO("Wrote benchmark results for {} frames to \"{}\"", _framesCollected, _settings.OutputPath);
+	return true;
+}
+
+void Benchmark::_CollectFrame(const ProfileFrame& frame) {
+	_framesCollected++;
+	_cpuFrameTimes.push_back((frame.End - frame.Start) / 1000000.0);
+
+	for (const ProfileTrack& track : frame.Tracks) {
+		bool isGpu = track.ThreadId == Profiler::GPU_TRACK_ID;
+		std::map<std::string, ScopeStats>& scopes = isGpu ? _gpuScopes : _cpuScopes;
+
+		// Events are stored as they end (children first), sort them so parents come first and we can build paths
+		std::vector<ProfileEvent> events = track.Events;
+		std::sort(events.begin(), events.end(), [](const ProfileEvent& a, const ProfileEvent& b) {
+			return a.Start != b.Start ? a.Start < b.Start : a.Depth < b.Depth;
+		});
+
+		std::vector<std::string> stack;
+		double gpuFrameTime = 0.0;
+		for (const ProfileEvent& e : events) {
+			stack.resize(e.Depth);
+			std::string path = stack.empty() ? e.Name : stack.back() + "/" + e.Name;
+			stack.push_back(path);
+
+			// Worker threads are all reported together, since jobs land on whichever one is free
+			std::string key = isGpu || track.ThreadId == 0 ? path : "Workers/" + path;
+
+			double ms = (e.End - e.Start) / 1000000.0;
+			ScopeStats& stats = scopes[key];
+			stats.TotalMs += ms;
+			stats.MaxMs = std::max(stats.MaxMs, ms);
+			stats.Calls++;
+
+			if (isGpu && e.Depth == 0) {
+				gpuFrameTime += ms;
+			}
+		}
+
+		if (isGpu) {
+			_gpuFrameTimes.push_back(gpuFrameTime);
+		}
+	}
+}
+
+void Benchmark::_SampleMemory() {
+	PROCESS_MEMORY_COUNTERS memory = PROCESS_MEMORY_COUNTERS();
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &memory, sizeof(memory))) {
+		_peakWorkingSet = std::max<uint64_t>(_peakWorkingSet, memory.WorkingSetSize);
+	}
+}
+
+void Benchmark::_SampleAllocations() {
+	// FrameMemory has already rolled over, so the last frame's stats are the ones for the frame that just ended
+	const FrameMemoryStats& stats = FrameMemory::GetLastFrameStats();
+	_allocationFrames++;
+	_allocationTotals.HeapAllocations  += stats.HeapAllocations;
+	_allocationTotals.HeapBytes        += stats.HeapBytes;
+	_allocationTotals.FrameAllocations += stats.FrameAllocations;
+	_allocationTotals.PoolAllocations  += stats.PoolAllocations;
+	// For the frame allocator we care about the peak, since that's what it's buffer grows to
+	_allocationTotals.FrameBytes = std::max(_allocationTotals.FrameBytes, stats.FrameBytes);
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <GLM/glm.hpp>
+#include <json.hpp>
+
+#include "Utils/FrameMemory.h"
+
+struct ProfileFrame;
+
+/**
+ * Drives the application through a fixed number of frames with a fixed timestep, without the editor,
+ * and collects frame time percentiles, per scope CPU/GPU timings (from the profiler) and memory stats
+ * into a JSON report. Started from the command line, ex:
+ *
+ *   --benchmark scene.json --frames 600 --warmup 60 --dt 0.0166667 --resolution 1280x720 --out results.json
+ *
+ * Leaving out the scene path benchmarks the scene created by the DefaultSceneLayer
+ */
+class Benchmark final {
+public:
+	struct Settings {
+		// The scene to load, or empty to use the default scene
+		std::string ScenePath;
+		// The number of frames to record stats for
+		uint32_t    Frames = 600;
+		// The number of frames to run before we start recording, lets loading and caches settle
+		uint32_t    WarmupFrames = 60;
+		// The timestep fed to the Timing singleton every frame, so gameplay is reproducible
+		float       DeltaTime = 1.0f / 60.0f;
+		// The size of the (hidden) window we render into
+		glm::ivec2  Resolution = glm::ivec2(1280, 720);
+		// Where to write the JSON report
+		std::string OutputPath = "benchmark.json";
+		// The API GLFW creates the context with, "native", "egl" or "osmesa" (for machines with no GPU, needs the OSMesa library)
+		std::string ContextApi = "native";
+		// If true, the window is shown while benchmarking
+		bool        ShowWindow = false;
+	};
+
+	Benchmark() = delete;
+
+	/**
+	 * Parses the benchmark settings from the command line
+	 * @returns True if the --benchmark flag was passed
+	 */
+	static bool ParseArguments(int argCount, char** arguments, Settings& settings);
+
+	/**
+	 * Puts the application into benchmark mode, must be called before the application is started
+	 */
+	static void Begin(const Settings& settings);
+	static bool IsActive() { return _active; }
+	static const Settings& GetSettings() { return _settings; }
+
+	/**
+	 * Collects the stats for any frames that have finished, should be called after the profiler's EndFrame
+	 * @returns True once all the frames have been run and the application should exit
+	 */
+	static bool EndFrame();
+
+	/**
+	 * Writes the report to the settings' output path, must be called while the GL context exists
+	 * @returns True if the report was written
+	 */
+	static bool WriteResults();
+
+	/**
+	 * Summarizes a set of times into the mean, standard deviation, min, max and percentiles that we report
+	 */
+	static nlohmann::json SummarizeTimes(std::vector<double> times);
+
+protected:
+	struct ScopeStats {
+		double   TotalMs = 0.0;
+		double   MaxMs   = 0.0;
+		uint32_t Calls   = 0;
+	};
+
+	static bool     _active;
+	static Settings _settings;
+	static uint64_t _firstFrame;
+	static uint64_t _lastCollected;
+	static uint32_t _framesRun;
+	static uint32_t _framesCollected;
+
+	static std::vector<double> _cpuFrameTimes;
+	static std::vector<double> _gpuFrameTimes;
+	static std::map<std::string, ScopeStats> _cpuScopes;
+	static std::map<std::string, ScopeStats> _gpuScopes;
+	static uint64_t _peakWorkingSet;
+	static uint32_t _allocationFrames;
+	static FrameMemoryStats _allocationTotals;
+
+	static void _CollectFrame(const ProfileFrame& frame);
+	static void _SampleMemory();
+	static void _SampleAllocations();
+};
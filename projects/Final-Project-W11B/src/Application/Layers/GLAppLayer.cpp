@@ -2,6 +2,8 @@
 #include "GLFW/glfw3.h"
 #include "Logging.h"
 #include "Application/Application.h"
+#include "Graphics/Buffers/PixelUploadBuffer.h"
+#include "Application/Benchmark.h"
 
 GLAppLayer::GLAppLayer() :
 	ApplicationLayer() {
@@ -22,10 +24,27 @@ void GLAppLayer::OnAppLoad(const nlohmann::json& config) {
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+	// Benchmarks render into a hidden window, and can use EGL or OSMesa for machines without a GPU or display
+	if (Benchmark::IsActive()) {
+		const Benchmark::Settings& settings = Benchmark::GetSettings();
+		glfwWindowHint(GLFW_VISIBLE, settings.ShowWindow);
+		if (settings.ContextApi == "egl") {
+			glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+		} else if (settings.ContextApi == "osmesa") {
+			glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+		}
+	}
+
 	//Create a new GLFW window and make it current
 	app._window = glfwCreateWindow(app._windowSize.x, app._windowSize.y, app._windowTitle.c_str(), nullptr, nullptr);
+	LOG_ASSERT(app._window != nullptr, "Failed to create window");
 	glfwMakeContextCurrent(app._window);
 
+	// We don't want vsync capping our benchmark results
+	if (Benchmark::IsActive()) {
+		glfwSwapInterval(0);
+	}
+
 	// Set our window resized callback
 	glfwSetWindowSizeCallback(app._window, GlWindowResizedCallback);
 
@@ -45,6 +64,10 @@ void GLAppLayer::OnAppLoad(const nlohmann::json& config) {
 void GLAppLayer::OnAppUnload()
 {
 	Application& app = Application::Get();
+
+	// Our upload ring is persistently mapped, release it while we still have a context
+	PixelUploadBuffer::ReleaseShared();
+
 	glfwDestroyWindow(app._window);
 	app._window = nullptr;
 	app._windowSize = glm::ivec2(0, 0);
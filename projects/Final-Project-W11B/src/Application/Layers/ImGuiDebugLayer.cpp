@@ -15,6 +15,7 @@
 #include "../Windows/DebugWindow.h"
 #include "../Windows/GBufferPreviews.h"
 #include "../Windows/PostProcessingSettingsWindow.h"
+#include "../Windows/ProfilerWindow.h"
 
 #include "Graphics/DebugDraw.h"
 
@@ -40,6 +41,7 @@ void ImGuiDebugLayer::OnAppLoad(const nlohmann::json& config)
 	RegisterWindow<DebugWindow>();
 	RegisterWindow<GBufferPreviews>();
 	RegisterWindow<PostProcessingSettingsWindow>();
+	RegisterWindow<ProfilerWindow>();
 }
 
 void ImGuiDebugLayer::OnAppUnload()
@@ -349,6 +351,25 @@ void ImGuiDebugLayer::_RenderGameWindow()
 
 	// Tell the viewport where to render the game contents to
 	app.SetPrimaryViewport(glm::vec4(relPos.x, rootSize.y - relPos.y - size.y, size.x, size.y));
+
+	// Ctrl+click in the game view selects the object under the mouse, left mouse alone is used by the camera controls
+	ImGuiIO& io = ImGui::GetIO();
+	if (!scene->IsPlaying && scene->MainCamera != nullptr && io.KeyCtrl && size.x > 0.0f && size.y > 0.0f &&
+		ImGui::IsWindowHovered() && ImGui::IsMouseClicked(0)) {
+		// Convert the mouse position into normalized device coordinates within the game view
+		glm::vec2 mouse = glm::vec2(io.MousePos.x - subPos.x - cursorPos.x, io.MousePos.y - subPos.y - cursorPos.y);
+		glm::vec2 ndc = glm::vec2(mouse.x / size.x * 2.0f - 1.0f, 1.0f - mouse.y / size.y * 2.0f);
+
+		// Unproject points on the near and far planes to get our picking ray
+		glm::mat4 invViewProj = glm::inverse(scene->MainCamera->GetViewProjection());
+		glm::vec4 nearPoint = invViewProj * glm::vec4(ndc, -1.0f, 1.0f);
+		glm::vec4 farPoint  = invViewProj * glm::vec4(ndc,  1.0f, 1.0f);
+		glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+		glm::vec3 end    = glm::vec3(farPoint) / farPoint.w;
+
+		GameObject* picked = scene->PickObject(origin, glm::normalize(end - origin), glm::length(end - origin));
+		app.EditorState.SelectedObject = picked != nullptr ? picked->SelfRef() : nullptr;
+	}
 	
 	// Finish window
 	ImGui::End();
@@ -1,16 +1,26 @@
 #include "LogicUpdateLayer.h"
 #include "../Application.h"
 #include "../Timing.h"
+#include "Gameplay/Physics/PhysicsSettings.h"
+#include "Utils/JsonGlmHelpers.h"
 
 LogicUpdateLayer::LogicUpdateLayer() :
 	ApplicationLayer()
 {
 	Name = "Logic";
-	Overrides = AppLayerFunctions::OnUpdate;
+	Overrides = AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnUpdate;
 }
 
 LogicUpdateLayer::~LogicUpdateLayer() = default;
 
+void LogicUpdateLayer::OnAppLoad(const nlohmann::json& config)
+{
+	// Scenes created from here on out will build their physics worlds with these, unless the scene overrides them
+	if (config.contains(Name)) {
+		Gameplay::Physics::PhysicsSettings::Default = Gameplay::Physics::PhysicsSettings::FromJson(JsonGet(config[Name], "physics", nlohmann::json()));
+	}
+}
+
 void LogicUpdateLayer::OnUpdate()
 {
 	Application& app = Application::Get();
@@ -21,3 +31,10 @@ void LogicUpdateLayer::OnUpdate()
 	// Update our worlds physics!
 	app.CurrentScene()->DoPhysics(Timing::Current().DeltaTime());
 }
+
+nlohmann::json LogicUpdateLayer::GetDefaultConfig()
+{
+	return {
+		{ "physics", Gameplay::Physics::PhysicsSettings::Default.ToJson() }
+	};
+}
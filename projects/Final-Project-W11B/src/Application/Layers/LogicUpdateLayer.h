@@ -10,8 +10,11 @@ public:
 
 	// Inherited from ApplicationLayer
 
+	virtual void OnAppLoad(const nlohmann::json& config) override;
 	virtual void OnUpdate() override;
 
+	virtual nlohmann::json GetDefaultConfig() override;
+
 protected:
 
 };
\ No newline at end of file
@@ -22,10 +22,8 @@ void ParticleLayer::OnUpdate()
 	// Only update the particle systems when the game is playing, so we can edit them in
 	// the inspector
 	if (app.CurrentScene()->IsPlaying) {
-		app.CurrentScene()->Components().Each<ParticleSystem>([](const ParticleSystem::Sptr& system) {
-			if (system->IsEnabled) {
-				system->Update();
-			}
+		app.CurrentScene()->Components().Each<ParticleSystem>([](ParticleSystem* system) {
+			system->Update();
 		});
 	}
 }
@@ -41,10 +39,8 @@ void ParticleLayer::OnPostRender()
 	renderOutput->Bind();
 	glViewport(0, 0, renderOutput->GetWidth(), renderOutput->GetHeight());
 
-	Application::Get().CurrentScene()->Components().Each<ParticleSystem>([](const ParticleSystem::Sptr& system) {
-		if (system->IsEnabled) {
-			system->Render(); 
-		}
+	Application::Get().CurrentScene()->Components().Each<ParticleSystem>([](ParticleSystem* system) {
+		system->Render(); 
 	});
 
 	//renderer->GetRenderOutput()->Unbind();
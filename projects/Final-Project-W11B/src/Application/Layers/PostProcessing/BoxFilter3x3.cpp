@@ -7,7 +7,8 @@
 #include <GLM/glm.hpp>
 
 BoxFilter3x3::BoxFilter3x3() :
-	PostProcessingLayer::Effect()
+	PostProcessingLayer::Effect(),
+	_separable(3)
 {
 	Name = "Box Filter";
 	_format = RenderTargetType::ColorRgb8;
@@ -26,15 +27,36 @@ BoxFilter3x3::~BoxFilter3x3() = default;
 
 void BoxFilter3x3::Apply(const Framebuffer::Sptr& gBuffer)
 {
-	_shader->Bind(); 
-	_shader->SetUniform("u_Filter", Filter, 9); 
-	_shader->SetUniform("u_PixelSize", glm::vec2(1.0f) / (glm::vec2)gBuffer->GetSize()); 
+	// The kernel is applied in the output's pixels, so lower resolutions cover more of the screen for the same cost
+	glm::ivec2 outputSize = _output->GetSize();
+
+	if (_separable.Update(Filter)) {
+		// Blur horizontally into the intermediate buffer, then vertically into our output (drawn by the layer)
+		_separable.BeginHorizontal(outputSize);
+		DrawFullscreen();
+		_separable.BeginVertical(_output);
+	} else {
+		_shader->Bind();
+		_shader->SetUniform("u_Filter", Filter, 9);
+		_shader->SetUniform("u_PixelSize", glm::vec2(1.0f) / (glm::vec2)outputSize);
+	}
 }
 
 void BoxFilter3x3::RenderImGui()
 {
 	ImGui::PushID(this);
 
+	static const char* resolutions[] = { "Full", "Half", "Quarter" };
+	int resolution = GetOutputScale() <= 0.25f ? 2 : GetOutputScale() <= 0.5f ? 1 : 0;
+	if (LABEL_LEFT(ImGui::Combo, "Resolution", &resolution, resolutions, 3)) {
+		SetOutputScale(1.0f / (1 << resolution));
+	}
+	if (_separable.Update(Filter)) {
+		ImGui::Text("Separable, %d samples per pixel (full kernel is 9)", _separable.GetSampleCount());
+	} else {
+		ImGui::Text("Not separable, 9 samples per pixel");
+	}
+
 	ImGui::Columns(3); 
 	for (int iy = 0; iy < 3; iy++) { 
 		for (int ix = 0; ix < 3; ix++) {
@@ -80,6 +102,7 @@ BoxFilter3x3::Sptr BoxFilter3x3::FromJson(const nlohmann::json& data)
 {
 	BoxFilter3x3::Sptr result = std::make_shared<BoxFilter3x3>();
 	result->Enabled = JsonGet(data, "enabled", true);
+	result->SetOutputScale(JsonGet(data, "output_scale", 1.0f));
 	std::vector<float> filter = JsonGet(data, "filter", std::vector<float>(9, 0.0f));
 	for (int ix = 0; ix < 9; ix++) {
 		result->Filter[ix] = filter[ix];
@@ -95,6 +118,7 @@ nlohmann::json BoxFilter3x3::ToJson() const
 	}
 	return {
 		{ "enabled", Enabled },
+		{ "output_scale", GetOutputScale() },
 		{ "filter", filter }
 	};
 }
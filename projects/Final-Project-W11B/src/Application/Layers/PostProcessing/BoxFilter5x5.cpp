@@ -7,7 +7,8 @@
 #include <GLM/glm.hpp>
 
 BoxFilter5x5::BoxFilter5x5() :
-	PostProcessingLayer::Effect()
+	PostProcessingLayer::Effect(),
+	_separable(5)
 {
 	Name = "Box Filter";
 	_format = RenderTargetType::ColorRgb8;
@@ -25,15 +26,36 @@ BoxFilter5x5::~BoxFilter5x5() = default;
 
 void BoxFilter5x5::Apply(const Framebuffer::Sptr& gBuffer)
 {
-	_shader->Bind();
-	_shader->SetUniform("u_Filter", Filter, 25);
-	_shader->SetUniform("u_PixelSize", glm::vec2(1.0f) / (glm::vec2)gBuffer->GetSize()); 
+	// The kernel is applied in the output's pixels, so lower resolutions cover more of the screen for the same cost
+	glm::ivec2 outputSize = _output->GetSize();
+
+	if (_separable.Update(Filter)) {
+		// Blur horizontally into the intermediate buffer, then vertically into our output (drawn by the layer)
+		_separable.BeginHorizontal(outputSize);
+		DrawFullscreen();
+		_separable.BeginVertical(_output);
+	} else {
+		_shader->Bind();
+		_shader->SetUniform("u_Filter", Filter, 25);
+		_shader->SetUniform("u_PixelSize", glm::vec2(1.0f) / (glm::vec2)outputSize);
+	}
 }
 
 void BoxFilter5x5::RenderImGui()
 {
 	ImGui::PushID(this);
 
+	static const char* resolutions[] = { "Full", "Half", "Quarter" };
+	int resolution = GetOutputScale() <= 0.25f ? 2 : GetOutputScale() <= 0.5f ? 1 : 0;
+	if (LABEL_LEFT(ImGui::Combo, "Resolution", &resolution, resolutions, 3)) {
+		SetOutputScale(1.0f / (1 << resolution));
+	}
+	if (_separable.Update(Filter)) {
+		ImGui::Text("Separable, %d samples per pixel (full kernel is 25)", _separable.GetSampleCount());
+	} else {
+		ImGui::Text("Not separable, 25 samples per pixel");
+	}
+
 	ImGui::Columns(5); 
 	for (int iy = 0; iy < 5; iy++) { 
 		for (int ix = 0; ix < 5; ix++) {
@@ -78,6 +100,7 @@ BoxFilter5x5::Sptr BoxFilter5x5::FromJson(const nlohmann::json& data)
 {
 	BoxFilter5x5::Sptr result = std::make_shared<BoxFilter5x5>();
 	result->Enabled = JsonGet(data, "enabled", true);
+	result->SetOutputScale(JsonGet(data, "output_scale", 1.0f));
 	std::vector<float> filter = JsonGet(data, "filter", std::vector<float>(25, 0.0f));
 	for (int ix = 0; ix < 25; ix++) {
 		result->Filter[ix] = filter[ix];
@@ -93,6 +116,7 @@ nlohmann::json BoxFilter5x5::ToJson() const
 	}
 	return {
 		{ "enabled", Enabled },
+		{ "output_scale", GetOutputScale() },
 		{ "filter", filter }
 	};
 }
@@ -3,6 +3,7 @@
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/Textures/Texture3D.h"
 #include "Graphics/Framebuffer.h"
+#include "SeparableFilter.h"
 
 class BoxFilter5x5 : public PostProcessingLayer::Effect {
 public:
@@ -22,4 +23,6 @@ public:
 
 protected:
 	ShaderProgram::Sptr _shader;
+	// Used instead of the full kernel when the filter can be split into two 1D passes
+	SeparableFilter _separable;
 };
\ No newline at end of file
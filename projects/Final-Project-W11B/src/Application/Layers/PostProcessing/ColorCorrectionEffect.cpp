@@ -2,6 +2,7 @@
 #include "Utils/ResourceManager/ResourceManager.h"
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/ImGuiHelper.h"
+#include "Utils/FileHelpers.h"
 
 ColorCorrectionEffect::ColorCorrectionEffect() :
 	ColorCorrectionEffect(true) { }
@@ -21,7 +22,11 @@ ColorCorrectionEffect::ColorCorrectionEffect(bool defaultLut) :
 	});
 
 	if (defaultLut) {
-		Lut = ResourceManager::CreateAsset<Texture3D>("luts/cool.cube");
+		// Store the LUT as half floats so we don't lose precision to 8 bit quantization
+		Texture3DDescription lutDescription = Texture3DDescription();
+		lutDescription.Filename = "luts/cool.cube";
+		lutDescription.Format = InternalFormat::RGB16F;
+		Lut = ResourceManager::CreateAsset<Texture3D>(lutDescription);
 	}
 }
 
@@ -34,6 +39,27 @@ void ColorCorrectionEffect::Apply(const Framebuffer::Sptr& gBuffer)
 	_shader->SetUniform("u_Strength", _strength);
 }
 
+PostProcessingLayer::Effect::FuseMode ColorCorrectionEffect::GetFuseMode() const
+{
+	return FuseMode::PerPixel;
+}
+
+std::string ColorCorrectionEffect::GetFusedSource() const
+{
+	return FileHelpers::ReadFile("shaders/fragments/post_fused/color_correction.glsl");
+}
+
+int ColorCorrectionEffect::GetFusedTextureCount() const
+{
+	return 1;
+}
+
+void ColorCorrectionEffect::ApplyFused(const ShaderProgram::Sptr& shader, const std::string& prefix, int textureSlot)
+{
+	Lut->Bind(textureSlot);
+	shader->SetUniform(prefix + "u_Strength", _strength);
+}
+
 void ColorCorrectionEffect::RenderImGui()
 {
 	LABEL_LEFT(ImGui::LabelText, "LUT", Lut ? Lut->GetDebugName().c_str() : "none");
@@ -15,6 +15,11 @@ public:
 	virtual void Apply(const Framebuffer::Sptr& gBuffer) override;
 	virtual void RenderImGui() override;
 
+	virtual FuseMode GetFuseMode() const override;
+	virtual std::string GetFusedSource() const override;
+	virtual int GetFusedTextureCount() const override;
+	virtual void ApplyFused(const ShaderProgram::Sptr& shader, const std::string& prefix, int textureSlot) override;
+
 	// Inherited from IResource
 
 	ColorCorrectionEffect::Sptr FromJson(const nlohmann::json& data);
@@ -2,6 +2,7 @@
 
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/ImGuiHelper.h"
+#include "Utils/FileHelpers.h"
 #include "../RenderLayer.h"
 #include "Application/Application.h"
 
@@ -34,6 +35,27 @@ void NightVision::Apply(const Framebuffer::Sptr& gBuffer)
 	} 
 } 
 
+PostProcessingLayer::Effect::FuseMode NightVision::GetFuseMode() const
+{
+	return FuseMode::SamplesInput;
+}
+
+std::string NightVision::GetFusedSource() const
+{
+	return FileHelpers::ReadFile("shaders/fragments/post_fused/night_vision.glsl");
+}
+
+void NightVision::ApplyFused(const ShaderProgram::Sptr& shader, const std::string& prefix, int textureSlot)
+{
+	const auto& nvToggle = Application::Get().CurrentScene()->FindObjectByName("nvToggle");
+
+	if (nvToggle != nullptr)
+	{
+		shader->SetUniform(prefix + "loadTime", nvToggle->Get<SimpleToggle>()->nvToggleTime);
+		shader->SetUniform(prefix + "isToggleOn", nvToggle->Get<SimpleToggle>()->isNvOn);
+	}
+}
+
 void NightVision::RenderImGui()
 {
 	const auto& nvToggle = Application::Get().CurrentScene()->FindObjectByName("nvToggle");
@@ -16,6 +16,10 @@ public:
 	virtual void Apply(const Framebuffer::Sptr& gBuffer) override;
 	virtual void RenderImGui() override;
 
+	virtual FuseMode GetFuseMode() const override;
+	virtual std::string GetFusedSource() const override;
+	virtual void ApplyFused(const ShaderProgram::Sptr& shader, const std::string& prefix, int textureSlot) override;
+
 	// Inherited from IResource
 
 	NightVision::Sptr FromJson(const nlohmann::json& data);
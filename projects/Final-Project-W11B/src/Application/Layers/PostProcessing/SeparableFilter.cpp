@@ -0,0 +1,144 @@
+#include "SeparableFilter.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+
+#include <GLM/glm.hpp>
+
+SeparableFilter::SeparableFilter(int size) :
+	_size(size),
+	_kernel(),
+	_isSeparable(false),
+	_horizontal(),
+	_vertical(),
+	_shader(nullptr),
+	_intermediate(nullptr)
+{
+	LOG_ASSERT(size % 2 == 1 && size <= MAX_TAPS, "Kernel size must be odd and at most {}", MAX_TAPS);
+
+	_shader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
+		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/separable_filter.glsl" }
+	});
+}
+
+SeparableFilter::~SeparableFilter() = default;
+
+bool SeparableFilter::Update(const float* kernel)
+{
+	// Only re-calculate if the kernel has been edited
+	if (_kernel.size() == _size * _size && memcmp(_kernel.data(), kernel, sizeof(float) * _kernel.size()) == 0) {
+		return _isSeparable;
+	}
+	_kernel.assign(kernel, kernel + _size * _size);
+
+	// Find the largest element, we use it's row and column as the 1D kernels
+	int row = 0, col = 0;
+	float largest = 0.0f;
+	for (int iy = 0; iy < _size; iy++) {
+		for (int ix = 0; ix < _size; ix++) {
+			if (glm::abs(kernel[iy * _size + ix]) > largest) {
+				largest = glm::abs(kernel[iy * _size + ix]);
+				row = iy;
+				col = ix;
+			}
+		}
+	}
+
+	// K = v * h, where h is the row containing the largest element and v is it's column scaled by 1 / K[row][col]
+	std::vector<float> horizontal(_size, 0.0f);
+	std::vector<float> vertical(_size, 0.0f);
+	if (largest > 0.0f) {
+		for (int ix = 0; ix < _size; ix++) {
+			horizontal[ix] = kernel[row * _size + ix];
+			vertical[ix] = kernel[ix * _size + col] / kernel[row * _size + col];
+		}
+	}
+
+	// Make sure the kernel is actually rank 1, otherwise we need the full 2D kernel
+	const float epsilon = 1e-5f * glm::max(largest, 1.0f);
+	_isSeparable = true;
+	for (int iy = 0; iy < _size && _isSeparable; iy++) {
+		for (int ix = 0; ix < _size && _isSeparable; ix++) {
+			_isSeparable = glm::abs(kernel[iy * _size + ix] - vertical[iy] * horizontal[ix]) <= epsilon;
+		}
+	}
+
+	if (_isSeparable) {
+		_BuildPass(horizontal.data(), _horizontal);
+		_BuildPass(vertical.data(), _vertical);
+	}
+	return _isSeparable;
+}
+
+void SeparableFilter::BeginHorizontal(const glm::ivec2& outputSize)
+{
+	// Keep the intermediate result in half floats so we don't quantize between the passes
+	if (_intermediate == nullptr) {
+		FramebufferDescriptor fboDesc = FramebufferDescriptor();
+		fboDesc.Width  = outputSize.x;
+		fboDesc.Height = outputSize.y;
+		fboDesc.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(RenderTargetType::ColorRgb16F);
+		_intermediate = std::make_shared<Framebuffer>(fboDesc);
+	} else {
+		_intermediate->Resize(outputSize);
+	}
+
+	_intermediate->Bind();
+	glViewport(0, 0, outputSize.x, outputSize.y);
+
+	_shader->Bind();
+	_ApplyPass(_horizontal, glm::vec2(1.0f / outputSize.x, 0.0f));
+}
+
+void SeparableFilter::BeginVertical(const Framebuffer::Sptr& output)
+{
+	_intermediate->Unbind();
+
+	output->Bind();
+	glViewport(0, 0, output->GetWidth(), output->GetHeight());
+	_intermediate->BindAttachment(RenderTargetAttachment::Color0, 0);
+
+	_ApplyPass(_vertical, glm::vec2(0.0f, 1.0f / output->GetHeight()));
+}
+
+int SeparableFilter::GetSampleCount() const
+{
+	return _horizontal.TapCount + _vertical.TapCount;
+}
+
+void SeparableFilter::_BuildPass(const float* weights, Pass& pass)
+{
+	const int radius = _size / 2;
+	pass.TapCount = 0;
+
+	for (int ix = 0; ix < _size; ix++) {
+		// Taps with no weight can be skipped entirely
+		if (weights[ix] == 0.0f) {
+			continue;
+		}
+
+		float offset = (float)(ix - radius);
+		float weight = weights[ix];
+
+		// If the next tap has the same sign, we can sample between the two and let the
+		// linear filtering do the weighting for us
+		if (ix + 1 < _size && weights[ix + 1] != 0.0f && (weights[ix] > 0.0f) == (weights[ix + 1] > 0.0f)) {
+			weight = weights[ix] + weights[ix + 1];
+			offset += weights[ix + 1] / weight;
+			ix++;
+		}
+
+		pass.Offsets[pass.TapCount] = offset;
+		pass.Weights[pass.TapCount] = weight;
+		pass.TapCount++;
+	}
+}
+
+void SeparableFilter::_ApplyPass(const Pass& pass, const glm::vec2& step)
+{
+	_shader->SetUniform("u_Step", step);
+	_shader->SetUniform("u_TapCount", pass.TapCount);
+	if (pass.TapCount > 0) {
+		_shader->SetUniform("u_Offsets", pass.Offsets, pass.TapCount);
+		_shader->SetUniform("u_Weights", pass.Weights, pass.TapCount);
+	}
+}
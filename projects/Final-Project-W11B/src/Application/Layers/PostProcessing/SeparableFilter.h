@@ -0,0 +1,70 @@
+#pragma once
+#include "Graphics/ShaderProgram.h"
+#include "Graphics/Framebuffer.h"
+
+/**
+ * Helper for the kernel based filters, which splits an n x n kernel into a horizontal
+ * and a vertical pass when the kernel is separable (rank 1). Neighbouring taps with
+ * weights of the same sign are merged into a single bilinear sample, so a 5 tap row
+ * only needs 3 texture reads
+ */
+class SeparableFilter {
+public:
+	// The most taps that a single pass can have after merging
+	static const int MAX_TAPS = 8;
+
+	/**
+	 * Creates a new separable filter helper for kernels of the given width
+	 * @param size The width and height of the kernel, must be odd and at most MAX_TAPS
+	 */
+	SeparableFilter(int size);
+	~SeparableFilter();
+
+	/**
+	 * Updates the kernel, and re-calculates the passes if it has changed
+	 * @param kernel The kernel, in row major order with rows going up the screen (size x size elements)
+	 * @returns True if the kernel can be rendered with two 1D passes
+	 */
+	bool Update(const float* kernel);
+
+	/**
+	 * Binds the intermediate buffer and sets up the horizontal pass, the caller should
+	 * draw a fullscreen quad after this. Texture slot 0 should contain the input image
+	 * @param outputSize The size of the effect's output, in pixels
+	 */
+	void BeginHorizontal(const glm::ivec2& outputSize);
+	/**
+	 * Binds the output and sets up the vertical pass, reading from the intermediate buffer.
+	 * The caller should draw a fullscreen quad after this
+	 * @param output The framebuffer to render the final result into
+	 */
+	void BeginVertical(const Framebuffer::Sptr& output);
+
+	/**
+	 * Gets the number of texture reads per pixel when using the separable passes
+	 */
+	int GetSampleCount() const;
+
+protected:
+	struct Pass {
+		float Offsets[MAX_TAPS];
+		float Weights[MAX_TAPS];
+		int   TapCount = 0;
+	};
+
+	int _size;
+	std::vector<float> _kernel;
+	bool _isSeparable;
+
+	Pass _horizontal;
+	Pass _vertical;
+
+	ShaderProgram::Sptr _shader;
+	Framebuffer::Sptr   _intermediate;
+
+	/**
+	 * Builds the taps for a single pass from a row of weights, merging neighbours into bilinear taps
+	 */
+	void _BuildPass(const float* weights, Pass& pass);
+	void _ApplyPass(const Pass& pass, const glm::vec2& step);
+};
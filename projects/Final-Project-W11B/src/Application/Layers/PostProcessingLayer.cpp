@@ -10,6 +10,17 @@
 #include "PostProcessing/DepthOfField.h"
 #include "PostProcessing/NightVision.h"
 
+#include "Utils/StringUtils.h"
+#include "Application/Profiler.h"
+#include <sstream>
+
+/**
+ * Gets the size of an effect's output for the given screen size, never going below 1x1
+ */
+static glm::ivec2 ScaledOutputSize(const glm::ivec2& size, const glm::vec2& scale) {
+	return glm::max(glm::ivec2(glm::vec2(size) * scale), glm::ivec2(1));
+}
+
 PostProcessingLayer::PostProcessingLayer() :
 	ApplicationLayer()
 {
@@ -48,9 +59,10 @@ void PostProcessingLayer::OnAppLoad(const nlohmann::json& config)
 
 	// Initialize all the effect's output FBOs (inefficient) 
 	for (const auto& effect : _effects) {
+		glm::ivec2 size = ScaledOutputSize({ viewport.z, viewport.w }, effect->_outputScale);
 		FramebufferDescriptor fboDesc = FramebufferDescriptor();
-		fboDesc.Width  = viewport.z * effect->_outputScale.x;
-		fboDesc.Height = viewport.w * effect->_outputScale.y;
+		fboDesc.Width  = size.x;
+		fboDesc.Height = size.y;
 		fboDesc.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(effect->_format);
 
 		effect->_output = std::make_shared<Framebuffer>(fboDesc);
@@ -89,28 +101,61 @@ void PostProcessingLayer::OnPostRender()
 	glDepthMask(false);
 	glDisable(GL_BLEND);
 
+	// Regroup our effects into passes if any have been toggled since last frame
+	bool needsRebuild = _passEnabledState.size() != _effects.size();
+	for (size_t ix = 0; !needsRebuild && ix < _effects.size(); ix++) {
+		needsRebuild = _passEnabledState[ix] != _effects[ix]->Enabled;
+	}
+	if (needsRebuild) {
+		_BuildPasses();
+	}
+
 	// Bind the quad VAO so our effects can use it
 	_quadVAO->Bind();
 
-	// Iterate over all the effects in the queue
-	for (const auto& effect : _effects) {
-		// Only render if it's enabled
-		if (effect->Enabled) {
-			// Bind the FBO and make sure we're rendering to the whole thing
-			effect->_output->Bind();
-			glViewport(0, 0, effect->_output->GetWidth(), effect->_output->GetHeight());
-
-			// Bind color 0 from previous pass to texture slot 0 so our effects can access
-			current->BindAttachment(RenderTargetAttachment::Color0, 0);
-
-			// Apply the effect and render the fullscreen quad
-			effect->Apply(gBuffer);
-			_quadVAO->Draw();
-
-			// Unbind output and set it as input for next pass
-			effect->_output->Unbind();
-			current = effect->_output;
+	// Iterate over all the passes, each of which is one or more effects
+	for (Pass& pass : _passes) {
+		// Fused passes render into the output of their last effect
+		Effect* target = pass.Effects.back();
+
+		// Fused passes are named after their shader, which lives as long as our cache
+		PROFILE_GPU_SCOPE(pass.FusedShader != nullptr ? pass.FusedShader->GetDebugName().c_str() : target->Name.c_str());
+
+		// Effects can change their scale at runtime, this does nothing if the size matches
+		target->_output->Resize(ScaledOutputSize({ viewport.z, viewport.w }, target->_outputScale));
+
+		// Bind the FBO and make sure we're rendering to the whole thing
+		target->_output->Bind();
+		glViewport(0, 0, target->_output->GetWidth(), target->_output->GetHeight());
+
+		// Bind color 0 from previous pass to texture slot 0 so our effects can access
+		current->BindAttachment(RenderTargetAttachment::Color0, 0);
+
+		pass.Timer->Begin();
+
+		// Apply the effect(s) and render the fullscreen quad
+		if (pass.FusedShader != nullptr) {
+			pass.FusedShader->Bind();
+			for (size_t ix = 0; ix < pass.Effects.size(); ix++) {
+				pass.Effects[ix]->ApplyFused(pass.FusedShader, pass.Prefixes[ix], pass.TextureSlots[ix]);
+			}
+		} else {
+			target->Apply(gBuffer);
+		}
+		_quadVAO->Draw();
+
+		pass.Timer->End();
+
+		// Results come from a few frames ago, but that's fine for a readout
+		float gpuTime = pass.Timer->GetMilliseconds();
+		for (Effect* effect : pass.Effects) {
+			effect->_gpuTime = gpuTime;
+			effect->_passEffectCount = static_cast<int>(pass.Effects.size());
 		}
+
+		// Unbind output and set it as input for next pass
+		target->_output->Unbind();
+		current = target->_output;
 	}
 	_quadVAO->Unbind();
 
@@ -158,10 +203,142 @@ void PostProcessingLayer::OnWindowResize(const glm::ivec2& oldSize, const glm::i
 {
 	for (const auto& effect : _effects) {
 		effect->OnWindowResize(oldSize, newSize);
-		effect->_output->Resize(newSize.x, newSize.y);
+		effect->_output->Resize(ScaledOutputSize(newSize, effect->_outputScale));
 	}
 }
 
+void PostProcessingLayer::_BuildPasses() {
+	_passes.clear();
+	_passEnabledState.resize(_effects.size());
+
+	// Group the enabled effects, per pixel effects get merged into the pass before them if it can be fused,
+	// and effects that sample their input can follow a pass made up of only per pixel effects
+	std::vector<std::string> keys;
+	bool canAppend = false;
+	bool allPerPixel = false;
+	for (size_t ix = 0; ix < _effects.size(); ix++) {
+		Effect* effect = _effects[ix].get();
+		_passEnabledState[ix] = effect->Enabled;
+		effect->_gpuTime = 0.0f;
+		effect->_passEffectCount = 1;
+
+		if (!effect->Enabled) {
+			continue;
+		}
+
+		Effect::FuseMode mode = effect->GetFuseMode();
+		if ((mode == Effect::FuseMode::PerPixel && canAppend) || (mode == Effect::FuseMode::SamplesInput && allPerPixel)) {
+			_passes.back().Effects.push_back(effect);
+			keys.back() += "," + std::to_string(ix);
+			allPerPixel = allPerPixel && mode == Effect::FuseMode::PerPixel;
+		} else {
+			_passes.emplace_back();
+			_passes.back().Effects.push_back(effect);
+			keys.push_back(std::to_string(ix));
+			allPerPixel = mode == Effect::FuseMode::PerPixel;
+		}
+		canAppend = mode != Effect::FuseMode::None;
+	}
+
+	// Generate the shaders for any passes with more than one effect
+	std::vector<Pass> passes;
+	std::vector<std::string> passKeys;
+	for (size_t ix = 0; ix < _passes.size(); ix++) {
+		Pass& pass = _passes[ix];
+		if (pass.Effects.size() > 1) {
+			// Slot 0 is the input image, so effect textures start at 1
+			int textureSlot = 1;
+			for (size_t iy = 0; iy < pass.Effects.size(); iy++) {
+				pass.Prefixes.push_back("e" + std::to_string(iy) + "_");
+				pass.TextureSlots.push_back(textureSlot);
+				textureSlot += pass.Effects[iy]->GetFusedTextureCount();
+			}
+
+			auto it = _fusedShaders.find(keys[ix]);
+			if (it == _fusedShaders.end()) {
+				it = _fusedShaders.emplace(keys[ix], _CreateFusedShader(pass)).first;
+			}
+			pass.FusedShader = it->second;
+
+			// Fall back to running the effects one at a time if we couldn't generate a shader
+			if (pass.FusedShader == nullptr) {
+				std::vector<std::string> indices = StringTools::Split(keys[ix]);
+				for (size_t iy = 0; iy < pass.Effects.size(); iy++) {
+					Pass single;
+					single.Effects.push_back(pass.Effects[iy]);
+					passes.push_back(std::move(single));
+					passKeys.push_back(indices[iy]);
+				}
+				continue;
+			}
+		}
+		passes.push_back(std::move(pass));
+		passKeys.push_back(keys[ix]);
+	}
+	_passes = std::move(passes);
+
+	// Grab timers for each pass, re-using ones from previous builds so they keep their results
+	for (size_t ix = 0; ix < _passes.size(); ix++) {
+		GpuTimer::Sptr& timer = _passTimers[passKeys[ix]];
+		if (timer == nullptr) {
+			timer = std::make_shared<GpuTimer>();
+		}
+		_passes[ix].Timer = timer;
+	}
+}
+
+ShaderProgram::Sptr PostProcessingLayer::_CreateFusedShader(Pass& pass) {
+	std::stringstream source;
+	source << "#version 430\n\n";
+	source << "layout(location = 0) in vec2 inUV;\n";
+	source << "layout(location = 0) out vec4 outColor;\n\n";
+	source << "uniform layout(binding = 0) sampler2D s_Image;\n\n";
+
+	std::string name = "Fused:";
+	for (size_t ix = 0; ix < pass.Effects.size(); ix++) {
+		Effect* effect = pass.Effects[ix];
+		std::string stage = effect->GetFusedSource();
+
+		// Resolve texture slots first, since they share our prefix token
+		for (int slot = effect->GetFusedTextureCount() - 1; slot >= 0; slot--) {
+			StringTools::ReplaceAll(stage, "$TEX" + std::to_string(slot), std::to_string(pass.TextureSlots[ix] + slot));
+		}
+		StringTools::ReplaceAll(stage, "$", pass.Prefixes[ix]);
+
+		// Sampling the input needs to apply all the (per pixel) effects before this one to the sample
+		source << "// " << effect->Name << "\n";
+		source << "vec4 " << pass.Prefixes[ix] << "SampleInput(vec2 uv) {\n";
+		source << "\tvec4 color = texture(s_Image, uv);\n";
+		for (size_t iy = 0; iy < ix; iy++) {
+			source << "\tcolor = " << pass.Prefixes[iy] << "Apply(color, uv);\n";
+		}
+		source << "\treturn color;\n}\n\n";
+		source << stage << "\n\n";
+		name += " " + effect->Name;
+	}
+
+	// Each effect feeds it's color into the next
+	source << "void main() {\n";
+	source << "\tvec4 color = texture(s_Image, inUV);\n";
+	for (size_t ix = 0; ix < pass.Effects.size(); ix++) {
+		source << "\tcolor = " << pass.Prefixes[ix] << "Apply(color, inUV);\n";
+	}
+	source << "\toutColor = color;\n";
+	source << "}\n";
+
+	ShaderProgram::Sptr result = ShaderProgram::Create();
+	bool success = result->LoadShaderPartFromFile("shaders/vertex_shaders/fullscreen_quad.glsl", ShaderPartType::Vertex);
+	success = success && result->LoadShaderPart(source.str().c_str(), ShaderPartType::Fragment);
+	success = success && result->Link();
+	if (!success) {
+		LOG_WARN("Failed to generate fused post processing shader for{}, effects will run separately", name.substr(6));
+		return nullptr;
+	}
+
+	result->SetDebugName(name);
+	return result;
+}
+
 const std::vector<PostProcessingLayer::Effect::Sptr>& PostProcessingLayer::GetEffects() const
 {
 	return _effects;
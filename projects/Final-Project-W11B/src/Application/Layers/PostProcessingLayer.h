@@ -3,6 +3,8 @@
 #include "Application/ApplicationLayer.h"
 #include "Utils/Macros.h"
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/ShaderProgram.h"
+#include "Graphics/GpuTimer.h"
 
 /**
  * The post processing layer will handle rendering effects after the primary
@@ -19,6 +21,18 @@ public:
 	public:
 		MAKE_PTRS(Effect);
 
+		/**
+		 * Describes whether an effect can be merged with it's neighbours into a single generated pass
+		 */
+		enum class FuseMode {
+			// The effect needs it's own pass (ex: it reads neighbouring pixels of a previous effect's output)
+			None,
+			// The effect only needs the color of the current pixel, and can go anywhere in a fused pass
+			PerPixel,
+			// The effect samples the input image at arbitrary UVs, so it can only follow per pixel effects in a fused pass
+			SamplesInput
+		};
+
 		// True if this effect is enabled, false if otherwise
 		bool Enabled = true;
 
@@ -51,6 +65,50 @@ public:
 		 */
 		virtual void RenderImGui() {}
 
+		/**
+		 * Gets how this effect can be fused with other effects, by default effects are not fused
+		 */
+		virtual FuseMode GetFuseMode() const { return FuseMode::None; }
+		/**
+		 * Gets the GLSL source for this effect when it is fused into a generated shader. The source must
+		 * define "vec4 $Apply(vec4 color, vec2 uv)", returning the color after the effect is applied.
+		 * $ will be replaced with a prefix unique to this effect, so all uniforms and functions should
+		 * start with it. $TEX0, $TEX1, ... are replaced with the texture slots reserved for this effect,
+		 * and effects that sample the input may call $SampleInput(uv), which includes any effects before it in the pass
+		 */
+		virtual std::string GetFusedSource() const { return ""; }
+		/**
+		 * Gets the number of texture slots this effect needs when fused
+		 */
+		virtual int GetFusedTextureCount() const { return 0; }
+		/**
+		 * Sets the uniforms and binds the textures for this effect when it is part of a fused pass
+		 * @param shader The generated shader, which is already bound
+		 * @param prefix The prefix that $ was replaced with in the source
+		 * @param textureSlot The first texture slot reserved for this effect
+		 */
+		virtual void ApplyFused(const ShaderProgram::Sptr& shader, const std::string& prefix, int textureSlot) {}
+
+		/**
+		 * Gets the GPU time in milliseconds of the pass this effect was last rendered in. Effects
+		 * that are fused report the time of the whole fused pass
+		 */
+		float GetGpuTime() const { return _gpuTime; }
+		/**
+		 * Gets the number of effects in the pass this effect was last rendered in, 1 if it was not fused
+		 */
+		int GetPassEffectCount() const { return _passEffectCount; }
+
+		/**
+		 * Sets the resolution of this effect's output relative to the screen, ex 0.5 for half resolution.
+		 * Effects after this one will sample the output with bilinear filtering, which upsamples it
+		 */
+		void SetOutputScale(float scale) { _outputScale = glm::vec2(glm::clamp(scale, 0.0f, 1.0f)); }
+		/**
+		 * Gets the resolution of this effect's output relative to the screen
+		 */
+		float GetOutputScale() const { return _outputScale.x; }
+
 		/**
 		 * Helper for drawing a fullscreen quad from within this effect. Uses
 		 * state from the post processing layer, and cannot be used outside of
@@ -67,6 +125,10 @@ public:
 		glm::vec2 _outputScale = glm::vec2(1);
 		// The render target format for the effect's buffer
 		RenderTargetType _format = RenderTargetType::ColorRgba8;
+		// The GPU time of the last pass this effect was a part of
+		float _gpuTime = 0.0f;
+		// The number of effects in the last pass this effect was a part of
+		int _passEffectCount = 1;
 		
 		Effect() = default;
 	};
@@ -110,6 +172,32 @@ public:
 protected:
 	friend class Effect;
 
+	// A single fullscreen pass, made up of one or more effects
+	struct Pass {
+		std::vector<Effect*> Effects;
+		ShaderProgram::Sptr  FusedShader; // Only set if multiple effects were fused
+		std::vector<std::string> Prefixes;
+		std::vector<int>     TextureSlots;
+		GpuTimer::Sptr       Timer;
+	};
+
 	std::vector<Effect::Sptr> _effects;
 	VertexArrayObject::Sptr _quadVAO;
+
+	// The passes generated from the enabled effects, rebuilt when effects are toggled
+	std::vector<Pass> _passes;
+	std::vector<bool> _passEnabledState;
+	// Generated shaders, keyed by the indices of the effects they contain
+	std::unordered_map<std::string, ShaderProgram::Sptr> _fusedShaders;
+	// Timers for each pass, keyed the same as the shaders so the readouts survive rebuilds
+	std::unordered_map<std::string, GpuTimer::Sptr> _passTimers;
+
+	/**
+	 * Groups the enabled effects into passes, fusing neighbouring effects where possible
+	 */
+	void _BuildPasses();
+	/**
+	 * Generates the shader for a set of fused effects
+	 */
+	ShaderProgram::Sptr _CreateFusedShader(Pass& pass);
 };
\ No newline at end of file
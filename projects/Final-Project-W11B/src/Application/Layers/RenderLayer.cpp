@@ -16,6 +16,7 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <GLM/gtx/common.hpp> // for fmod (floating modulus)
 #include "Gameplay/Components/ShadowCamera.h"
+#include "Application/Profiler.h"
 
 
 RenderLayer::RenderLayer() :
@@ -25,6 +26,7 @@ RenderLayer::RenderLayer() :
 	_frameUniforms(nullptr),
 	_instanceUniforms(nullptr),
 	_renderFlags(RenderFlags::None),
+	_lodPixelError(1.0f),
 	_clearColor({ 0.1f, 0.1f, 0.1f, 1.0f })
 {
 	Name = "Rendering";
@@ -193,7 +195,7 @@ void RenderLayer::_AccumulateLighting()
 	// Send in how many active lights we have and the global lighting settings
 	data.AmbientCol = glm::vec3(0.1f);
 	int ix = 0;
-	app.CurrentScene()->Components().Each<Light>([&](const Light::Sptr& light) {
+	app.CurrentScene()->Components().Each<Light>([&](Light* light) {
 		// Get the light's position in view space, since we're doing view space lighting
 		glm::vec4 pos = glm::vec4(light->GetGameObject()->GetWorldPosition(), 1.0f);
 		pos = view * pos;
@@ -232,13 +234,15 @@ void RenderLayer::_AccumulateLighting()
 	}
 
 	// Re-render the scene for shadows
-	app.CurrentScene()->Components().Each<ShadowCamera>([&](const ShadowCamera::Sptr& shadowCam) {
+	app.CurrentScene()->Components().Each<ShadowCamera>([&](ShadowCamera* shadowCam) {
+		PROFILE_GPU_SCOPE(Profiler::InternName("Shadow Map: " + shadowCam->GetGameObject()->Name));
+
 		// Bind the shadow camera's depth buffer and clear it
 		shadowCam->GetDepthBuffer()->Bind();
 		glClear(GL_DEPTH_BUFFER_BIT);
 		glViewport(0, 0, shadowCam->GetBufferResolution().x, shadowCam->GetBufferResolution().y);
 
-		_RenderScene(shadowCam->GetGameObject()->GetInverseTransform(), shadowCam->GetProjection(), shadowCam->GetDepthBuffer()->GetSize());
+		_RenderScene(shadowCam->GetGameObject()->GetInverseTransform(), shadowCam->GetProjection(), shadowCam->GetDepthBuffer()->GetSize(), shadowCam->LodBias);
 
 		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 	});
@@ -260,7 +264,8 @@ void RenderLayer::_AccumulateLighting()
 	_shadowShader->Bind();
 
 	// Add each shadow casting light to the lighting buffers
-	app.CurrentScene()->Components().Each<ShadowCamera>([&](const ShadowCamera::Sptr& shadowCam) {
+	app.CurrentScene()->Components().Each<ShadowCamera>([&](ShadowCamera* shadowCam) {
+		PROFILE_GPU_SCOPE(Profiler::InternName("Shadow Composite: " + shadowCam->GetGameObject()->Name));
 
 		// This gets us the light -> view space matrix, which we'll inverse to go from view space to light space
 		glm::mat4 lightSpaceMatrix = camera->GetView() * shadowCam->GetGameObject()->GetTransform();
@@ -502,6 +507,14 @@ RenderFlags RenderLayer::GetRenderFlags() const {
 	return _renderFlags;
 }
 
+void RenderLayer::SetLodPixelError(float value) {
+	_lodPixelError = value;
+}
+
+float RenderLayer::GetLodPixelError() const {
+	return _lodPixelError;
+}
+
 const Framebuffer::Sptr& RenderLayer::GetLightingBuffer() const {
 	return _lightingFBO;
 }
@@ -544,7 +557,7 @@ void RenderLayer::_InitFrameUniforms()
 	_frameUniforms->Update();
 }
 
-void RenderLayer::_RenderScene(const glm::mat4& view, const glm::mat4& projection, const glm::ivec2& screenSize)
+void RenderLayer::_RenderScene(const glm::mat4& view, const glm::mat4& projection, const glm::ivec2& screenSize, float lodBias)
 {
 	using namespace Gameplay;
 
@@ -566,8 +579,13 @@ void RenderLayer::_RenderScene(const glm::mat4& view, const glm::mat4& projectio
 	frameData.u_Viewport = { 0.0f, 0.0f, screenSize.x, screenSize.y };
 	_frameUniforms->Update();
 
+	// How many pixels a unit long object covers at a view depth of 1 (or at any depth for orthographic projections)
+	float pixelsPerUnit = projection[1][1] * 0.5f * screenSize.y;
+	bool isPerspective = projection[3][3] == 0.0f;
+	float maxPixelError = _lodPixelError * lodBias;
+
 	// Render all our objects
-	app.CurrentScene()->Components().Each<RenderComponent>([&](const RenderComponent::Sptr& renderable) {
+	app.CurrentScene()->Components().Each<RenderComponent>([&](RenderComponent* renderable) {
 		// Early bail if mesh not set
 		if (renderable->GetMesh() == nullptr) {
 			return;
@@ -605,8 +623,28 @@ void RenderLayer::_RenderScene(const glm::mat4& view, const glm::mat4& projectio
 		instanceData.u_NormalMatrix = glm::mat3(glm::transpose(glm::inverse(object->GetTransform())));
 		_instanceUniforms->Update();
 
+		// Pick the coarsest level of detail whose simplification error stays under our pixel threshold on screen
+		VertexArrayObject::Sptr mesh = renderable->GetMesh();
+		uint32_t lod = 0;
+		if (mesh->GetLodCount() > 1 && mesh->HasBounds()) {
+			const glm::mat4& transform = object->GetTransform();
+			float scale = glm::max(glm::max(glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1]))), glm::length(glm::vec3(transform[2])));
+			glm::vec3 center = (mesh->GetBoundsMin() + mesh->GetBoundsMax()) * 0.5f;
+			float radius = glm::length(mesh->GetBoundsMax() - mesh->GetBoundsMin()) * 0.5f * scale;
+
+			// Perspective projections shrink things with distance, we use the closest point of the bounds to be safe
+			float depth = 1.0f;
+			if (isPerspective) {
+				depth = -(instanceData.u_ModelView * glm::vec4(center, 1.0f)).z - radius;
+			}
+			if (depth > 0.0f) {
+				float unitsToPixels = pixelsPerUnit * scale / depth;
+				lod = mesh->SelectLod(maxPixelError / unitsToPixels);
+			}
+		}
+
 		// Draw the object
-		renderable->GetMesh()->Draw();
+		mesh->DrawLod(lod);
 
 	});
 
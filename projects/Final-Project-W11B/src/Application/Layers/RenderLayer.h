@@ -110,6 +110,13 @@ public:
 	void SetRenderFlags(RenderFlags value);
 	RenderFlags GetRenderFlags() const;
 
+	/// <summary>
+	/// Sets how many pixels of mesh simplification error are acceptable on screen before a more
+	/// detailed level of detail is used. Higher values trade quality for speed
+	/// </summary>
+	void SetLodPixelError(float value);
+	float GetLodPixelError() const;
+
 	const Framebuffer::Sptr& GetLightingBuffer() const;
 	const Framebuffer::Sptr& GetRenderOutput() const;
 	const Framebuffer::Sptr& GetGBuffer() const;
@@ -139,6 +146,7 @@ protected:
 	bool              _blitFbo;
 	glm::vec4         _clearColor;
 	RenderFlags       _renderFlags;
+	float             _lodPixelError;
 
 	const int FRAME_UBO_BINDING = 0;
 	UniformBuffer<FrameLevelUniforms>::Sptr _frameUniforms;
@@ -150,7 +158,7 @@ protected:
 	UniformBuffer<LightingUboStruct>::Sptr _lightingUbo;
 
 	void _InitFrameUniforms();
-	void _RenderScene(const glm::mat4& view, const glm::mat4&Projection, const glm::ivec2& screenSize);
+	void _RenderScene(const glm::mat4& view, const glm::mat4&Projection, const glm::ivec2& screenSize, float lodBias = 1.0f);
 
 	void _AccumulateLighting();
 	void _Composite();
@@ -0,0 +1,320 @@
+#include "Application/Profiler.h"
+
+#include <chrono>
+#include <glad/glad.h>
+#include <json.hpp>
+#include <unordered_map>
+
+#include "Logging.h"
+#include "Utils/FileHelpers.h"
+
+std::atomic<bool> Profiler::_enabled    = true;
+bool              Profiler::_paused     = false;
+uint64_t          Profiler::_frameIndex = 0;
+uint64_t          Profiler::_frameStart = 0;
+
+std::mutex                                         Profiler::_ringsMutex;
+std::vector<std::unique_ptr<Profiler::ThreadRing>> Profiler::_rings;
+std::unordered_set<std::string>                    Profiler::_names;
+std::mutex                                         Profiler::_namesMutex;
+
+Profiler::GpuFrame Profiler::_gpuFrames[Profiler::GPU_LATENCY];
+uint32_t           Profiler::_gpuDepth = 0;
+
+std::deque<ProfileFrame> Profiler::_history;
+
+// All our times are relative to when the app started, so they fit nicely into a trace
+static const std::chrono::steady_clock::time_point ProfilerEpoch = std::chrono::steady_clock::now();
+
+uint64_t Profiler::Now() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - ProfilerEpoch).count();
+}
+
+void Profiler::SetEnabled(bool value) {
+	_enabled.store(value, std::memory_order_relaxed);
+}
+
+void Profiler::BeginFrame() {
+	_frameIndex++;
+	_frameStart = Now();
+
+	if (!IsEnabled()) {
+		return;
+	}
+
+	// The slot we're about to re-use holds the queries from GPU_LATENCY frames ago, which should be done by now
+	GpuFrame& gpu = _gpuFrames[_frameIndex % GPU_LATENCY];
+	if (gpu.Pending) {
+		_CollectGpuFrame(gpu);
+	}
+
+	gpu.Index = _frameIndex;
+	gpu.QueriesUsed = 0;
+	gpu.Scopes.clear();
+	gpu.Pending = true;
+	_gpuDepth = 0;
+
+	// Grab the GPU's clock so we can line up GPU events with the CPU ones
+	GLint64 gpuNow = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+	gpu.ClockOffset = static_cast<int64_t>(Now()) - static_cast<int64_t>(gpuNow);
+}
+
+void Profiler::EndFrame() {
+	if (!IsEnabled()) {
+		return;
+	}
+
+	ProfileFrame frame;
+	frame.Index = _frameIndex;
+	frame.Start = _frameStart;
+	frame.End   = Now();
+
+	// Drain all the threads' rings, we do this even when paused so they don't overflow
+	{
+		std::unique_lock<std::mutex> lock(_ringsMutex);
+		for (const auto& ring : _rings) {
+			uint64_t head = ring->Head.load(std::memory_order_acquire);
+
+			// If the thread lapped us, skip ahead with some margin so we don't read events as they are overwritten
+			if (head - ring->Tail > RING_SIZE) {
+				LOG_WARN("Profiler dropped {} events from thread \"{}\"", head - ring->Tail - RING_SIZE * 3 / 4, ring->Name);
+				ring->Tail = head - RING_SIZE * 3 / 4;
+			}
+
+			if (head != ring->Tail) {
+				ProfileTrack track;
+				track.Name     = ring->Name;
+				track.ThreadId = ring->ThreadId;
+				track.Events.reserve(head - ring->Tail);
+				for (; ring->Tail < head; ring->Tail++) {
+					track.Events.push_back(ring->Events[ring->Tail % RING_SIZE]);
+				}
+				frame.Tracks.push_back(std::move(track));
+			}
+		}
+	}
+
+	if (!_paused) {
+		_history.push_back(std::move(frame));
+		while (_history.size() > HISTORY_SIZE) {
+			_history.pop_front();
+		}
+	}
+}
+
+void Profiler::Shutdown() {
+	for (GpuFrame& frame : _gpuFrames) {
+		if (!frame.Queries.empty()) {
+			glDeleteQueries(static_cast<GLsizei>(frame.Queries.size()), frame.Queries.data());
+		}
+		frame.Queries.clear();
+		frame.QueriesUsed = 0;
+		frame.Scopes.clear();
+		frame.Pending = false;
+	}
+}
+
+const char* Profiler::InternName(const std::string& name) {
+	std::unique_lock<std::mutex> lock(_namesMutex);
+	// Elements of an unordered_set never move, so the pointer stays valid
+	return _names.insert(name).first->c_str();
+}
+
+void Profiler::SetThreadName(const std::string& name) {
+	ThreadRing* ring = _GetThreadRing();
+	std::unique_lock<std::mutex> lock(_ringsMutex);
+	ring->Name = name;
+}
+
+bool Profiler::ExportChromeTrace(const std::string& path) {
+	if (_history.empty()) {
+		return false;
+	}
+
+	nlohmann::json events = nlohmann::json::array();
+	std::unordered_map<uint32_t, std::string> threadNames;
+
+	for (const ProfileFrame& frame : _history) {
+		for (const ProfileTrack& track : frame.Tracks) {
+			threadNames[track.ThreadId] = track.Name;
+
+			for (const ProfileEvent& e : track.Events) {
+				// Chrome wants timestamps in microseconds
+				events.push_back({
+					{ "name", e.Name },
+					{ "cat", track.ThreadId == GPU_TRACK_ID ? "gpu" : "cpu" },
+					{ "ph", "X" },
+					{ "ts", e.Start / 1000.0 },
+					{ "dur", (e.End - e.Start) / 1000.0 },
+					{ "pid", 0 },
+					{ "tid", track.ThreadId },
+					{ "args", { { "frame", frame.Index } } }
+				});
+			}
+		}
+	}
+
+	// Metadata events give our tracks readable names
+	for (const auto& [id, name] : threadNames) {
+		events.push_back({
+			{ "name", "thread_name" },
+			{ "ph", "M" },
+			{ "pid", 0 },
+			{ "tid", id },
+			{ "args", { { "name", name } } }
+		});
+	}
+
+	nlohmann::json result = {
+		{ "traceEvents", events },
+		{ "displayTimeUnit", "ms" }
+	};
+	FileHelpers::WriteContentsToFile(path, result.dump());
+	LOG_INFO("Exported {} frames of profiling data to \"{}\"", _history.size(), path);
+	return true;
+}
+
+Profiler::ThreadRing* Profiler::_GetThreadRing() {
+	thread_local ThreadRing* ring = nullptr;
+	if (ring == nullptr) {
+		// Only happens the first time a thread records something, rings live as long as the app does
+		std::unique_lock<std::mutex> lock(_ringsMutex);
+		_rings.push_back(std::make_unique<ThreadRing>());
+		ring = _rings.back().get();
+		ring->ThreadId = static_cast<uint32_t>(_rings.size() - 1);
+		ring->Name = "Thread " + std::to_string(ring->ThreadId);
+	}
+	return ring;
+}
+
+void Profiler::_Record(ThreadRing* ring, const ProfileEvent& e) {
+	// Only this thread writes the head, so we only need to publish the event before moving it
+	uint64_t head = ring->Head.load(std::memory_order_relaxed);
+	ring->Events[head % RING_SIZE] = e;
+	ring->Head.store(head + 1, std::memory_order_release);
+}
+
+int32_t Profiler::_BeginGpuScope(const char* name) {
+	GpuFrame& frame = _gpuFrames[_frameIndex % GPU_LATENCY];
+	if (!frame.Pending) {
+		return -1;
+	}
+
+	GpuScope scope;
+	scope.Name       = name;
+	scope.Depth      = _gpuDepth++;
+	scope.StartQuery = _PushGpuQuery();
+	scope.EndQuery   = UINT32_MAX;
+	frame.Scopes.push_back(scope);
+	return static_cast<int32_t>(frame.Scopes.size() - 1);
+}
+
+void Profiler::_EndGpuScope(int32_t scope) {
+	GpuFrame& frame = _gpuFrames[_frameIndex % GPU_LATENCY];
+	if (scope >= 0 && static_cast<size_t>(scope) < frame.Scopes.size()) {
+		frame.Scopes[scope].EndQuery = _PushGpuQuery();
+		_gpuDepth--;
+	}
+}
+
+uint32_t Profiler::_PushGpuQuery() {
+	GpuFrame& frame = _gpuFrames[_frameIndex % GPU_LATENCY];
+
+	// Queries are kept around between frames, so we only create them as the number of scopes grows
+	if (frame.QueriesUsed == frame.Queries.size()) {
+		GLuint query = 0;
+		glGenQueries(1, &query);
+		frame.Queries.push_back(query);
+	}
+
+	uint32_t index = frame.QueriesUsed++;
+	glQueryCounter(frame.Queries[index], GL_TIMESTAMP);
+	return index;
+}
+
+void Profiler::_CollectGpuFrame(GpuFrame& frame) {
+	frame.Pending = false;
+	if (frame.QueriesUsed == 0) {
+		return;
+	}
+
+	// Queries complete in order, so if the last one is done they all are. If the GPU is running more than
+	// GPU_LATENCY frames behind we drop the results rather than stalling
+	GLint available = 0;
+	glGetQueryObjectiv(frame.Queries[frame.QueriesUsed - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available) {
+		return;
+	}
+
+	ProfileFrame* target = _FindFrame(frame.Index);
+	if (target == nullptr) {
+		return;
+	}
+
+	ProfileTrack track;
+	track.Name     = "GPU";
+	track.ThreadId = GPU_TRACK_ID;
+	track.Events.reserve(frame.Scopes.size());
+	for (const GpuScope& scope : frame.Scopes) {
+		if (scope.EndQuery == UINT32_MAX) {
+			continue;
+		}
+
+		GLuint64 start = 0, end = 0;
+		glGetQueryObjectui64v(frame.Queries[scope.StartQuery], GL_QUERY_RESULT, &start);
+		glGetQueryObjectui64v(frame.Queries[scope.EndQuery], GL_QUERY_RESULT, &end);
+
+		ProfileEvent e;
+		e.Name  = scope.Name;
+		e.Start = static_cast<uint64_t>(static_cast<int64_t>(start) + frame.ClockOffset);
+		e.End   = static_cast<uint64_t>(static_cast<int64_t>(end) + frame.ClockOffset);
+		e.Depth = scope.Depth;
+		track.Events.push_back(e);
+	}
+	target->Tracks.push_back(std::move(track));
+}
+
+ProfileFrame* Profiler::_FindFrame(uint64_t index) {
+	// Frames are stored in order, so we can index straight into the history
+	if (_history.empty() || index < _history.front().Index || index > _history.back().Index) {
+		return nullptr;
+	}
+	ProfileFrame& frame = _history[index - _history.front().Index];
+	return frame.Index == index ? &frame : nullptr;
+}
+
+ProfileScope::ProfileScope(const char* name, bool gpu) :
+	_name(name),
+	_start(0),
+	_ring(nullptr),
+	_gpuScope(-1)
+{
+	if (!Profiler::IsEnabled()) {
+		return;
+	}
+
+	_ring = Profiler::_GetThreadRing();
+	_ring->Depth++;
+	if (gpu) {
+		_gpuScope = Profiler::_BeginGpuScope(name);
+	}
+	_start = Profiler::Now();
+}
+
+ProfileScope::~ProfileScope() {
+	if (_ring == nullptr) {
+		return;
+	}
+
+	ProfileEvent e;
+	e.Name  = _name;
+	e.Start = _start;
+	e.End   = Profiler::Now();
+	e.Depth = --_ring->Depth;
+
+	if (_gpuScope >= 0) {
+		Profiler::_EndGpuScope(_gpuScope);
+	}
+	Profiler::_Record(_ring, e);
+}
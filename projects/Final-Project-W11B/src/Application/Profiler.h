@@ -0,0 +1,204 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "Utils/Macros.h"
+
+/**
+ * A single timed region of a frame, either on a CPU thread or on the GPU
+ */
+struct ProfileEvent {
+	// The name of the scope, must outlive the profiler's history (string literals, or names from Profiler::InternName)
+	const char* Name  = nullptr;
+	// Start and end times in nanoseconds since the profiler started, GPU times are converted to the CPU clock
+	uint64_t    Start = 0;
+	uint64_t    End   = 0;
+	// How many scopes this one is nested in on it's thread
+	uint32_t    Depth = 0;
+};
+
+/**
+ * All the events that were collected for a single thread (or the GPU) in a frame
+ */
+struct ProfileTrack {
+	std::string               Name;
+	uint32_t                  ThreadId;
+	std::vector<ProfileEvent> Events;
+};
+
+/**
+ * The events collected over a single frame
+ */
+struct ProfileFrame {
+	uint64_t                  Index = 0;
+	uint64_t                  Start = 0;
+	uint64_t                  End   = 0;
+	std::vector<ProfileTrack> Tracks;
+};
+
+/**
+ * A hierarchical frame profiler. CPU scopes are written into a ring buffer owned by the
+ * thread that recorded them, so recording never takes a lock, and the main thread drains
+ * the rings at the end of every frame. GPU scopes use GL_TIMESTAMP queries that are read
+ * back GPU_LATENCY frames later so that we never stall waiting on results.
+ *
+ * Use the PROFILE_SCOPE and PROFILE_GPU_SCOPE macros rather than ProfileScope directly
+ */
+class Profiler final {
+public:
+	Profiler() = delete;
+
+	// The number of events each thread can have in flight before the main thread drains them
+	static const uint32_t RING_SIZE = 4096;
+	// The number of frames GPU queries are kept around for before we read them
+	static const uint32_t GPU_LATENCY = 4;
+	// The number of frames kept for the timeline
+	static const uint32_t HISTORY_SIZE = 240;
+	// The thread ID that GPU tracks are reported with
+	static const uint32_t GPU_TRACK_ID = 0xFFFF;
+
+	/**
+	 * Sets whether the profiler is recording, scopes are almost free while disabled
+	 */
+	static void SetEnabled(bool value);
+	static bool IsEnabled() { return _enabled.load(std::memory_order_relaxed); }
+
+	/**
+	 * Pauses collection into the history, while still recording (so the timeline can be inspected)
+	 */
+	static void SetPaused(bool value) { _paused = value; }
+	static bool IsPaused() { return _paused; }
+
+	/**
+	 * Starts a new frame, should be called by the main thread at the top of the game loop
+	 */
+	static void BeginFrame();
+	/**
+	 * Ends the current frame, draining all threads' events and collecting finished GPU results
+	 */
+	static void EndFrame();
+
+	/**
+	 * Releases all GPU queries, should be called before the GL context is destroyed
+	 */
+	static void Shutdown();
+
+	/**
+	 * Gets the frames that have been collected, oldest first. GPU tracks for the most
+	 * recent GPU_LATENCY frames will not be filled in yet
+	 */
+	static const std::deque<ProfileFrame>& GetHistory() { return _history; }
+
+	/**
+	 * Gets a pointer to a copy of the given name that will live as long as the application,
+	 * for scopes whose names are not string literals
+	 */
+	static const char* InternName(const std::string& name);
+	/**
+	 * Sets the name that the calling thread will be shown with
+	 */
+	static void SetThreadName(const std::string& name);
+
+	/**
+	 * Writes the collected history to a file in the Chrome trace event format, which can
+	 * be opened with chrome://tracing or https://ui.perfetto.dev
+	 * @returns True if there was anything to export
+	 */
+	static bool ExportChromeTrace(const std::string& path);
+
+	/**
+	 * Gets the current time in nanoseconds since the profiler started
+	 */
+	static uint64_t Now();
+
+protected:
+	friend class ProfileScope;
+
+	// Events that a single thread has recorded. Only the owning thread writes events and the head,
+	// and only the main thread reads events and writes the tail
+	struct ThreadRing {
+		std::string           Name;
+		uint32_t              ThreadId;
+		ProfileEvent          Events[RING_SIZE];
+		std::atomic<uint64_t> Head = 0;
+		uint64_t              Tail = 0;
+		uint32_t              Depth = 0;
+	};
+
+	struct GpuScope {
+		const char* Name;
+		uint32_t    Depth;
+		uint32_t    StartQuery;
+		uint32_t    EndQuery;
+	};
+
+	// The GPU queries and scopes issued during a single frame
+	struct GpuFrame {
+		uint64_t              Index = 0;
+		std::vector<uint32_t> Queries;
+		uint32_t              QueriesUsed = 0;
+		std::vector<GpuScope> Scopes;
+		// The difference between the CPU and GPU clocks when the frame started
+		int64_t               ClockOffset = 0;
+		bool                  Pending = false;
+	};
+
+	static std::atomic<bool> _enabled;
+	static bool              _paused;
+	static uint64_t          _frameIndex;
+	static uint64_t          _frameStart;
+
+	static std::mutex                               _ringsMutex;
+	static std::vector<std::unique_ptr<ThreadRing>> _rings;
+	static std::unordered_set<std::string>          _names;
+	static std::mutex                               _namesMutex;
+
+	static GpuFrame  _gpuFrames[GPU_LATENCY];
+	static uint32_t  _gpuDepth;
+
+	static std::deque<ProfileFrame> _history;
+
+	static ThreadRing* _GetThreadRing();
+	static void _Record(ThreadRing* ring, const ProfileEvent& e);
+	static int32_t _BeginGpuScope(const char* name);
+	static void _EndGpuScope(int32_t scope);
+	static uint32_t _PushGpuQuery();
+	static void _CollectGpuFrame(GpuFrame& frame);
+	static ProfileFrame* _FindFrame(uint64_t index);
+};
+
+/**
+ * Times the region from it's construction to it's destruction. GPU scopes must only be
+ * used on the main thread, since that's where the GL context lives
+ */
+class ProfileScope final {
+public:
+	NO_COPY(ProfileScope);
+	NO_MOVE(ProfileScope);
+
+	ProfileScope(const char* name, bool gpu = false);
+	~ProfileScope();
+
+private:
+	const char*             _name;
+	uint64_t                _start;
+	Profiler::ThreadRing*   _ring;
+	int32_t                 _gpuScope;
+};
+
+#define __PROFILE_CONCAT_IMPL(a, b) a##b
+#define __PROFILE_CONCAT(a, b) __PROFILE_CONCAT_IMPL(a, b)
+
+// Times the rest of the enclosing block on the CPU
+#define PROFILE_SCOPE(name) ProfileScope __PROFILE_CONCAT(__profileScope, __LINE__)(name)
+// Times the rest of the enclosing block on the CPU, and the GL commands issued in it on the GPU
+#define PROFILE_GPU_SCOPE(name) ProfileScope __PROFILE_CONCAT(__profileScope, __LINE__)(name, true)
+// Times the rest of the enclosing function on the CPU
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
@@ -24,6 +24,14 @@ void DebugWindow::RenderMenuBar()
 		app.CurrentScene()->SetPhysicsDebugDrawMode(physicsDrawMode);
 	}
 
+	ImGui::Separator();
+
+	float lodPixelError = renderLayer->GetLodPixelError();
+	ImGui::SetNextItemWidth(ImGui::GetTextLineHeight() * 4);
+	if (ImGui::DragFloat("LOD Error (px)", &lodPixelError, 0.05f, 0.0f, 64.0f)) {
+		renderLayer->SetLodPixelError(lodPixelError);
+	}
+
 	/*ImGui::Separator();
 
 	RenderFlags flags = renderLayer->GetRenderFlags();
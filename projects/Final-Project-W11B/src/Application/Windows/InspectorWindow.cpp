@@ -76,7 +76,7 @@ void InspectorWindow::Render()
 			std::shared_ptr<Gameplay::IComponent> component = selection->_components[ix];
 
 			if (_RenderComponent(component)) {
-				selection->_components.erase(selection->_components.begin() + ix);
+				selection->RemoveComponent(ix);
 				ix--;
 			}
 		}
@@ -39,6 +39,13 @@ void PostProcessingSettingsWindow::_RenderEffect(const PostProcessingLayer::Effe
 
 	if (isOpen) {
 		ImGui::Indent();
+		if (value->Enabled) {
+			if (value->GetPassEffectCount() > 1) {
+				ImGui::Text("GPU: %.3f ms (fused pass of %d effects)", value->GetGpuTime(), value->GetPassEffectCount());
+			} else {
+				ImGui::Text("GPU: %.3f ms", value->GetGpuTime());
+			}
+		}
 		value->RenderImGui();
 		ImGui::Unindent();
 		ImGui::Separator();
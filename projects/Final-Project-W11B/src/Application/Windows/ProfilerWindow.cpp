@@ -0,0 +1,160 @@
+#include "ProfilerWindow.h"
+#include "Utils/ImGuiHelper.h"
+#include "Utils/Windows/FileDialogs.h"
+#include "Utils/FrameMemory.h"
+
+#include <algorithm>
+#include <functional>
+
+ProfilerWindow::ProfilerWindow() :
+	IEditorWindow(),
+	_selectedFrame(-1),
+	_zoom(1.0f)
+{
+	Name = "Profiler";
+	SplitDirection = ImGuiDir_::ImGuiDir_None;
+	Requirements = EditorWindowRequirements::Window;
+	Open = false;
+}
+
+ProfilerWindow::~ProfilerWindow() = default;
+
+void ProfilerWindow::Render()
+{
+	bool enabled = Profiler::IsEnabled();
+	if (ImGui::Checkbox("Enabled", &enabled)) {
+		Profiler::SetEnabled(enabled);
+	}
+	ImGui::SameLine();
+	bool paused = Profiler::IsPaused();
+	if (ImGui::Checkbox("Paused", &paused)) {
+		Profiler::SetPaused(paused);
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Export Chrome Trace")) {
+		std::optional<std::string> path = FileDialogs::SaveFile("Chrome Trace (*.json)\0*.json\0\0");
+		if (path.has_value()) {
+			Profiler::ExportChromeTrace(path.value());
+		}
+	}
+
+	// Allocation counts are always tracked, so they're shown even if the profiler is disabled
+	const FrameMemoryStats& memory = FrameMemory::GetLastFrameStats();
+	ImGui::Text("Heap: %llu allocs (%.1f KB)  Frame: %llu allocs (%.1f / %.1f KB)  Pools: %llu allocs",
+		memory.HeapAllocations, memory.HeapBytes / 1024.0f,
+		memory.FrameAllocations, memory.FrameBytes / 1024.0f, memory.FrameCapacity / 1024.0f,
+		memory.PoolAllocations);
+
+	const std::deque<ProfileFrame>& history = Profiler::GetHistory();
+	if (history.empty()) {
+		ImGui::TextUnformatted("No frames have been recorded");
+		return;
+	}
+
+	// Plot the CPU frame times, so spikes are easy to find
+	float frameTimes[Profiler::HISTORY_SIZE];
+	float maxTime = 0.0f;
+	int count = static_cast<int>(history.size());
+	for (int ix = 0; ix < count; ix++) {
+		frameTimes[ix] = (history[ix].End - history[ix].Start) / 1000000.0f;
+		maxTime = glm::max(maxTime, frameTimes[ix]);
+	}
+	ImGui::PlotHistogram("##frame-times", frameTimes, count, 0, "Frame Time (ms)", 0.0f, maxTime, ImVec2(ImGui::GetContentRegionAvail().x, 60.0f));
+
+	// Clicking on the histogram selects that frame
+	if (ImGui::IsItemHovered() && ImGui::IsMouseClicked(0)) {
+		float t = (ImGui::GetMousePos().x - ImGui::GetItemRectMin().x) / ImGui::GetItemRectSize().x;
+		_selectedFrame = glm::clamp(static_cast<int>(t * count), 0, count - 1);
+	}
+
+	// By default we look at the newest frame that has had time to get it's GPU results back
+	int frameIndex = _selectedFrame >= 0 ? glm::min(_selectedFrame, count - 1) : glm::max(count - 1 - (int)Profiler::GPU_LATENCY, 0);
+	if (LABEL_LEFT(ImGui::SliderInt, "Frame", &frameIndex, 0, count - 1)) {
+		_selectedFrame = frameIndex;
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Follow")) {
+		_selectedFrame = -1;
+	}
+	LABEL_LEFT(ImGui::SliderFloat, "Zoom", &_zoom, 1.0f, 50.0f, "%.1fx", 2.0f);
+
+	const ProfileFrame& frame = history[frameIndex];
+	ImGui::Text("Frame %llu: %.3f ms", frame.Index, (frame.End - frame.Start) / 1000000.0f);
+
+	_RenderTimeline(frame);
+}
+
+void ProfilerWindow::_RenderTimeline(const ProfileFrame& frame)
+{
+	const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+	const float labelWidth = 110.0f;
+
+	// GPU events can run past the end of the CPU frame, so we fit the range to everything we have
+	uint64_t start = frame.Start;
+	uint64_t end = frame.End;
+	for (const ProfileTrack& track : frame.Tracks) {
+		for (const ProfileEvent& e : track.Events) {
+			start = glm::min(start, e.Start);
+			end = glm::max(end, e.End);
+		}
+	}
+	double range = static_cast<double>(glm::max<uint64_t>(end - start, 1));
+
+	// Show the main thread first and the GPU last, with workers in between
+	std::vector<const ProfileTrack*> tracks;
+	for (const ProfileTrack& track : frame.Tracks) {
+		tracks.push_back(&track);
+	}
+	std::sort(tracks.begin(), tracks.end(), [](const ProfileTrack* a, const ProfileTrack* b) { return a->ThreadId < b->ThreadId; });
+
+	ImGui::BeginChild("##timeline", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
+
+	float width = (ImGui::GetContentRegionAvail().x - labelWidth) * _zoom;
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	ImVec2 origin = ImGui::GetCursorScreenPos();
+	float scroll = ImGui::GetScrollX();
+	float y = origin.y;
+
+	for (const ProfileTrack* track : tracks) {
+		uint32_t maxDepth = 0;
+		for (const ProfileEvent& e : track->Events) {
+			maxDepth = glm::max(maxDepth, e.Depth);
+		}
+
+		for (const ProfileEvent& e : track->Events) {
+			float x0 = origin.x + labelWidth + static_cast<float>((e.Start - start) / range) * width;
+			float x1 = origin.x + labelWidth + static_cast<float>((e.End - start) / range) * width;
+			x1 = glm::max(x1, x0 + 1.0f);
+			float y0 = y + e.Depth * rowHeight;
+			ImVec2 min(x0, y0), max(x1, y0 + rowHeight - 1.0f);
+
+			// Colour by name, so the same scope is the same colour from frame to frame
+			size_t hash = std::hash<std::string>()(e.Name);
+			ImU32 color = ImColor::HSV((hash % 360) / 360.0f, 0.55f, 0.75f);
+			drawList->AddRectFilled(min, max, color);
+
+			// Only label scopes that have room for some text
+			float duration = (e.End - e.Start) / 1000000.0f;
+			if (x1 - x0 > 30.0f) {
+				ImVec4 clip(x0, y0, x1, y0 + rowHeight);
+				drawList->AddText(ImGui::GetFont(), ImGui::GetFontSize(), ImVec2(x0 + 2.0f, y0), IM_COL32_WHITE, e.Name, nullptr, 0.0f, &clip);
+			}
+
+			if (ImGui::IsMouseHoveringRect(min, max) && ImGui::IsWindowHovered()) {
+				ImGui::SetTooltip("%s\n%.3f ms", e.Name, duration);
+			}
+		}
+
+		// Draw the track label last, so it stays readable over the events when scrolled
+		float trackHeight = (maxDepth + 1) * rowHeight;
+		ImVec2 labelMin(origin.x + scroll, y);
+		drawList->AddRectFilled(labelMin, ImVec2(labelMin.x + labelWidth - 4.0f, y + trackHeight), ImGui::GetColorU32(ImGuiCol_FrameBg));
+		drawList->AddText(labelMin, ImGui::GetColorU32(ImGuiCol_Text), track->Name.c_str());
+
+		y += trackHeight + 4.0f;
+	}
+
+	// Reserve the space we drew in, so the child window knows how far to scroll
+	ImGui::Dummy(ImVec2(labelWidth + width, y - origin.y));
+	ImGui::EndChild();
+}
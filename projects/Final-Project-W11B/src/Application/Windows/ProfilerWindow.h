@@ -0,0 +1,26 @@
+#pragma once
+#include "../IEditorWindow.h"
+#include "Application/Profiler.h"
+
+/**
+ * Handles an editor window for viewing the profiler's frame history as a timeline
+ */
+class ProfilerWindow : public IEditorWindow {
+public:
+	MAKE_PTRS(ProfilerWindow);
+
+	ProfilerWindow();
+	virtual ~ProfilerWindow();
+
+	// Inherited from IEditorWindow
+
+	virtual void Render() override;
+
+protected:
+	// Index into the profiler's history, or -1 to follow the newest frame with GPU results
+	int   _selectedFrame;
+	// How many times wider than the window the timeline is drawn
+	float _zoom;
+
+	void _RenderTimeline(const ProfileFrame& frame);
+};
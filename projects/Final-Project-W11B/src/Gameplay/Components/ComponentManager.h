@@ -1,9 +1,13 @@
 #pragma once
 #include <functional>
+#include <atomic>
+#include <tuple>
 #include "IComponent.h"
+#include "ComponentView.h"
 #include <typeindex>
 #include <optional>
 #include <Logging.h>
+#include "Utils/FrameMemory.h"
 
 namespace Gameplay {
 	/// <summary>
@@ -43,10 +47,11 @@ namespace Gameplay {
 
 					// Make sure the component knows it's own type
 					result->_realType = typeIndex.value();
+					result->_typeId = _TypeIdMap[typeIndex.value()];
 					result->_weakSelfPtr = result;
 
 					// Add the component to the global pools
-					_Components[result->_realType].push_back(result);
+					_Components[result->_realType].push_back(result.get());
 					return result;
 				}
 			}
@@ -73,9 +78,10 @@ namespace Gameplay {
 					IComponent::Sptr result = callback();
 					// Make sure the component knows it's own type
 					result->_realType = typeIndex.value();
+					result->_typeId = _TypeIdMap[typeIndex.value()];
 					result->_weakSelfPtr = result;
 					// Add the component to the global pools
-					_Components[result->_realType].push_back(result);
+					_Components[result->_realType].push_back(result.get());
 					return result;
 				}
 			}
@@ -100,9 +106,10 @@ namespace Gameplay {
 				IComponent::Sptr result = callback();
 				// Make sure the component knows it's own type
 				result->_realType = type;
+				result->_typeId = _TypeIdMap[type];
 				result->_weakSelfPtr = result;
 				// Add the component to the global pools
-				_Components[result->_realType].push_back(result);
+				_Components[result->_realType].push_back(result.get());
 				return result;
 			}
 			return nullptr;
@@ -135,16 +142,17 @@ namespace Gameplay {
 			std::type_index type = std::type_index(typeid(ComponentType));
 			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
 
-			// Create component, forwarding arguments
-			std::shared_ptr<ComponentType> component = std::make_shared<ComponentType>(std::forward<TArgs>(args)...);
+			// Create component from the object pools, forwarding arguments
+			std::shared_ptr<ComponentType> component = std::allocate_shared<ComponentType>(std::pmr::polymorphic_allocator<ComponentType>(FrameMemory::Objects()), std::forward<TArgs>(args)...);
 
 			// Make sure the component knows it's concrete type
 			component->_realType = type;
+			component->_typeId = TypeId<ComponentType>();
 			// Give the component a weak pointer to itself that it can upcast to a shared pointer when needed
 			component->_weakSelfPtr = component;
 
 			// Add to global component list for that type
-			_Components[type].push_back(component);
+			_Components[type].push_back(component.get());
 
 			// Return the result
 			return component;
@@ -165,52 +173,90 @@ namespace Gameplay {
 			std::type_index type = std::type_index(typeid(ComponentType));
 			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
 
-			// Clear any dead weak pointers
-			auto removeIt = std::remove_if(_Components[type].begin(), _Components[type].end(), [](const std::weak_ptr<IComponent>& ptr) {
-				return ptr.expired();
-			});
-			_Components[type].erase(removeIt, _Components[type].end());
-
 			// Search the component store for a component that matches that ID
-			auto& it = std::find_if(_Components[type].begin(), _Components[type].end(), [&](const std::weak_ptr<IComponent>& ptr) {
-				return (ptr.lock())->GetGUID() == id;
+			std::vector<IComponent*>& store = _Components[type];
+			auto it = std::find_if(store.begin(), store.end(), [&](const IComponent* component) {
+				return component->GetGUID() == id;
 			});
 
 			// If the component was found, return it. Otherwise return nullptr
-			if (it != _Components[type].end()) {
-				// We need to lock the weak pointer to convert it to a shared ptr
-				return std::dynamic_pointer_cast<ComponentType>((*it).lock());
+			if (it != store.end()) {
+				// We need to lock the component's self reference to get a shared ptr
+				return std::static_pointer_cast<ComponentType>((*it)->SelfRef().lock());
 			} else {
 				return nullptr;
 			}
 		}
 
 		/// <summary>
-		/// Iterates over all components of the given type and invokes a method with them
+		/// Iterates over all components of the given type and invokes a callable with them. The callable
+		/// is a template parameter so that it can be inlined, and should take a ComponentType*
+		/// 
+		/// When multiple types are given, the callable is invoked once for every game object that has
+		/// all of the types attached, with a pointer to each (ex: Each<RenderComponent, RigidBody>(
+		/// [](RenderComponent* renderer, RigidBody* body) { ... }))
+		/// 
+		/// Components may be created from the callback, but must not be destroyed (remove game objects
+		/// via the scene's deletion queue instead)
 		/// </summary>
-		/// <typeparam name="ComponentType">The type of component to iterate on</typeparam>
+		/// <typeparam name="ComponentTypes">The types of component to iterate on</typeparam>
+		/// <typeparam name="Func">The type of the callable to invoke</typeparam>
 		/// <param name="callback">The callback to invoke with the components</param>
 		/// <param name="includeDisabled">True to include disabled components, false if otherwise</param>
-		template <
-			typename ComponentType,
-			typename = typename std::enable_if<std::is_base_of<IComponent, ComponentType>::value>::type>
-		void Each(std::function<void(const std::shared_ptr<ComponentType>&)> callback, bool includeDisabled = false) {
-			// We can use typeid and type_index to get a unique ID for our types
-			std::type_index type = std::type_index(typeid(ComponentType));
-			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
-
-			// Iterate over all the components in the store
-			for (auto& wptr : _Components[type]) {
-				// Lock the weak pointer to get a shared pointer (maybe)
-				std::shared_ptr<IComponent> sptr = wptr.lock();
-				// If the pointer is alive and matches our enabled criteria, invoke the callback
-				if (sptr && sptr->IsEnabled | includeDisabled) {
-					// Upcast to component type and invoke the callback
-					callback(std::dynamic_pointer_cast<ComponentType>(sptr));
+		template <typename ... ComponentTypes, typename Func>
+		void Each(Func&& callback, bool includeDisabled = false) {
+			static_assert(std::is_invocable<Func, ComponentTypes*...>::value, "Each callbacks should take a pointer to each component type");
+			if constexpr (sizeof...(ComponentTypes) == 1) {
+				for (auto* component : View<ComponentTypes...>(includeDisabled)) {
+					callback(component);
+				}
+			} else {
+				for (const auto& components : View<ComponentTypes...>(includeDisabled)) {
+					std::apply(callback, components);
 				}
 			}
 		}
 
+		/// <summary>
+		/// Gets a view over all components of the given type, which can be used in a range based for loop
+		/// 
+		/// When multiple types are given, the view yields a tuple of pointers for every game object that has
+		/// all of the types attached (ex: for (auto [renderer, body] : View<RenderComponent, RigidBody>()))
+		/// </summary>
+		/// <typeparam name="ComponentTypes">The types of component to iterate on</typeparam>
+		/// <param name="includeDisabled">True to include disabled components, false if otherwise</param>
+		template <typename ... ComponentTypes>
+		auto View(bool includeDisabled = false) {
+			static_assert(sizeof...(ComponentTypes) > 0, "Views need at least one component type");
+			static_assert((std::is_base_of<IComponent, ComponentTypes>::value && ...), "Views can only be used with components");
+
+			if constexpr (sizeof...(ComponentTypes) == 1) {
+				return ComponentView<ComponentTypes...>(_GetStore<ComponentTypes...>(), includeDisabled);
+			} else {
+				return ComponentJoinView<ComponentTypes...>({ &_GetStore<ComponentTypes>()... }, { TypeId<ComponentTypes>()... }, includeDisabled);
+			}
+		}
+
+		/// <summary>
+		/// Gets a small, dense ID for the given component type, which game objects use to index their
+		/// component lookup tables. IDs are assigned the first time they are requested, so they are not
+		/// stable between runs and should never be serialized
+		/// </summary>
+		/// <typeparam name="T">The type of component to get the ID for</typeparam>
+		template <typename T>
+		static uint32_t TypeId() {
+			static const uint32_t id = _NextTypeId++;
+			return id;
+		}
+
+		/// <summary>
+		/// Gets the dense ID for a registered component type, or UINT32_MAX if the type is not registered
+		/// </summary>
+		static uint32_t TypeId(const std::type_index& type) {
+			auto it = _TypeIdMap.find(type);
+			return it != _TypeIdMap.end() ? it->second : UINT32_MAX;
+		}
+
 		/// <summary>
 		/// Attempts to register a given type as a component, should be called for each component type 
 		/// at the start of you application
@@ -231,6 +277,7 @@ namespace Gameplay {
 				_TypeLoadRegistry[type] = &ComponentManager::ParseTypeFromBlob<T>;
 				_TypeCreateRegistry[type] = &ComponentManager::_InternalCreate<T>;
 				_TypeNameMap[StringTools::SanitizeClassName(typeid(T).name())] = type;
+				_TypeIdMap[type] = TypeId<T>();
 			}
 		}
 
@@ -238,7 +285,7 @@ namespace Gameplay {
 		/// Removes all components of all types from the registry, whether they are referenced elsewhere or not
 		/// </summary>
 		inline void FlushAll() {
-			_Components = std::unordered_map<std::type_index, std::vector<std::weak_ptr<IComponent>>>();
+			_Components = std::unordered_map<std::type_index, std::vector<IComponent*>>();
 		}
 
 	private:
@@ -253,11 +300,23 @@ namespace Gameplay {
 		inline static std::unordered_map<std::type_index, LoadComponentFunc> _TypeLoadRegistry;
 		// Stores functions to load components from JSON, indexed on the type that they load
 		inline static std::unordered_map<std::type_index, CreateComponentFunc> _TypeCreateRegistry;
+		// Maps registered types to their dense IDs, for when we only know the type at runtime
+		inline static std::unordered_map<std::type_index, uint32_t> _TypeIdMap;
+		// The next ID to hand out from TypeId
+		inline static std::atomic<uint32_t> _NextTypeId = 0;
 
-		// Weak pointers let us store a reference to an object stored by a shared pointer, without
-		// actually increasing the reference count. Thus components will be destroyed at the correct
-		// time (when the only reference is the one stored here).
-		std::unordered_map<std::type_index, std::vector<std::weak_ptr<IComponent>>> _Components;  
+		// We store raw pointers so that iterating doesn't need to lock weak pointers or touch reference
+		// counts. This is safe since every component removes itself from it's store in it's destructor, so
+		// the stores only ever contain live components.
+		std::unordered_map<std::type_index, std::vector<IComponent*>> _Components;
+
+		template <typename ComponentType>
+		std::vector<IComponent*>& _GetStore() {
+			// We can use typeid and type_index to get a unique ID for our types
+			std::type_index type = std::type_index(typeid(ComponentType));
+			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
+			return _Components[type];
+		}
 
 		template <typename T>
 		static IComponent::Sptr ParseTypeFromBlob(const nlohmann::json& blob) {
@@ -270,11 +329,12 @@ namespace Gameplay {
 			std::type_index type = std::type_index(typeid(ComponentType));
 			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
 
-			// Create component, forwarding arguments
-			std::shared_ptr<ComponentType> component = std::make_shared<ComponentType>();
+			// Create component from the object pools
+			std::shared_ptr<ComponentType> component = std::allocate_shared<ComponentType>(std::pmr::polymorphic_allocator<ComponentType>(FrameMemory::Objects()));
 
 			// Make sure the component knows it's concrete type
 			component->_realType = type;
+			component->_typeId = TypeId<ComponentType>();
 			// Give the component a weak pointer to itself that it can upcast to a shared pointer when needed
 			component->_weakSelfPtr = component;
 
@@ -296,12 +356,10 @@ namespace Gameplay {
 
 			
 			// Get a reference to the vector of components for easy access
-			std::vector<std::weak_ptr<IComponent>>& componentStore = _Components[component->_realType];
+			std::vector<IComponent*>& componentStore = _Components[component->_realType];
 
-			// Clear any dead weak pointers
-			auto it = std::remove_if(componentStore.begin(), componentStore.end(), [](const std::weak_ptr<IComponent>& ptr) {
-				return ptr.expired();
-				});
+			// Erase rather than swapping with the back, so that iteration order stays the same
+			auto it = std::find(componentStore.begin(), componentStore.end(), component);
 			if (it != componentStore.end()) {
 				componentStore.erase(it);
 			}
@@ -0,0 +1,180 @@
+#pragma once
+#include <array>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <type_traits>
+
+#include "IComponent.h"
+
+namespace Gameplay {
+	/// <summary>
+	/// A lightweight range over all the components of a single type in a ComponentManager, so
+	/// that they can be iterated with a range based for loop:
+	/// 
+	///		for (RenderComponent* renderable : scene->Components().View<RenderComponent>()) { ... }
+	/// 
+	/// The view walks the manager's store by index, so components may be added while iterating
+	/// (they will be visited at the end of the loop), but components must not be destroyed while
+	/// a view is iterating them
+	/// </summary>
+	/// <typeparam name="ComponentType">The exact type of the components to iterate</typeparam>
+	template <typename ComponentType>
+	class ComponentView {
+	public:
+		static_assert(std::is_base_of<IComponent, ComponentType>::value, "ComponentView can only be used with components");
+
+		class Iterator {
+		public:
+			Iterator(const std::vector<IComponent*>* store, size_t index, bool includeDisabled) :
+				_store(store),
+				_index(index),
+				_includeDisabled(includeDisabled)
+			{
+				_SkipFiltered();
+			}
+
+			ComponentType* operator*() const {
+				// The store only ever holds components of exactly this type, so we don't need a dynamic cast
+				return static_cast<ComponentType*>((*_store)[_index]);
+			}
+
+			Iterator& operator++() {
+				_index++;
+				_SkipFiltered();
+				return *this;
+			}
+
+			// We only ever compare against end(), which is past the end of the store whenever we're done
+			bool operator!=(const Iterator& other) const {
+				return _index < _store->size();
+			}
+
+		private:
+			const std::vector<IComponent*>* _store;
+			size_t                          _index;
+			bool                            _includeDisabled;
+
+			void _SkipFiltered() {
+				while (_index < _store->size() && !(_includeDisabled || (*_store)[_index]->IsEnabled)) {
+					_index++;
+				}
+			}
+		};
+
+		ComponentView(const std::vector<IComponent*>& store, bool includeDisabled) :
+			_store(&store),
+			_includeDisabled(includeDisabled)
+		{ }
+
+		Iterator begin() const { return Iterator(_store, 0, _includeDisabled); }
+		Iterator end() const { return Iterator(_store, _store->size(), _includeDisabled); }
+
+		/// <summary>
+		/// Gets the number of components in the store, including disabled ones
+		/// </summary>
+		size_t Size() const { return _store->size(); }
+
+	private:
+		const std::vector<IComponent*>* _store;
+		bool                            _includeDisabled;
+	};
+
+	/// <summary>
+	/// A range over every game object that has all of the given component types attached, yielding
+	/// a tuple with a pointer to each component:
+	/// 
+	///		for (auto [renderable, body] : scene->Components().View<RenderComponent, RigidBody>()) { ... }
+	/// 
+	/// We walk whichever of the types has the fewest components, and use the game object's
+	/// component lookup table to find the rest, so the join costs one table lookup per type for
+	/// each candidate. The same rules as ComponentView apply to modifying components while iterating
+	/// </summary>
+	/// <typeparam name="ComponentTypes">The exact types of the components to join</typeparam>
+	template <typename ... ComponentTypes>
+	class ComponentJoinView {
+	public:
+		static const size_t TYPE_COUNT = sizeof...(ComponentTypes);
+		typedef std::tuple<ComponentTypes*...> Tuple;
+
+		class Iterator {
+		public:
+			Iterator(const ComponentJoinView* view, size_t index) :
+				_view(view),
+				_index(index),
+				_current()
+			{
+				_SkipUnmatched();
+			}
+
+			const Tuple& operator*() const { return _current; }
+
+			Iterator& operator++() {
+				_index++;
+				_SkipUnmatched();
+				return *this;
+			}
+
+			// We only ever compare against end(), which is past the end of the store whenever we're done
+			bool operator!=(const Iterator& other) const {
+				return _index < _view->_driver->size();
+			}
+
+		private:
+			const ComponentJoinView* _view;
+			size_t                   _index;
+			Tuple                    _current;
+
+			void _SkipUnmatched() {
+				while (_index < _view->_driver->size() && !_view->_Match((*_view->_driver)[_index], _current)) {
+					_index++;
+				}
+			}
+		};
+
+		ComponentJoinView(const std::array<const std::vector<IComponent*>*, TYPE_COUNT>& stores, const std::array<uint32_t, TYPE_COUNT>& typeIds, bool includeDisabled) :
+			_driver(stores[0]),
+			_typeIds(typeIds),
+			_includeDisabled(includeDisabled)
+		{
+			// An object needs all the types to match, so the smallest store bounds the number of matches
+			for (const std::vector<IComponent*>* store : stores) {
+				if (store->size() < _driver->size()) {
+					_driver = store;
+				}
+			}
+		}
+
+		Iterator begin() const { return Iterator(this, 0); }
+		Iterator end() const { return Iterator(this, _driver->size()); }
+
+	private:
+		const std::vector<IComponent*>*       _driver;
+		std::array<uint32_t, TYPE_COUNT>      _typeIds;
+		bool                                  _includeDisabled;
+
+		// GameObject is incomplete at this point, so we take it as a template parameter to defer
+		// the lookups until the view is actually used
+		template <typename TObject = GameObject>
+		bool _Match(const IComponent* candidate, Tuple& result) const {
+			TObject* object = candidate->GetGameObject();
+			return object != nullptr && _MatchAll(object, result, std::index_sequence_for<ComponentTypes...>());
+		}
+
+		template <typename TObject, size_t ... Indices>
+		bool _MatchAll(TObject* object, Tuple& result, std::index_sequence<Indices...>) const {
+			return (_MatchOne<Indices>(object, result) && ...);
+		}
+
+		template <size_t Index, typename TObject>
+		bool _MatchOne(TObject* object, Tuple& result) const {
+			IComponent* component = object->FindComponent(_typeIds[Index]);
+			if (component == nullptr || !(_includeDisabled || component->IsEnabled)) {
+				return false;
+			}
+			// Lookups are by exact type, so we don't need a dynamic cast
+			std::get<Index>(result) = static_cast<std::tuple_element_t<Index, Tuple>>(component);
+			return true;
+		}
+	};
+}
@@ -8,13 +8,15 @@ GuiPanel::GuiPanel() :
 	_borderRadius(-1),
 	_color(glm::vec4(1.0f)),
 	_texture(nullptr),
-	_transform(nullptr)
+	_transform(nullptr),
+	_geometry()
 { }
 
 GuiPanel::~GuiPanel() = default;
 
 void GuiPanel::SetColor(const glm::vec4& color) {
 	_color = color;
+	_geometry.Invalidate();
 }
 
 const glm::vec4& GuiPanel::GetColor() const {
@@ -27,6 +29,7 @@ int GuiPanel::GetBorderRadius() const {
 
 void GuiPanel::SetBorderRadius(int value) {
 	_borderRadius = value;
+	_geometry.Invalidate();
 }
 
 Texture2D::Sptr GuiPanel::GetTexture() const {
@@ -35,6 +38,7 @@ Texture2D::Sptr GuiPanel::GetTexture() const {
 
 void GuiPanel::SetTexture(const Texture2D::Sptr& value) {
 	_texture = value;
+	_geometry.Invalidate();
 }
 
 void GuiPanel::Awake() {
@@ -46,21 +50,23 @@ void GuiPanel::Awake() {
 }
 
 void GuiPanel::StartGUI() {
-	Texture2D::Sptr tex = _texture != nullptr ? _texture : GuiBatcher::GetDefaultTexture();
+	// Our rect only needs to be rebuilt if we or our transform have changed
+	if (GuiBatcher::BeginCached(_geometry, _transform->GetRevision())) {
+		Texture2D::Sptr tex = _texture != nullptr ? _texture : GuiBatcher::GetDefaultTexture();
 
-	GuiBatcher::PushRect(glm::vec2(0,0), _transform->GetSize(), _color, tex, _borderRadius < 0 ? GuiBatcher::GetDefaultBorderRadius() : _borderRadius);
-
-	GuiBatcher::Flush();
-}
-
-void GuiPanel::FinishGUI() {
-	GuiBatcher::Flush();
+		GuiBatcher::PushRect(glm::vec2(0,0), _transform->GetSize(), _color, tex, _borderRadius < 0 ? GuiBatcher::GetDefaultBorderRadius() : _borderRadius);
+	}
+	GuiBatcher::EndCached(_geometry);
 }
 
 void GuiPanel::RenderImGui()
 {
-	LABEL_LEFT(ImGui::ColorEdit4, "Color ", &_color.x);
-	LABEL_LEFT(ImGui::DragInt,    "Radius", &_borderRadius, 1, 0, 128);
+	bool changed = false;
+	changed |= LABEL_LEFT(ImGui::ColorEdit4, "Color ", &_color.x);
+	changed |= LABEL_LEFT(ImGui::DragInt,    "Radius", &_borderRadius, 1, 0, 128);
+	if (changed) {
+		_geometry.Invalidate();
+	}
 }
 
 nlohmann::json GuiPanel::ToJson() const {
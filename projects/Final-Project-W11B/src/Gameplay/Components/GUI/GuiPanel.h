@@ -3,6 +3,7 @@
 #include "Gameplay/Components/IComponent.h"
 #include "Gameplay/Components/GUI/RectTransform.h"
 #include "Graphics/Textures/Texture2D.h"
+#include "Graphics/GuiBatcher.h"
 
 /// <summary>
 /// Draws a textured background for UI components
@@ -47,7 +48,6 @@ public:
 public:
 	virtual void Awake() override;
 	virtual void StartGUI() override;
-	virtual void FinishGUI() override;
 	virtual void RenderImGui() override;
 	MAKE_TYPENAME(GuiPanel);
 	virtual nlohmann::json ToJson() const override;
@@ -59,4 +59,5 @@ protected:
 	glm::vec4       _color;
 
 	RectTransform::Sptr _transform;
+	GuiGeometryCache    _geometry;
 };
\ No newline at end of file
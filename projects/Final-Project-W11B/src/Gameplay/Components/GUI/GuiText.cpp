@@ -13,14 +13,18 @@ GuiText::GuiText() :
 	_text(LR"()"), // The LR and parenthesis tell us it's a unicode string (wide string)
 	_color(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)),
 	_font(nullptr),
-	_textSize(glm::vec2(0.0f)),
-	_textScale(1.0f)
+	_textScale(1.0f),
+	_glyphRun(),
+	_layoutDirty(true),
+	_atlasRevision(0),
+	_geometry()
 { }
 
 GuiText::~GuiText() = default;
 
 void GuiText::SetColor(const glm::vec4& color) {
 	_color = color;
+	_geometry.Invalidate();
 }
 
 const glm::vec4& GuiText::GetColor() const {
@@ -41,10 +45,8 @@ const std::wstring& GuiText::GetTextUnicode() const {
 
 void GuiText::SetTextUnicode(const std::wstring& value) {
 	_text = value;
-	
-	if (_font != nullptr) {
-		_textSize = _font->MeausureString(_text, _textScale);
-	}
+	_layoutDirty = true;
+	_geometry.Invalidate();
 }
 
 const float GuiText::GetTextScale() const {
@@ -53,6 +55,8 @@ const float GuiText::GetTextScale() const {
 
 void GuiText::SetTextScale(float value) {
 	_textScale = value;
+	_layoutDirty = true;
+	_geometry.Invalidate();
 }
 
 const Font::Sptr& GuiText::GetFont() const {
@@ -61,9 +65,8 @@ const Font::Sptr& GuiText::GetFont() const {
 
 void GuiText::SetFont(const Font::Sptr& font) {
 	_font = font;
-	if (_font != nullptr) {
-		_textSize = _font->MeausureString(_text, _textScale);
-	}
+	_layoutDirty = true;
+	_geometry.Invalidate();
 }
 
 void GuiText::Awake() {
@@ -77,9 +80,24 @@ void GuiText::Awake() {
 void GuiText::RenderGUI()
 {
 	if (_font != nullptr && !_text.empty()) {
-		glm::vec2 position = _transform->GetSize() / 2.0f;
-		position -= _textSize / 2.0f;
-		GuiBatcher::RenderText(_text, _font, position, _color, _textScale);
+		// Glyphs we were using may have been evicted from a dynamic atlas
+		if (_font->GetAtlasRevision() != _atlasRevision) {
+			_layoutDirty = true;
+			_geometry.Invalidate();
+		}
+
+		// The glyph quads only need to be regenerated when we or our transform have changed
+		if (GuiBatcher::BeginCached(_geometry, _transform->GetRevision())) {
+			if (_layoutDirty) {
+				_font->LayoutText(_text, _glyphRun, _textScale);
+				_atlasRevision = _font->GetAtlasRevision();
+				_layoutDirty = false;
+			}
+			glm::vec2 position = _transform->GetSize() / 2.0f;
+			position -= _glyphRun.Size / 2.0f;
+			GuiBatcher::RenderGlyphRun(_glyphRun, _font, position, _color);
+		}
+		GuiBatcher::EndCached(_geometry);
 	}
 }
 
@@ -91,15 +109,15 @@ void GuiText::RenderImGui()
 
 	if (LABEL_LEFT(ImGui::InputTextMultiline, "Text", buffer, 4096)) {
 		_text = StringConvert.from_bytes(buffer);
-		if (_font != nullptr) {
-			_textSize = _font->MeausureString(_text, _textScale);
-		}
+		_layoutDirty = true;
+		_geometry.Invalidate();
+	}
+	if (LABEL_LEFT(ImGui::ColorEdit4, "Color", &_color.x)) {
+		_geometry.Invalidate();
 	}
-	LABEL_LEFT(ImGui::ColorEdit4, "Color", &_color.x);
 	if (LABEL_LEFT(ImGui::DragFloat, "Scale", &_textScale, 0.01f)) {
-		if (_font != nullptr) {
-			_textSize = _font->MeausureString(_text, _textScale);
-		}
+		_layoutDirty = true;
+		_geometry.Invalidate();
 	}
 }
 
@@ -2,6 +2,7 @@
 #include "Gameplay/Components/IComponent.h"
 #include "Gameplay/Components/GUI/RectTransform.h"
 #include "Graphics/Font.h"
+#include "Graphics/GuiBatcher.h"
 
 /// <summary>
 /// Renders text for UI components
@@ -78,8 +79,13 @@ protected:
 	std::wstring    _text;
 	glm::vec4       _color;
 	Font::Sptr      _font;
-	glm::vec2       _textSize;
 	float           _textScale;
 
+	// The laid out glyphs for our text, only rebuilt when the text, font or scale change
+	GlyphRun        _glyphRun;
+	bool            _layoutDirty;
+	uint32_t        _atlasRevision; // The font's atlas revision when we were laid out
+
 	RectTransform::Sptr _transform;
+	GuiGeometryCache    _geometry;
 };
\ No newline at end of file
@@ -13,7 +13,8 @@ RectTransform::RectTransform() :
 	_halfSize({0.5f, 0.5f}),
 	_rotation(0.0f),
 	_transform(glm::mat3(1.0f)),
-	_transformDirty(true)
+	_transformDirty(true),
+	_revision(0)
 { }
 
 RectTransform::~RectTransform() = default;
@@ -23,7 +24,7 @@ const glm::vec2& RectTransform::GetPosition() const {
 }
 void RectTransform::SetPosition(const glm::vec2& pos) {
 	_position = pos;
-	_transformDirty = true;
+	_MarkDirty();
 }
 
 glm::vec2 RectTransform::GetMin() const {
@@ -35,7 +36,7 @@ void RectTransform::SetMin(const glm::vec2& value)
 	glm::vec2 newSize = glm::max(value, GetMax()) - glm::min(value, GetMax());
 	_halfSize = newSize / 2.0f;
 	_position = value + _halfSize;
-	_transformDirty = true;
+	_MarkDirty();
 }
 
 glm::vec2 RectTransform::GetMax() const {
@@ -45,18 +46,20 @@ void RectTransform::SetMax(const glm::vec2& value) {
 	glm::vec2 newSize = glm::max(value, GetMin()) - glm::min(value, GetMin());
 	_halfSize = newSize / 2.0f;
 	_position = value - _halfSize;
-	_transformDirty = true;
+	_MarkDirty();
 }
 
 glm::vec2 RectTransform::GetSize() const {
 	return _halfSize * 2.0f;
 }
 void RectTransform::SetSize(const glm::vec2& value) {
-	_halfSize = value * 2.0f;
+	_halfSize = value / 2.0f;
+	_MarkDirty();
 }
 
 void RectTransform::SetRotationDeg(float value) {
 	_rotation = glm::radians(value);
+	_MarkDirty();
 }
 
 float RectTransform::GetRotationDeg() const {
@@ -68,12 +71,18 @@ const glm::mat3& RectTransform::GetLocalTransform() const {
 	return _transform;
 }
 
+uint32_t RectTransform::GetRevision() const {
+	return _revision;
+}
+
 void RectTransform::RenderImGui()
 {
-	_transformDirty |= LABEL_LEFT(ImGui::DragFloat2, "Position", &_position.x, 0.01f);
+	if (LABEL_LEFT(ImGui::DragFloat2, "Position", &_position.x, 0.01f)) {
+		_MarkDirty();
+	}
 	float degrees = glm::degrees(_rotation);
 	if (LABEL_LEFT(ImGui::DragFloat, "Rotation", &degrees, 0.1f)) {
-		_transformDirty = true;
+		_MarkDirty();
 		_rotation = glm::radians(degrees);
 	}
 	glm::vec2 temp = GetSize();
@@ -118,6 +127,11 @@ RectTransform::Sptr RectTransform::FromJson(const nlohmann::json& blob)
 	return result;
 }
 
+void RectTransform::_MarkDirty() {
+	_transformDirty = true;
+	_revision++;
+}
+
 void RectTransform::__RecalcTransforms() const {
 	if (_transformDirty) {
 		_transform = glm::translate(MAT3_IDENTITY, _position) * glm::rotate(MAT3_IDENTITY, _rotation) * glm::translate(MAT3_IDENTITY, -_halfSize);
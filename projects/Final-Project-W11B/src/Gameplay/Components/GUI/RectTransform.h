@@ -67,6 +67,12 @@ public:
 	/// </summary>
 	const glm::mat3& GetLocalTransform() const;
 
+	/// <summary>
+	/// Gets a counter that is incremented whenever the bounds of this transform
+	/// change, GUI components can use this to know when to rebuild cached geometry
+	/// </summary>
+	uint32_t GetRevision() const;
+
 public:
 	// Inherited from IComponent
 
@@ -85,6 +91,8 @@ protected:
 
 	mutable glm::mat3 _transform;
 	mutable bool _transformDirty;
+	uint32_t  _revision;
 
+	void _MarkDirty();
 	void __RecalcTransforms() const;
 };
\ No newline at end of file
@@ -4,10 +4,6 @@
 #include "Gameplay/Scene.h"
 
 namespace Gameplay {
-	GameObject* IComponent::GetGameObject() const {
-		return _context;
-	}
-
 	std::weak_ptr<IComponent>& IComponent::SelfRef() {
 		return _weakSelfPtr;
 	}
@@ -28,6 +24,7 @@ namespace Gameplay {
 		IResource(),
 		IsEnabled(true),
 		_realType(typeid(IComponent)),
+		_typeId(UINT32_MAX),
 		_context(nullptr)
 	{ }
 
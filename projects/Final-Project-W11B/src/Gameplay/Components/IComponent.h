@@ -117,7 +117,7 @@ namespace Gameplay {
 		/// <summary>
 		/// Gets the gameobject that this component is attached to
 		/// </summary>
-		GameObject* GetGameObject() const;
+		GameObject* GetGameObject() const { return _context; }
 
 		/// <summary>
 		/// Checks whether this component's gameobject has a component of the given type
@@ -161,6 +161,8 @@ namespace Gameplay {
 		friend class GameObject;
 
 		std::type_index _realType;
+		// A small dense ID for our real type, used for O(1) lookups in our game object (see ComponentManager::TypeId)
+		uint32_t _typeId;
 		GameObject* _context;
 
 		// By storing a weak pointer to ourselves, we can pass a pointer to this
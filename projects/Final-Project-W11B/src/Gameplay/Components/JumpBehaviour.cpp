@@ -3,6 +3,7 @@
 #include "Gameplay/GameObject.h"
 #include "Gameplay/Scene.h"
 #include "Utils/ImGuiHelper.h"
+#include "Utils/JsonGlmHelpers.h"
 #include "Gameplay/InputEngine.h"
 
 void JumpBehaviour::Awake()
@@ -15,17 +16,20 @@ void JumpBehaviour::Awake()
 
 void JumpBehaviour::RenderImGui() {
 	LABEL_LEFT(ImGui::DragFloat, "Impulse", &_impulse, 1.0f);
+	LABEL_LEFT(ImGui::DragFloat, "Ground Dist", &_groundDistance, 0.01f, 0.0f);
 }
 
 nlohmann::json JumpBehaviour::ToJson() const {
 	return {
-		{ "impulse", _impulse }
+		{ "impulse", _impulse },
+		{ "ground_distance", _groundDistance }
 	};
 }
 
 JumpBehaviour::JumpBehaviour() :
 	IComponent(),
-	_impulse(10.0f)
+	_impulse(10.0f),
+	_groundDistance(1.0f)
 { }
 
 JumpBehaviour::~JumpBehaviour() = default;
@@ -33,11 +37,12 @@ JumpBehaviour::~JumpBehaviour() = default;
 JumpBehaviour::Sptr JumpBehaviour::FromJson(const nlohmann::json& blob) {
 	JumpBehaviour::Sptr result = std::make_shared<JumpBehaviour>();
 	result->_impulse = blob["impulse"];
+	result->_groundDistance = JsonGet(blob, "ground_distance", result->_groundDistance);
 	return result;
 }
 
 void JumpBehaviour::Update(float deltaTime) {
-	if (InputEngine::GetKeyState(GLFW_KEY_SPACE) == ButtonState::Pressed) {
+	if (InputEngine::GetKeyState(GLFW_KEY_SPACE) == ButtonState::Pressed && _IsGrounded()) {
 		_body->ApplyImpulse(glm::vec3(0.0f, 0.0f, _impulse));
 		Gameplay::IComponent::Sptr ptr = Panel.lock();
 		if (ptr != nullptr) {
@@ -46,3 +51,16 @@ void JumpBehaviour::Update(float deltaTime) {
 	}
 }
 
+
+bool JumpBehaviour::_IsGrounded() const {
+	if (_groundDistance <= 0.0f) {
+		return true;
+	}
+
+	// Look straight down for anything but ourselves
+	Gameplay::Physics::PhysicsQueryFilter filter;
+	filter.Ignore = GetGameObject();
+	Gameplay::Physics::PhysicsHit hit;
+	glm::vec3 position = GetGameObject()->GetPosition();
+	return GetGameObject()->GetScene()->Raycast(position, position - glm::vec3(0.0f, 0.0f, _groundDistance), hit, filter);
+}
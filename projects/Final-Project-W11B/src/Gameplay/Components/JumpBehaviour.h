@@ -4,7 +4,8 @@
 
 /// <summary>
 /// A simple behaviour that applies an impulse along the Z axis to the 
-/// rigidbody of the parent when the space key is pressed
+/// rigidbody of the parent when the space key is pressed, as long as it's
+/// standing on something
 /// </summary>
 class JumpBehaviour : public Gameplay::IComponent {
 public:
@@ -26,7 +27,11 @@ public:
 
 protected:
 	float _impulse;
+	// How far below the object's origin we look for the ground, 0 lets the object jump in mid air
+	float _groundDistance;
 
 	bool _isPressed = false;
 	Gameplay::Physics::RigidBody::Sptr _body;
+
+	bool _IsGrounded() const;
 };
\ No newline at end of file
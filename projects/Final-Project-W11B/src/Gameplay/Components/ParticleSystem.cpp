@@ -3,6 +3,7 @@
 #include "Application/Timing.h"
 #include "Application/Application.h"
 #include "Utils/ImGuiHelper.h"
+#include "Utils/FrameMemory.h"
 #include "Graphics/DebugDraw.h"
 #include "imgui_internal.h"
 
@@ -117,9 +118,9 @@ void ParticleSystem::Update()
 	if (_needsUpload) {
 		glBindVertexArray(0);
 
-		// Allocate some temp space for particles, so we can init the emitters
+		// Grab some temp space for particles from the frame allocator, so we can init the emitters
 		size_t dataSize = (_emitters.size()) * sizeof(ParticleData);
-		ParticleData* data = new ParticleData[_emitters.size()];
+		ParticleData* data = FrameMemory::Frame().AllocateArray<ParticleData>(_emitters.size());
 		memset(data, 0, dataSize);
 
 		// Add all emitter to the the particle list at the beginning
@@ -131,9 +132,6 @@ void ParticleSystem::Update()
 		for (int ix = 0; ix < 2; ix++) {
 			glNamedBufferSubData(_particleBuffers[ix], 0, dataSize, data);
 		}
-
-		// We no longer need the CPU copy
-		delete[] data;
 	}
 
 	// Disable rasterization, this is update only
@@ -56,6 +56,7 @@ RenderComponent::Sptr RenderComponent::FromJson(const nlohmann::json& data) {
 void RenderComponent::RenderImGui() {
 	ImGui::Text("Indexed:   %s", GetMesh() != nullptr ? (_mesh->Mesh->GetIndexBuffer() != nullptr ? "true" : "false") : "N/A");
 	ImGui::Text("Triangles: %d", GetMesh() != nullptr ? (_mesh->Mesh->GetElementCount() / 3) : 0);
+	ImGui::Text("LODs:      %d", GetMesh() != nullptr ? _mesh->Mesh->GetLodCount() : 0);
 	ImGui::Text("Source:    %s", (_mesh == nullptr || _mesh->Filename.empty()) ? "Generated" : _mesh->Filename.c_str());
 	ImGui::Separator();
 	ImGui::Text("Material:  %s", _material != nullptr ? _material->Name.c_str() : "NULL");
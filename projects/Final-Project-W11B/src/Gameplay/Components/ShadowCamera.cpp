@@ -12,6 +12,7 @@ ShadowCamera::ShadowCamera() :
 	NormalBias(0.0001f),
 	Intensity(1.0f),
 	Range(100.0f),
+	LodBias(2.0f),
 	_depthBuffer(nullptr),
 	_projectionMask(nullptr),
 	_color(glm::vec4(1.0f)),
@@ -85,6 +86,7 @@ nlohmann::json ShadowCamera::ToJson() const
 		{ "normal_bias", NormalBias },
 		{ "range", Range },
 		{ "intensity", Intensity },
+		{ "lod_bias", LodBias },
 		{ "resolution", _bufferResolution },
 		{ "flags", *Flags },
 		{ "mask", _projectionMask ? _projectionMask->GetGUID().str() : "null" },
@@ -101,6 +103,7 @@ ShadowCamera::Sptr ShadowCamera::FromJson(const nlohmann::json& data)
 	result->NormalBias = JsonGet(data, "normal_bias", result->NormalBias);
 	result->Range = JsonGet(data, "range", result->Range);
 	result->Intensity = JsonGet(data, "intensity", result->Intensity);
+	result->LodBias = JsonGet(data, "lod_bias", result->LodBias);
 	result->_color = JsonGet(data, "color", result->_color);
 	result->_bufferResolution = JsonGet(data, "resolution", result->_bufferResolution);
 	result->_projectionMask = ResourceManager::Get<Texture2D>(Guid(JsonGet<std::string>(data, "mask", "null")));
@@ -131,6 +134,7 @@ void ShadowCamera::RenderImGui()
 	}
 	ImGui::DragFloat("Bias", &Bias, 0.000001f, 0.0f, 0.1f, "%.9f");
 	ImGui::DragFloat("Normal Bias", &NormalBias, 0.000001f, 0.0f, 0.1f, "%.9f");
+	ImGui::DragFloat("LOD Bias", &LodBias, 0.01f, 0.0f, 16.0f);
 	if (ImGui::DragInt2("Resolution", &_bufferResolution.x, 1.0f, 1, 1024)) {
 		SetBufferResolution(_bufferResolution);
 	}
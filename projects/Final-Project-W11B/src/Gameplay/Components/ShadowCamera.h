@@ -29,6 +29,11 @@ public:
 	float NormalBias;
 	float Intensity;
 	float Range;
+	/// <summary>
+	/// Multiplies how much mesh simplification error is allowed when picking levels of detail for
+	/// this light's shadow map, shadows hide detail so they can usually use coarser meshes
+	/// </summary>
+	float LodBias;
 
 	ShadowCamera();
 	virtual ~ShadowCamera();
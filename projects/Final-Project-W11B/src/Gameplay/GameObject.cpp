@@ -12,6 +12,7 @@
 #include "Utils/ImGuiHelper.h"
 
 #include "Gameplay/Scene.h"
+#include "Utils/FrameMemory.h"
 
 namespace Gameplay {
 	GameObject::GameObject() :
@@ -19,6 +20,7 @@ namespace Gameplay {
 		Name("Unknown"),
 		HideInHierarchy(false),
 		_components(std::vector<IComponent::Sptr>()),
+		_componentSlots(std::vector<uint16_t>()),
 		_scene(nullptr),
 		_position(ZERO),
 		_rotation(glm::quat(glm::vec3(0.0f))),
@@ -29,10 +31,26 @@ namespace Gameplay {
 		_worldTransform(MAT4_IDENTITY),
 		_inverseWorldTransform(MAT4_IDENTITY),
 		_isWorldTransformDirty(true),
+		_transformVersion(0),
+		_spatialProxy(-1),
+		_spatialVersion(0),
+		_spatialMesh(nullptr),
+		_spatialPosition(ZERO),
 		_parent(WeakRef()),
 		_children(std::vector<WeakRef>())
 	{ }
 
+	GameObject::Sptr GameObject::_Allocate() {
+		// We can't use allocate_shared since our constructor is protected, so we construct the object in
+		// pool memory ourselves, and pass the pool to the shared pointer for it's control block
+		std::pmr::memory_resource* pool = FrameMemory::Objects();
+		GameObject* object = new (pool->allocate(sizeof(GameObject), alignof(GameObject))) GameObject();
+		return GameObject::Sptr(object, [pool](GameObject* ptr) {
+			ptr->~GameObject();
+			pool->deallocate(ptr, sizeof(GameObject), alignof(GameObject));
+		}, std::pmr::polymorphic_allocator<GameObject>(pool));
+	}
+
 	void GameObject::_RecalcLocalTransform() const
 	{
 		if (_isLocalTransformDirty) {
@@ -71,6 +89,7 @@ namespace Gameplay {
 				_inverseWorldTransform = _inverseLocalTransform;
 			}
 			_isWorldTransformDirty = false;
+			_transformVersion++;
 		}
 	}
 
@@ -172,6 +191,11 @@ namespace Gameplay {
 		return _inverseLocalTransform;
 	}
 
+	uint32_t GameObject::GetTransformVersion() const {
+		_RecalcWorldTransform();
+		return _transformVersion;
+	}
+
 	void GameObject::RenderGUI() {
 		// Prune children
 		auto it = std::remove_if(_children.begin(), _children.end(), [](const WeakRef& child) { return !child.IsAlive(); });
@@ -222,26 +246,37 @@ namespace Gameplay {
 	}
 
 	bool GameObject::Has(const std::type_index& type) {
-		// Iterate over all the pointers in the components list
-		for (const auto& ptr : _components) {
-			// If the pointer type matches T, we return true
-			if (std::type_index(typeid(*ptr.get())) == type) {
-				return true;
-			}
-		}
-		return false;
+		return _FindComponentIndex(ComponentManager::TypeId(type)) >= 0;
 	}
 
 	std::shared_ptr<IComponent> GameObject::Get(const std::type_index& type)
 	{
-		// Iterate over all the pointers in the binding list
-		for (const auto& ptr : _components) {
-			// If the pointer type matches T, we return that behaviour, making sure to cast it back to the requested type
-			if (std::type_index(typeid(*ptr.get())) == type) {
-				return ptr;
-			}
+		int index = _FindComponentIndex(ComponentManager::TypeId(type));
+		return index >= 0 ? _components[index] : nullptr;
+	}
+
+	void GameObject::RemoveComponent(size_t index) {
+		LOG_ASSERT(index < _components.size(), "Component index out of range!");
+		_components.erase(_components.begin() + index);
+		// Removing shifts every component after it, so our slots need to be rebuilt
+		_RebuildComponentSlots();
+	}
+
+	void GameObject::_AddComponent(const IComponent::Sptr& component) {
+		LOG_ASSERT(component->_typeId != UINT32_MAX, "Component was not created by a ComponentManager!");
+		_components.push_back(component);
+
+		if (component->_typeId >= _componentSlots.size()) {
+			_componentSlots.resize(component->_typeId + 1, 0);
+		}
+		_componentSlots[component->_typeId] = static_cast<uint16_t>(_components.size());
+	}
+
+	void GameObject::_RebuildComponentSlots() {
+		std::fill(_componentSlots.begin(), _componentSlots.end(), 0);
+		for (size_t ix = 0; ix < _components.size(); ix++) {
+			_componentSlots[_components[ix]->_typeId] = static_cast<uint16_t>(ix + 1);
 		}
-		return nullptr;
 	}
 
 	std::shared_ptr<IComponent> GameObject::Add(const std::type_index& type)
@@ -254,7 +289,7 @@ namespace Gameplay {
 		component->_context = this;
 
 		// Append it to the binding component's storage, and invoke the OnLoad
-		_components.push_back(component);
+		_AddComponent(component);
 		component->OnLoad();
 
 		if (_scene->GetIsAwake()) {
@@ -394,7 +429,7 @@ namespace Gameplay {
 					component->RenderImGui();
 					// Render a delete button for the component
 					if (ImGuiHelper::WarningButton("Delete")) {
-						_components.erase(_components.begin() + ix);
+						RemoveComponent(ix);
 						ix--;
 					}
 					ImGui::PopID();
@@ -452,7 +487,7 @@ namespace Gameplay {
 	{
 		// We need to manually construct since the GameObject constructor is
 		// protected. We can call it here since Scene is a friend class of GameObjects
-		GameObject::Sptr result(new GameObject());
+		GameObject::Sptr result = _Allocate();
 		result->_scene = scene;
 
 		// Load in basic info
@@ -477,7 +512,7 @@ namespace Gameplay {
 			component->_context = result.get();
 
 			// Add component to object and allow it to perform self initialization
-			result->_components.push_back(component);
+			result->_AddComponent(component);
 			component->OnLoad();
 		}
 
@@ -226,6 +226,12 @@ namespace Gameplay {
 		const glm::mat4& GetLocalTransform() const;
 		const glm::mat4& GetInverseLocalTransform() const;
 
+		/// <summary>
+		/// Gets a counter that changes whenever the object's world transform does, recalculating the
+		/// transform if needed. Lets systems cheaply tell whether an object moved since they last looked
+		/// </summary>
+		uint32_t GetTransformVersion() const;
+
 		/// <summary>
 		/// Allows components to render GUI elements to the screen
 		/// </summary>
@@ -253,14 +259,7 @@ namespace Gameplay {
 		/// <typeparam name="T">The type of component to search for</typeparam>
 		template <typename T, typename = typename std::enable_if<std::is_base_of<IComponent, T>::value>::type>
 		bool Has() {
-			// Iterate over all the pointers in the components list
-			for (const auto& ptr : _components) {
-				// If the pointer type matches T, we return true
-				if (std::type_index(typeid(*ptr.get())) == std::type_index(typeid(T))) {
-					return true;
-				}
-			}
-			return false;
+			return _FindComponentIndex(ComponentManager::TypeId<T>()) >= 0;
 		}
 
 		bool Has(const std::type_index& type);
@@ -271,18 +270,28 @@ namespace Gameplay {
 		/// <typeparam name="T">The type of component to search for</typeparam>
 		template <typename T, typename = typename std::enable_if<std::is_base_of<IComponent, T>::value>::type>
 		std::shared_ptr<T> Get() {
-			// Iterate over all the pointers in the binding list
-			for (const auto& ptr : _components) {
-				// If the pointer type matches T, we return that behaviour, making sure to cast it back to the requested type
-				if (std::type_index(typeid(*ptr.get())) == std::type_index(typeid(T))) {
-					return std::dynamic_pointer_cast<T>(ptr);
-				}
-			}
-			return nullptr;
+			// Lookups are by exact type, so we don't need a dynamic cast
+			int index = _FindComponentIndex(ComponentManager::TypeId<T>());
+			return index >= 0 ? std::static_pointer_cast<T>(_components[index]) : nullptr;
 		}
 
 		std::shared_ptr<IComponent> Get(const std::type_index& type);
 
+		/// <summary>
+		/// Removes the component at the given index in this gameobject's component list
+		/// </summary>
+		/// <param name="index">The index of the component to remove</param>
+		void RemoveComponent(size_t index);
+
+		/// <summary>
+		/// Gets the component with the given dense type ID (see ComponentManager::TypeId), without
+		/// touching any reference counts. Returns nullptr if we have no component of that type
+		/// </summary>
+		IComponent* FindComponent(uint32_t typeId) const {
+			int index = _FindComponentIndex(typeId);
+			return index >= 0 ? _components[index].get() : nullptr;
+		}
+
 		/// <summary>
 		/// Adds a component of the given type to this gameobject. Note that only one component
 		/// of a given type may be attached to a gameobject
@@ -300,7 +309,7 @@ namespace Gameplay {
 			component->_context = this;
 
 			// Append it to the binding component's storage, and invoke the OnLoad
-			_components.push_back(component);
+			_AddComponent(component);
 			component->OnLoad();
 
 			if (_scene->GetIsAwake()) {
@@ -354,6 +363,14 @@ namespace Gameplay {
 		mutable glm::mat4 _worldTransform;
 		mutable glm::mat4 _inverseWorldTransform;
 		mutable bool _isWorldTransformDirty;
+		// Incremented whenever the world transform is recalculated, so the scene can tell which objects moved
+		mutable uint32_t _transformVersion;
+
+		// Our leaf in the scene's spatial index, and the state it was last updated with
+		int         _spatialProxy;
+		uint32_t    _spatialVersion;
+		const void* _spatialMesh;
+		glm::vec3   _spatialPosition;
 
 		// For the hierarchy
 		WeakRef _parent;
@@ -361,6 +378,9 @@ namespace Gameplay {
 
 		// The components that this game object has attached to it
 		std::vector<IComponent::Sptr> _components;
+		// Maps component type IDs to their index in _components plus one, so 0 means we don't have
+		// that type. This is tiny since type IDs are dense, and saves us comparing typeids on lookup
+		std::vector<uint16_t> _componentSlots;
 		std::weak_ptr<GameObject> _selfRef;
 
 		// Pointer to the scene, we use raw pointers since 
@@ -372,12 +392,25 @@ namespace Gameplay {
 		/// Only scenes will be allowed to create gameobjects
 		/// </summary>
 		GameObject();
+		/// <summary>
+		/// Constructs a new game object in memory from the object pools
+		/// </summary>
+		static GameObject::Sptr _Allocate();
 
 		// Recalculates the transform matrix for the object when required
 		void _RecalcLocalTransform() const;
 		void _RecalcWorldTransform() const;
 
 		void _PurgeDeletedChildren();
+
+		// Finds the index of the component with the given type ID in _components, or -1
+		int _FindComponentIndex(uint32_t typeId) const {
+			return typeId < _componentSlots.size() ? static_cast<int>(_componentSlots[typeId]) - 1 : -1;
+		}
+		// Appends a component and adds it to the lookup table
+		void _AddComponent(const IComponent::Sptr& component);
+		// Rebuilds the lookup table, after removing components
+		void _RebuildComponentSlots();
 	};
 
 }
\ No newline at end of file
@@ -2,24 +2,41 @@
 #include <filesystem>
 
 #include "Utils/ObjLoader.h"
+#include "Utils/OptimizedObjLoader.h"
+#include "Utils/GltfLoader.h"
 
 namespace Gameplay {
+	namespace {
+		VertexArrayObject::Sptr LoadMeshFile(const std::string& filename, int meshIndex) {
+			if (GltfLoader::IsGltfFile(filename)) {
+				return GltfLoader::LoadFromFile(filename, meshIndex);
+			}
+			#ifdef OPTIMIZED_OBJ_LOADER
+			return OptimizedObjLoader::LoadFromFile(filename);
+			#else
+			return ObjLoader::LoadFromFile(filename);
+			#endif
+		}
+	}
+
 	MeshResource::MeshResource() :
 		IResource(),
 		Filename(""),
+		MeshIndex(0),
 		MeshBuilderParams(std::vector<MeshBuilderParam>()),
 		Mesh(nullptr),
-		BulletTriMesh(nullptr)
+		CollisionHulls(nullptr)
 	{ }
 
-	MeshResource::MeshResource(const std::string& filename) :
+	MeshResource::MeshResource(const std::string& filename, int meshIndex) :
 		IResource(),
 		Filename(filename),
+		MeshIndex(meshIndex),
 		MeshBuilderParams(std::vector<MeshBuilderParam>()),
 		Mesh(nullptr),
-		BulletTriMesh(nullptr)
+		CollisionHulls(nullptr)
 	{
-		Mesh = ObjLoader::LoadFromFile(filename);
+		Mesh = LoadMeshFile(filename, meshIndex);
 	}
 
 	MeshResource::~MeshResource() = default;
@@ -35,6 +52,9 @@ namespace Gameplay {
 			result["params"] = params;
 		} else {
 			result["filename"] = Filename.empty() ? "null" : Filename;
+			if (MeshIndex != 0) {
+				result["mesh_index"] = MeshIndex;
+			}
 		}
 		return result;
 	}
@@ -54,13 +74,9 @@ namespace Gameplay {
 			result->Mesh = mesh.Bake();
 		} else {
 			result->Filename = JsonGet<std::string>(blob, "filename", "null");
+			result->MeshIndex = JsonGet<int>(blob, "mesh_index", 0);
 			if (result->Filename != "null" && std::filesystem::exists(result->Filename)) {
-				#ifdef OPTIMIZED_OBJ_LOADER
-				result->Mesh = OptimizedObjLoader::LoadFromFile(result->Filename);
-				#else
-				result->Mesh = ObjLoader::LoadFromFile(result->Filename);
-				#endif
-
+				result->Mesh = LoadMeshFile(result->Filename, result->MeshIndex);
 			}
 		}
 		return result;
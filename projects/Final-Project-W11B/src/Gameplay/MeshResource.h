@@ -3,14 +3,14 @@
 #include "Graphics/VertexArrayObject.h"
 #include "Utils/MeshFactory.h"
 
-// bullet triangle mesh pre-declaration
-class btTriangleMesh;
+// cooked collision shape pre-declaration
+struct CookedCollisionShape;
 
 namespace Gameplay {
 	/// <summary>
 	/// A mesh resource contains information on how to generate a VAO at runtime
-	/// It can either load a VAO from a file, or generate one using the mesh 
-	/// factory and MeshBuilderParams
+	/// It can either load a VAO from a file (OBJ, or glTF/GLB), or generate one 
+	/// using the mesh factory and MeshBuilderParams
 	/// </summary>
 	class MeshResource : public IResource {
 	public:
@@ -22,7 +22,8 @@ namespace Gameplay {
 		/// Constructor for loading from file
 		/// </summary>
 		/// <param name="filename"></param>
-		MeshResource(const std::string& filename);
+		/// <param name="meshIndex">For glTF files, which of the file's meshes to load</param>
+		MeshResource(const std::string& filename, int meshIndex = 0);
 
 		virtual ~MeshResource();
 
@@ -32,6 +33,10 @@ namespace Gameplay {
 		/// </summary>
 		std::string                     Filename;
 		/// <summary>
+		/// For glTF files, the index of the mesh within the file
+		/// </summary>
+		int                             MeshIndex;
+		/// <summary>
 		/// The mesh builder parameters if this mesh resource is created at runtime
 		/// </summary>
 		std::vector<MeshBuilderParam>   MeshBuilderParams;
@@ -47,9 +52,9 @@ namespace Gameplay {
 		/// </summary>
 		MeshResource::Sptr             ColliderMeshData;
 		/// <summary>
-		/// Allows for bullet to generate a triangle mesh from this mesh and cache it
+		/// The convex hulls cooked from this mesh for mesh colliders, shared by every collider using this mesh
 		/// </summary>
-		std::shared_ptr<btTriangleMesh> BulletTriMesh;
+		std::shared_ptr<CookedCollisionShape> CollisionHulls;
 
 		/// <summary>
 		/// Generates a new mesh from the mesh builder parameters
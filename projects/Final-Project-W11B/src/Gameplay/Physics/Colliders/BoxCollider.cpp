@@ -21,6 +21,10 @@ namespace Gameplay::Physics {
 		return new btBoxShape(btVector3(_extents.x, _extents.y, _extents.z));
 	}
 
+	void BoxCollider::WriteShapeKey(CollisionShapeKey& key) const {
+		key.Add(_extents);
+	}
+
 	void BoxCollider::FromJson(const nlohmann::json& data) {
 		_extents = data["extents"];
 	}
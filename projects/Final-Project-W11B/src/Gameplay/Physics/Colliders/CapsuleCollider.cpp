@@ -35,6 +35,10 @@ namespace Gameplay::Physics {
 		return new btCapsuleShapeZ(_radius, _height);
 	}
 
+	void CapsuleCollider::WriteShapeKey(CollisionShapeKey& key) const {
+		key.Add(_radius).Add(_height);
+	}
+
 
 	CapsuleCollider* CapsuleCollider::SetRadius(float value) {
 		_radius = value;
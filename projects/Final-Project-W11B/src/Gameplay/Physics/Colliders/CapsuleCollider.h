@@ -25,6 +25,7 @@ namespace Gameplay::Physics {
 
 	protected:
 		virtual btCollisionShape* CreateShape() const override;
+		virtual void WriteShapeKey(CollisionShapeKey& key) const override;
 
 	private:
 		float _radius;
@@ -35,6 +35,10 @@ namespace Gameplay::Physics {
 		return new btConeShapeZ(_radius, _height);
 	}
 
+	void ConeCollider::WriteShapeKey(CollisionShapeKey& key) const {
+		key.Add(_radius).Add(_height);
+	}
+
 
 	ConeCollider* ConeCollider::SetRadius(float value) {
 		_radius = value;
@@ -42,6 +42,7 @@ namespace Gameplay::Physics {
 
 	protected:
 		virtual btCollisionShape* CreateShape() const override;
+		virtual void WriteShapeKey(CollisionShapeKey& key) const override;
 
 	private:
 		float _radius;
@@ -1,13 +1,95 @@
 #include "ConvexMeshCollider.h"
-#include <BulletCollision/CollisionShapes/btShapeHull.h>
+#include <filesystem>
+#include <BulletCollision/CollisionShapes/btConvexPointCloudShape.h>
 
 #include "Gameplay/GameObject.h"
 #include "Gameplay/MeshResource.h"
 #include "Gameplay/Components/RenderComponent.h"
+#include "Graphics/VertexParamMap.h"
 
-#include "Utils/GlmBulletConversions.h"
+#include "Utils/JsonGlmHelpers.h"
+#include "Utils/ImGuiHelper.h"
 
 namespace Gameplay::Physics {
+	namespace {
+		/// <summary>
+		/// Reads the positions and triangles of a mesh back from OpenGL, returns false if the
+		/// positions could not be read. If the mesh is not indexed, indices will be left empty
+		/// </summary>
+		bool ReadMeshData(const VertexArrayObject::Sptr& vao, std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices) {
+			// Get the vertex declaration from the VAO so we can pull out positions
+			const VertexArrayObject::VertexDeclaration& VDecl = vao->GetVDecl();
+			if (VDecl.size() == 0) {
+				LOG_WARN("Mesh does not have a vertex declaration, unable to determine position elements");
+				return false;
+			}
+
+			// Get the attribute for positions from the vertex declaration
+			auto it = std::find_if(VDecl.begin(), VDecl.end(), [](const BufferAttribute& attrib) {
+				return attrib.Usage == AttribUsage::Position;
+			});
+			if (it == VDecl.end()) {
+				LOG_WARN("Mesh vertex declaration does not have a position element");
+				return false;
+			}
+			BufferAttribute posAttrib = *it;
+
+			// Positions may be packed, so we let the param map decode them
+			VertexParamMap vMap(VDecl);
+			vMap.PositionDequantize = vao->GetPositionDequantize();
+			if (!vMap.HasPosition()) {
+				LOG_WARN("Mesh vertex declaration has an unsupported position format");
+				return false;
+			}
+
+			// Get the VBO that contains our data about the position elements
+			const auto* vertBuff = vao->GetBufferBinding(AttribUsage::Position);
+			if (vertBuff == nullptr) {
+				return false;
+			}
+
+			// Shorthand our buffers
+			IndexBuffer::Sptr indexBuff = vao->GetIndexBuffer();
+			VertexBuffer::Sptr vertexBuff = vertBuff->GetBuffer();
+
+			// Allocate some space to read data from OpenGL and read our buffer data back into CPU memory
+			std::vector<uint8_t> vertexStore(vertexBuff->GetTotalSize());
+			glGetNamedBufferSubData(vertexBuff->GetHandle(), 0, vertexBuff->GetTotalSize(), vertexStore.data());
+			positions.resize(vertexBuff->GetElementCount());
+			for (size_t ix = 0; ix < positions.size(); ix++) {
+				positions[ix] = vMap.GetPosition(vertexStore[ix * posAttrib.Stride]);
+			}
+
+			// If our data is indexed, we read back the triangles, only using the full detail level if the mesh has levels of detail
+			if (indexBuff != nullptr) {
+				std::vector<uint8_t> indexStore(indexBuff->GetTotalSize());
+				glGetNamedBufferSubData(indexBuff->GetHandle(), 0, indexBuff->GetTotalSize(), indexStore.data());
+
+				indices.resize(vao->GetElementCount());
+				for (size_t ix = 0; ix < indices.size(); ix++) {
+					switch (indexBuff->GetElementType())
+					{
+						case IndexType::UByte:
+							indices[ix] = indexStore[ix];
+							break;
+						case IndexType::UShort:
+							indices[ix] = reinterpret_cast<const uint16_t*>(indexStore.data())[ix];
+							break;
+						case IndexType::UInt:
+							indices[ix] = reinterpret_cast<const uint32_t*>(indexStore.data())[ix];
+							break;
+						case IndexType::Unknown:
+						default:
+							indices[ix] = 0;
+							break;
+					}
+				}
+			}
+
+			return true;
+		}
+	}
+
 	ConvexMeshCollider::Sptr ConvexMeshCollider::Create() {
 		return std::shared_ptr<ConvexMeshCollider>(new ConvexMeshCollider());
 	}
@@ -16,28 +98,48 @@ namespace Gameplay::Physics {
 
 	ConvexMeshCollider::ConvexMeshCollider() :
 		ICollider(ColliderType::ConvexMesh),
-		_triMesh(nullptr)
+		_settings(),
+		_mesh(),
+		_cooked(nullptr)
 	{ }
 
+	const CollisionCookSettings& ConvexMeshCollider::GetCookSettings() const {
+		return _settings;
+	}
+
+	void ConvexMeshCollider::SetCookSettings(const CollisionCookSettings& value) {
+		_settings = value;
+		_CookHulls();
+	}
+
 	btCollisionShape* ConvexMeshCollider::CreateShape() const {
-		// https://pybullet.org/Bullet/phpBB3/viewtopic.php?t=4513
-		if (_triMesh == nullptr) {
+		if (_cooked == nullptr || _cooked->Hulls.empty()) {
 			return nullptr;
 		}
-		btConvexShape* result = new btConvexTriangleMeshShape(_triMesh);
 
-		// The hull shape will calculate the convex hull that contains our shape
-		//btShapeHull* hull = new btShapeHull(result);
-		//float margin = result->getMargin();
-		//bool build = hull->buildHull(margin);
-		//if (!build) {
-		//	LOG_WARN("Failed to build hull for convex mesh");
-		//}
-		//delete hull;
+		// Point cloud shapes reference the cooked vertices rather than copying them, so all colliders on the
+		// same mesh share one set of hulls, even when their shapes are scaled differently
+		if (_cooked->Hulls.size() == 1) {
+			std::vector<btVector3>& hull = _cooked->Hulls[0];
+			return new btConvexPointCloudShape(hull.data(), static_cast<int>(hull.size()), btVector3(1.0f, 1.0f, 1.0f));
+		}
 
+		btTransform identity;
+		identity.setIdentity();
+		// The compound owns the hulls, the shape cache will delete them along with it
+		btCompoundShape* result = new btCompoundShape(true, static_cast<int>(_cooked->Hulls.size()));
+		for (std::vector<btVector3>& hull : _cooked->Hulls) {
+			result->addChildShape(identity, new btConvexPointCloudShape(hull.data(), static_cast<int>(hull.size()), btVector3(1.0f, 1.0f, 1.0f)));
+		}
 		return result;
 	}
 
+	void ConvexMeshCollider::WriteShapeKey(CollisionShapeKey& key) const {
+		// Our shapes point into the cooked hulls, so they need to stay alive as long as the shape does
+		key.Add(_cooked.get());
+		key.Hold(_cooked);
+	}
+
 	void ConvexMeshCollider::Awake(GameObject* context)
 	{
 		// Get the components from the gameobject that we'll need to generate the mesh
@@ -55,119 +157,93 @@ namespace Gameplay::Physics {
 			mesh = mesh->ColliderMeshData;
 		}
 
-		// We've already calculated the mesh, use existing
-		if (mesh->BulletTriMesh != nullptr) {
-			_triMesh = mesh->BulletTriMesh.get();
+		_mesh = mesh;
+		_CookHulls();
+	}
+
+	void ConvexMeshCollider::_CookHulls() {
+		MeshResource::Sptr mesh = _mesh.lock();
+		if (mesh == nullptr) {
+			return;
+		}
+
+		// Our current shape points into the old hulls, so it has to be rebuilt whenever we replace them. The
+		// old hulls are kept alive by the shape cache until the shape that uses them is released
+		CookedCollisionShape::Sptr hulls = _LoadHulls(mesh);
+		if (hulls != _cooked) {
+			_cooked = hulls;
+			_isDirty = true;
+		}
+	}
+
+	CookedCollisionShape::Sptr ConvexMeshCollider::_LoadHulls(const std::shared_ptr<MeshResource>& mesh) const {
+		// Another collider has already cooked the hulls we want, use existing
+		if (mesh->CollisionHulls != nullptr && mesh->CollisionHulls->Settings == _settings) {
+			return mesh->CollisionHulls;
+		}
+
+		// Try to load the hulls from the cache next to the mesh file
+		CookedCollisionShape::Sptr result = nullptr;
+		std::string cachePath;
+		if (!mesh->Filename.empty()) {
+			cachePath = CollisionCooker::GetCachePath(mesh->Filename, mesh->MeshIndex);
+			result = CollisionCooker::LoadFromFile(cachePath, _settings, mesh->Filename);
 		}
-		// We need to calculate the triangle mesh from the mesh data
-		else {
+
+		// We need to cook the hulls from the mesh data
+		if (result == nullptr) {
 			// Get the VAO from the mesh and make sure it exists
 			VertexArrayObject::Sptr vao = mesh->Mesh;
 			if (vao == nullptr) {
 				LOG_WARN("Mesh resource not fully configured!");
-				return;
+				return nullptr;
 			}
 
-			// Get the vertex declaration from the VAO so we can pull out positions
-			const VertexArrayObject::VertexDeclaration& VDecl = vao->GetVDecl();
-			if (VDecl.size() == 0) {
-				LOG_WARN("Mesh does not have a vertex declaration, unable to determine position elements");
-				return;
+			std::vector<glm::vec3> positions;
+			std::vector<uint32_t> indices;
+			if (!ReadMeshData(vao, positions, indices)) {
+				return nullptr;
 			}
 
-			// Get the attribute for positions from the vertex declaration
-			auto& it = std::find_if(VDecl.begin(), VDecl.end(), [](const BufferAttribute& attrib) {
-				return attrib.Usage == AttribUsage::Position;
-			});
-			if (it == VDecl.end()) {
-				LOG_WARN("Mesh vertex declaration does not have a position element");
-				return;
+			result = CollisionCooker::Cook(positions, indices, _settings);
+			if (result == nullptr) {
+				LOG_WARN("Failed to cook collision hulls for mesh, it may not have any volume");
+				return nullptr;
 			}
-			BufferAttribute posAttrib = *it;
-
-			// Get the VBO that contains our data about the position elements
-			const auto* vertBuff = vao->GetBufferBinding(AttribUsage::Position);
-			if (vertBuff != nullptr) {
-				// Shorthand our buffers
-				IndexBuffer::Sptr indexBuff = vao->GetIndexBuffer();
-				VertexBuffer::Sptr vertexBuff = vertBuff->GetBuffer();
-
-				// Create the bullet physics triangle mesh
-				_triMesh = new btTriangleMesh();
-
-				// Helper for extracting an int from a raw index buffer datastore
-				auto getBufferIndex = [](IndexBuffer::Sptr buff, uint8_t* dataStore, int offset) {
-					switch (buff->GetElementType())
-					{
-						case IndexType::UByte:
-							return (int)*(dataStore + offset);
-						case IndexType::UShort:
-							return (int)*(reinterpret_cast<uint16_t*>(dataStore) + offset);
-						case IndexType::UInt:
-							return (int)*(reinterpret_cast<uint32_t*>(dataStore) + offset);
-						case IndexType::Unknown:
-						default:
-							return 0;
-					}
-				};
-
-				// Allocate some space to read data from OpenGL and read our buffer data back into CPU memory
-				uint8_t* vertexStore = reinterpret_cast<uint8_t*>(malloc(vertexBuff->GetTotalSize()));
-				glGetNamedBufferSubData(vertexBuff->GetHandle(), 0, vertexBuff->GetTotalSize(), vertexStore);
-				_triMesh->preallocateVertices(vao->GetVertexCount());
-
-				// If our data is indexed, we use the index buffer to add our triangles
-				if (indexBuff != nullptr) {
-					// Allocate and read space for the indices
-					uint8_t* indexStore = reinterpret_cast<uint8_t*>(malloc(indexBuff->GetTotalSize()));
-					glGetNamedBufferSubData(indexBuff->GetHandle(), 0, indexBuff->GetTotalSize(), indexStore);
-
-					// Iterate over index triangles
-					for (size_t ix = 0; ix < indexBuff->GetElementCount(); ix+=3) {
-						// Extract index from the raw data
-						int i1 = getBufferIndex(indexBuff, indexStore, static_cast<int>(ix));
-						int i2 = getBufferIndex(indexBuff, indexStore, static_cast<int>(ix + 1));
-						int i3 = getBufferIndex(indexBuff, indexStore, static_cast<int>(ix + 2));
-
-						// Find the positions for the indices
-						glm::vec3 p1 = *reinterpret_cast<glm::vec3*>(vertexStore + (posAttrib.Stride * i1) + posAttrib.Offset);
-						glm::vec3 p2 = *reinterpret_cast<glm::vec3*>(vertexStore + (posAttrib.Stride * i2) + posAttrib.Offset);
-						glm::vec3 p3 = *reinterpret_cast<glm::vec3*>(vertexStore + (posAttrib.Stride * i3) + posAttrib.Offset);
-
-						// Add the triangle
-						_triMesh->addTriangle(ToBt(p1), ToBt(p2), ToBt(p3));
-					}
-			
-					// Free the data we copied the indices into
-					free(indexStore);
 
-				}
-				// We only have vertex data, create triangles sequentially
-				else {
-					// Iterate over triangles, and add each to the mesh
-					for (size_t ix = 0; ix < vertexBuff->GetElementCount(); ix+=3) {
-						glm::vec3 p1 = *reinterpret_cast<glm::vec3*>(vertexStore + ((ix + 0) * posAttrib.Stride) + posAttrib.Offset);
-						glm::vec3 p2 = *reinterpret_cast<glm::vec3*>(vertexStore + ((ix + 1) * posAttrib.Stride) + posAttrib.Offset);
-						glm::vec3 p3 = *reinterpret_cast<glm::vec3*>(vertexStore + ((ix + 2) * posAttrib.Stride) + posAttrib.Offset);
-						_triMesh->addTriangle(ToBt(p1), ToBt(p2), ToBt(p3));
-					}
-				}
-
-				// free our vertex store data
-				free(vertexStore);
-
-				// Store the bullet tri mesh in the MeshResource in case we want it later
-				mesh->BulletTriMesh = std::shared_ptr<btTriangleMesh>(_triMesh);
+			// Save the hulls so we don't need to cook them next time
+			if (!cachePath.empty() && std::filesystem::exists(mesh->Filename)) {
+				CollisionCooker::SaveToFile(*result, cachePath);
 			}
 		}
+
+		// Store the hulls in the MeshResource so other colliders can share them
+		mesh->CollisionHulls = result;
+		return result;
 	}
 
 	void ConvexMeshCollider::FromJson(const nlohmann::json& data) {
+		_settings.MaxHulls = JsonGet(data, "max_hulls", _settings.MaxHulls);
+		_settings.MaxHullVertices = JsonGet(data, "max_hull_vertices", _settings.MaxHullVertices);
+		_settings.MaxConcavity = JsonGet(data, "max_concavity", _settings.MaxConcavity);
 	}
 
 	void ConvexMeshCollider::ToJson(nlohmann::json& blob) const {
+		blob["max_hulls"] = _settings.MaxHulls;
+		blob["max_hull_vertices"] = _settings.MaxHullVertices;
+		blob["max_concavity"] = _settings.MaxConcavity;
 	}
 
 	void ConvexMeshCollider::DrawImGui() {
+		CollisionCookSettings settings = _settings;
+		bool changed = false;
+		changed |= LABEL_LEFT(ImGui::DragScalar, "Max Hulls   ", ImGuiDataType_U32, &settings.MaxHulls, 0.1f);
+		changed |= LABEL_LEFT(ImGui::DragScalar, "Max Vertices", ImGuiDataType_U32, &settings.MaxHullVertices, 0.1f);
+		changed |= LABEL_LEFT(ImGui::DragFloat, "Concavity   ", &settings.MaxConcavity, 0.001f, 0.0f, 1.0f);
+		if (changed) {
+			settings.MaxHulls = glm::max(settings.MaxHulls, 1u);
+			settings.MaxHullVertices = glm::max(settings.MaxHullVertices, 4u);
+			SetCookSettings(settings);
+		}
 	}
 }
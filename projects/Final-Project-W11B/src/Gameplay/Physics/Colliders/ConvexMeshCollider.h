@@ -1,10 +1,17 @@
 #pragma once
 
 #include "Gameplay/Physics/ICollider.h"
+#include "Utils/CollisionCooker.h"
+
+namespace Gameplay {
+	class MeshResource;
+}
 
 namespace Gameplay::Physics {
 	/// <summary>
-	/// A complex collider type that allows us to construct collision hulls from arbitrary convex meshes
+	/// A complex collider type that allows us to construct collision hulls from arbitrary meshes. The mesh is
+	/// wrapped in one or more simplified convex hulls, which are cooked once and shared by every collider
+	/// that uses the same mesh resource
 	/// </summary>
 	class ConvexMeshCollider final : public ICollider {
 	public:
@@ -12,6 +19,17 @@ namespace Gameplay::Physics {
 		static ConvexMeshCollider::Sptr Create();
 		virtual ~ConvexMeshCollider();
 
+		/// <summary>
+		/// Gets the settings that this collider's hulls are cooked with
+		/// </summary>
+		const CollisionCookSettings& GetCookSettings() const;
+		/// <summary>
+		/// Updates the settings to cook this collider's hulls with, re-cooking them if
+		/// the collider has already been awoken
+		/// </summary>
+		/// <param name="value">The new settings for the collider</param>
+		void SetCookSettings(const CollisionCookSettings& value);
+
 		// Inherited from ICollider
 		virtual void Awake(GameObject* context) override;
 		virtual void DrawImGui() override;
@@ -19,9 +37,23 @@ namespace Gameplay::Physics {
 		virtual void FromJson(const nlohmann::json& data) override;
 
 	protected:
-		btTriangleMesh* _triMesh;
+		CollisionCookSettings               _settings;
+		std::weak_ptr<MeshResource>         _mesh;
+		CookedCollisionShape::Sptr          _cooked;
+
 		ConvexMeshCollider();
 
+		/// <summary>
+		/// Updates our hulls to match our settings, marking the collider dirty if they were replaced
+		/// </summary>
+		void _CookHulls();
+		/// <summary>
+		/// Gets the hulls for our mesh, from the mesh resource if another collider has
+		/// already cooked them, otherwise from the cache file or by cooking them
+		/// </summary>
+		CookedCollisionShape::Sptr _LoadHulls(const std::shared_ptr<MeshResource>& mesh) const;
+
 		virtual btCollisionShape* CreateShape() const override;
+		virtual void WriteShapeKey(CollisionShapeKey& key) const override;
 	};
-}
\ No newline at end of file
+}
@@ -33,6 +33,10 @@ namespace Gameplay::Physics {
 		return new btCylinderShapeZ(ToBt(_extents));
 	}
 
+	void CylinderCollider::WriteShapeKey(CollisionShapeKey& key) const {
+		key.Add(_extents);
+	}
+
 	CylinderCollider* CylinderCollider::SetHalfExtents(const glm::vec3 & value) {
 		_extents = value;
 		_isDirty = true;
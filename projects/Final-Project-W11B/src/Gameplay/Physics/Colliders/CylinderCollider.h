@@ -22,6 +22,7 @@ namespace Gameplay::Physics {
 
 	protected:
 		virtual btCollisionShape* CreateShape() const override;
+		virtual void WriteShapeKey(CollisionShapeKey& key) const override;
 
 	private:
 		glm::vec3 _extents;
@@ -31,6 +31,10 @@ namespace Gameplay::Physics {
 		return new btStaticPlaneShape(btVector3(_normal.x, _normal.y, _normal.z), 0.0f);
 	}
 
+	void PlaneCollider::WriteShapeKey(CollisionShapeKey& key) const {
+		key.Add(_normal);
+	}
+
 	const glm::vec3& PlaneCollider::GetNormal() const {
 		return _normal;
 	}
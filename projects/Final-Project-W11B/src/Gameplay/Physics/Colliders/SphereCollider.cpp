@@ -18,6 +18,10 @@ namespace Gameplay::Physics {
 		return new btSphereShape(_radius);
 	}
 
+	void SphereCollider::WriteShapeKey(CollisionShapeKey& key) const {
+		key.Add(_radius);
+	}
+
 	SphereCollider* SphereCollider::SetRadius(float value) {
 		_radius = value;
 		_isDirty = true;
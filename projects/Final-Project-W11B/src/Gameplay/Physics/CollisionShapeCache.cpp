@@ -0,0 +1,134 @@
+#include "Gameplay/Physics/CollisionShapeCache.h"
+
+#include "Logging.h"
+
+namespace Gameplay::Physics {
+	// Compound keys start with this, so they can't collide with the keys of collider shapes, which start with the collider type
+	static const int COMPOUND_KEY_TAG = -1;
+
+	std::unordered_map<std::string, CollisionShapeCache::Entry> CollisionShapeCache::_entries;
+	std::unordered_map<const btCollisionShape*, CollisionShapeCache::Entry*> CollisionShapeCache::_shapeEntries;
+
+	CollisionShapeKey& CollisionShapeKey::Hold(const std::shared_ptr<const void>& data) {
+		_held.push_back(data);
+		return *this;
+	}
+
+	const std::string& CollisionShapeKey::GetData() const {
+		return _data;
+	}
+
+	btCollisionShape* CollisionShapeCache::Acquire(const CollisionShapeKey& key, const ShapeFactory& factory) {
+		auto it = _entries.find(key._data);
+		if (it != _entries.end()) {
+			it->second.RefCount++;
+			return it->second.Shape;
+		}
+
+		btCollisionShape* shape = factory();
+		if (shape == nullptr) {
+			return nullptr;
+		}
+
+		Entry& entry = _entries[key._data];
+		entry.Key      = key._data;
+		entry.Shape    = shape;
+		entry.RefCount = 1;
+		entry.Held     = key._held;
+		_shapeEntries[shape] = &entry;
+		return shape;
+	}
+
+	btCompoundShape* CollisionShapeCache::AcquireCompound(const std::vector<CompoundChild>& children) {
+		// Children are already interned, so their addresses are enough to identify them
+		CollisionShapeKey key;
+		key.Add(COMPOUND_KEY_TAG);
+		for (const CompoundChild& child : children) {
+			const btVector3& origin = child.Transform.getOrigin();
+			btQuaternion rotation = child.Transform.getRotation();
+			btScalar transform[7] = { origin.x(), origin.y(), origin.z(), rotation.x(), rotation.y(), rotation.z(), rotation.w() };
+			key.Add(child.Shape);
+			key.Add(transform);
+		}
+
+		auto it = _entries.find(key._data);
+		if (it != _entries.end()) {
+			// The existing compound already holds references to the children
+			for (const CompoundChild& child : children) {
+				Release(child.Shape);
+			}
+			it->second.RefCount++;
+			return static_cast<btCompoundShape*>(it->second.Shape);
+		}
+
+		btCompoundShape* shape = new btCompoundShape(true, static_cast<int>(children.size()));
+		Entry& entry = _entries[key._data];
+		entry.Key      = key._data;
+		entry.Shape    = shape;
+		entry.RefCount = 1;
+		for (const CompoundChild& child : children) {
+			shape->addChildShape(child.Transform, child.Shape);
+			entry.Children.push_back(child.Shape);
+		}
+		_shapeEntries[shape] = &entry;
+		return shape;
+	}
+
+	btCollisionShape* CollisionShapeCache::AddReference(btCollisionShape* shape) {
+		auto it = _shapeEntries.find(shape);
+		if (it == _shapeEntries.end()) {
+			LOG_WARN("Referencing a collision shape that was not acquired from the shape cache");
+			return shape;
+		}
+		it->second->RefCount++;
+		return shape;
+	}
+
+	void CollisionShapeCache::Release(btCollisionShape* shape) {
+		if (shape == nullptr) {
+			return;
+		}
+
+		auto it = _shapeEntries.find(shape);
+		if (it == _shapeEntries.end()) {
+			LOG_WARN("Releasing a collision shape that was not acquired from the shape cache");
+			return;
+		}
+
+		Entry* entry = it->second;
+		LOG_ASSERT(entry->RefCount > 0, "Collision shape has been released too many times!");
+		if (--entry->RefCount > 0) {
+			return;
+		}
+
+		std::vector<btCollisionShape*> children = std::move(entry->Children);
+		std::string key = entry->Key;
+		_shapeEntries.erase(it);
+		_entries.erase(key);
+
+		// Compounds made by colliders own their children, compounds made by the cache reference cached shapes
+		if (children.empty() && shape->isCompound()) {
+			btCompoundShape* compound = static_cast<btCompoundShape*>(shape);
+			for (int ix = 0; ix < compound->getNumChildShapes(); ix++) {
+				delete compound->getChildShape(ix);
+			}
+		}
+		delete shape;
+
+		for (btCollisionShape* child : children) {
+			Release(child);
+		}
+	}
+
+	size_t CollisionShapeCache::GetShapeCount() {
+		return _entries.size();
+	}
+
+	size_t CollisionShapeCache::GetReferenceCount() {
+		size_t result = 0;
+		for (const auto& [key, entry] : _entries) {
+			result += entry.RefCount;
+		}
+		return result;
+	}
+}
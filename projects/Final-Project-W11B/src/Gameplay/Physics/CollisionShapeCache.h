@@ -0,0 +1,120 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <btBulletCollisionCommon.h>
+
+namespace Gameplay::Physics {
+	/// <summary>
+	/// Describes everything that a collision shape was built from, so that identical shapes can be shared
+	/// </summary>
+	class CollisionShapeKey {
+	public:
+		CollisionShapeKey() = default;
+
+		/// <summary>
+		/// Appends a value to the key, values are compared bit for bit
+		/// </summary>
+		template <typename T>
+		CollisionShapeKey& Add(const T& value) {
+			static_assert(std::is_trivially_copyable<T>::value, "Shape key values must be trivially copyable");
+			_data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+			return *this;
+		}
+
+		/// <summary>
+		/// Keeps data that the shape points into (ex: cooked hulls) alive for as long as the shape is cached
+		/// </summary>
+		CollisionShapeKey& Hold(const std::shared_ptr<const void>& data);
+
+		/// <summary>
+		/// Gets the raw bytes of the key
+		/// </summary>
+		const std::string& GetData() const;
+
+	private:
+		friend class CollisionShapeCache;
+
+		std::string                              _data;
+		std::vector<std::shared_ptr<const void>> _held;
+	};
+
+	/// <summary>
+	/// Interns bullet collision shapes, so that bodies with the same colliders (ex: 1000 crates) share
+	/// one shape instead of each having their own copy. Shapes are reference counted, and deleted when
+	/// the last reference is released.
+	///
+	/// Shared shapes must never be modified after they have been created, so any scaling needs to be
+	/// part of the key rather than being applied with setLocalScaling later
+	/// </summary>
+	class CollisionShapeCache {
+	public:
+		// Creates a new shape allocated with new, compound shapes own their children
+		typedef std::function<btCollisionShape*()> ShapeFactory;
+
+		/// <summary>
+		/// A child of a compound shape, with it's transform relative to the compound
+		/// </summary>
+		struct CompoundChild {
+			btCollisionShape* Shape;
+			btTransform       Transform;
+		};
+
+		/// <summary>
+		/// Gets the shape for a key, creating it if nothing else is using a matching shape
+		/// </summary>
+		/// <param name="key">The key describing the shape</param>
+		/// <param name="factory">Creates the shape if it is not already cached</param>
+		/// <returns>The shape with a new reference added to it, or nullptr if the factory did not create a shape</returns>
+		static btCollisionShape* Acquire(const CollisionShapeKey& key, const ShapeFactory& factory);
+
+		/// <summary>
+		/// Gets a compound shape made from cached shapes. The compound takes over the caller's
+		/// references to the children, which are released once the compound is deleted
+		/// </summary>
+		/// <param name="children">The children of the compound, which must have been acquired from the cache</param>
+		/// <returns>The compound shape with a new reference added to it</returns>
+		static btCompoundShape* AcquireCompound(const std::vector<CompoundChild>& children);
+
+		/// <summary>
+		/// Adds another reference to a shape that was acquired from the cache
+		/// </summary>
+		/// <returns>The shape, for chaining</returns>
+		static btCollisionShape* AddReference(btCollisionShape* shape);
+
+		/// <summary>
+		/// Releases a reference to a shape from the cache, deleting it if nothing is using it anymore
+		/// </summary>
+		/// <param name="shape">The shape to release, may be nullptr</param>
+		static void Release(btCollisionShape* shape);
+
+		/// <summary>
+		/// Gets the number of unique shapes that are currently cached
+		/// </summary>
+		static size_t GetShapeCount();
+		/// <summary>
+		/// Gets the total number of references to all cached shapes
+		/// </summary>
+		static size_t GetReferenceCount();
+
+	protected:
+		CollisionShapeCache() = default;
+		~CollisionShapeCache() = default;
+
+		struct Entry {
+			std::string                              Key;
+			btCollisionShape*                        Shape;
+			uint32_t                                 RefCount;
+			// For compounds that we built, the cached children that we hold references to
+			std::vector<btCollisionShape*>           Children;
+			std::vector<std::shared_ptr<const void>> Held;
+		};
+
+		static std::unordered_map<std::string, Entry>            _entries;
+		static std::unordered_map<const btCollisionShape*, Entry*> _shapeEntries;
+	};
+}
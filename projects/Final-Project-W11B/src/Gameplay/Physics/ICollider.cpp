@@ -21,6 +21,7 @@ namespace Gameplay::Physics {
 	ICollider::ICollider(ColliderType type) :
 		_type(type),
 		_shape(nullptr),
+		_isDirty(true),
 		_position(glm::vec3(0.0f)),
 		_rotation(glm::vec3(0.0f)),
 		_scale(glm::vec3(1.0f)),
@@ -28,10 +29,8 @@ namespace Gameplay::Physics {
 	{ }
 
 	ICollider::~ICollider() {
-		if (_shape != nullptr) {
-			delete _shape;
-			_shape = nullptr;
-		}
+		CollisionShapeCache::Release(_shape);
+		_shape = nullptr;
 	}
 
 	ColliderType ICollider::GetType() const {
@@ -39,9 +38,6 @@ namespace Gameplay::Physics {
 	}
 
 	btCollisionShape* ICollider::GetShape() const {
-		if (_shape == nullptr) {
-			_shape = CreateShape();
-		}
 		return _shape;
 	}
 
@@ -7,6 +7,7 @@
 #include <btBulletCollisionCommon.h>
 
 #include "Utils/GUID.hpp"
+#include "Gameplay/Physics/CollisionShapeCache.h"
 
 /// <summary>
 /// Represents the shape of a collider
@@ -89,7 +90,8 @@ namespace Gameplay::Physics {
 		/// </summary>
 		virtual ColliderType GetType() const;
 		/// <summary>
-		/// Gets this collider's bullet collision shape
+		/// Gets this collider's bullet collision shape, which may be shared with other colliders. This
+		/// will be nullptr until the collider's body has been awoken
 		/// </summary>
 		btCollisionShape* GetShape() const;
 
@@ -144,7 +146,7 @@ namespace Gameplay::Physics {
 	protected:
 		// Stores type 
 		ColliderType _type;
-		// Stores shape, note that mutable lets us modify in const functions
+		// Stores shape, this is a reference into the CollisionShapeCache, note that mutable lets us modify in const functions
 		mutable btCollisionShape* _shape;
 		mutable bool _isDirty;
 
@@ -155,6 +157,12 @@ namespace Gameplay::Physics {
 		/// </summary>
 		/// <returns>A btCollisionShape allocated with new</returns>
 		virtual btCollisionShape* CreateShape() const = 0;
+		/// <summary>
+		/// Writes all of the parameters that CreateShape uses to a key, colliders that
+		/// write the same key will share the same collision shape
+		/// </summary>
+		/// <param name="key">The key to append this collider's parameters to</param>
+		virtual void WriteShapeKey(CollisionShapeKey& key) const = 0;
 
 	private:
 		// Allow RigidBody to access protected and private members
@@ -18,13 +18,13 @@ int PhysicsBase::_editorSelectedColliderType = 0;
 		_isShapeDirty(true),
 		_collisionGroup(0x01),
 		_collisionMask(0xFFFFFFFF),
-		_prevScale(glm::vec3(1.0f))
+		_prevScale(glm::vec3(1.0f)),
+		_awakeScale(glm::vec3(1.0f)),
+		_syncedTransformVersion(0)
 	{ }
 
 	PhysicsBase::~PhysicsBase() {
-		if (_scene != nullptr) {
-			delete _shape;
-		}
+		CollisionShapeCache::Release(_shape);
 	}
 
 	void PhysicsBase::_RenderImGuiBase() {
@@ -150,58 +150,106 @@ int PhysicsBase::_editorSelectedColliderType = 0;
 	void PhysicsBase::RemoveCollider(const ICollider::Sptr& collider) {
 		auto& it = std::find(_colliders.begin(), _colliders.end(), collider);
 		if (it != _colliders.end()) {
-			if (collider->GetShape() != nullptr) {
-				_shape->removeChildShape(collider->GetShape());
-				_isShapeDirty = true;
-			}
 			_colliders.erase(it);
+			_isShapeDirty = true;
 		}
 	}
 
 
-	void PhysicsBase::_AddColliderToShape(ICollider* collider) {
-		// Create the bullet collision shape from the collider
-		btCollisionShape* newShape = collider->CreateShape();
-		collider->_shape = newShape;
+	void PhysicsBase::_AcquireColliderShape(ICollider* collider) {
+		// Shared shapes can't be scaled after the fact, so any scaling since we woke up is baked into the shape
+		glm::vec3 scale = collider->_scale * _GetRelativeScale();
 
-		// If the shape actually exists
-		if (newShape != nullptr) {
-			// We convert our shape parameters to a bullet transform
-			btTransform transform;
-			transform.setIdentity();
-			transform.setOrigin(ToBt(collider->_position));
-			transform.setRotation(ToBt(glm::quat(glm::radians(collider->_rotation))));
-			newShape->setLocalScaling(ToBt(collider->_scale));
-
-			// Add the shape to the compound shape
-			_shape->addChildShape(transform, newShape);
-
-			// Remove any existing collision manifolds, so that our body can properly be updated with it's new shape
-			if (_scene != nullptr) {
-				_scene->GetPhysicsWorld()->getBroadphase()->getOverlappingPairCache()->cleanProxyFromPairs(_GetBroadphaseHandle(), _scene->GetPhysicsWorld()->getDispatcher());
+		// The key is everything that goes into the shape, so identical colliders get the same shape
+		CollisionShapeKey key;
+		key.Add(collider->_type);
+		collider->WriteShapeKey(key);
+		key.Add(scale);
+
+		btCollisionShape* newShape = CollisionShapeCache::Acquire(key, [&]() {
+			btCollisionShape* result = collider->CreateShape();
+			if (result != nullptr) {
+				result->setLocalScaling(ToBt(scale));
 			}
+			return result;
+		});
 
-			// Our inertia has changed, so flag mass as dirty so it's recalculated
-			_isShapeDirty = true;
-		}
+		CollisionShapeCache::Release(collider->_shape);
+		collider->_shape = newShape;
 	}
 
 	bool PhysicsBase::_HandleShapeDirty() {
-		bool wasDirty = false;
+		// If our gameobject has been scaled, all of our colliders need to be re-scaled
+		glm::vec3 scale = GetGameObject()->GetScale();
+		bool scaleChanged = scale != _prevScale;
+		_prevScale = scale;
+
+		bool wasDirty = _isShapeDirty || _shape == nullptr;
 		for (auto& collider : _colliders) {
-			if (collider->_isDirty) {
-				// If the collider already had a shape, delete it
-				if (collider->_shape != nullptr) {
-					_shape->removeChildShape(collider->_shape);
-					delete collider->_shape;
-				}
-				_AddColliderToShape(collider.get());
+			if (collider->_isDirty || scaleChanged) {
+				_AcquireColliderShape(collider.get());
 				collider->_isDirty = false;
 				wasDirty = true;
 			}
 		}
+		if (!wasDirty) {
+			return false;
+		}
+
+		// Build our compound from the cached collider shapes, so bodies with the same colliders share it
+		std::vector<CollisionShapeCache::CompoundChild> children;
+		children.reserve(_colliders.size());
+		for (auto& collider : _colliders) {
+			if (collider->_shape != nullptr) {
+				// We convert our shape parameters to a bullet transform
+				btTransform transform;
+				transform.setIdentity();
+				transform.setOrigin(ToBt(collider->_position * _GetRelativeScale()));
+				transform.setRotation(ToBt(glm::quat(glm::radians(collider->_rotation))));
+
+				// The compound takes it's own reference to the shape, since the collider could be removed first
+				children.push_back({ CollisionShapeCache::AddReference(collider->_shape), transform });
+			}
+		}
+		btCompoundShape* newShape = CollisionShapeCache::AcquireCompound(children);
+		CollisionShapeCache::Release(_shape);
+		_shape = newShape;
+		_isShapeDirty = false;
+
+		// Swap the shape on our bullet object and remove any existing collision manifolds, so that it can properly be updated with it's new shape
+		btCollisionObject* object = _GetCollisionObject();
+		if (object != nullptr) {
+			object->setCollisionShape(_shape);
+			_scene->GetPhysicsWorld()->getBroadphase()->getOverlappingPairCache()->cleanProxyFromPairs(_GetBroadphaseHandle(), _scene->GetPhysicsWorld()->getDispatcher());
+			_scene->GetPhysicsWorld()->updateSingleAabb(object);
+		}
 
-		return wasDirty;
+		return true;
+	}
+
+	glm::vec3 PhysicsBase::_GetRelativeScale() const {
+		// Matches how bullet's compound shapes handle being re-scaled, guarding against a zero scale at wake up
+		glm::vec3 result;
+		for (int ix = 0; ix < 3; ix++) {
+			result[ix] = _awakeScale[ix] != 0.0f ? _prevScale[ix] / _awakeScale[ix] : 1.0f;
+		}
+		return result;
+	}
+
+	bool PhysicsBase::_IsShapeDirty() const {
+		if (_isShapeDirty || _shape == nullptr) {
+			return true;
+		}
+		for (const auto& collider : _colliders) {
+			if (collider->_isDirty) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool PhysicsBase::_HasGameobjectMoved() const {
+		return GetGameObject()->GetTransformVersion() != _syncedTransformVersion;
 	}
 
 	bool PhysicsBase::_HandleGroupDirty() {
@@ -224,11 +272,7 @@ int PhysicsBase::_editorSelectedColliderType = 0;
 		transform.setIdentity();
 		transform.setOrigin(ToBt(context->GetPosition()));	 
 		transform.setRotation(ToBt(context->GetRotation()));
-		if (context->GetScale() != _prevScale) {
-			_shape->setLocalScaling(ToBt(context->GetScale()));
-			_scene->GetPhysicsWorld()->getBroadphase()->getOverlappingPairCache()->cleanProxyFromPairs(_GetBroadphaseHandle(), _scene->GetPhysicsWorld()->getDispatcher());
-			_prevScale = context->GetScale();
-		}
+		_syncedTransformVersion = context->GetTransformVersion();
 	}
 
 	void PhysicsBase::_CopyGameobjectTransformFrom(const btTransform& transform) {
@@ -237,5 +281,7 @@ int PhysicsBase::_editorSelectedColliderType = 0;
 		// Update the pos and rotation params
 		context->SetPostion(ToGlm(transform.getOrigin()));
 		context->SetRotation(ToGlm(transform.getRotation()));
+		// Recalculates the transform now, so that we don't mistake our own change for someone moving the object
+		_syncedTransformVersion = context->GetTransformVersion();
 	}
 }
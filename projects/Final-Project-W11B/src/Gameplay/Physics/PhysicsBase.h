@@ -89,7 +89,8 @@ namespace Gameplay {
 		protected:
 			Scene*        _scene;
 
-			// Stores the bullet shape associated with the physics object
+			// Stores the bullet shape associated with the physics object, this is a reference into the CollisionShapeCache
+			// and may be shared with other bodies that have the same colliders
 			btCompoundShape* _shape;
 
 			// List of colliders and whether they have been changed
@@ -102,6 +103,12 @@ namespace Gameplay {
 			mutable bool _isGroupMaskDirty;
 
 			glm::vec3 _prevScale;
+			// The gameobject's scale when we woke up. Colliders are sized in world units at this scale, and only
+			// scale changes after waking up (relative to this) are applied to them
+			glm::vec3 _awakeScale;
+
+			// The gameobject's transform version when we last copied it's transform to or from Bullet
+			uint32_t _syncedTransformVersion;
 
 			PhysicsBase();
 
@@ -110,20 +117,29 @@ namespace Gameplay {
 			void ToJsonBase(nlohmann::json& output) const;
 			void FromJsonBase(const nlohmann::json& input);
 
-			// Handles adding a collider to our compound shape
-			void _AddColliderToShape(ICollider* collider);
+			// Handles getting a collider's shape from the shape cache at our current scale
+			void _AcquireColliderShape(ICollider* collider);
+			// Gets how much the gameobject has been scaled since we woke up
+			glm::vec3 _GetRelativeScale() const;
 
-			// Handles resolving any dirty state stuff for our object
+			// Handles resolving any dirty state stuff for our object, returns true if our shape was replaced
 			bool _HandleShapeDirty();
 
 			bool _HandleGroupDirty();
 
-			// Copies the gameobject's transform the the bullet transform
+			// Returns true if our shape needs to be rebuilt, because colliders were added, removed or changed
+			bool _IsShapeDirty() const;
+			// Returns true if the gameobject has moved since we last copied it's transform to or from Bullet
+			bool _HasGameobjectMoved() const;
+
+			// Copies the gameobject's transform the the bullet transform, these mark the gameobject as synced
 			void _CopyGameobjectTransformTo(btTransform& transform);
 			void _CopyGameobjectTransformFrom(const btTransform& transform);
 
 			// Gets the bullet broadphase proxy that we can use for clearing collisions
 			virtual btBroadphaseProxy* _GetBroadphaseHandle() = 0;
+			// Gets the bullet object that our shape is attached to, or nullptr if it has not been created yet
+			virtual btCollisionObject* _GetCollisionObject() = 0;
 
 			static int _editorSelectedColliderType;
 		};
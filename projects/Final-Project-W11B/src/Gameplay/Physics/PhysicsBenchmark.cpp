@@ -0,0 +1,125 @@
+#include "Gameplay/Physics/PhysicsBenchmark.h"
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Gameplay/Scene.h"
+#include "Gameplay/Physics/PhysicsTaskScheduler.h"
+#include "Application/Benchmark.h"
+#include "Logging.h"
+
+namespace Gameplay::Physics {
+	nlohmann::json PhysicsBenchmark::Run(uint32_t bodyCount, uint32_t frames) {
+		using Clock = std::chrono::high_resolution_clock;
+		const float timestep = 1.0f / 60.0f;
+
+		bodyCount = std::max(bodyCount, 1u);
+		frames = std::max(frames, 1u);
+
+		struct Configuration {
+			std::string     Name;
+			PhysicsSettings Settings;
+		};
+		std::vector<Configuration> configurations;
+		for (bool multithreaded : { false, true }) {
+			for (BroadphaseType broadphase : { BroadphaseType::Dbvt, BroadphaseType::AxisSweep }) {
+				Configuration config;
+				config.Name = (broadphase == BroadphaseType::Dbvt ? "dbvt" : "sap") + std::string(multithreaded ? "_mt" : "");
+				config.Settings = PhysicsSettings::Default;
+				config.Settings.Broadphase = broadphase;
+				config.Settings.Multithreaded = multithreaded;
+				// Every box plus the ground has to fit in the sweep and prune broadphase
+				config.Settings.MaxProxies = std::max(config.Settings.MaxProxies, bodyCount + 1);
+				configurations.push_back(config);
+			}
+		}
+
+		// The boxes start out in columns roughly 8 boxes high, with a bit of spin so that they don't stack perfectly
+		const float spacing = 1.5f;
+		uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(bodyCount / 8.0f)));
+		btBoxShape boxShape(btVector3(0.5f, 0.5f, 0.5f));
+		btStaticPlaneShape groundShape(btVector3(0.0f, 0.0f, 1.0f), 0.0f);
+		btVector3 boxInertia;
+		boxShape.calculateLocalInertia(1.0f, boxInertia);
+
+		nlohmann::json report = nlohmann::json::array();
+		for (const Configuration& config : configurations) {
+			// We only want the scene's physics world, constructing a scene doesn't need a window
+			Scene::Sptr scene = std::make_shared<Scene>(config.Settings);
+			btDynamicsWorld* world = scene->GetPhysicsWorld();
+
+			std::vector<std::unique_ptr<btDefaultMotionState>> motionStates;
+			std::vector<std::unique_ptr<btRigidBody>> bodies;
+			motionStates.reserve(bodyCount + 1);
+			bodies.reserve(bodyCount + 1);
+			auto addBody = [&](btCollisionShape* shape, float mass, const btVector3& inertia, const btTransform& transform) {
+				motionStates.push_back(std::make_unique<btDefaultMotionState>(transform));
+				bodies.push_back(std::make_unique<btRigidBody>(mass, motionStates.back().get(), shape, inertia));
+				world->addRigidBody(bodies.back().get());
+			};
+
+			addBody(&groundShape, 0.0f, btVector3(0.0f, 0.0f, 0.0f), btTransform::getIdentity());
+
+			// Same seed for every configuration so that they all simulate the same pile
+			std::mt19937 random(1234);
+			std::uniform_real_distribution<float> angle(-0.3f, 0.3f);
+			float offset = (columns - 1) * spacing * 0.5f;
+			for (uint32_t ix = 0; ix < bodyCount; ix++) {
+				uint32_t column = ix % (columns * columns);
+				uint32_t layer = ix / (columns * columns);
+				btTransform transform;
+				transform.setOrigin(btVector3((column % columns) * spacing - offset, (column / columns) * spacing - offset, 1.0f + layer * spacing));
+				transform.setRotation(btQuaternion(angle(random), angle(random), angle(random)));
+				addBody(&boxShape, 1.0f, boxInertia, transform);
+			}
+
+			std::vector<double> stepTimes;
+			stepTimes.reserve(frames);
+			auto start = Clock::now();
+			for (uint32_t frame = 0; frame < frames; frame++) {
+				auto stepStart = Clock::now();
+				world->stepSimulation(timestep, 1, timestep);
+				stepTimes.push_back(std::chrono::duration<double, std::milli>(Clock::now() - stepStart).count());
+			}
+			double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+			// How much of the pile settled tells us whether configurations actually simulated the same thing
+			uint32_t sleeping = 0;
+			for (size_t ix = 1; ix < bodies.size(); ix++) {
+				if (bodies[ix]->getActivationState() == ISLAND_SLEEPING) {
+					sleeping++;
+				}
+			}
+			int manifolds = world->getDispatcher()->getNumManifolds();
+
+			for (auto it = bodies.rbegin(); it != bodies.rend(); it++) {
+				world->removeRigidBody(it->get());
+			}
+			bodies.clear();
+			motionStates.clear();
+			scene = nullptr;
+
+			nlohmann::json stepStats = Benchmark::SummarizeTimes(stepTimes);
+			LOG_INFO("{}: {} bodies, {} steps in {:.1f}ms, {:.3f}ms mean, {:.3f}ms p99, {} asleep",
+				config.Name, bodyCount, frames, totalMs, stepStats["mean"].get<double>(), stepStats["p99"].get<double>(), sleeping);
+
+			report.push_back({
+				{ "name", config.Name },
+				{ "settings", config.Settings.ToJson() },
+				{ "threads", config.Settings.Multithreaded ? PhysicsTaskScheduler::GetThreadLimit() : 1 },
+				{ "bodies", bodyCount },
+				{ "frames", frames },
+				{ "total_ms", totalMs },
+				{ "step_ms", stepStats },
+				{ "sleeping_bodies", sleeping },
+				{ "manifolds", manifolds }
+			});
+		}
+
+		return report;
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include "json.hpp"
+
+namespace Gameplay::Physics {
+	/// <summary>
+	/// Stress tests the physics world configurations by dropping a pile of boxes onto the ground and timing
+	/// every step. Each configuration builds it's world through a scene, so this measures exactly what the
+	/// PhysicsSettings would give a real scene, without needing a window or GL context. Started from the
+	/// command line, ex:
+	///
+	///   --benchmark-physics --bodies 4000 --frames 600 --out physics.json
+	/// </summary>
+	class PhysicsBenchmark {
+	public:
+		/// <summary>
+		/// Runs the benchmark for every configuration
+		/// </summary>
+		/// <param name="bodyCount">The number of boxes to drop</param>
+		/// <param name="frames">The number of fixed 60hz steps to time</param>
+		/// <returns>A JSON array with the settings, step times and final state of each configuration</returns>
+		static nlohmann::json Run(uint32_t bodyCount, uint32_t frames);
+
+	protected:
+		PhysicsBenchmark() = default;
+		~PhysicsBenchmark() = default;
+	};
+}
@@ -0,0 +1,286 @@
+#include "Gameplay/Physics/PhysicsQueries.h"
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <unordered_set>
+#include <utility>
+#include <btBulletCollisionCommon.h>
+#include <BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
+
+#include "Gameplay/GameObject.h"
+#include "Gameplay/Physics/RigidBody.h"
+#include "Utils/GlmBulletConversions.h"
+#include "Utils/ThreadPool.h"
+
+namespace Gameplay::Physics {
+	// Below this many queries, handing them out to the pool costs more than running them
+	static const size_t PARALLEL_THRESHOLD = 32;
+	// The fewest queries we give to any one job
+	static const size_t MIN_QUERIES_PER_JOB = 16;
+
+	// Gets the physics component that owns a bullet object, our bodies store a weak reference to themselves in the user pointer
+	static PhysicsBase* GetOwner(const btCollisionObject* object) {
+		void* userPointer = object->getUserPointer();
+		if (userPointer == nullptr) {
+			return nullptr;
+		}
+		IComponent::Sptr component = reinterpret_cast<std::weak_ptr<IComponent>*>(userPointer)->lock();
+		return dynamic_cast<PhysicsBase*>(component.get());
+	}
+
+	// Handles the parts of our filter that bullet's group and mask checks don't
+	static bool PassesFilter(const btCollisionObject* object, const PhysicsQueryFilter& filter) {
+		if (!filter.IncludeTriggers && object->getInternalType() == btCollisionObject::CO_GHOST_OBJECT) {
+			return false;
+		}
+		if (filter.Ignore != nullptr) {
+			PhysicsBase* owner = GetOwner(object);
+			if (owner != nullptr && owner->GetGameObject() == filter.Ignore) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static void FillHit(const btCollisionObject* object, const btVector3& point, const btVector3& normal, float fraction, float length, PhysicsHit& hit) {
+		PhysicsBase* owner = GetOwner(object);
+		hit.Object   = owner != nullptr ? owner->GetGameObject() : nullptr;
+		hit.Body     = dynamic_cast<RigidBody*>(owner);
+		hit.Point    = ToGlm(point);
+		hit.Normal   = normal.fuzzyZero() ? glm::vec3(0.0f) : ToGlm(normal.normalized());
+		hit.Fraction = fraction;
+		hit.Distance = fraction * length;
+	}
+
+	// Applies a query filter on top of one of bullet's result callbacks
+	template <typename Base>
+	struct Filtered : public Base {
+		const PhysicsQueryFilter* Filter;
+
+		template <typename ... TArgs>
+		Filtered(const PhysicsQueryFilter& filter, TArgs&& ... args) :
+			Base(std::forward<TArgs>(args)...),
+			Filter(&filter)
+		{
+			this->m_collisionFilterGroup = filter.Group;
+			this->m_collisionFilterMask  = filter.Mask;
+		}
+
+		virtual bool needsCollision(btBroadphaseProxy* proxy) const override {
+			return Base::needsCollision(proxy) && PassesFilter(static_cast<const btCollisionObject*>(proxy->m_clientObject), *Filter);
+		}
+	};
+
+	typedef Filtered<btCollisionWorld::ClosestRayResultCallback>    RayCallback;
+	typedef Filtered<btCollisionWorld::AllHitsRayResultCallback>    AllRayCallback;
+	typedef Filtered<btCollisionWorld::ClosestConvexResultCallback> SweepCallback;
+
+	// Collects the first contact with each object that overlaps our query shape
+	struct OverlapCallback : public Filtered<btCollisionWorld::ContactResultCallback> {
+		const btCollisionObject*                     Query;
+		std::vector<PhysicsHit>*                     Results;
+		std::unordered_set<const btCollisionObject*> Found;
+
+		OverlapCallback(const PhysicsQueryFilter& filter, const btCollisionObject* query, std::vector<PhysicsHit>* results) :
+			Filtered(filter),
+			Query(query),
+			Results(results),
+			Found()
+		{ }
+
+		virtual btScalar addSingleResult(btManifoldPoint& point, const btCollisionObjectWrapper* object0, int, int, const btCollisionObjectWrapper* object1, int, int) override {
+			// Bullet may hand us the objects in either order
+			bool isSwapped = object0->getCollisionObject() != Query;
+			const btCollisionObject* other = isSwapped ? object0->getCollisionObject() : object1->getCollisionObject();
+			if (Found.insert(other).second) {
+				PhysicsHit hit;
+				FillHit(other, isSwapped ? point.getPositionWorldOnA() : point.getPositionWorldOnB(), isSwapped ? -point.m_normalWorldOnB : point.m_normalWorldOnB, 0.0f, 0.0f, hit);
+				Results->push_back(hit);
+			}
+			return 0.0f;
+		}
+	};
+
+	static btTransform MakeTransform(const glm::vec3& position, const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f)) {
+		return btTransform(ToBt(rotation), ToBt(position));
+	}
+
+	static bool Sweep(btCollisionWorld* world, const btConvexShape& shape, const glm::vec3& from, const glm::vec3& to, const glm::quat& rotation, PhysicsHit& hit, const PhysicsQueryFilter& filter) {
+		SweepCallback callback(filter, ToBt(from), ToBt(to));
+		world->convexSweepTest(&shape, MakeTransform(from, rotation), MakeTransform(to, rotation), callback, world->getDispatchInfo().m_allowedCcdPenetration);
+		if (callback.hasHit()) {
+			FillHit(callback.m_hitCollisionObject, callback.m_hitPointWorld, callback.m_hitNormalWorld, callback.m_closestHitFraction, glm::distance(from, to), hit);
+			return true;
+		}
+		return false;
+	}
+
+	static void Overlap(btCollisionWorld* world, btCollisionShape& shape, const glm::vec3& center, const glm::quat& rotation, std::vector<PhysicsHit>& results, const PhysicsQueryFilter& filter) {
+		btCollisionObject query;
+		query.setCollisionShape(&shape);
+		query.setWorldTransform(MakeTransform(center, rotation));
+		OverlapCallback callback(filter, &query, &results);
+		world->contactTest(&query, callback);
+	}
+
+	bool PhysicsQueries::Raycast(btCollisionWorld* world, const glm::vec3& from, const glm::vec3& to, PhysicsHit& hit, const PhysicsQueryFilter& filter) {
+		RayCallback callback(filter, ToBt(from), ToBt(to));
+		world->rayTest(ToBt(from), ToBt(to), callback);
+		if (callback.hasHit()) {
+			FillHit(callback.m_collisionObject, callback.m_hitPointWorld, callback.m_hitNormalWorld, callback.m_closestHitFraction, glm::distance(from, to), hit);
+			return true;
+		}
+		return false;
+	}
+
+	void PhysicsQueries::RaycastAll(btCollisionWorld* world, const glm::vec3& from, const glm::vec3& to, std::vector<PhysicsHit>& hits, const PhysicsQueryFilter& filter) {
+		AllRayCallback callback(filter, ToBt(from), ToBt(to));
+		world->rayTest(ToBt(from), ToBt(to), callback);
+
+		float length = glm::distance(from, to);
+		size_t first = hits.size();
+		for (int ix = 0; ix < callback.m_collisionObjects.size(); ix++) {
+			PhysicsHit hit;
+			FillHit(callback.m_collisionObjects[ix], callback.m_hitPointWorld[ix], callback.m_hitNormalWorld[ix], callback.m_hitFractions[ix], length, hit);
+			hits.push_back(hit);
+		}
+		// Bullet reports hits in whatever order it finds them, we want them closest first
+		std::sort(hits.begin() + first, hits.end(), [](const PhysicsHit& a, const PhysicsHit& b) {
+			return a.Fraction < b.Fraction;
+		});
+	}
+
+	bool PhysicsQueries::SphereCast(btCollisionWorld* world, const glm::vec3& from, const glm::vec3& to, float radius, PhysicsHit& hit, const PhysicsQueryFilter& filter) {
+		btSphereShape shape(radius);
+		return Sweep(world, shape, from, to, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), hit, filter);
+	}
+
+	bool PhysicsQueries::BoxCast(btCollisionWorld* world, const glm::vec3& from, const glm::vec3& to, const glm::vec3& halfExtents, const glm::quat& rotation, PhysicsHit& hit, const PhysicsQueryFilter& filter) {
+		btBoxShape shape(ToBt(halfExtents));
+		return Sweep(world, shape, from, to, rotation, hit, filter);
+	}
+
+	void PhysicsQueries::OverlapSphere(btCollisionWorld* world, const glm::vec3& center, float radius, std::vector<PhysicsHit>& results, const PhysicsQueryFilter& filter) {
+		btSphereShape shape(radius);
+		Overlap(world, shape, center, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), results, filter);
+	}
+
+	void PhysicsQueries::OverlapBox(btCollisionWorld* world, const glm::vec3& center, const glm::vec3& halfExtents, const glm::quat& rotation, std::vector<PhysicsHit>& results, const PhysicsQueryFilter& filter) {
+		btBoxShape shape(ToBt(halfExtents));
+		Overlap(world, shape, center, rotation, results, filter);
+	}
+
+	// Runs one query of a batch on the calling thread, through the world's own tests
+	static void RunQuery(btCollisionWorld* world, PhysicsQuery& query) {
+		switch (query.Type) {
+			case PhysicsQueryType::Raycast:
+				query.HasHit = PhysicsQueries::Raycast(world, query.From, query.To, query.Hit, query.Filter);
+				break;
+			case PhysicsQueryType::SphereCast:
+				query.HasHit = PhysicsQueries::SphereCast(world, query.From, query.To, query.Radius, query.Hit, query.Filter);
+				break;
+			case PhysicsQueryType::BoxCast:
+				query.HasHit = PhysicsQueries::BoxCast(world, query.From, query.To, query.HalfExtents, query.Rotation, query.Hit, query.Filter);
+				break;
+			default:
+				query.HasHit = false;
+				break;
+		}
+	}
+
+	// Runs one query of a batch by walking the broadphase's trees directly. Bullet's own ray test shares
+	// a traversal stack between callers, but the tree's static ray test and collideTV use a stack per call,
+	// and the narrowphase tests don't touch any shared state, so these can run on many threads at once
+	static void RunQueryThreadSafe(const btDbvtBroadphase* broadphase, btScalar allowedPenetration, PhysicsQuery& query) {
+		// Calls a function for every object whose broadphase bounds are touched. Process isn't marked as an
+		// override since bullet's trees take the policy as a template instead of a virtual interface on MSVC
+		struct Collector : public btDbvt::ICollide {
+			std::function<void(btCollisionObject*)> Callback;
+			void Process(const btDbvtNode* leaf) {
+				const btDbvtProxy* proxy = static_cast<const btDbvtProxy*>(leaf->data);
+				Callback(static_cast<btCollisionObject*>(proxy->m_clientObject));
+			}
+		} collector;
+
+		float length = glm::distance(query.From, query.To);
+		if (query.Type == PhysicsQueryType::Raycast) {
+			btTransform from = MakeTransform(query.From), to = MakeTransform(query.To);
+			RayCallback callback(query.Filter, from.getOrigin(), to.getOrigin());
+			collector.Callback = [&](btCollisionObject* object) {
+				if (callback.needsCollision(object->getBroadphaseHandle())) {
+					btCollisionWorld::rayTestSingle(from, to, object, object->getCollisionShape(), object->getWorldTransform(), callback);
+				}
+			};
+			// The first set holds the bodies that are moving, the second the ones that have come to rest
+			for (const btDbvt& tree : broadphase->m_sets) {
+				btDbvt::rayTest(tree.m_root, from.getOrigin(), to.getOrigin(), collector);
+			}
+
+			query.HasHit = callback.hasHit();
+			if (query.HasHit) {
+				FillHit(callback.m_collisionObject, callback.m_hitPointWorld, callback.m_hitNormalWorld, callback.m_closestHitFraction, length, query.Hit);
+			}
+		} else {
+			btSphereShape sphere(query.Radius);
+			btBoxShape box(ToBt(query.HalfExtents));
+			const btConvexShape* shape = query.Type == PhysicsQueryType::SphereCast ? static_cast<const btConvexShape*>(&sphere) : &box;
+			glm::quat rotation = query.Type == PhysicsQueryType::SphereCast ? glm::quat(1.0f, 0.0f, 0.0f, 0.0f) : query.Rotation;
+			btTransform from = MakeTransform(query.From, rotation), to = MakeTransform(query.To, rotation);
+
+			// Anything the shape could hit is inside of the bounds of the whole sweep
+			btVector3 fromMin, fromMax, toMin, toMax;
+			shape->getAabb(from, fromMin, fromMax);
+			shape->getAabb(to, toMin, toMax);
+			fromMin.setMin(toMin);
+			fromMax.setMax(toMax);
+			btDbvtVolume bounds = btDbvtVolume::FromMM(fromMin, fromMax);
+
+			SweepCallback callback(query.Filter, from.getOrigin(), to.getOrigin());
+			collector.Callback = [&](btCollisionObject* object) {
+				if (callback.needsCollision(object->getBroadphaseHandle())) {
+					btCollisionWorld::objectQuerySingle(shape, from, to, object, object->getCollisionShape(), object->getWorldTransform(), callback, allowedPenetration);
+				}
+			};
+			for (const btDbvt& tree : broadphase->m_sets) {
+				tree.collideTV(tree.m_root, bounds, collector);
+			}
+
+			query.HasHit = callback.hasHit();
+			if (query.HasHit) {
+				FillHit(callback.m_hitCollisionObject, callback.m_hitPointWorld, callback.m_hitNormalWorld, callback.m_closestHitFraction, length, query.Hit);
+			}
+		}
+	}
+
+	void PhysicsQueries::RunBatch(btCollisionWorld* world, PhysicsQuery* queries, size_t count) {
+		const btDbvtBroadphase* broadphase = dynamic_cast<const btDbvtBroadphase*>(world->getBroadphase());
+		size_t jobCount = std::min<size_t>(std::max(ThreadPool::GetThreadCount(), 1u) + 1, count / MIN_QUERIES_PER_JOB);
+		if (broadphase == nullptr || count < PARALLEL_THRESHOLD || jobCount <= 1) {
+			for (size_t ix = 0; ix < count; ix++) {
+				RunQuery(world, queries[ix]);
+			}
+			return;
+		}
+
+		btScalar allowedPenetration = world->getDispatchInfo().m_allowedCcdPenetration;
+		auto runRange = [=](size_t begin, size_t end) {
+			for (size_t ix = begin; ix < end; ix++) {
+				RunQueryThreadSafe(broadphase, allowedPenetration, queries[ix]);
+			}
+		};
+
+		// The workers take every chunk but the first, which we run while we wait
+		size_t chunkSize = (count + jobCount - 1) / jobCount;
+		std::vector<std::future<void>> jobs;
+		jobs.reserve(jobCount - 1);
+		for (size_t begin = chunkSize; begin < count; begin += chunkSize) {
+			size_t end = std::min(begin + chunkSize, count);
+			jobs.push_back(ThreadPool::Enqueue([=]() { runRange(begin, end); }));
+		}
+		runRange(0, std::min(chunkSize, count));
+		for (auto& job : jobs) {
+			job.wait();
+		}
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <EnumToString.h>
+#include <GLM/glm.hpp>
+#include <GLM/gtc/quaternion.hpp>
+
+class btCollisionWorld;
+
+ENUM(PhysicsQueryType, int,
+	// Casts an infinitely thin ray
+	Raycast    = 0,
+	// Sweeps a sphere along a line
+	SphereCast = 1,
+	// Sweeps an oriented box along a line
+	BoxCast    = 2,
+);
+
+namespace Gameplay {
+	class GameObject;
+
+	namespace Physics {
+		class RigidBody;
+
+		/// <summary>
+		/// Controls which objects a physics query can hit
+		/// </summary>
+		struct PhysicsQueryFilter {
+			// The collision groups that the query belongs to, objects whose collision mask doesn't include any of
+			// these are skipped, exactly like for bodies (see PhysicsBase::SetCollisionGroup)
+			int               Group = 0x01;
+			// The collision groups that the query can hit
+			int               Mask = -1;
+			// If true, trigger volumes can be hit as well as rigid bodies
+			bool              IncludeTriggers = false;
+			// An object to leave out of the results, such as the one doing the query
+			const GameObject* Ignore = nullptr;
+		};
+
+		/// <summary>
+		/// Describes something that a physics query hit
+		/// </summary>
+		struct PhysicsHit {
+			// The object that was hit
+			GameObject* Object = nullptr;
+			// The rigid body that was hit, or nullptr if a trigger volume was hit
+			RigidBody*  Body = nullptr;
+			// The point of contact, in world space
+			glm::vec3   Point = glm::vec3(0.0f);
+			// The surface normal at the point of contact, in world space
+			glm::vec3   Normal = glm::vec3(0.0f);
+			// How far along the ray or sweep the hit is, from 0 to 1
+			float       Fraction = 1.0f;
+			// How far along the ray or sweep the hit is, in world units
+			float       Distance = 0.0f;
+		};
+
+		/// <summary>
+		/// A single query for a batch, see Scene::RunPhysicsQueries
+		/// </summary>
+		struct PhysicsQuery {
+			PhysicsQueryType   Type = PhysicsQueryType::Raycast;
+			// The start and end of the ray or sweep, in world space
+			glm::vec3          From = glm::vec3(0.0f);
+			glm::vec3          To = glm::vec3(0.0f);
+			// The radius of the sphere for sphere casts
+			float              Radius = 0.5f;
+			// The half extents and orientation of the box for box casts
+			glm::vec3          HalfExtents = glm::vec3(0.5f);
+			glm::quat          Rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+			PhysicsQueryFilter Filter;
+
+			// Filled in when the query is run, the closest thing that was hit if HasHit is true
+			bool               HasHit = false;
+			PhysicsHit         Hit;
+		};
+
+		/// <summary>
+		/// Runs ray casts, shape sweeps and overlap tests against a Bullet world. Components should use the
+		/// wrappers on Scene rather than calling these directly.
+		///
+		/// Queries see the world as of the last physics step, so they should not be run while the world is
+		/// being stepped
+		/// </summary>
+		class PhysicsQueries {
+		public:
+			static bool Raycast(btCollisionWorld* world, const glm::vec3& from, const glm::vec3& to, PhysicsHit& hit, const PhysicsQueryFilter& filter);
+			static void RaycastAll(btCollisionWorld* world, const glm::vec3& from, const glm::vec3& to, std::vector<PhysicsHit>& hits, const PhysicsQueryFilter& filter);
+			static bool SphereCast(btCollisionWorld* world, const glm::vec3& from, const glm::vec3& to, float radius, PhysicsHit& hit, const PhysicsQueryFilter& filter);
+			static bool BoxCast(btCollisionWorld* world, const glm::vec3& from, const glm::vec3& to, const glm::vec3& halfExtents, const glm::quat& rotation, PhysicsHit& hit, const PhysicsQueryFilter& filter);
+			static void OverlapSphere(btCollisionWorld* world, const glm::vec3& center, float radius, std::vector<PhysicsHit>& results, const PhysicsQueryFilter& filter);
+			static void OverlapBox(btCollisionWorld* world, const glm::vec3& center, const glm::vec3& halfExtents, const glm::quat& rotation, std::vector<PhysicsHit>& results, const PhysicsQueryFilter& filter);
+
+			/// <summary>
+			/// Runs a batch of ray casts and sweeps, spread across the ThreadPool. Each job walks the DBVT
+			/// broadphase itself, since Bullet's own ray test shares a traversal stack between callers. With
+			/// any other broadphase, or with only a few queries, they are run one after another on this thread
+			/// </summary>
+			static void RunBatch(btCollisionWorld* world, PhysicsQuery* queries, size_t count);
+
+		protected:
+			PhysicsQueries() = default;
+			~PhysicsQueries() = default;
+		};
+	}
+}
@@ -0,0 +1,37 @@
+#include "Gameplay/Physics/PhysicsSettings.h"
+#include "Utils/JsonGlmHelpers.h"
+
+namespace Gameplay::Physics {
+	PhysicsSettings PhysicsSettings::Default = PhysicsSettings();
+
+	nlohmann::json PhysicsSettings::ToJson() const {
+		return {
+			{ "broadphase", ~Broadphase },
+			{ "world_min", WorldMin },
+			{ "world_max", WorldMax },
+			{ "max_proxies", MaxProxies },
+			{ "solver_iterations", SolverIterations },
+			{ "manifold_pool_size", PersistentManifoldPoolSize },
+			{ "algorithm_pool_size", CollisionAlgorithmPoolSize },
+			{ "multithreaded", Multithreaded },
+			{ "thread_count", ThreadCount }
+		};
+	}
+
+	PhysicsSettings PhysicsSettings::FromJson(const nlohmann::json& data, const PhysicsSettings& defaults) {
+		PhysicsSettings result = defaults;
+		if (!data.is_object()) {
+			return result;
+		}
+		result.Broadphase = JsonParseEnum(BroadphaseType, data, "broadphase", defaults.Broadphase);
+		result.WorldMin = JsonGet(data, "world_min", defaults.WorldMin);
+		result.WorldMax = JsonGet(data, "world_max", defaults.WorldMax);
+		result.MaxProxies = JsonGet(data, "max_proxies", defaults.MaxProxies);
+		result.SolverIterations = JsonGet(data, "solver_iterations", defaults.SolverIterations);
+		result.PersistentManifoldPoolSize = JsonGet(data, "manifold_pool_size", defaults.PersistentManifoldPoolSize);
+		result.CollisionAlgorithmPoolSize = JsonGet(data, "algorithm_pool_size", defaults.CollisionAlgorithmPoolSize);
+		result.Multithreaded = JsonGet(data, "multithreaded", defaults.Multithreaded);
+		result.ThreadCount = JsonGet(data, "thread_count", defaults.ThreadCount);
+		return result;
+	}
+}
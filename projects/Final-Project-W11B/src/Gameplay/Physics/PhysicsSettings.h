@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <EnumToString.h>
+#include <GLM/glm.hpp>
+#include "json.hpp"
+
+ENUM(BroadphaseType, int,
+	// Dynamic AABB trees, good for scenes where lots of objects move around or are added and removed
+	Dbvt      = 0,
+	// Sweep and prune within fixed world bounds, good for large scenes that mostly sit still
+	AxisSweep = 1,
+);
+
+namespace Gameplay::Physics {
+	/// <summary>
+	/// Controls how a scene's Bullet world is built. These can be set per scene in the scene's JSON,
+	/// with defaults coming from the "physics" block of the Logic layer's app settings
+	/// </summary>
+	struct PhysicsSettings {
+		// The broadphase that finds which objects' bounds overlap
+		BroadphaseType Broadphase = BroadphaseType::Dbvt;
+		// The bounds of the world for the sweep and prune broadphase, objects outside of these still work but slow the broadphase down
+		glm::vec3      WorldMin = glm::vec3(-1000.0f);
+		glm::vec3      WorldMax = glm::vec3(1000.0f);
+		// The most objects the sweep and prune broadphase can hold, more than 16383 switches to 32 bit handles
+		uint32_t       MaxProxies = 16383;
+		// The number of passes the constraint solver makes each step, more passes make stacks more stable
+		int            SolverIterations = 10;
+		// The number of contact manifolds and collision algorithms Bullet preallocates, anything past these hits the heap
+		int            PersistentManifoldPoolSize = 4096;
+		int            CollisionAlgorithmPoolSize = 4096;
+		// If true, collisions, islands and integration are spread over our ThreadPool (needs Bullet to be built with BT_THREADSAFE)
+		bool           Multithreaded = false;
+		// The number of threads Bullet may use when multithreaded, or 0 to use every ThreadPool worker plus the main thread
+		uint32_t       ThreadCount = 0;
+
+		/// <summary>
+		/// The settings new scenes are created with, loaded from the app settings by the LogicUpdateLayer
+		/// </summary>
+		static PhysicsSettings Default;
+
+		nlohmann::json ToJson() const;
+		/// <summary>
+		/// Loads settings from a JSON blob, any missing values are taken from the given defaults
+		/// </summary>
+		static PhysicsSettings FromJson(const nlohmann::json& data, const PhysicsSettings& defaults = Default);
+	};
+}
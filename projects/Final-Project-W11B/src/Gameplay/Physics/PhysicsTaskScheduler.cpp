@@ -0,0 +1,112 @@
+#include "Gameplay/Physics/PhysicsTaskScheduler.h"
+
+#include <algorithm>
+#include <future>
+#include <vector>
+
+#include "Utils/ThreadPool.h"
+
+namespace Gameplay::Physics {
+	// Set while a worker is running part of a loop, Bullet doesn't nest loops but if it ever did, waiting
+	// on the pool from inside of the pool could deadlock, so nested loops just run in place
+	static thread_local bool isInLoop = false;
+
+	PhysicsTaskScheduler::PhysicsTaskScheduler() :
+		btITaskScheduler("ThreadPool"),
+		_threadLimit(1)
+	{ }
+
+	PhysicsTaskScheduler& PhysicsTaskScheduler::_GetInstance() {
+		static PhysicsTaskScheduler instance;
+		return instance;
+	}
+
+	void PhysicsTaskScheduler::Install(int threadCount) {
+		// The pool is usually started by the application, but benchmarks can get here without it
+		ThreadPool::Init();
+		PhysicsTaskScheduler& instance = _GetInstance();
+		instance.setNumThreads(threadCount > 0 ? threadCount : instance.getMaxNumThreads());
+		if (btGetTaskScheduler() != &instance) {
+			btSetTaskScheduler(&instance);
+		}
+	}
+
+	int PhysicsTaskScheduler::GetThreadLimit() {
+		return _GetInstance()._threadLimit;
+	}
+
+	int PhysicsTaskScheduler::getMaxNumThreads() const {
+		// The pool's workers, plus the thread that is waiting on them
+		return std::min(static_cast<int>(ThreadPool::GetThreadCount()) + 1, static_cast<int>(BT_MAX_THREAD_COUNT));
+	}
+
+	int PhysicsTaskScheduler::getNumThreads() const {
+		// Any worker can pick up a chunk, so Bullet needs storage for all of them regardless of our limit
+		return getMaxNumThreads();
+	}
+
+	void PhysicsTaskScheduler::setNumThreads(int numThreads) {
+		_threadLimit = std::clamp(numThreads, 1, getMaxNumThreads());
+	}
+
+	int PhysicsTaskScheduler::_GetChunkCount(int iBegin, int iEnd, int grainSize) const {
+		if (isInLoop) {
+			return 1;
+		}
+		int count = iEnd - iBegin;
+		int chunks = (count + std::max(grainSize, 1) - 1) / std::max(grainSize, 1);
+		return std::clamp(chunks, 1, _threadLimit);
+	}
+
+	void PhysicsTaskScheduler::parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) {
+		int chunks = _GetChunkCount(iBegin, iEnd, grainSize);
+		if (chunks <= 1) {
+			body.forLoop(iBegin, iEnd);
+			return;
+		}
+
+		int chunkSize = (iEnd - iBegin + chunks - 1) / chunks;
+		std::vector<std::future<void>> jobs;
+		jobs.reserve(chunks - 1);
+		for (int begin = iBegin + chunkSize; begin < iEnd; begin += chunkSize) {
+			int end = std::min(begin + chunkSize, iEnd);
+			jobs.push_back(ThreadPool::Enqueue([&body, begin, end]() {
+				isInLoop = true;
+				body.forLoop(begin, end);
+				isInLoop = false;
+			}));
+		}
+
+		body.forLoop(iBegin, std::min(iBegin + chunkSize, iEnd));
+		for (auto& job : jobs) {
+			job.wait();
+		}
+	}
+
+	btScalar PhysicsTaskScheduler::parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) {
+		int chunks = _GetChunkCount(iBegin, iEnd, grainSize);
+		if (chunks <= 1) {
+			return body.sumLoop(iBegin, iEnd);
+		}
+
+		int chunkSize = (iEnd - iBegin + chunks - 1) / chunks;
+		std::vector<std::future<btScalar>> jobs;
+		jobs.reserve(chunks - 1);
+		for (int begin = iBegin + chunkSize; begin < iEnd; begin += chunkSize) {
+			int end = std::min(begin + chunkSize, iEnd);
+			jobs.push_back(ThreadPool::Enqueue([&body, begin, end]() {
+				isInLoop = true;
+				btScalar result = body.sumLoop(begin, end);
+				isInLoop = false;
+				return result;
+			}));
+		}
+
+		// Sum in chunk order so that results don't depend on which thread finished first
+		btScalar result = body.sumLoop(iBegin, std::min(iBegin + chunkSize, iEnd));
+		for (auto& job : jobs) {
+			result += job.get();
+		}
+		return result;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <LinearMath/btThreads.h>
+
+namespace Gameplay::Physics {
+	/// <summary>
+	/// Runs Bullet's parallel loops on our ThreadPool, so that multithreaded worlds share the same worker
+	/// threads as the rest of our jobs instead of spinning up their own. Each loop is split into one chunk
+	/// per thread, the calling thread runs the first chunk and then waits for the workers to finish the rest.
+	///
+	/// Chunks run on whichever worker is free, and Bullet sizes it's per-thread storage from getNumThreads and
+	/// indexes it with btGetCurrentThreadIndex, so we always report every worker plus the main thread. The
+	/// thread count from the physics settings only limits how many chunks a loop is split into
+	///
+	/// NOTE: Bullet only makes use of this if it's libraries were built with BT_THREADSAFE, otherwise
+	/// multithreaded worlds will run everything on the main thread
+	/// </summary>
+	class PhysicsTaskScheduler final : public btITaskScheduler {
+	public:
+		/// <summary>
+		/// Makes our scheduler Bullet's task scheduler, if it is not already
+		/// </summary>
+		/// <param name="threadCount">The number of threads to split loops over, or 0 to use every worker and the main thread</param>
+		static void Install(int threadCount = 0);
+		/// <summary>
+		/// Gets the number of threads that loops are currently split over
+		/// </summary>
+		static int GetThreadLimit();
+
+		virtual int getMaxNumThreads() const override;
+		virtual int getNumThreads() const override;
+		virtual void setNumThreads(int numThreads) override;
+		virtual void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override;
+		virtual btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override;
+
+	protected:
+		// The most chunks that we will split a loop into
+		int _threadLimit;
+
+		PhysicsTaskScheduler();
+
+		static PhysicsTaskScheduler& _GetInstance();
+
+		// Gets the number of chunks to split a loop into, or 1 if it should just run on this thread
+		int _GetChunkCount(int iBegin, int iEnd, int grainSize) const;
+	};
+}
@@ -154,29 +154,58 @@ namespace Gameplay::Physics {
 		return _type;
 	}
 
+	RigidBody::SyncMotionState::SyncMotionState(RigidBody* body, std::vector<RigidBody*>* movedBodies, const btTransform& transform) :
+		Transform(transform),
+		_body(body),
+		_movedBodies(movedBodies)
+	{ }
+
+	void RigidBody::SyncMotionState::getWorldTransform(btTransform& worldTrans) const {
+		worldTrans = Transform;
+	}
+
+	void RigidBody::SyncMotionState::setWorldTransform(const btTransform& worldTrans) {
+		// Bullet calls this from the main thread when syncing motion states, even for multithreaded worlds
+		Transform = worldTrans;
+		_movedBodies->push_back(_body);
+	}
+
 	void RigidBody::PhysicsPreStep(float dt) {
+		// Most bodies are asleep or static and nobody has touched them, so we want to skip them as quickly as we can
+		bool moved = _HasGameobjectMoved();
+		if (!moved && !_IsStateDirty()) {
+			return;
+		}
+
 		// Update any dirty state that may have changed
 		_HandleStateDirty();
 
-		if (_type != RigidBodyType::Static) {		
+		if (moved) {
 			btTransform transform;
 			_CopyGameobjectTransformTo(transform);
 
-			// Copy to body and to it's motion state
-			if (_type == RigidBodyType::Dynamic) {
-				_body->setWorldTransform(transform);
-			} else {
-				// Kinematics prefer to be driven my motion state for some reason :|
-				_body->getMotionState()->setWorldTransform(transform); 
+			// Statics are placed when they wake up, and are never moved after that
+			if (_type != RigidBodyType::Static) {
+				// Kinematics are driven by their motion state, dynamics need the body's transforms set directly so
+				// that Bullet doesn't interpolate from where they used to be
+				_motionState->Transform = transform;
+				if (_type == RigidBodyType::Dynamic) {
+					_body->setWorldTransform(transform);
+					_body->setInterpolationWorldTransform(transform);
+				}
+
+				// Sleeping bodies won't notice that they've been moved unless we wake them up
+				_body->activate();
+				_scene->GetPhysicsWorld()->updateSingleAabb(_body);
 			}
 		}
 	}
 
 	void RigidBody::PhysicsPostStep(float dt) {
-		// Kinematics are driven externally and statics don't move, so only need to get data out for dynamics!
-		if (_type == RigidBodyType::Dynamic && _body->isActive()) {
-			btTransform transform = _body->getWorldTransform();
-			_CopyGameobjectTransformFrom(transform);
+		// The scene only calls this for bodies whose motion states Bullet updated this step, which is only ever
+		// done for active dynamic bodies. Kinematics are driven externally and statics don't move
+		if (_type == RigidBodyType::Dynamic) {
+			_CopyGameobjectTransformFrom(_motionState->Transform);
 
 			// Store a copy of our velocities
 			_linearVelocity = _body->getLinearVelocity();
@@ -187,7 +216,8 @@ namespace Gameplay::Physics {
 	void RigidBody::Awake() {
 		GameObject* context = GetGameObject();
 		_scene = context->GetScene();
-		_prevScale = context->GetScale();
+		_prevScale  = context->GetScale();
+		_awakeScale = _prevScale;
 
 		// Awake all our colliders to let them do initialization
 		// that requires the gameobject
@@ -195,27 +225,17 @@ namespace Gameplay::Physics {
 			collider->Awake(context);
 		}
 
-		// Create our compound shape and add all colliders
-		_shape = new btCompoundShape(true, _colliders.size());
-		_shape->setLocalScaling(ToBt(context->GetScale()));
-		for (auto& collider : _colliders) {
-			_AddColliderToShape(collider.get());
-		}
-		_isShapeDirty = false;
+		// Get our compound shape with all colliders from the shape cache
+		_HandleShapeDirty();
 
 		// Update inertia
 		_shape->calculateLocalInertia(_mass, _inertia);
 		_isMassDirty = false;
 
-		// Create a default motion state instance for tracking the bodies motion
-		_motionState = new btDefaultMotionState();
-
-		// Get the object's starting transform, create a bullet representation for it
+		// Get the object's starting transform, and a motion state for tracking the bodies motion
 		btTransform transform; 
-		transform.setIdentity();
-		transform.setOrigin(ToBt(context->GetPosition()));
-		transform.setRotation(ToBt(context->GetRotation()));
-		_motionState->setWorldTransform(transform);
+		_CopyGameobjectTransformTo(transform);
+		_motionState = new SyncMotionState(this, &_scene->_movedBodies, transform);
 
 		// Create the bullet rigidbody and add it to the physics scene
 		_body = new btRigidBody(_mass, _motionState, _shape, _inertia);
@@ -292,6 +312,11 @@ namespace Gameplay::Physics {
 		return result;
 	}
 
+	bool RigidBody::_IsStateDirty() const {
+		return _isMassDirty || _isDampingDirty || _linearVelocityDirty || _angularVelocityDirty || _angularFactorDirty ||
+			_isGroupMaskDirty || _IsShapeDirty();
+	}
+
 	void RigidBody::_HandleStateDirty() {
 		// Only dynamic bodies have velocities
 		if (_type == RigidBodyType::Dynamic) {
@@ -342,5 +367,9 @@ namespace Gameplay::Physics {
 		return _body != nullptr ? _body->getBroadphaseProxy() : nullptr;
 	}
 
+	btCollisionObject* RigidBody::_GetCollisionObject() {
+		return _body;
+	}
+
 }
 
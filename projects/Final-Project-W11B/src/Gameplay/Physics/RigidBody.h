@@ -187,9 +187,31 @@ namespace Gameplay::Physics {
 		float _linearDamping;
 		mutable bool _isDampingDirty;
 
+		/// <summary>
+		/// Holds the body's transform for Bullet. Bullet only hands transforms to the motion states of
+		/// active dynamic bodies, so we use that to queue up just the bodies that moved for PhysicsPostStep
+		/// </summary>
+		class SyncMotionState : public btMotionState {
+		public:
+			BT_DECLARE_ALIGNED_ALLOCATOR();
+
+			// The last transform we got from or gave to Bullet
+			btTransform Transform;
+
+			SyncMotionState(RigidBody* body, std::vector<RigidBody*>* movedBodies, const btTransform& transform);
+
+			virtual void getWorldTransform(btTransform& worldTrans) const override;
+			virtual void setWorldTransform(const btTransform& worldTrans) override;
+
+		private:
+			RigidBody* _body;
+			// The scene's list of bodies to copy transforms out of after the step
+			std::vector<RigidBody*>* _movedBodies;
+		};
+
 		// Our bullet state stuff
 		btRigidBody*     _body;
-		btMotionState*   _motionState;
+		SyncMotionState* _motionState;
 		btVector3        _inertia;
 		btVector3        _linearVelocity;
 		bool             _linearVelocityDirty;
@@ -200,7 +222,10 @@ namespace Gameplay::Physics {
 
 		// Handles resolving any dirty state stuff for our object
 		void _HandleStateDirty();
+		// Returns true if any of our state has changed and needs to be sent to Bullet
+		bool _IsStateDirty() const;
 
 		virtual btBroadphaseProxy* _GetBroadphaseHandle() override;
+		virtual btCollisionObject* _GetCollisionObject() override;
 	};
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <BulletCollision/CollisionDispatch/btGhostObject.h>
 
 #include "Utils/GlmBulletConversions.h"
+#include "Utils/FrameMemory.h"
 
 #include "Gameplay/GameObject.h"
 #include "Gameplay/Scene.h"
@@ -25,20 +26,25 @@ namespace Gameplay::Physics {
 
 	void TriggerVolume::PhysicsPreStep(float dt) {
 		// Update any dirty state that may have changed
-		_HandleShapeDirty();
+		bool moved = _HasGameobjectMoved();
+		if (moved || _IsShapeDirty()) {
+			_HandleShapeDirty();
+		}
 		_HandleGroupDirty();
 
-		// Copy our transform info from OpenGL
-		GameObject* context = GetGameObject();
-		btTransform transform;
-		_CopyGameobjectTransformTo(transform);
+		// Copy our transform info from OpenGL, only if the object has actually moved
+		if (moved) {
+			btTransform transform;
+			_CopyGameobjectTransformTo(transform);
 
-		_ghost->setWorldTransform(transform);
+			_ghost->setWorldTransform(transform);
+			_scene->GetPhysicsWorld()->updateSingleAabb(_ghost);
+		}
 	}
 
 	void TriggerVolume::PhysicsPostStep(float dt) {
-		// This will store all the objects inside the trigger this frame
-		std::vector<std::weak_ptr<RigidBody>> thisFrameCollision;
+		// This will store all the objects inside the trigger this frame, it's scratch memory so we grab it from the frame allocator
+		std::pmr::vector<std::weak_ptr<RigidBody>> thisFrameCollision(&FrameMemory::Frame());
 
 		// Get all our collisions from from the world
 		_scene->GetPhysicsWorld()->getDispatcher()->dispatchAllCollisionPairs(_ghost->getOverlappingPairCache(), _scene->GetPhysicsWorld()->getDispatchInfo(), _scene->GetPhysicsWorld()->getDispatcher());
@@ -134,14 +140,15 @@ namespace Gameplay::Physics {
 			}
 		}
 
-		// Load the contents of the current collision items into the cache
-		_currentCollisions.swap(thisFrameCollision);
+		// Load the contents of the current collision items into the cache, re-using it's storage
+		_currentCollisions.assign(thisFrameCollision.begin(), thisFrameCollision.end());
 	}
 
 	void TriggerVolume::Awake() {
 		GameObject* context = GetGameObject();
 		_scene = GetGameObject()->GetScene();
-		_prevScale = context->GetScale();
+		_prevScale  = context->GetScale();
+		_awakeScale = _prevScale;
 
 		// Awake all our colliders to let them do initialization
 		// that requires the gameobject
@@ -149,12 +156,8 @@ namespace Gameplay::Physics {
 			collider->Awake(context);
 		}
 
-		// Create our compound shape and add all colliders
-		_shape = new btCompoundShape(true, _colliders.size());
-		_shape->setLocalScaling(ToBt(context->GetScale()));
-		for (auto& collider : _colliders) {
-			_AddColliderToShape(collider.get());
-		}
+		// Get our compound shape with all colliders from the shape cache
+		_HandleShapeDirty();
 
 		// Create the ghost object
 		_ghost = new btPairCachingGhostObject();
@@ -195,6 +198,10 @@ namespace Gameplay::Physics {
 		return _ghost != nullptr ? _ghost->getBroadphaseHandle() : nullptr;
 	}
 
+	btCollisionObject* TriggerVolume::_GetCollisionObject() {
+		return _ghost;
+	}
+
 	void TriggerVolume::SetFlags(TriggerTypeFlags flags) {
 		_typeFlags = flags;
 	}
@@ -57,6 +57,7 @@ namespace Gameplay::Physics {
 		std::vector<std::weak_ptr<RigidBody>> _currentCollisions;
 
 		virtual btBroadphaseProxy* _GetBroadphaseHandle() override;
+		virtual btCollisionObject* _GetCollisionObject() override;
 
 	};
 }
\ No newline at end of file
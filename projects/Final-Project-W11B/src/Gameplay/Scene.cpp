@@ -3,22 +3,37 @@
 #include <GLFW/glfw3.h>
 #include <locale>
 #include <codecvt>
+#include <filesystem>
+#include <functional>
 
 #include "Utils/FileHelpers.h"
 #include "Utils/GlmBulletConversions.h"
+#include "Utils/GltfLoader.h"
 
 #include "Gameplay/Physics/RigidBody.h"
 #include "Gameplay/Physics/TriggerVolume.h"
+#include "Gameplay/Physics/PhysicsTaskScheduler.h"
+#include "BulletCollision/BroadphaseCollision/btAxisSweep3.h"
+#include "BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
+#include "BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
 #include "Gameplay/MeshResource.h"
 #include "Gameplay/Material.h"
+#include "Gameplay/Components/RenderComponent.h"
 
 #include "Graphics/DebugDraw.h"
 #include "Graphics/Textures/TextureCube.h"
 #include "Graphics/VertexArrayObject.h"
 #include "Application/Application.h"
+#include "Application/Profiler.h"
 
 namespace Gameplay {
 	Scene::Scene() :
+		Scene(Physics::PhysicsSettings::Default)
+	{ }
+
+	Scene::Scene(const Physics::PhysicsSettings& physicsSettings) :
+		_physicsArena(16 * 1024),
 		_objects(std::vector<GameObject::Sptr>()),
 		_deletionQueue(std::vector<std::weak_ptr<GameObject>>()),
 		IsPlaying(false),
@@ -32,7 +47,8 @@ namespace Gameplay {
 		_skyboxTexture(nullptr),
 		_skyboxRotation(glm::mat3(1.0f)),
 		_ambientLight(glm::vec3(0.1f)),
-		_gravity(glm::vec3(0.0f, 0.0f, -9.81f))
+		_gravity(glm::vec3(0.0f, 0.0f, -9.81f)),
+		_physicsSettings(physicsSettings)
 	{
 		GameObject::Sptr mainCam = CreateGameObject("Main Camera");		
 		MainCamera = mainCam->Add<Camera>();
@@ -95,7 +111,7 @@ namespace Gameplay {
 
 	GameObject::Sptr Scene::CreateGameObject(const std::string& name)
 	{
-		GameObject::Sptr result(new GameObject());
+		GameObject::Sptr result = GameObject::_Allocate();
 		result->Name = name;
 		result->_scene = this;
 		result->_selfRef = result;
@@ -103,6 +119,56 @@ namespace Gameplay {
 		return result;
 	}
 
+	GameObject::Sptr Scene::ImportGltf(const std::string& filename, const std::shared_ptr<Material>& material) {
+		GltfModel model;
+		if (!GltfLoader::LoadModel(filename, model)) {
+			return nullptr;
+		}
+
+		// Every mesh becomes a resource, which remembers where it came from so that it can be reloaded with the scene
+		std::vector<MeshResource::Sptr> meshes(model.Meshes.size());
+		for (int ix = 0; ix < model.Meshes.size(); ix++) {
+			if (model.Meshes[ix] != nullptr) {
+				meshes[ix] = ResourceManager::CreateAsset<MeshResource>();
+				meshes[ix]->Filename = filename;
+				meshes[ix]->MeshIndex = ix;
+				meshes[ix]->Mesh = model.Meshes[ix];
+			}
+		}
+
+		GameObject::Sptr root = CreateGameObject(std::filesystem::path(filename).stem().string());
+		root->SetRotation(glm::angleAxis(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f)));
+
+		// Nodes may only have one parent, but we don't want a broken file that loops back on itself to hang us
+		std::vector<bool> visited(model.Nodes.size(), false);
+		std::function<void(int, const GameObject::Sptr&)> addNode = [&](int nodeIx, const GameObject::Sptr& parent) {
+			if (visited[nodeIx]) {
+				return;
+			}
+			visited[nodeIx] = true;
+
+			const GltfNode& node = model.Nodes[nodeIx];
+			GameObject::Sptr object = CreateGameObject(node.Name.empty() ? "Node " + std::to_string(nodeIx) : node.Name);
+			object->SetPostion(node.Position);
+			object->SetRotation(node.Rotation);
+			object->SetScale(node.Scale);
+			if (node.Mesh >= 0 && meshes[node.Mesh] != nullptr) {
+				object->Add<RenderComponent>()->SetMesh(meshes[node.Mesh])->SetMaterial(material != nullptr ? material : DefaultMaterial);
+			}
+			parent->AddChild(object);
+
+			for (int child : node.Children) {
+				addNode(child, object);
+			}
+		};
+		for (int node : model.RootNodes) {
+			addNode(node, root);
+		}
+
+		LOG_INFO("Imported {} meshes and {} nodes from \"{}\"", meshes.size(), model.Nodes.size(), filename);
+		return root;
+	}
+
 	void Scene::RemoveGameObject(const GameObject::Sptr& object) {
 		_deletionQueue.push_back(object);
 		for (const auto& child : object->_children) {
@@ -153,25 +219,29 @@ namespace Gameplay {
 			obj->Awake();
 		}
 
+		_UpdateSpatialIndex();
+
 		_isAwake = true;
 	}
 
 	void Scene::DoPhysics(float dt) {
-		_components.Each<Gameplay::Physics::RigidBody>([=](const std::shared_ptr<Gameplay::Physics::RigidBody>& body) {
+		_components.Each<Gameplay::Physics::RigidBody>([=](Gameplay::Physics::RigidBody* body) {
 			body->PhysicsPreStep(dt);
 		});
-		_components.Each<Gameplay::Physics::TriggerVolume>([=](const std::shared_ptr<Gameplay::Physics::TriggerVolume>& body) {
+		_components.Each<Gameplay::Physics::TriggerVolume>([=](Gameplay::Physics::TriggerVolume* body) {
 			body->PhysicsPreStep(dt);
 		});
 
 		if (IsPlaying) {
 
+			// Only bodies that were awake get their transforms copied back out, so this scales with how much is moving
+			_movedBodies.clear();
 			_physicsWorld->stepSimulation(dt, 1);
 
-			_components.Each<Gameplay::Physics::RigidBody>([=](const std::shared_ptr<Gameplay::Physics::RigidBody>& body) {
+			for (Gameplay::Physics::RigidBody* body : _movedBodies) {
 				body->PhysicsPostStep(dt);
-			});
-			_components.Each<Gameplay::Physics::TriggerVolume>([=](const std::shared_ptr<Gameplay::Physics::TriggerVolume>& body) {
+			}
+			_components.Each<Gameplay::Physics::TriggerVolume>([=](Gameplay::Physics::TriggerVolume* body) {
 				body->PhysicsPostStep(dt);
 			});
 		}
@@ -192,6 +262,9 @@ namespace Gameplay {
 			}
 		}
 		_FlushDeleteQueue();
+
+		// The editor moves objects while we're not playing, so we keep the index up to date either way
+		_UpdateSpatialIndex();
 	}
 
 	void Scene::RenderGUI()
@@ -208,10 +281,29 @@ namespace Gameplay {
 		return _physicsWorld;
 	}
 
+	void Scene::SetPhysicsSettings(const Physics::PhysicsSettings& settings) {
+		LOG_ASSERT(!_isAwake, "Physics settings must be set before the scene is awoken!");
+		BulletDebugMode debugMode = GetPhysicsDebugDrawMode();
+		_CleanupPhysics();
+		_physicsSettings = settings;
+		_InitPhysics();
+		SetPhysicsDebugDrawMode(debugMode);
+	}
+
+	const Physics::PhysicsSettings& Scene::GetPhysicsSettings() const {
+		return _physicsSettings;
+	}
+
 	Scene::Sptr Scene::FromJson(const nlohmann::json& data)
 	{
 
-		Scene::Sptr result = std::make_shared<Scene>();
+		// Parse the physics settings first, so the world only gets built once
+		Physics::PhysicsSettings physicsSettings = Physics::PhysicsSettings::Default;
+		if (data.contains("physics")) {
+			physicsSettings = Physics::PhysicsSettings::FromJson(data["physics"]);
+		}
+
+		Scene::Sptr result = std::make_shared<Scene>(physicsSettings);
 		result->MainCamera = nullptr;
 		result->_objects.clear();
 		result->DefaultMaterial = ResourceManager::Get<Material>(Guid(data["default_material"]));
@@ -259,6 +351,8 @@ namespace Gameplay {
 
 		blob["ambient"] = GetAmbientLight();
 
+		blob["physics"] = _physicsSettings.ToJson();
+
 		blob["skybox"] = nlohmann::json();
 		blob["skybox"]["mesh"] = _skyboxMesh ? _skyboxMesh->GetGUID().str() : "null";
 		blob["skybox"]["shader"] = _skyboxShader ? _skyboxShader->GetGUID().str() : "null";
@@ -305,32 +399,79 @@ namespace Gameplay {
 	}
 
 	void Scene::_InitPhysics() {
-		_collisionConfig = new btDefaultCollisionConfiguration();
-		_collisionDispatcher = new btCollisionDispatcher(_collisionConfig);
-		_broadphaseInterface = new btDbvtBroadphase();
-		_ghostCallback = new btGhostPairCallback();
+		// The world and it's helpers are all torn down together, so we keep them together in the physics arena
+		const Physics::PhysicsSettings& settings = _physicsSettings;
+
+		btDefaultCollisionConstructionInfo constructionInfo;
+		constructionInfo.m_defaultMaxPersistentManifoldPoolSize = std::max(settings.PersistentManifoldPoolSize, 1);
+		constructionInfo.m_defaultMaxCollisionAlgorithmPoolSize = std::max(settings.CollisionAlgorithmPoolSize, 1);
+		_collisionConfig = _PhysicsNew<btDefaultCollisionConfiguration>(constructionInfo);
+
+		switch (settings.Broadphase) {
+			case BroadphaseType::AxisSweep:
+			{
+				btVector3 worldMin = ToBt(glm::min(settings.WorldMin, settings.WorldMax));
+				btVector3 worldMax = ToBt(glm::max(settings.WorldMin, settings.WorldMax));
+				// 16 bit handles are smaller and faster, but can only address so many objects
+				if (settings.MaxProxies > 16383) {
+					_broadphaseInterface = _PhysicsNew<bt32BitAxisSweep3>(worldMin, worldMax, settings.MaxProxies);
+				} else {
+					_broadphaseInterface = _PhysicsNew<btAxisSweep3>(worldMin, worldMax, static_cast<unsigned short>(std::max(settings.MaxProxies, 2u)));
+				}
+				break;
+			}
+			case BroadphaseType::Dbvt:
+			default:
+				_broadphaseInterface = _PhysicsNew<btDbvtBroadphase>();
+				break;
+		}
+		_ghostCallback = _PhysicsNew<btGhostPairCallback>();
 		_broadphaseInterface->getOverlappingPairCache()->setInternalGhostPairCallback(_ghostCallback);
-		_constraintSolver = new btSequentialImpulseConstraintSolver();
-		_physicsWorld = new btDiscreteDynamicsWorld(
-			_collisionDispatcher,
-			_broadphaseInterface,
-			_constraintSolver,
-			_collisionConfig
-		);
+
+		if (settings.Multithreaded) {
+			// Bullet's parallel loops will run on our ThreadPool, each thread gets a solver from the pool
+			Physics::PhysicsTaskScheduler::Install(static_cast<int>(settings.ThreadCount));
+			_collisionDispatcher = _PhysicsNew<btCollisionDispatcherMt>(_collisionConfig);
+			_solverPool = _PhysicsNew<btConstraintSolverPoolMt>(btGetTaskScheduler()->getNumThreads());
+			_constraintSolver = _PhysicsNew<btSequentialImpulseConstraintSolverMt>();
+			_physicsWorld = _PhysicsNew<btDiscreteDynamicsWorldMt>(
+				_collisionDispatcher,
+				_broadphaseInterface,
+				_solverPool,
+				_constraintSolver,
+				_collisionConfig
+			);
+		} else {
+			_collisionDispatcher = _PhysicsNew<btCollisionDispatcher>(_collisionConfig);
+			_solverPool = nullptr;
+			_constraintSolver = _PhysicsNew<btSequentialImpulseConstraintSolver>();
+			_physicsWorld = _PhysicsNew<btDiscreteDynamicsWorld>(
+				_collisionDispatcher,
+				_broadphaseInterface,
+				_constraintSolver,
+				_collisionConfig
+			);
+		}
+		_physicsWorld->getSolverInfo().m_numIterations = std::max(settings.SolverIterations, 1);
+		// Only update the bounds of awake objects, bodies update their own bounds when they are moved by hand
+		_physicsWorld->setForceUpdateAllAabbs(false);
 		_physicsWorld->setGravity(ToBt(_gravity));
 		// TODO bullet debug drawing
-		_bulletDebugDraw = new BulletDebugDraw();
+		_bulletDebugDraw = _PhysicsNew<BulletDebugDraw>();
 		_physicsWorld->setDebugDrawer(_bulletDebugDraw);
 		_bulletDebugDraw->setDebugMode(btIDebugDraw::DBG_NoDebug);
 	}
 
 	void Scene::_CleanupPhysics() {
-		delete _physicsWorld;
-		delete _constraintSolver;
-		delete _broadphaseInterface;
-		delete _ghostCallback;
-		delete _collisionDispatcher;
-		delete _collisionConfig;
+		_PhysicsDelete(_physicsWorld);
+		_PhysicsDelete(_bulletDebugDraw);
+		_PhysicsDelete(_constraintSolver);
+		_PhysicsDelete(_solverPool);
+		_PhysicsDelete(_broadphaseInterface);
+		_PhysicsDelete(_ghostCallback);
+		_PhysicsDelete(_collisionDispatcher);
+		_PhysicsDelete(_collisionConfig);
+		_physicsArena.Reset();
 	}
 
 
@@ -339,12 +480,114 @@ namespace Gameplay {
 			if (weakPtr.expired()) continue;
 			auto& it = std::find(_objects.begin(), _objects.end(), weakPtr.lock());
 			if (it != _objects.end()) {
+				if ((*it)->_spatialProxy != SpatialIndex::NULL_PROXY) {
+					_spatialIndex.DestroyProxy((*it)->_spatialProxy);
+					(*it)->_spatialProxy = SpatialIndex::NULL_PROXY;
+				}
 				_objects.erase(it);
 			}
 		}
 		_deletionQueue.clear();
 	}
 
+	void Scene::_UpdateSpatialIndex() {
+		PROFILE_SCOPE("Scene::UpdateSpatialIndex");
+
+		const uint32_t renderType = ComponentManager::TypeId<RenderComponent>();
+		for (const auto& object : _objects) {
+			GameObject* obj = object.get();
+
+			// Fetching the transform recalculates it if needed, which bumps the version if it changed
+			const glm::mat4& transform = obj->GetTransform();
+
+			RenderComponent* renderer = static_cast<RenderComponent*>(obj->FindComponent(renderType));
+			VertexArrayObject* mesh = nullptr;
+			if (renderer != nullptr && renderer->GetMeshResource() != nullptr) {
+				mesh = renderer->GetMeshResource()->Mesh.get();
+			}
+
+			// Most objects are static most of the time, so this is the only work we do for them
+			if (obj->_spatialProxy != SpatialIndex::NULL_PROXY &&
+				obj->_spatialVersion == obj->_transformVersion &&
+				obj->_spatialMesh == mesh) {
+				continue;
+			}
+
+			// Use the world space bounds of our mesh if we have one, otherwise treat the object as a point
+			glm::vec3 position = glm::vec3(transform[3]);
+			Aabb bounds = (mesh != nullptr && mesh->HasBounds()) ?
+				Aabb(mesh->GetBoundsMin(), mesh->GetBoundsMax()).Transformed(transform) :
+				Aabb(position, position);
+
+			if (obj->_spatialProxy == SpatialIndex::NULL_PROXY) {
+				obj->_spatialProxy = _spatialIndex.CreateProxy(bounds, obj);
+			} else {
+				_spatialIndex.MoveProxy(obj->_spatialProxy, bounds, position - obj->_spatialPosition);
+			}
+
+			obj->_spatialVersion  = obj->_transformVersion;
+			obj->_spatialMesh     = mesh;
+			obj->_spatialPosition = position;
+		}
+	}
+
+	bool Scene::Raycast(const glm::vec3& from, const glm::vec3& to, Physics::PhysicsHit& hit, const Physics::PhysicsQueryFilter& filter) const {
+		return Physics::PhysicsQueries::Raycast(_physicsWorld, from, to, hit, filter);
+	}
+
+	void Scene::RaycastAll(const glm::vec3& from, const glm::vec3& to, std::vector<Physics::PhysicsHit>& hits, const Physics::PhysicsQueryFilter& filter) const {
+		Physics::PhysicsQueries::RaycastAll(_physicsWorld, from, to, hits, filter);
+	}
+
+	bool Scene::SphereCast(const glm::vec3& from, const glm::vec3& to, float radius, Physics::PhysicsHit& hit, const Physics::PhysicsQueryFilter& filter) const {
+		return Physics::PhysicsQueries::SphereCast(_physicsWorld, from, to, radius, hit, filter);
+	}
+
+	bool Scene::BoxCast(const glm::vec3& from, const glm::vec3& to, const glm::vec3& halfExtents, const glm::quat& rotation, Physics::PhysicsHit& hit, const Physics::PhysicsQueryFilter& filter) const {
+		return Physics::PhysicsQueries::BoxCast(_physicsWorld, from, to, halfExtents, rotation, hit, filter);
+	}
+
+	void Scene::OverlapSphere(const glm::vec3& center, float radius, std::vector<Physics::PhysicsHit>& results, const Physics::PhysicsQueryFilter& filter) const {
+		Physics::PhysicsQueries::OverlapSphere(_physicsWorld, center, radius, results, filter);
+	}
+
+	void Scene::OverlapBox(const glm::vec3& center, const glm::vec3& halfExtents, const glm::quat& rotation, std::vector<Physics::PhysicsHit>& results, const Physics::PhysicsQueryFilter& filter) const {
+		Physics::PhysicsQueries::OverlapBox(_physicsWorld, center, halfExtents, rotation, results, filter);
+	}
+
+	void Scene::RunPhysicsQueries(std::vector<Physics::PhysicsQuery>& queries) const {
+		Physics::PhysicsQueries::RunBatch(_physicsWorld, queries.data(), queries.size());
+	}
+
+	void Scene::FindObjectsInSphere(const glm::vec3& center, float radius, std::vector<GameObject*>& results) const {
+		_spatialIndex.QuerySphere(center, radius, [&](GameObject* object) {
+			results.push_back(object);
+			return true;
+		});
+	}
+
+	void Scene::FindObjectsInBox(const glm::vec3& min, const glm::vec3& max, std::vector<GameObject*>& results) const {
+		_spatialIndex.QueryOverlap(Aabb(min, max), [&](GameObject* object) {
+			results.push_back(object);
+			return true;
+		});
+	}
+
+	void Scene::FindNearestObjects(const glm::vec3& point, size_t count, std::vector<std::pair<GameObject*, float>>& results, float maxDistance, const GameObject* ignore) const {
+		_spatialIndex.QueryNearest(point, count, results, maxDistance, ignore);
+	}
+
+	GameObject* Scene::PickObject(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float* distance) const {
+		SpatialRayHit hit;
+		if (_spatialIndex.Raycast(origin, direction, hit, maxDistance)) {
+			if (distance != nullptr) {
+				*distance = hit.Distance;
+			}
+			return hit.Object;
+		}
+		return nullptr;
+	}
+
 	void Scene::DrawAllGameObjectGUIs()
 	{
 		for (auto& object : _objects) {
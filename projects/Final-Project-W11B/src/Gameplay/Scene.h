@@ -1,14 +1,19 @@
 #pragma once
 #include <btBulletDynamicsCommon.h>
 #include "BulletCollision/CollisionDispatch/btGhostObject.h"
+class btConstraintSolverPoolMt;
 
 #include "Gameplay/Components/Camera.h"
 #include "Gameplay/GameObject.h"
+#include "Gameplay/SpatialIndex.h"
 
 #include "Physics/BulletDebugDraw.h"
+#include "Physics/PhysicsSettings.h"
+#include "Physics/PhysicsQueries.h"
 
 #include "Graphics/Buffers/UniformBuffer.h"
 #include "Graphics/Textures/Texture3D.h"
+#include "Utils/LinearAllocator.h"
 
 struct GLFWwindow;
 
@@ -47,6 +52,10 @@ namespace Gameplay {
 		bool IsDestroyed;
 
 		Scene();
+		/// <summary>
+		/// Creates a scene whose physics world is built with the given settings
+		/// </summary>
+		explicit Scene(const Physics::PhysicsSettings& physicsSettings);
 		~Scene();
 
 		void SetPhysicsDebugDrawMode(BulletDebugMode mode);
@@ -77,6 +86,15 @@ namespace Gameplay {
 		/// <returns>A new gameobject with the given name</returns>
 		GameObject::Sptr CreateGameObject(const std::string& name);
 
+		/// <summary>
+		/// Imports the nodes of a glTF file as a tree of game objects, with a render component on
+		/// every node that has a mesh. glTF is Y-up, so the root object is rotated to match our Z-up world
+		/// </summary>
+		/// <param name="filename">The path to the .gltf or .glb file to import</param>
+		/// <param name="material">The material for the render components, or nullptr to use the scene's default material</param>
+		/// <returns>The root of the new tree, or nullptr if the file could not be loaded</returns>
+		GameObject::Sptr ImportGltf(const std::string& filename, const std::shared_ptr<Material>& material = nullptr);
+
 		/// <summary>
 		/// Queues a game object for deletion at the call of the next Update function
 		/// </summary>
@@ -159,6 +177,14 @@ namespace Gameplay {
 		/// </summary>
 		btDynamicsWorld* GetPhysicsWorld() const;
 
+		/// <summary>
+		/// Rebuilds the scene's physics world with new settings. Bodies are added to the world when they
+		/// wake up, so this can only be done before the scene is awoken
+		/// </summary>
+		/// <param name="settings">The settings to build the world with</param>
+		void SetPhysicsSettings(const Physics::PhysicsSettings& settings);
+		const Physics::PhysicsSettings& GetPhysicsSettings() const;
+
 		/// <summary>
 		/// Loads a scene from a JSON blob
 		/// </summary>
@@ -187,9 +213,114 @@ namespace Gameplay {
 		int NumObjects() const;
 		GameObject::Sptr GetObjectByIndex(int index) const;
 
+		/// <summary>
+		/// Gets the index of object bounds in this scene, which is updated at the end of every Update
+		/// </summary>
+		const SpatialIndex& GetSpatialIndex() const { return _spatialIndex; }
+
+		/// <summary>
+		/// Finds all objects whose bounds overlap a sphere
+		/// </summary>
+		/// <param name="center">The center of the sphere, in world space</param>
+		/// <param name="radius">The radius of the sphere</param>
+		/// <param name="results">Receives the objects that were found, is not cleared first</param>
+		void FindObjectsInSphere(const glm::vec3& center, float radius, std::vector<GameObject*>& results) const;
+		/// <summary>
+		/// Finds all objects whose bounds overlap an axis aligned box
+		/// </summary>
+		/// <param name="min">The minimum corner of the box, in world space</param>
+		/// <param name="max">The maximum corner of the box, in world space</param>
+		/// <param name="results">Receives the objects that were found, is not cleared first</param>
+		void FindObjectsInBox(const glm::vec3& min, const glm::vec3& max, std::vector<GameObject*>& results) const;
+		/// <summary>
+		/// Finds the objects closest to a point, closest first
+		/// </summary>
+		/// <param name="point">The point to search around, in world space</param>
+		/// <param name="count">The maximum number of objects to return</param>
+		/// <param name="results">Receives the objects and their distances</param>
+		/// <param name="maxDistance">Objects further than this are ignored</param>
+		/// <param name="ignore">An object to leave out of the results, such as the one searching</param>
+		void FindNearestObjects(const glm::vec3& point, size_t count, std::vector<std::pair<GameObject*, float>>& results,
+			float maxDistance = std::numeric_limits<float>::max(), const GameObject* ignore = nullptr) const;
+		/// <summary>
+		/// Finds the first object whose bounds are hit by a ray. Note that this tests against the
+		/// object's bounds, not it's triangles
+		/// </summary>
+		/// <param name="origin">The origin of the ray, in world space</param>
+		/// <param name="direction">The direction of the ray</param>
+		/// <param name="maxDistance">The furthest along the ray to search</param>
+		/// <param name="distance">If not null, receives the distance along the ray to the hit</param>
+		/// <returns>The object that was hit, or nullptr</returns>
+		GameObject* PickObject(const glm::vec3& origin, const glm::vec3& direction,
+			float maxDistance = std::numeric_limits<float>::max(), float* distance = nullptr) const;
+
+		/// <summary>
+		/// Casts a ray against the physics world, unlike PickObject this hits the actual colliders
+		/// </summary>
+		/// <param name="from">The start of the ray, in world space</param>
+		/// <param name="to">The end of the ray, in world space</param>
+		/// <param name="hit">Receives the closest hit</param>
+		/// <param name="filter">Controls which objects can be hit</param>
+		/// <returns>True if anything was hit</returns>
+		bool Raycast(const glm::vec3& from, const glm::vec3& to, Physics::PhysicsHit& hit,
+			const Physics::PhysicsQueryFilter& filter = Physics::PhysicsQueryFilter()) const;
+		/// <summary>
+		/// Casts a ray against the physics world, returning everything it passes through
+		/// </summary>
+		/// <param name="hits">Receives the hits closest first, is not cleared first</param>
+		void RaycastAll(const glm::vec3& from, const glm::vec3& to, std::vector<Physics::PhysicsHit>& hits,
+			const Physics::PhysicsQueryFilter& filter = Physics::PhysicsQueryFilter()) const;
+		/// <summary>
+		/// Sweeps a sphere from one point to another, returning the first thing that it would hit
+		/// </summary>
+		/// <param name="radius">The radius of the sphere</param>
+		/// <returns>True if anything was hit</returns>
+		bool SphereCast(const glm::vec3& from, const glm::vec3& to, float radius, Physics::PhysicsHit& hit,
+			const Physics::PhysicsQueryFilter& filter = Physics::PhysicsQueryFilter()) const;
+		/// <summary>
+		/// Sweeps an oriented box from one point to another, returning the first thing that it would hit
+		/// </summary>
+		/// <param name="halfExtents">Half of the size of the box along each axis</param>
+		/// <param name="rotation">The orientation of the box</param>
+		/// <returns>True if anything was hit</returns>
+		bool BoxCast(const glm::vec3& from, const glm::vec3& to, const glm::vec3& halfExtents, const glm::quat& rotation, Physics::PhysicsHit& hit,
+			const Physics::PhysicsQueryFilter& filter = Physics::PhysicsQueryFilter()) const;
+		/// <summary>
+		/// Finds every physics object that overlaps a sphere
+		/// </summary>
+		/// <param name="results">Receives one contact for each object, is not cleared first</param>
+		void OverlapSphere(const glm::vec3& center, float radius, std::vector<Physics::PhysicsHit>& results,
+			const Physics::PhysicsQueryFilter& filter = Physics::PhysicsQueryFilter()) const;
+		/// <summary>
+		/// Finds every physics object that overlaps an oriented box
+		/// </summary>
+		/// <param name="results">Receives one contact for each object, is not cleared first</param>
+		void OverlapBox(const glm::vec3& center, const glm::vec3& halfExtents, const glm::quat& rotation, std::vector<Physics::PhysicsHit>& results,
+			const Physics::PhysicsQueryFilter& filter = Physics::PhysicsQueryFilter()) const;
+		/// <summary>
+		/// Runs a batch of ray casts and sweeps in parallel, for systems that need lots of them every frame (ex: AI
+		/// sight lines). Each query's results are written back into it. Like the other queries this sees the
+		/// world as of the last physics step, and must not be called while physics is being stepped
+		/// </summary>
+		/// <param name="queries">The queries to run</param>
+		void RunPhysicsQueries(std::vector<Physics::PhysicsQuery>& queries) const;
+
+		/// <summary>
+		/// Gets the scene's arena, for memory that should live until the scene is destroyed.
+		/// Nothing allocated from the arena is ever destroyed, so it should only be used for
+		/// trivially destructible data or objects that the owner destroys manually
+		/// </summary>
+		LinearAllocator& GetArena() { return _arena; }
+
 	protected:
 		friend class HierarchyWindow;
 		friend class GameObject;
+		friend class Physics::RigidBody;
+
+		// Memory that lives for as long as the scene, declared first so that it is released last
+		LinearAllocator _arena;
+		// Holds the physics world and it's helpers, reset whenever the world is torn down
+		LinearAllocator _physicsArena;
 
 		// The component manager will store all components for objects in this scene
 		ComponentManager _components;
@@ -204,21 +335,32 @@ namespace Gameplay {
 		btBroadphaseInterface*    _broadphaseInterface;
 		// Resolves contraints (ex: hinge constraints, angle axis, etc...)
 		btConstraintSolver*       _constraintSolver;
+		// When multithreaded, the solvers that islands are handed out to, nullptr otherwise
+		btConstraintSolverPoolMt* _solverPool;
 		// this is what allows us to get our pairs from the trigger volumes
 		btGhostPairCallback*      _ghostCallback;
 
 		BulletDebugDraw* _bulletDebugDraw;
 
+		// The settings that our physics world was built with
+		Physics::PhysicsSettings _physicsSettings;
+
 		// The path that we've saved or loaded this scene from
 		std::string             _filePath;
 
 		// Our physics scene's global gravity, default matches earth's gravity (m/s^2)
 		glm::vec3 _gravity;
 
+		// The bodies that Bullet moved during the last step, filled in by their motion states
+		std::vector<Physics::RigidBody*> _movedBodies;
+
 		// Stores all the objects in our scene
 		std::vector<GameObject::Sptr>  _objects;
 		std::vector<std::weak_ptr<GameObject>>  _deletionQueue;
 
+		// Bounding volume hierarchy of all objects, for spatial queries and picking
+		SpatialIndex _spatialIndex;
+
 		// Info for rendering our skybox will be stored in the scene itself
 		std::shared_ptr<ShaderProgram>       _skyboxShader;
 		std::shared_ptr<MeshResource> _skyboxMesh;
@@ -241,6 +383,24 @@ namespace Gameplay {
 		/// </summary>
 		void _CleanupPhysics();
 
+		// Constructs a physics object in the physics arena
+		template <typename T, typename ... TArgs>
+		T* _PhysicsNew(TArgs&& ... args) {
+			return ::new (_physicsArena.allocate(sizeof(T), alignof(T))) T(std::forward<TArgs>(args)...);
+		}
+		// Destroys an object constructed with _PhysicsNew, the memory is released when the physics arena is reset
+		template <typename T>
+		void _PhysicsDelete(T* object) {
+			if (object != nullptr) {
+				object->~T();
+			}
+		}
+
 		void _FlushDeleteQueue();
+
+		/// <summary>
+		/// Updates the spatial index for any objects that have moved or changed meshes since the last update
+		/// </summary>
+		void _UpdateSpatialIndex();
 	};
 }
\ No newline at end of file
@@ -0,0 +1,376 @@
+#include "Gameplay/SpatialIndex.h"
+
+#include <algorithm>
+
+#include "Logging.h"
+
+namespace Gameplay {
+	Aabb Aabb::Transformed(const glm::mat4& transform) const {
+		// Arvo's method, each axis of the result is the translation plus the min and max
+		// contributions of each column of the rotation/scale part
+		glm::vec3 min = glm::vec3(transform[3]);
+		glm::vec3 max = min;
+		for (int col = 0; col < 3; col++) {
+			glm::vec3 axis = glm::vec3(transform[col]);
+			glm::vec3 a = axis * Min[col];
+			glm::vec3 b = axis * Max[col];
+			min += glm::min(a, b);
+			max += glm::max(a, b);
+		}
+		return Aabb(min, max);
+	}
+
+	SpatialIndex::SpatialIndex(float margin, float displacementScale) :
+		_nodes(),
+		_root(NULL_PROXY),
+		_freeList(NULL_PROXY),
+		_proxyCount(0),
+		_margin(margin),
+		_displacementScale(displacementScale)
+	{ }
+
+	SpatialIndex::~SpatialIndex() = default;
+
+	int SpatialIndex::CreateProxy(const Aabb& bounds, GameObject* object) {
+		int proxy = _AllocateNode();
+		Node& node = _nodes[proxy];
+		node.Tight = bounds;
+		node.Bounds = _Inflate(bounds, glm::vec3(0.0f));
+		node.Object = object;
+		node.Height = 0;
+		_InsertLeaf(proxy);
+		_proxyCount++;
+		return proxy;
+	}
+
+	void SpatialIndex::DestroyProxy(int proxy) {
+		LOG_ASSERT(proxy >= 0 && proxy < (int)_nodes.size() && _nodes[proxy].IsLeaf(), "Invalid spatial proxy");
+		_RemoveLeaf(proxy);
+		_FreeNode(proxy);
+		_proxyCount--;
+	}
+
+	bool SpatialIndex::MoveProxy(int proxy, const Aabb& bounds, const glm::vec3& displacement) {
+		LOG_ASSERT(proxy >= 0 && proxy < (int)_nodes.size() && _nodes[proxy].IsLeaf(), "Invalid spatial proxy");
+		_nodes[proxy].Tight = bounds;
+
+		// Most of the time the object is still inside it's inflated box, and the tree doesn't need to change
+		if (_nodes[proxy].Bounds.Contains(bounds)) {
+			return false;
+		}
+
+		_RemoveLeaf(proxy);
+		_nodes[proxy].Bounds = _Inflate(bounds, displacement);
+		_InsertLeaf(proxy);
+		return true;
+	}
+
+	void SpatialIndex::Clear() {
+		_nodes.clear();
+		_root = NULL_PROXY;
+		_freeList = NULL_PROXY;
+		_proxyCount = 0;
+	}
+
+	void SpatialIndex::QueryNearest(const glm::vec3& point, size_t count, std::vector<std::pair<GameObject*, float>>& results, float maxDistance, const GameObject* ignore) const {
+		results.clear();
+		if (count == 0 || _root == NULL_PROXY) {
+			return;
+		}
+
+		// Results are kept sorted by squared distance while we search, so the worst accepted distance
+		// lets us skip any subtree that can't contain something closer
+		float worstSq = maxDistance < std::numeric_limits<float>::max() ? maxDistance * maxDistance : std::numeric_limits<float>::max();
+
+		TraversalStack stack;
+		stack.Push(_root);
+		while (!stack.Empty()) {
+			const Node& node = _nodes[stack.Pop()];
+			if (node.Bounds.DistanceSquared(point) > worstSq) {
+				continue;
+			}
+
+			if (node.IsLeaf()) {
+				float distSq = node.Tight.DistanceSquared(point);
+				if (node.Object == ignore || distSq > worstSq) {
+					continue;
+				}
+
+				auto it = std::upper_bound(results.begin(), results.end(), distSq, [](float value, const std::pair<GameObject*, float>& item) {
+					return value < item.second;
+				});
+				results.insert(it, std::make_pair(node.Object, distSq));
+				if (results.size() > count) {
+					results.pop_back();
+				}
+				if (results.size() == count) {
+					worstSq = results.back().second;
+				}
+			} else {
+				// Push the further child first, so that we visit the closer one first and tighten our bound sooner
+				float d1 = _nodes[node.Child1].Bounds.DistanceSquared(point);
+				float d2 = _nodes[node.Child2].Bounds.DistanceSquared(point);
+				if (d1 < d2) {
+					stack.Push(node.Child2);
+					stack.Push(node.Child1);
+				} else {
+					stack.Push(node.Child1);
+					stack.Push(node.Child2);
+				}
+			}
+		}
+
+		// We work in squared distances, but report actual distances
+		for (auto& result : results) {
+			result.second = glm::sqrt(result.second);
+		}
+	}
+
+	bool SpatialIndex::Raycast(const glm::vec3& origin, const glm::vec3& direction, SpatialRayHit& hit, float maxDistance, const GameObject* ignore) const {
+		if (_root == NULL_PROXY) {
+			return false;
+		}
+
+		// Dividing by zero gives us infinities, which the slab test handles correctly
+		glm::vec3 invDirection = 1.0f / direction;
+		float best = maxDistance;
+		GameObject* bestObject = nullptr;
+
+		TraversalStack stack;
+		stack.Push(_root);
+		while (!stack.Empty()) {
+			const Node& node = _nodes[stack.Pop()];
+			float distance;
+			if (!node.Bounds.Raycast(origin, invDirection, best, distance)) {
+				continue;
+			}
+
+			if (node.IsLeaf()) {
+				if (node.Object != ignore && node.Tight.Raycast(origin, invDirection, best, distance)) {
+					best = distance;
+					bestObject = node.Object;
+				}
+			} else {
+				// Visit the child the ray enters first, so that the best distance shrinks as soon as possible
+				float d1, d2;
+				bool hit1 = _nodes[node.Child1].Bounds.Raycast(origin, invDirection, best, d1);
+				bool hit2 = _nodes[node.Child2].Bounds.Raycast(origin, invDirection, best, d2);
+				if (hit1 && hit2) {
+					stack.Push(d1 < d2 ? node.Child2 : node.Child1);
+					stack.Push(d1 < d2 ? node.Child1 : node.Child2);
+				} else if (hit1) {
+					stack.Push(node.Child1);
+				} else if (hit2) {
+					stack.Push(node.Child2);
+				}
+			}
+		}
+
+		if (bestObject != nullptr) {
+			hit.Object = bestObject;
+			hit.Distance = best;
+			hit.Point = origin + direction * best;
+			return true;
+		}
+		return false;
+	}
+
+	int SpatialIndex::_AllocateNode() {
+		// Grow the pool if the free list is empty, chaining all the new nodes into the free list
+		if (_freeList == NULL_PROXY) {
+			size_t oldSize = _nodes.size();
+			size_t newSize = std::max<size_t>(oldSize * 2, 16);
+			_nodes.resize(newSize);
+			for (size_t ix = oldSize; ix < newSize; ix++) {
+				_nodes[ix].Parent = ix + 1 < newSize ? (int)ix + 1 : NULL_PROXY;
+				_nodes[ix].Height = -1;
+			}
+			_freeList = (int)oldSize;
+		}
+
+		int result = _freeList;
+		Node& node = _nodes[result];
+		_freeList = node.Parent;
+		node.Parent = NULL_PROXY;
+		node.Child1 = NULL_PROXY;
+		node.Child2 = NULL_PROXY;
+		node.Height = 0;
+		node.Object = nullptr;
+		return result;
+	}
+
+	void SpatialIndex::_FreeNode(int node) {
+		_nodes[node].Parent = _freeList;
+		_nodes[node].Height = -1;
+		_nodes[node].Object = nullptr;
+		_freeList = node;
+	}
+
+	void SpatialIndex::_InsertLeaf(int leaf) {
+		if (_root == NULL_PROXY) {
+			_root = leaf;
+			_nodes[leaf].Parent = NULL_PROXY;
+			return;
+		}
+
+		// Walk down the tree, picking the child that would grow the least (by surface area) if we added the leaf to it
+		Aabb leafBounds = _nodes[leaf].Bounds;
+		int index = _root;
+		while (!_nodes[index].IsLeaf()) {
+			const Node& node = _nodes[index];
+			float area = node.Bounds.SurfaceArea();
+			float combinedArea = Aabb::Union(node.Bounds, leafBounds).SurfaceArea();
+
+			// The cost of making a new parent for this node and the leaf
+			float cost = 2.0f * combinedArea;
+			// The minimum cost of pushing the leaf further down, since every ancestor will grow
+			float inheritanceCost = 2.0f * (combinedArea - area);
+
+			auto descendCost = [&](int child) {
+				const Aabb& childBounds = _nodes[child].Bounds;
+				float unionArea = Aabb::Union(leafBounds, childBounds).SurfaceArea();
+				return (_nodes[child].IsLeaf() ? unionArea : unionArea - childBounds.SurfaceArea()) + inheritanceCost;
+			};
+			float cost1 = descendCost(node.Child1);
+			float cost2 = descendCost(node.Child2);
+
+			if (cost < cost1 && cost < cost2) {
+				break;
+			}
+			index = cost1 < cost2 ? node.Child1 : node.Child2;
+		}
+
+		// Create a new parent for the sibling we found and the leaf
+		int sibling = index;
+		int oldParent = _nodes[sibling].Parent;
+		int newParent = _AllocateNode();
+		_nodes[newParent].Parent = oldParent;
+		_nodes[newParent].Bounds = Aabb::Union(leafBounds, _nodes[sibling].Bounds);
+		_nodes[newParent].Height = _nodes[sibling].Height + 1;
+		_nodes[newParent].Child1 = sibling;
+		_nodes[newParent].Child2 = leaf;
+		_nodes[sibling].Parent = newParent;
+		_nodes[leaf].Parent = newParent;
+
+		if (oldParent != NULL_PROXY) {
+			if (_nodes[oldParent].Child1 == sibling) {
+				_nodes[oldParent].Child1 = newParent;
+			} else {
+				_nodes[oldParent].Child2 = newParent;
+			}
+		} else {
+			_root = newParent;
+		}
+
+		// Fix up the heights and bounds of all the ancestors
+		_Refit(_nodes[leaf].Parent);
+	}
+
+	void SpatialIndex::_RemoveLeaf(int leaf) {
+		if (leaf == _root) {
+			_root = NULL_PROXY;
+			return;
+		}
+
+		// The leaf's sibling takes the place of their parent
+		int parent = _nodes[leaf].Parent;
+		int grandParent = _nodes[parent].Parent;
+		int sibling = _nodes[parent].Child1 == leaf ? _nodes[parent].Child2 : _nodes[parent].Child1;
+
+		if (grandParent != NULL_PROXY) {
+			if (_nodes[grandParent].Child1 == parent) {
+				_nodes[grandParent].Child1 = sibling;
+			} else {
+				_nodes[grandParent].Child2 = sibling;
+			}
+			_nodes[sibling].Parent = grandParent;
+			_FreeNode(parent);
+			_Refit(grandParent);
+		} else {
+			_root = sibling;
+			_nodes[sibling].Parent = NULL_PROXY;
+			_FreeNode(parent);
+		}
+	}
+
+	void SpatialIndex::_Refit(int index) {
+		while (index != NULL_PROXY) {
+			index = _Balance(index);
+
+			Node& node = _nodes[index];
+			node.Height = 1 + std::max(_nodes[node.Child1].Height, _nodes[node.Child2].Height);
+			node.Bounds = Aabb::Union(_nodes[node.Child1].Bounds, _nodes[node.Child2].Bounds);
+
+			index = node.Parent;
+		}
+	}
+
+	int SpatialIndex::_Balance(int iA) {
+		// If A is a leaf or is already balanced there's nothing to do
+		Node& A = _nodes[iA];
+		if (A.IsLeaf() || A.Height < 2) {
+			return iA;
+		}
+
+		int iB = A.Child1;
+		int iC = A.Child2;
+		int balance = _nodes[iC].Height - _nodes[iB].Height;
+
+		// Rotates the taller child (P) up to take A's place. The taller of P's children stays under P,
+		// and the shorter one moves under A in place of P
+		auto rotate = [&](int iP, int iOther) -> int {
+			Node& P = _nodes[iP];
+			int iF = P.Child1;
+			int iG = P.Child2;
+
+			// P takes A's place in the tree
+			P.Child1 = iA;
+			P.Parent = A.Parent;
+			A.Parent = iP;
+			if (P.Parent != NULL_PROXY) {
+				if (_nodes[P.Parent].Child1 == iA) {
+					_nodes[P.Parent].Child1 = iP;
+				} else {
+					_nodes[P.Parent].Child2 = iP;
+				}
+			} else {
+				_root = iP;
+			}
+
+			// Keep the taller grandchild under P, and move the shorter one under A
+			int iKeep = _nodes[iF].Height > _nodes[iG].Height ? iF : iG;
+			int iMove = iKeep == iF ? iG : iF;
+			P.Child2 = iKeep;
+			if (A.Child1 == iP) {
+				A.Child1 = iMove;
+			} else {
+				A.Child2 = iMove;
+			}
+			_nodes[iMove].Parent = iA;
+
+			A.Bounds = Aabb::Union(_nodes[iOther].Bounds, _nodes[iMove].Bounds);
+			A.Height = 1 + std::max(_nodes[iOther].Height, _nodes[iMove].Height);
+			P.Bounds = Aabb::Union(A.Bounds, _nodes[iKeep].Bounds);
+			P.Height = 1 + std::max(A.Height, _nodes[iKeep].Height);
+			return iP;
+		};
+
+		if (balance > 1) {
+			return rotate(iC, iB);
+		}
+		if (balance < -1) {
+			return rotate(iB, iC);
+		}
+		return iA;
+	}
+
+	Aabb SpatialIndex::_Inflate(const Aabb& bounds, const glm::vec3& displacement) const {
+		Aabb result(bounds.Min - glm::vec3(_margin), bounds.Max + glm::vec3(_margin));
+
+		// Stretch the box in the direction the object is moving, so it can keep moving that way for a while
+		glm::vec3 predicted = displacement * _displacementScale;
+		result.Min += glm::min(predicted, glm::vec3(0.0f));
+		result.Max += glm::max(predicted, glm::vec3(0.0f));
+		return result;
+	}
+}
@@ -0,0 +1,289 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <GLM/glm.hpp>
+
+#include "Utils/Macros.h"
+
+namespace Gameplay {
+	class GameObject;
+
+	/// <summary>
+	/// An axis aligned bounding box
+	/// </summary>
+	struct Aabb {
+		glm::vec3 Min;
+		glm::vec3 Max;
+
+		Aabb() : Min(glm::vec3(0.0f)), Max(glm::vec3(0.0f)) { }
+		Aabb(const glm::vec3& min, const glm::vec3& max) : Min(min), Max(max) { }
+
+		glm::vec3 Center() const { return (Min + Max) * 0.5f; }
+		glm::vec3 Extents() const { return (Max - Min) * 0.5f; }
+
+		/// <summary>
+		/// Gets the surface area of the box, which is our cost heuristic when building the tree
+		/// </summary>
+		float SurfaceArea() const {
+			glm::vec3 d = Max - Min;
+			return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+		}
+
+		bool Contains(const Aabb& other) const {
+			return glm::all(glm::lessThanEqual(Min, other.Min)) && glm::all(glm::greaterThanEqual(Max, other.Max));
+		}
+
+		bool Overlaps(const Aabb& other) const {
+			return glm::all(glm::lessThanEqual(Min, other.Max)) && glm::all(glm::greaterThanEqual(Max, other.Min));
+		}
+
+		/// <summary>
+		/// Gets the squared distance from a point to the closest point on the box, 0 if the point is inside
+		/// </summary>
+		float DistanceSquared(const glm::vec3& point) const {
+			glm::vec3 d = glm::max(glm::max(Min - point, point - Max), glm::vec3(0.0f));
+			return glm::dot(d, d);
+		}
+
+		/// <summary>
+		/// Intersects a ray with the box using the slab method
+		/// </summary>
+		/// <param name="origin">The origin of the ray</param>
+		/// <param name="invDirection">The reciprocal of the ray's direction</param>
+		/// <param name="maxDistance">The furthest along the ray to accept a hit</param>
+		/// <param name="distance">Receives the distance along the ray that it enters the box (0 if it starts inside)</param>
+		/// <returns>True if the ray hits the box within maxDistance</returns>
+		bool Raycast(const glm::vec3& origin, const glm::vec3& invDirection, float maxDistance, float& distance) const {
+			glm::vec3 t0 = (Min - origin) * invDirection;
+			glm::vec3 t1 = (Max - origin) * invDirection;
+			glm::vec3 tMin = glm::min(t0, t1);
+			glm::vec3 tMax = glm::max(t0, t1);
+			float enter = glm::max(glm::max(tMin.x, tMin.y), glm::max(tMin.z, 0.0f));
+			float exit = glm::min(glm::min(tMax.x, tMax.y), glm::min(tMax.z, maxDistance));
+			distance = enter;
+			return enter <= exit;
+		}
+
+		/// <summary>
+		/// Transforms the box by a matrix, returning the box that encloses the transformed box
+		/// </summary>
+		Aabb Transformed(const glm::mat4& transform) const;
+
+		static Aabb Union(const Aabb& a, const Aabb& b) {
+			return Aabb(glm::min(a.Min, b.Min), glm::max(a.Max, b.Max));
+		}
+	};
+
+	/// <summary>
+	/// The result of a ray cast against a spatial index
+	/// </summary>
+	struct SpatialRayHit {
+		GameObject* Object   = nullptr;
+		// The distance along the ray to where it entered the object's bounds
+		float       Distance = 0.0f;
+		glm::vec3   Point    = glm::vec3(0.0f);
+	};
+
+	/// <summary>
+	/// A dynamic bounding volume hierarchy of game objects, used to answer overlap, nearest neighbour
+	/// and ray queries without visiting every object in the scene.
+	///
+	/// Each object gets a leaf (a proxy) whose box is inflated by a margin and by how far the object
+	/// moved last update. Moving an object only touches the tree when it leaves it's inflated box, so
+	/// most frames for most moving objects cost a single containment test. Inserts pick a sibling with
+	/// the surface area heuristic, and the tree is kept balanced with AVL style rotations
+	/// </summary>
+	class SpatialIndex {
+	public:
+		NO_COPY(SpatialIndex);
+		NO_MOVE(SpatialIndex);
+
+		static const int NULL_PROXY = -1;
+
+		/// <summary>
+		/// Creates a new empty index
+		/// </summary>
+		/// <param name="margin">How far to inflate each object's box, so that small movements don't need to update the tree</param>
+		/// <param name="displacementScale">How far ahead to predict movement, as a multiple of an object's last displacement</param>
+		SpatialIndex(float margin = 0.1f, float displacementScale = 2.0f);
+		~SpatialIndex();
+
+		/// <summary>
+		/// Adds an object to the index
+		/// </summary>
+		/// <param name="bounds">The world space bounds of the object</param>
+		/// <param name="object">The object that queries will return for this proxy</param>
+		/// <returns>The ID of the object's proxy, used to move and remove it</returns>
+		int CreateProxy(const Aabb& bounds, GameObject* object);
+		/// <summary>
+		/// Removes a proxy from the index
+		/// </summary>
+		void DestroyProxy(int proxy);
+		/// <summary>
+		/// Updates the bounds of a proxy
+		/// </summary>
+		/// <param name="proxy">The proxy to move</param>
+		/// <param name="bounds">The new world space bounds of the object</param>
+		/// <param name="displacement">How far the object moved since it's last update, used to predict future movement</param>
+		/// <returns>True if the proxy had to be re-inserted into the tree</returns>
+		bool MoveProxy(int proxy, const Aabb& bounds, const glm::vec3& displacement);
+
+		/// <summary>
+		/// Removes all proxies from the index
+		/// </summary>
+		void Clear();
+
+		GameObject* GetObject(int proxy) const { return _nodes[proxy].Object; }
+		/// <summary>
+		/// Gets the bounds that were last given for a proxy
+		/// </summary>
+		const Aabb& GetBounds(int proxy) const { return _nodes[proxy].Tight; }
+		/// <summary>
+		/// Gets the inflated bounds of a proxy, as stored in the tree
+		/// </summary>
+		const Aabb& GetFatBounds(int proxy) const { return _nodes[proxy].Bounds; }
+
+		int GetProxyCount() const { return _proxyCount; }
+		/// <summary>
+		/// Gets the height of the tree, for debugging (a balanced tree should be close to 2*log2(proxies))
+		/// </summary>
+		int GetHeight() const { return _root == NULL_PROXY ? 0 : _nodes[_root].Height; }
+
+		/// <summary>
+		/// Invokes a callback for every object whose bounds overlap the given box
+		/// </summary>
+		/// <typeparam name="Func">A callable taking a GameObject*, returning false to stop the query early</typeparam>
+		template <typename Func>
+		void QueryOverlap(const Aabb& bounds, Func&& callback) const {
+			TraversalStack stack;
+			if (_root != NULL_PROXY) {
+				stack.Push(_root);
+			}
+			while (!stack.Empty()) {
+				const Node& node = _nodes[stack.Pop()];
+				if (!node.Bounds.Overlaps(bounds)) {
+					continue;
+				}
+				if (node.IsLeaf()) {
+					if (node.Tight.Overlaps(bounds) && !callback(node.Object)) {
+						return;
+					}
+				} else {
+					stack.Push(node.Child1);
+					stack.Push(node.Child2);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Invokes a callback for every object whose bounds overlap the given sphere
+		/// </summary>
+		/// <typeparam name="Func">A callable taking a GameObject*, returning false to stop the query early</typeparam>
+		template <typename Func>
+		void QuerySphere(const glm::vec3& center, float radius, Func&& callback) const {
+			float radiusSq = radius * radius;
+			TraversalStack stack;
+			if (_root != NULL_PROXY) {
+				stack.Push(_root);
+			}
+			while (!stack.Empty()) {
+				const Node& node = _nodes[stack.Pop()];
+				if (node.Bounds.DistanceSquared(center) > radiusSq) {
+					continue;
+				}
+				if (node.IsLeaf()) {
+					if (node.Tight.DistanceSquared(center) <= radiusSq && !callback(node.Object)) {
+						return;
+					}
+				} else {
+					stack.Push(node.Child1);
+					stack.Push(node.Child2);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Finds the objects whose bounds are closest to a point
+		/// </summary>
+		/// <param name="point">The point to search around</param>
+		/// <param name="count">The maximum number of objects to find</param>
+		/// <param name="results">Receives pairs of objects and their distances, closest first</param>
+		/// <param name="maxDistance">Objects further than this from the point are ignored</param>
+		/// <param name="ignore">An object to leave out of the results (ex: the one doing the searching)</param>
+		void QueryNearest(const glm::vec3& point, size_t count, std::vector<std::pair<GameObject*, float>>& results,
+			float maxDistance = std::numeric_limits<float>::max(), const GameObject* ignore = nullptr) const;
+
+		/// <summary>
+		/// Finds the first object whose bounds are hit by a ray
+		/// </summary>
+		/// <param name="origin">The origin of the ray</param>
+		/// <param name="direction">The direction of the ray, does not need to be normalized (distances are in multiples of it's length)</param>
+		/// <param name="hit">Receives the closest hit</param>
+		/// <param name="maxDistance">The furthest along the ray to search</param>
+		/// <param name="ignore">An object to ignore (ex: the one casting the ray)</param>
+		/// <returns>True if an object was hit</returns>
+		bool Raycast(const glm::vec3& origin, const glm::vec3& direction, SpatialRayHit& hit,
+			float maxDistance = std::numeric_limits<float>::max(), const GameObject* ignore = nullptr) const;
+
+	protected:
+		struct Node {
+			// The inflated bounds for leaves, or the union of both children for branches
+			Aabb        Bounds;
+			// The exact bounds of the object, for leaves
+			Aabb        Tight;
+			GameObject* Object;
+			// Our parent, or the next free node when we're in the free list
+			int         Parent;
+			int         Child1;
+			int         Child2;
+			// The height of the subtree (0 for leaves), or -1 for free nodes
+			int         Height;
+
+			bool IsLeaf() const { return Child1 == NULL_PROXY; }
+		};
+
+		// A stack for walking the tree without allocating in the common case
+		struct TraversalStack {
+			static const int INLINE_SIZE = 128;
+			int              Inline[INLINE_SIZE];
+			std::vector<int> Overflow;
+			int              Count = 0;
+
+			void Push(int value) {
+				if (Count < INLINE_SIZE) {
+					Inline[Count] = value;
+				} else {
+					Overflow.push_back(value);
+				}
+				Count++;
+			}
+			int Pop() {
+				Count--;
+				if (Count >= INLINE_SIZE) {
+					int result = Overflow.back();
+					Overflow.pop_back();
+					return result;
+				}
+				return Inline[Count];
+			}
+			bool Empty() const { return Count == 0; }
+		};
+
+		std::vector<Node> _nodes;
+		int               _root;
+		int               _freeList;
+		int               _proxyCount;
+		float             _margin;
+		float             _displacementScale;
+
+		int _AllocateNode();
+		void _FreeNode(int node);
+		void _InsertLeaf(int leaf);
+		void _RemoveLeaf(int leaf);
+		int _Balance(int node);
+		void _Refit(int node);
+		Aabb _Inflate(const Aabb& bounds, const glm::vec3& displacement) const;
+	};
+}
@@ -0,0 +1,152 @@
+#include "PersistentVertexBuffer.h"
+#include "Logging.h"
+#include <algorithm>
+
+PersistentVertexBuffer::PersistentVertexBuffer(uint32_t elementSize, uint32_t capacity) :
+	VertexBuffer(BufferUsage::DynamicDraw),
+	_mappedData(nullptr),
+	_capacity(capacity),
+	_used(0),
+	_freeRanges(),
+	_retired(),
+	_pending()
+{
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glNamedBufferStorage(_rendererId, (GLsizeiptr)elementSize * capacity, nullptr, flags);
+	_mappedData = static_cast<uint8_t*>(glMapNamedBufferRange(_rendererId, 0, (GLsizeiptr)elementSize * capacity, flags));
+	_elementSize = elementSize;
+	_elementCount = capacity;
+	_size = elementSize * capacity;
+
+	if (_mappedData == nullptr) {
+		LOG_WARN("Failed to map persistent vertex buffer, allocations will fail");
+	} else {
+		_freeRanges.push_back({ 0, capacity });
+	}
+}
+
+PersistentVertexBuffer::~PersistentVertexBuffer() {
+	for (const auto& pending : _pending) {
+		glDeleteSync(pending.Fence);
+	}
+	_pending.clear();
+
+	if (_mappedData != nullptr) {
+		Unmap();
+		_mappedData = nullptr;
+	}
+}
+
+void PersistentVertexBuffer::LoadData(const void* data, uint32_t elementSize, uint32_t elementCount) {
+	LOG_WARN("Persistent vertex buffers cannot be resized, use Allocate instead");
+}
+
+void PersistentVertexBuffer::UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize) {
+	LOG_WARN("Persistent vertex buffers cannot be resized, use Allocate instead");
+}
+
+uint32_t PersistentVertexBuffer::Allocate(uint32_t count) {
+	if (_mappedData == nullptr || count == 0 || count > _capacity) {
+		return INVALID_OFFSET;
+	}
+
+	// Grab any ranges the GPU is already done with before searching
+	_Reclaim(false);
+
+	while (true) {
+		// First fit, our ranges are small and churn rarely so this keeps fragmentation low enough
+		for (auto it = _freeRanges.begin(); it != _freeRanges.end(); it++) {
+			if (it->Count >= count) {
+				uint32_t result = it->Offset;
+				it->Offset += count;
+				it->Count  -= count;
+				if (it->Count == 0) {
+					_freeRanges.erase(it);
+				}
+				_used += count;
+				return result;
+			}
+		}
+
+		// Nothing fits, wait for the GPU to hand back older ranges if there are any
+		if (!_Reclaim(true)) {
+			return INVALID_OFFSET;
+		}
+	}
+}
+
+void PersistentVertexBuffer::Free(uint32_t offset, uint32_t count) {
+	if (offset == INVALID_OFFSET || count == 0) {
+		return;
+	}
+	_retired.push_back({ offset, count });
+}
+
+void PersistentVertexBuffer::Fence() {
+	if (_retired.empty()) {
+		return;
+	}
+
+	PendingFree pending;
+	pending.Fence  = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	pending.Ranges = std::move(_retired);
+	_retired.clear();
+	_pending.push_back(std::move(pending));
+}
+
+bool PersistentVertexBuffer::_Reclaim(bool wait) {
+	// Ranges that were freed but never fenced need a fence before we can wait on them
+	if (wait && _pending.empty()) {
+		Fence();
+	}
+
+	bool result = false;
+	while (!_pending.empty()) {
+		PendingFree& pending = _pending.front();
+
+		GLenum status = glClientWaitSync(pending.Fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? 1000000000 : 0);
+		if (status == GL_TIMEOUT_EXPIRED) {
+			if (!wait) {
+				break;
+			}
+			continue;
+		}
+
+		glDeleteSync(pending.Fence);
+		for (const Range& range : pending.Ranges) {
+			_Release(range);
+		}
+		_pending.pop_front();
+		result = true;
+
+		// Only block for a single fence, the rest will be picked up next time around
+		wait = false;
+	}
+	return result;
+}
+
+void PersistentVertexBuffer::_Release(const Range& range) {
+	_used -= range.Count;
+
+	// Find the first free range after the one being inserted
+	auto it = std::lower_bound(_freeRanges.begin(), _freeRanges.end(), range.Offset, [](const Range& r, uint32_t offset) {
+		return r.Offset < offset;
+	});
+	it = _freeRanges.insert(it, range);
+
+	// Merge with the next range
+	auto next = it + 1;
+	if (next != _freeRanges.end() && it->Offset + it->Count == next->Offset) {
+		it->Count += next->Count;
+		_freeRanges.erase(next);
+	}
+
+	// Merge with the previous range
+	if (it != _freeRanges.begin()) {
+		auto prev = it - 1;
+		if (prev->Offset + prev->Count == it->Offset) {
+			prev->Count += it->Count;
+			_freeRanges.erase(it);
+		}
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "VertexBuffer.h"
+#include <vector>
+#include <deque>
+
+/// <summary>
+/// A vertex buffer with immutable, persistently mapped storage that is split up into ranges
+/// that callers allocate and write to directly. This lets geometry that rarely changes live on
+/// the GPU across frames without being re-uploaded. Freed ranges are only recycled once the GPU
+/// has finished with the commands that may still be reading them
+/// </summary>
+class PersistentVertexBuffer : public VertexBuffer {
+public:
+	MAKE_PTRS(PersistentVertexBuffer);
+
+	static const uint32_t INVALID_OFFSET = 0xFFFFFFFF;
+
+	/// <summary>
+	/// Creates a new persistent vertex buffer
+	/// </summary>
+	/// <param name="elementSize">The size of a single vertex, in bytes</param>
+	/// <param name="capacity">The maximum number of vertices that can be allocated at once</param>
+	PersistentVertexBuffer(uint32_t elementSize, uint32_t capacity);
+	virtual ~PersistentVertexBuffer();
+
+	// The storage for the buffer is immutable, data is written via Allocate and GetElementPtr instead
+	virtual void LoadData(const void* data, uint32_t elementSize, uint32_t elementCount) override;
+	virtual void UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize = true) override;
+
+	/// <summary>
+	/// Allocates a range of vertices from the buffer
+	/// </summary>
+	/// <param name="count">The number of vertices to allocate</param>
+	/// <returns>The index of the first vertex in the range, or INVALID_OFFSET if there is no room</returns>
+	uint32_t Allocate(uint32_t count);
+	/// <summary>
+	/// Returns a range to the buffer. The range will not be handed out again until the GPU has
+	/// consumed all commands issued before the next call to Fence
+	/// </summary>
+	/// <param name="offset">The index of the first vertex, as returned by Allocate</param>
+	/// <param name="count">The number of vertices that were allocated</param>
+	void Free(uint32_t offset, uint32_t count);
+	/// <summary>
+	/// Inserts a fence for any ranges freed since the last call, should be called after the draw
+	/// calls that may read from those ranges have been issued
+	/// </summary>
+	void Fence();
+
+	/// <summary>
+	/// Gets a pointer to the mapped memory for the given vertex
+	/// </summary>
+	/// <param name="offset">The index of the vertex to get the address of</param>
+	void* GetElementPtr(uint32_t offset) const { return _mappedData + (size_t)offset * _elementSize; }
+
+	/// <summary>
+	/// Returns true if the storage was successfully mapped
+	/// </summary>
+	bool IsMapped() const { return _mappedData != nullptr; }
+	/// <summary>
+	/// Gets the maximum number of vertices this buffer can store
+	/// </summary>
+	uint32_t GetCapacity() const { return _capacity; }
+	/// <summary>
+	/// Gets the number of vertices that are currently allocated or waiting to be recycled
+	/// </summary>
+	uint32_t GetUsedCount() const { return _used; }
+
+protected:
+	struct Range {
+		uint32_t Offset;
+		uint32_t Count;
+	};
+
+	// A set of ranges that will be free once the GPU signals the fence
+	struct PendingFree {
+		GLsync             Fence;
+		std::vector<Range> Ranges;
+	};
+
+	uint8_t*                _mappedData;
+	uint32_t                _capacity;
+	uint32_t                _used;
+	std::vector<Range>      _freeRanges; // Sorted by offset
+	std::vector<Range>      _retired;    // Freed, but not fenced yet
+	std::deque<PendingFree> _pending;
+
+	/// <summary>
+	/// Recycles the ranges from any fences the GPU has passed
+	/// </summary>
+	/// <param name="wait">True to block on the oldest fence if it has not been signaled yet</param>
+	/// <returns>True if any ranges were recycled</returns>
+	bool _Reclaim(bool wait);
+	/// <summary>
+	/// Inserts a range into the free list, merging it with it's neighbours
+	/// </summary>
+	void _Release(const Range& range);
+};
@@ -0,0 +1,108 @@
+#include "PixelUploadBuffer.h"
+#include "Logging.h"
+
+PixelUploadBuffer::Sptr PixelUploadBuffer::__shared = nullptr;
+
+PixelUploadBuffer::PixelUploadBuffer(uint32_t sizeInBytes) :
+	IBuffer(BufferType::PixelUnpack, BufferUsage::StreamDraw),
+	_mappedData(nullptr),
+	_head(0),
+	_inFlight()
+{
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glNamedBufferStorage(_rendererId, sizeInBytes, nullptr, flags);
+	_mappedData = static_cast<uint8_t*>(glMapNamedBufferRange(_rendererId, 0, sizeInBytes, flags));
+	_size = sizeInBytes;
+	_elementSize = 1;
+	_elementCount = sizeInBytes;
+
+	if (_mappedData == nullptr) {
+		LOG_WARN("Failed to map pixel upload buffer, texture uploads will not be streamed");
+	}
+}
+
+PixelUploadBuffer::~PixelUploadBuffer() {
+	for (const auto& region : _inFlight) {
+		glDeleteSync(region.Fence);
+	}
+	_inFlight.clear();
+
+	if (_mappedData != nullptr) {
+		Unmap();
+		_mappedData = nullptr;
+	}
+}
+
+void PixelUploadBuffer::LoadData(const void* data, uint32_t elementSize, uint32_t elementCount) {
+	LOG_WARN("Pixel upload buffers cannot be resized, use Upload instead");
+}
+
+void PixelUploadBuffer::UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize) {
+	LOG_WARN("Pixel upload buffers cannot be resized, use Upload instead");
+}
+
+uint8_t* PixelUploadBuffer::_Allocate(size_t size, size_t& offset) {
+	// Keep all our offsets aligned so they're valid for any pixel type
+	size_t alignedSize = (size + 255) & ~(size_t)255;
+	if (_mappedData == nullptr || alignedSize > _size) {
+		return nullptr;
+	}
+
+	// Wrap around if we can't fit at the end of the ring
+	if (_head + alignedSize > _size) {
+		_head = 0;
+	}
+
+	// Wait for the GPU to finish with any regions we're about to overwrite. Since the GPU consumes
+	// regions in order, waiting on the oldest region first is always correct
+	auto overlaps = [&]() {
+		for (const auto& region : _inFlight) {
+			if (region.Offset < _head + alignedSize && _head < region.Offset + region.Size) {
+				return true;
+			}
+		}
+		return false;
+	};
+	while (overlaps()) {
+		_WaitOldest();
+	}
+
+	offset = _head;
+	_head += alignedSize;
+	return _mappedData + offset;
+}
+
+void PixelUploadBuffer::_Fence(size_t offset, size_t size) {
+	InFlightRegion region;
+	region.Fence  = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	region.Offset = offset;
+	region.Size   = (size + 255) & ~(size_t)255;
+	_inFlight.push_back(region);
+}
+
+void PixelUploadBuffer::_WaitOldest() {
+	InFlightRegion region = _inFlight.front();
+	_inFlight.pop_front();
+
+	// Wait in 1 second increments, flushing on the first wait so the fence actually gets submitted
+	GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+	while (true) {
+		GLenum result = glClientWaitSync(region.Fence, flags, 1000000000);
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED) {
+			break;
+		}
+		flags = 0;
+	}
+	glDeleteSync(region.Fence);
+}
+
+PixelUploadBuffer::Sptr PixelUploadBuffer::GetShared() {
+	if (__shared == nullptr) {
+		__shared = std::make_shared<PixelUploadBuffer>();
+	}
+	return __shared;
+}
+
+void PixelUploadBuffer::ReleaseShared() {
+	__shared = nullptr;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "IBuffer.h"
+#include <deque>
+#include <cstring>
+
+/// <summary>
+/// A persistently mapped pixel unpack buffer that is used as a ring buffer for streaming
+/// texture data to the GPU. Data is copied into the ring and the texture upload is sourced
+/// from the buffer, letting the driver DMA the pixels asynchronously instead of blocking
+/// until it has made its own copy. Fences guard regions that the GPU has not consumed yet
+/// </summary>
+class PixelUploadBuffer : public IBuffer {
+public:
+	MAKE_PTRS(PixelUploadBuffer);
+
+	static const uint32_t DEFAULT_SIZE = 32 * 1024 * 1024;
+
+	/// <summary>
+	/// Creates a new upload ring with the given capacity
+	/// </summary>
+	/// <param name="sizeInBytes">The size of the ring in bytes, uploads larger than this will bypass the ring</param>
+	PixelUploadBuffer(uint32_t sizeInBytes = DEFAULT_SIZE);
+	virtual ~PixelUploadBuffer();
+
+	// The storage for the ring is immutable, data is streamed via Upload instead
+	virtual void LoadData(const void* data, uint32_t elementSize, uint32_t elementCount) override;
+	virtual void UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize = true) override;
+
+	/// <summary>
+	/// Copies pixel data into the ring, then invokes the upload function with the buffer bound to
+	/// GL_PIXEL_UNPACK_BUFFER and a pointer that is actually the offset into the buffer. If the data
+	/// cannot be streamed, the upload function is invoked with the original data pointer instead
+	/// </summary>
+	/// <param name="data">The pixel data to upload</param>
+	/// <param name="rowSize">The size of a single row of pixels, in bytes</param>
+	/// <param name="numRows">The number of rows of pixels (including all layers for 3D uploads)</param>
+	/// <param name="upload">The function that performs the glTexture*SubImage call with the given pointer</param>
+	template <typename Func>
+	void Upload(const void* data, size_t rowSize, size_t numRows, Func&& upload) {
+		size_t offset = 0;
+		// Tightly packed rows only line up with the default unpack alignment of 4 if they're a multiple of 4 bytes
+		uint8_t* dest = (rowSize % 4 == 0) ? _Allocate(rowSize * numRows, offset) : nullptr;
+		if (dest == nullptr) {
+			upload(data);
+			return;
+		}
+
+		memcpy(dest, data, rowSize * numRows);
+		Bind();
+		upload(reinterpret_cast<const void*>(offset));
+		IBuffer::UnBind(BufferType::PixelUnpack);
+		_Fence(offset, rowSize * numRows);
+	}
+
+	/// <summary>
+	/// Gets the shared upload ring used by our textures, creating it if required
+	/// Must only be called on the main thread
+	/// </summary>
+	static PixelUploadBuffer::Sptr GetShared();
+	/// <summary>
+	/// Releases the shared upload ring, should be called before the GL context is destroyed
+	/// </summary>
+	static void ReleaseShared();
+
+protected:
+	// Represents a region of the ring that the GPU may still be reading from
+	struct InFlightRegion {
+		GLsync Fence;
+		size_t Offset;
+		size_t Size;
+	};
+
+	uint8_t* _mappedData;
+	size_t   _head;
+	std::deque<InFlightRegion> _inFlight;
+
+	/// <summary>
+	/// Reserves a region of the ring, waiting on the GPU if the region is still in use
+	/// </summary>
+	/// <returns>A pointer to the mapped region, or nullptr if the request is larger than the ring</returns>
+	uint8_t* _Allocate(size_t size, size_t& offset);
+	/// <summary>
+	/// Inserts a fence for a region that has had commands issued that read from it
+	/// </summary>
+	void _Fence(size_t offset, size_t size);
+	/// <summary>
+	/// Blocks until the oldest in flight region has been consumed and releases it
+	/// </summary>
+	void _WaitOldest();
+
+	static PixelUploadBuffer::Sptr __shared;
+};
@@ -12,6 +12,59 @@
 #define OVERSAMPLE_Y 1
 #define PADDING 1
 
+// Settings for signed distance field glyphs, distances of SDF_PADDING pixels map to the full 0-SDF_ON_EDGE range
+#define SDF_PADDING 4
+#define SDF_ON_EDGE 128
+
+/// <summary>
+/// Decodes a UTF-8 string into unicode codepoints, invalid sequences are replaced with U+FFFD
+/// </summary>
+inline void DecodeUtf8(const std::string& text, std::vector<uint32_t>& result) {
+	result.clear();
+	result.reserve(text.size());
+
+	const uint8_t* data = reinterpret_cast<const uint8_t*>(text.data());
+	size_t length = text.size();
+	size_t ix = 0;
+	while (ix < length) {
+		uint8_t lead = data[ix];
+		uint32_t codepoint;
+		size_t extra;
+		if (lead < 0x80)                { codepoint = lead;        extra = 0; }
+		else if ((lead & 0xE0) == 0xC0) { codepoint = lead & 0x1F; extra = 1; }
+		else if ((lead & 0xF0) == 0xE0) { codepoint = lead & 0x0F; extra = 2; }
+		else if ((lead & 0xF8) == 0xF0) { codepoint = lead & 0x07; extra = 3; }
+		else {
+			result.push_back(0xFFFD);
+			ix++;
+			continue;
+		}
+
+		// Sequence was cut off by the end of the string
+		if (ix + extra >= length) {
+			result.push_back(0xFFFD);
+			break;
+		}
+
+		bool valid = true;
+		for (size_t iy = 1; iy <= extra; iy++) {
+			if ((data[ix + iy] & 0xC0) != 0x80) {
+				valid = false;
+				break;
+			}
+			codepoint = (codepoint << 6) | (data[ix + iy] & 0x3F);
+		}
+
+		if (valid) {
+			result.push_back(codepoint);
+			ix += extra + 1;
+		} else {
+			result.push_back(0xFFFD);
+			ix++;
+		}
+	}
+}
+
 Font::Font() : Font("", 0.0f) { }
 
 Font::Font(const std::string& fontPath, float size) :
@@ -28,7 +81,19 @@ Font::Font(const std::string& fontPath, float size) :
 	_fontInfo(stbtt_fontinfo()),
 	_defaultGlyph(GlyphInfo()),
 	_atlasWidth(256),
-	_atlasHeight(256)
+	_atlasHeight(256),
+	_isDynamic(false),
+	_isDistanceField(false),
+	_dynamicGlyphs(),
+	_freeDynamicGlyphs(),
+	_dynamicFlatGlyphs(),
+	_dynamicGlyphMap(),
+	_shelves(),
+	_atlasPixels(),
+	_dirtyMinY(0),
+	_dirtyMaxY(0),
+	_useStamp(0),
+	_atlasRevision(0)
 {
 	// For the box character
 	_glyphRanges.push_back({ 0xE000u, 0xE000u });
@@ -54,6 +119,7 @@ void Font::Load(const std::string& fontPath, float size /*= 16.0f*/)
 	if (!data.empty()) {
 		_fontPath = fontPath;
 		_fontData = data;
+		_fontSize = size;
 
 		if (_glyphs != nullptr) {
 			delete[] _glyphs;
@@ -79,14 +145,64 @@ void Font::Load(const std::string& fontPath, float size /*= 16.0f*/)
 }
 
 void Font::AddGlyphRange(uint32_t min, uint32_t max) {
-	LOG_ASSERT(_atlas == nullptr, "Cannot add glyphs after the font has been baked!");
+	if (_atlas != nullptr && !_isDynamic) {
+		LOG_WARN("Glyph range added after the font has been baked, call Bake again to add the glyphs to the atlas");
+	}
 	_glyphRanges.push_back({ min, max });
 }
 
+void Font::SetDynamic(bool value) {
+	_isDynamic = value;
+	// Distance fields are only supported by the dynamic atlas
+	if (!value) {
+		_isDistanceField = false;
+	}
+}
+
+bool Font::IsDynamic() const {
+	return _isDynamic;
+}
+
+void Font::SetDistanceField(bool value) {
+	_isDistanceField = value;
+	if (value) {
+		_isDynamic = true;
+	}
+}
+
+bool Font::IsDistanceField() const {
+	return _isDistanceField;
+}
+
+void Font::SetAtlasSize(uint32_t width, uint32_t height) {
+	_atlasWidth = width;
+	_atlasHeight = height;
+}
+
+uint32_t Font::GetAtlasRevision() const {
+	return _atlasRevision;
+}
+
 void Font::Bake() {
-	LOG_ASSERT(_atlas == nullptr, "Bake has already been called!");
 	LOG_ASSERT(_fontInfo.data != nullptr, "Have not loaded a font asset!");
 
+	// Baking again throws away the old atlas and glyphs so we can start fresh
+	if (_atlas != nullptr) {
+		delete[] _glyphs;
+		_glyphs = nullptr;
+		_glyphMap.clear();
+		_flatGlyphs.clear();
+		_defaultGlyph = GlyphInfo();
+		_atlas = nullptr;
+	}
+	_atlasRevision++;
+
+	if (_isDynamic) {
+		__InitDynamicAtlas();
+		__BuildKerningTable();
+		return;
+	}
+
 	uint8_t* rawFontData = reinterpret_cast<uint8_t*>(_fontData.data());
 
 	// Collect all codepoint ranges into a set, so we have a list of unique codepoints
@@ -190,24 +306,303 @@ void Font::Bake() {
 	_atlas->LoadData(desc.Width, desc.Height, PixelFormat::Red, PixelType::UByte, atlasData);
 	delete[] atlasData;
 
+	// Glyphs in the flat range are stored in an array for fast lookup, everything else goes in the map
+	_flatGlyphs.assign(FLAT_GLYPH_COUNT, GlyphInfo());
 	uint32_t index = 0;
 	for (uint32_t codepoint : codePoints) {
-		_glyphMap[codepoint] = __CreateGlyph(index);
+		GlyphInfo glyph = __CreateGlyph(index);
 		index++;
 
+		if (codepoint < FLAT_GLYPH_COUNT) {
+			_flatGlyphs[codepoint] = glyph;
+		} else {
+			_glyphMap[codepoint] = glyph;
+		}
+
 		if (codepoint == 0xE000u)
-			_defaultGlyph = _glyphMap[codepoint];
+			_defaultGlyph = glyph;
+	}
+
+	__BuildKerningTable();
+}
+
+void Font::__BuildKerningTable() {
+	_kerningTable.assign(FLAT_GLYPH_COUNT * FLAT_GLYPH_COUNT, 0.0f);
+
+	// Fonts without kerning data don't need any lookups
+	if (_fontInfo.kern == 0 && _fontInfo.gpos == 0) {
+		return;
+	}
+
+	// Resolve glyph indices once, we only care about pairs where both glyphs are in the atlas
+	int glyphIndices[FLAT_GLYPH_COUNT];
+	for (uint32_t ix = 0; ix < FLAT_GLYPH_COUNT; ix++) {
+		glyphIndices[ix] = (_isDynamic || _flatGlyphs[ix].IsPacked) ? stbtt_FindGlyphIndex(&_fontInfo, ix) : 0;
+	}
+
+	for (uint32_t left = 0; left < FLAT_GLYPH_COUNT; left++) {
+		if (glyphIndices[left] == 0) {
+			continue;
+		}
+		for (uint32_t right = 0; right < FLAT_GLYPH_COUNT; right++) {
+			if (glyphIndices[right] == 0) {
+				continue;
+			}
+			int kerning = stbtt_GetGlyphKernAdvance(&_fontInfo, glyphIndices[left], glyphIndices[right]);
+			_kerningTable[left * FLAT_GLYPH_COUNT + right] = kerning * _pixelHeightScale;
+		}
 	}
 }
 
 const Texture2D::Sptr& Font::GetAtlas() {
+	__UploadDirtyRows();
 	return _atlas;
 }
 
-GlyphInfo Font::GetGlyph(uint32_t codePoint, float offsetX, float offsetY) const {
+void Font::__InitDynamicAtlas() {
+	// Create an empty texture to store the atlas, we don't generate mips since the atlas is updated piece by piece
+	Texture2DDescription desc;
+	desc.Width = _atlasWidth;
+	desc.Height = _atlasHeight;
+	desc.Format = InternalFormat::R8;
+	desc.MinificationFilter = MinFilter::Linear;
+	desc.MagnificationFilter = MagFilter::Linear;
+	desc.HorizontalWrap = WrapMode::ClampToEdge;
+	desc.VerticalWrap = WrapMode::ClampToEdge;
+	desc.GenerateMipMaps = false;
+	_atlas = std::make_shared<Texture2D>(desc);
+
+	// We keep a copy of the atlas on the CPU, so that we can upload whole rows at a time
+	_atlasPixels.assign(_atlasWidth * (size_t)_atlasHeight, 0);
+	_dirtyMinY = 0;
+	_dirtyMaxY = _atlasHeight;
+
+	_shelves.clear();
+	_dynamicGlyphs.clear();
+	_freeDynamicGlyphs.clear();
+	_dynamicGlyphMap.clear();
+	_dynamicFlatGlyphs.assign(FLAT_GLYPH_COUNT, INVALID_INDEX);
+}
+
+uint32_t Font::__RasterizeGlyph(uint32_t codePoint) const {
+	// Codepoints missing from the font will use the font's .notdef glyph (index 0)
+	int glyphIndex = stbtt_FindGlyphIndex(&_fontInfo, codePoint);
+
+	int advance{ 0 }, leftBearing{ 0 };
+	stbtt_GetGlyphHMetrics(&_fontInfo, glyphIndex, &advance, &leftBearing);
+
+	// Determine the bounds of the glyph bitmap relative to the glyph origin
+	int width{ 0 }, height{ 0 }, xOffset{ 0 }, yOffset{ 0 };
+	uint8_t* sdf = nullptr;
+	if (_isDistanceField) {
+		sdf = stbtt_GetGlyphSDF(&_fontInfo, _pixelHeightScale, glyphIndex, SDF_PADDING, SDF_ON_EDGE, SDF_ON_EDGE / (float)SDF_PADDING, &width, &height, &xOffset, &yOffset);
+		if (sdf == nullptr) {
+			width = height = 0;
+		}
+	} else {
+		int x0, y0, x1, y1;
+		stbtt_GetGlyphBitmapBox(&_fontInfo, glyphIndex, _pixelHeightScale, _pixelHeightScale, &x0, &y0, &x1, &y1);
+		width = x1 - x0;
+		height = y1 - y0;
+		xOffset = x0;
+		yOffset = y0;
+	}
+
+	GlyphInfo info = GlyphInfo();
+	info.OffsetX = advance * _pixelHeightScale;
+	info.OffsetY = 0.0f;
+	info.IsPacked = true;
+
+	uint32_t shelf = INVALID_INDEX;
+	if (width > 0 && height > 0) {
+		// Find a spot for the glyph, with some padding so that filtering does not bleed between glyphs
+		uint32_t x, y;
+		if (!__AllocateGlyphRect(width + PADDING * 2, height + PADDING * 2, x, y, shelf)) {
+			if (sdf != nullptr) {
+				stbtt_FreeSDF(sdf, nullptr);
+			}
+			LOG_WARN("Font atlas for \"{}\" is full, increase the atlas size", _fontPath);
+			return INVALID_INDEX;
+		}
+
+		// Clear out whatever was in the region before, then write in our glyph
+		for (uint32_t row = 0; row < height + PADDING * 2; row++) {
+			memset(&_atlasPixels[(y + row) * (size_t)_atlasWidth + x], 0, width + PADDING * 2);
+		}
+		uint8_t* dest = &_atlasPixels[(y + PADDING) * (size_t)_atlasWidth + x + PADDING];
+		if (sdf != nullptr) {
+			for (int row = 0; row < height; row++) {
+				memcpy(dest + row * (size_t)_atlasWidth, sdf + row * (size_t)width, width);
+			}
+			stbtt_FreeSDF(sdf, nullptr);
+		} else {
+			stbtt_MakeGlyphBitmap(&_fontInfo, dest, width, height, _atlasWidth, _pixelHeightScale, _pixelHeightScale, glyphIndex);
+		}
+
+		// Track which rows need to be uploaded to the GPU
+		_dirtyMinY = glm::min(_dirtyMinY, y);
+		_dirtyMaxY = glm::max(_dirtyMaxY, y + height + PADDING * 2);
+
+		// Positions and UVs use the same winding as the glyphs created from the baked atlas
+		float xmin = (float)xOffset;
+		float xmax = (float)(xOffset + width);
+		float ymin = (float)(yOffset + height);
+		float ymax = (float)yOffset;
+		float s0 = (x + PADDING) / (float)_atlasWidth;
+		float s1 = (x + PADDING + width) / (float)_atlasWidth;
+		float t0 = (y + PADDING) / (float)_atlasHeight;
+		float t1 = (y + PADDING + height) / (float)_atlasHeight;
+
+		info.Positions[0] = { xmax, ymin };
+		info.Positions[1] = { xmax, ymax };
+		info.Positions[2] = { xmin, ymax };
+		info.Positions[3] = { xmin, ymin };
+		info.UVs[0]       = { s1, t1 };
+		info.UVs[1]       = { s1, t0 };
+		info.UVs[2]       = { s0, t0 };
+		info.UVs[3]       = { s0, t1 };
+	}
+
+	// Store the glyph, re-using a slot from an evicted glyph if we can
+	uint32_t index;
+	if (!_freeDynamicGlyphs.empty()) {
+		index = _freeDynamicGlyphs.back();
+		_freeDynamicGlyphs.pop_back();
+		_dynamicGlyphs[index] = { info, codePoint, shelf };
+	} else {
+		index = static_cast<uint32_t>(_dynamicGlyphs.size());
+		_dynamicGlyphs.push_back({ info, codePoint, shelf });
+	}
+
+	if (shelf != INVALID_INDEX) {
+		_shelves[shelf].Glyphs.push_back(index);
+	}
+	if (codePoint < FLAT_GLYPH_COUNT) {
+		_dynamicFlatGlyphs[codePoint] = index;
+	} else {
+		_dynamicGlyphMap[codePoint] = index;
+	}
+
+	return index;
+}
+
+bool Font::__AllocateGlyphRect(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y, uint32_t& shelf) const {
+	if (width > _atlasWidth || height > _atlasHeight) {
+		return false;
+	}
+
+	// Find the shortest shelf that the glyph fits in, skipping shelves that would waste too much space
+	uint32_t best = INVALID_INDEX;
+	for (uint32_t ix = 0; ix < _shelves.size(); ix++) {
+		const AtlasShelf& candidate = _shelves[ix];
+		if (candidate.Height >= height && candidate.Height <= height + height / 2 + 2 && candidate.CursorX + width <= _atlasWidth) {
+			if (best == INVALID_INDEX || candidate.Height < _shelves[best].Height) {
+				best = ix;
+			}
+		}
+	}
+
+	// Open a new shelf below the existing ones
+	if (best == INVALID_INDEX) {
+		uint32_t top = _shelves.empty() ? 0 : _shelves.back().Y + _shelves.back().Height;
+		if (top + height <= _atlasHeight) {
+			_shelves.push_back({ top, height, 0, _useStamp, {} });
+			best = static_cast<uint32_t>(_shelves.size() - 1);
+		}
+	}
+
+	// The atlas is full, evict the least recently used shelf that is tall enough. Shelves used by the
+	// text currently being laid out are never evicted
+	if (best == INVALID_INDEX) {
+		for (uint32_t ix = 0; ix < _shelves.size(); ix++) {
+			const AtlasShelf& candidate = _shelves[ix];
+			if (candidate.Height >= height && candidate.LastUsed != _useStamp) {
+				if (best == INVALID_INDEX || candidate.LastUsed < _shelves[best].LastUsed) {
+					best = ix;
+				}
+			}
+		}
+		if (best == INVALID_INDEX) {
+			return false;
+		}
+		__EvictShelf(best);
+	}
+
+	AtlasShelf& result = _shelves[best];
+	x = result.CursorX;
+	y = result.Y;
+	result.CursorX += width;
+	result.LastUsed = _useStamp;
+	shelf = best;
+	return true;
+}
+
+void Font::__EvictShelf(uint32_t shelf) const {
+	AtlasShelf& target = _shelves[shelf];
+	for (uint32_t index : target.Glyphs) {
+		uint32_t codePoint = _dynamicGlyphs[index].CodePoint;
+		if (codePoint < FLAT_GLYPH_COUNT) {
+			_dynamicFlatGlyphs[codePoint] = INVALID_INDEX;
+		} else {
+			_dynamicGlyphMap.erase(codePoint);
+		}
+		_freeDynamicGlyphs.push_back(index);
+	}
+	target.Glyphs.clear();
+	target.CursorX = 0;
+
+	// Anything laid out with the evicted glyphs now points at the wrong part of the atlas
+	_atlasRevision++;
+}
+
+void Font::__UploadDirtyRows() {
+	if (_atlas == nullptr || _dirtyMinY >= _dirtyMaxY) {
+		return;
+	}
+
+	// Upload whole rows, so the source data is contiguous and can be streamed through the upload ring
+	_atlas->LoadData(_atlasWidth, _dirtyMaxY - _dirtyMinY, PixelFormat::Red, PixelType::UByte, &_atlasPixels[_dirtyMinY * (size_t)_atlasWidth], 0, _dirtyMinY);
+	_dirtyMinY = _atlasHeight;
+	_dirtyMaxY = 0;
+}
+
+const GlyphInfo& Font::__FindGlyph(uint32_t codePoint) const {
+	if (_isDynamic && !_dynamicFlatGlyphs.empty()) {
+		uint32_t index = INVALID_INDEX;
+		if (codePoint < FLAT_GLYPH_COUNT) {
+			index = _dynamicFlatGlyphs[codePoint];
+		} else {
+			auto it = _dynamicGlyphMap.find(codePoint);
+			index = it == _dynamicGlyphMap.end() ? INVALID_INDEX : it->second;
+		}
+
+		// First time we've seen this glyph, rasterize it into the atlas
+		if (index == INVALID_INDEX) {
+			index = __RasterizeGlyph(codePoint);
+			if (index == INVALID_INDEX) {
+				return _defaultGlyph;
+			}
+		}
+
+		// Mark the glyph's shelf as recently used, so it's the last to be evicted
+		const DynamicGlyph& glyph = _dynamicGlyphs[index];
+		if (glyph.Shelf != INVALID_INDEX) {
+			_shelves[glyph.Shelf].LastUsed = _useStamp;
+		}
+		return glyph.Info;
+	}
+
+	if (codePoint < FLAT_GLYPH_COUNT && !_flatGlyphs.empty() && _flatGlyphs[codePoint].IsPacked) {
+		return _flatGlyphs[codePoint];
+	}
+
 	// Try and get glyph info from the codepoint, otherwise grab the default glyph
-	auto it = _glyphMap.find(codePoint);		
-	GlyphInfo result = it == _glyphMap.end() ? _defaultGlyph : it->second;
+	auto it = _glyphMap.find(codePoint);
+	return it == _glyphMap.end() ? _defaultGlyph : it->second;
+}
+
+GlyphInfo Font::GetGlyph(uint32_t codePoint, float offsetX, float offsetY) const {
+	GlyphInfo result = __FindGlyph(codePoint);
 
 	result.OffsetX += offsetX;
 	result.OffsetY += offsetY;
@@ -216,6 +611,9 @@ GlyphInfo Font::GetGlyph(uint32_t codePoint, float offsetX, float offsetY) const
 }
 
 float Font::GetKerning(int char1, int char2) const {
+	if ((uint32_t)char1 < FLAT_GLYPH_COUNT && (uint32_t)char2 < FLAT_GLYPH_COUNT && !_kerningTable.empty()) {
+		return _kerningTable[char1 * FLAT_GLYPH_COUNT + char2];
+	}
 	return stbtt_GetCodepointKernAdvance(&_fontInfo, char1, char2) * _pixelHeightScale;
 }
 
@@ -224,14 +622,15 @@ float Font::GetLineHeight() const {
 }
 
 glm::vec2 Font::MeausureString(const std::string& text, const float scale /*= 1.0f*/) {
-	// We can convert an ASCII string to unicode!
-	std::wstring unicode = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(text);
-	return MeausureString(unicode, scale);
+	GlyphRun run;
+	LayoutText(text, run, scale);
+	return run.Size;
 }
 
 glm::vec2 Font::MeausureString(const std::wstring& text, const float scale /*= 1.0f*/) {
 	// Will cache the current glyph
 	GlyphInfo glyph;
+	_useStamp++;
 
 	// We'll track the position and max size of the text
 	float xOff{ 0 }, yOff{ 0 };
@@ -267,6 +666,79 @@ glm::vec2 Font::MeausureString(const std::wstring& text, const float scale /*= 1
 }
 
 
+void Font::LayoutText(const std::wstring& text, GlyphRun& result, float scale /*= 1.0f*/) const {
+	// Widen to full codepoints, ascii and unicode overlap in the 0-255 range!
+	static std::vector<uint32_t> codepoints;
+	codepoints.assign(text.begin(), text.end());
+	__LayoutCodepoints(codepoints.data(), codepoints.size(), result, scale);
+}
+
+void Font::LayoutText(const std::string& text, GlyphRun& result, float scale /*= 1.0f*/) const {
+	static std::vector<uint32_t> codepoints;
+	DecodeUtf8(text, codepoints);
+	__LayoutCodepoints(codepoints.data(), codepoints.size(), result, scale);
+}
+
+void Font::__LayoutCodepoints(const uint32_t* codepoints, size_t count, GlyphRun& result, float scale) const {
+	result.Glyphs.clear();
+	result.Glyphs.reserve(count);
+	result.Scale = scale;
+
+	// Start a new use stamp, so that none of the glyphs in this text will be evicted while we lay it out
+	_useStamp++;
+
+	// Offsets are tracked unscaled, and the scale is applied as glyphs are emitted
+	glm::vec2 offset = glm::vec2(0.0f);
+	float lineHeight = 0.0f;
+	float maxWidth = 0.0f;
+	float totalHeight = 0.0f;
+
+	for (size_t ix = 0; ix < count; ix++) {
+		uint32_t codepoint = codepoints[ix];
+
+		// A newline will advance to the next line and return to the start of the line
+		if (codepoint == '\n') {
+			offset.y += GetLineHeight();
+			offset.x = 0.0f;
+			totalHeight += lineHeight;
+			lineHeight = 0.0f;
+		}
+		// A return character simply returns to the start of the line
+		else if (codepoint == '\r') {
+			offset.x = 0.0f;
+		}
+		// A tab character is 4 spaces
+		else if (codepoint == '\t') {
+			offset.x += __FindGlyph(' ').OffsetX * 4;
+			maxWidth = glm::max(maxWidth, offset.x);
+		}
+		// All other characters get a quad
+		else {
+			const GlyphInfo& glyph = __FindGlyph(codepoint);
+
+			GlyphRun::Glyph shaped;
+			for (int iv = 0; iv < 4; iv++) {
+				shaped.Positions[iv] = (offset + glyph.Positions[iv]) * scale;
+				shaped.UVs[iv] = glyph.UVs[iv];
+			}
+
+			// The glyph's offset is it's advance, since it was created at the origin
+			float advance = glyph.OffsetX;
+			if (ix < count - 1) {
+				advance += GetKerning(codepoint, codepoints[ix + 1]);
+			}
+			shaped.Advance = advance * scale;
+			result.Glyphs.push_back(shaped);
+
+			offset.x += advance;
+			lineHeight = glm::max(lineHeight, -glyph.Positions[1].y);
+			maxWidth = glm::max(maxWidth, offset.x);
+		}
+	}
+	totalHeight += lineHeight;
+	result.Size = glm::vec2(maxWidth, totalHeight) * scale;
+}
+
 GlyphInfo Font::__CreateGlyph(uint32_t index)
 {
 	stbtt_aligned_quad quad;
@@ -299,7 +771,10 @@ nlohmann::json Font::ToJson() const
 {
 	nlohmann::json blob = {
 		{ "filename", _fontPath },
-		{ "font_size", _fontSize }
+		{ "font_size", _fontSize },
+		{ "dynamic", _isDynamic },
+		{ "distance_field", _isDistanceField },
+		{ "atlas_size", glm::uvec2(_atlasWidth, _atlasHeight) }
 	};
 
 	nlohmann::json ranges = std::vector<nlohmann::json>();
@@ -317,6 +792,12 @@ Font::Sptr Font::FromJson(const nlohmann::json& data) {
 	std::string path = JsonGet<std::string>(data, "filename", "");
 	float size = JsonGet(data, "font_size", 16.0f);
 	result->Load(path, size);
+
+	// Dynamic atlases are only filled with the glyphs that are used, so they can afford to be larger
+	result->SetDynamic(JsonGet(data, "dynamic", false));
+	result->SetDistanceField(JsonGet(data, "distance_field", false));
+	glm::uvec2 atlasSize = JsonGet(data, "atlas_size", result->IsDynamic() ? glm::uvec2(1024) : glm::uvec2(256));
+	result->SetAtlasSize(atlasSize.x, atlasSize.y);
 		
 	// Iterate over the ranges and add them to the font
 	if (data.contains("ranges") && data["ranges"].is_array()) {
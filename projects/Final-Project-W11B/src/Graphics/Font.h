@@ -4,6 +4,8 @@
 #include "Graphics/Textures/Texture2D.h"
 
 #include <stb_truetype.h>
+#include <deque>
+#include <unordered_map>
 
 	struct GlyphInfo {
 		glm::vec2 Positions[4];
@@ -12,6 +14,24 @@
 		bool IsPacked;
 	};
 
+	/// <summary>
+	/// A block of text that has been laid out with a font, so that it can be drawn
+	/// repeatedly without looking up glyphs or kerning again
+	/// </summary>
+	struct GlyphRun {
+		struct Glyph {
+			glm::vec2 Positions[4]; // Positions relative to the origin of the run, with scale applied
+			glm::vec2 UVs[4];
+			float     Advance;      // The horizontal distance to the next glyph, with scale applied
+		};
+
+		std::vector<Glyph> Glyphs;
+		glm::vec2          Size;  // The size of the text, as returned by MeausureString
+		float              Scale;
+
+		GlyphRun() : Glyphs(), Size(glm::vec2(0.0f)), Scale(1.0f) {}
+	};
+
 	/// <summary>
 	/// The font resource wraps around stb_truetype to allow us to render text to the screen
 	/// A Font class contains the texture atlas and data needed to render glyphs using said atlas
@@ -21,6 +41,8 @@
 		typedef std::shared_ptr<Font> Sptr;
 		typedef std::weak_ptr<Font> Wptr;
 
+		// Codepoints below this value are stored in a flat array, and have their kerning precomputed
+		static const uint32_t FLAT_GLYPH_COUNT = 256;
 
 		Font();
 		Font(const std::string& fontPath, float size = 16.0f);
@@ -43,15 +65,48 @@
 		/// <param name="max">The maximum unicode character (inclusive)</param>
 		void AddGlyphRange(uint32_t min, uint32_t max);
 
+		/// <summary>
+		/// Enables or disables the dynamic atlas. Dynamic fonts rasterize glyphs the first time they
+		/// are used into a shelf packed atlas, evicting the least recently used glyphs when the atlas
+		/// is full, instead of baking every glyph in the glyph ranges up front. Takes effect on the next Bake
+		/// </summary>
+		void SetDynamic(bool value);
+		/// <summary>
+		/// Returns true if this font rasterizes glyphs on demand
+		/// </summary>
+		bool IsDynamic() const;
+
+		/// <summary>
+		/// Enables or disables signed distance field glyphs, which stay sharp at any scale so one atlas
+		/// can serve all text sizes. Distance fields are always rasterized with a dynamic atlas.
+		/// Takes effect on the next Bake
+		/// </summary>
+		void SetDistanceField(bool value);
+		/// <summary>
+		/// Returns true if the atlas for this font stores signed distance fields
+		/// </summary>
+		bool IsDistanceField() const;
+
+		/// <summary>
+		/// Sets the size of the atlas texture in pixels. Takes effect on the next Bake
+		/// </summary>
+		void SetAtlasSize(uint32_t width, uint32_t height);
+
 		/// <summary>
 		/// Generates the texture to use when rendering with this font, must be called
-		/// before the font is used
+		/// before the font is used. Calling this again will rebuild the atlas
 		/// </summary>
 		void Bake();
 		/// <summary>
-		/// Gets the texture atlas for this font
+		/// Gets the texture atlas for this font, uploading any glyphs that have been
+		/// rasterized since the last call
 		/// </summary>
 		const Texture2D::Sptr& GetAtlas();
+		/// <summary>
+		/// Gets a counter that is incremented whenever glyphs are removed from the atlas. Glyph runs
+		/// that were laid out with an older revision may reference stale UVs and should be laid out again
+		/// </summary>
+		uint32_t GetAtlasRevision() const;
 
 		/// <summary>
 		/// Extracts information about a glyph with the given codepoint, positioning
@@ -89,12 +144,31 @@
 		/// <returns>The dimension of the string as rendered with this font</returns>
 		virtual glm::vec2 MeausureString(const std::wstring& text, const float scale = 1.0f);
 
+		/// <summary>
+		/// Lays out a unicode string with this font, storing the resulting glyph quads
+		/// and the size of the text in the result
+		/// </summary>
+		/// <param name="text">The string to lay out</param>
+		/// <param name="result">The glyph run to store the results in, existing glyphs will be replaced</param>
+		/// <param name="scale">The scaling to apply to the text, default is 1.0f</param>
+		void LayoutText(const std::wstring& text, GlyphRun& result, float scale = 1.0f) const;
+		/// <summary>
+		/// Lays out a UTF-8 string with this font, storing the resulting glyph quads
+		/// and the size of the text in the result
+		/// </summary>
+		/// <param name="text">The string to lay out</param>
+		/// <param name="result">The glyph run to store the results in, existing glyphs will be replaced</param>
+		/// <param name="scale">The scaling to apply to the text, default is 1.0f</param>
+		void LayoutText(const std::string& text, GlyphRun& result, float scale = 1.0f) const;
+
 		virtual nlohmann::json ToJson() const override;
 		static Font::Sptr FromJson(const nlohmann::json& data);
 
 	protected:
 		std::vector<glm::uvec2> _glyphRanges;
-		std::map<uint32_t, GlyphInfo> _glyphMap;
+		std::map<uint32_t, GlyphInfo> _glyphMap;      // Glyphs outside of the flat range
+		std::vector<GlyphInfo>        _flatGlyphs;    // FLAT_GLYPH_COUNT glyphs, indexed by codepoint
+		std::vector<float>            _kerningTable;  // FLAT_GLYPH_COUNT^2 kerning values, indexed by [left * FLAT_GLYPH_COUNT + right]
 		GlyphInfo                     _defaultGlyph;
 		Texture2D::Sptr   _atlas;
 		std::string       _fontPath;
@@ -113,5 +187,45 @@
 		stbtt_packedchar* _glyphs;
 		stbtt_fontinfo    _fontInfo;
 
+		// A glyph that has been rasterized into the dynamic atlas
+		struct DynamicGlyph {
+			GlyphInfo Info;
+			uint32_t  CodePoint;
+			uint32_t  Shelf; // INVALID_INDEX for glyphs with no pixels
+		};
+
+		// A row of glyphs in the dynamic atlas, glyphs are evicted a shelf at a time
+		struct AtlasShelf {
+			uint32_t              Y;
+			uint32_t              Height;
+			uint32_t              CursorX;
+			uint64_t              LastUsed;
+			std::vector<uint32_t> Glyphs;
+		};
+
+		static const uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+		bool              _isDynamic;
+		bool              _isDistanceField;
+
+		// The dynamic atlas is filled in as glyphs are looked up, so it's state is mutable
+		mutable std::deque<DynamicGlyph>               _dynamicGlyphs;
+		mutable std::vector<uint32_t>                  _freeDynamicGlyphs;
+		mutable std::vector<uint32_t>                  _dynamicFlatGlyphs; // FLAT_GLYPH_COUNT indices into _dynamicGlyphs
+		mutable std::unordered_map<uint32_t, uint32_t> _dynamicGlyphMap;   // Codepoint to index for glyphs outside the flat range
+		mutable std::vector<AtlasShelf>                _shelves;
+		mutable std::vector<uint8_t>                   _atlasPixels;
+		mutable uint32_t                               _dirtyMinY, _dirtyMaxY;
+		mutable uint64_t                               _useStamp;
+		mutable uint32_t                               _atlasRevision;
+
 		GlyphInfo __CreateGlyph(uint32_t index);
+		const GlyphInfo& __FindGlyph(uint32_t codePoint) const;
+		void __BuildKerningTable();
+		void __InitDynamicAtlas();
+		uint32_t __RasterizeGlyph(uint32_t codePoint) const;
+		bool __AllocateGlyphRect(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y, uint32_t& shelf) const;
+		void __EvictShelf(uint32_t shelf) const;
+		void __UploadDirtyRows();
+		void __LayoutCodepoints(const uint32_t* codepoints, size_t count, GlyphRun& result, float scale) const;
 	};
\ No newline at end of file
@@ -9,6 +9,15 @@
 #include <Logging.h>
 #include <glm/glm.hpp>
 
+// Glad only loads core profile tokens, the S3TC formats come from EXT_texture_compression_s3tc
+// which is supported on basically every desktop GPU
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT  0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
 // We can use an enum to make our code more readable and restrict
 // values to only ones we want to accept
 ENUM(ShaderPartType, GLint,
@@ -48,11 +57,18 @@ ENUM(InternalFormat, GLint,
 	SRGB         = GL_SRGB8,
 	RGB10        = GL_RGB10,
 	RGB16        = GL_RGB16,
+	RGB16F       = GL_RGB16F,
 	RGB32F       = GL_RGB32F,
 	RGBA8        = GL_RGBA8,
 	SRGBA        = GL_SRGB8_ALPHA8,
 	RGBA16       = GL_RGBA16,
-	RGB32AF      = GL_RGBA32F
+	RGB32AF      = GL_RGBA32F,
+	// Block compressed formats, these can only be loaded from pre-compressed data
+	BC1          = GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+	BC3          = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+	BC4          = GL_COMPRESSED_RED_RGTC1,
+	BC5          = GL_COMPRESSED_RG_RGTC2,
+	BC7          = GL_COMPRESSED_RGBA_BPTC_UNORM
 	// Note: There are sized internal formats but there is a LOT of them
 )
 
@@ -79,6 +95,7 @@ ENUM(PixelType, GLint,
 	Short   = GL_SHORT,
 	UInt    = GL_UNSIGNED_INT,
 	Int     = GL_INT,
+	HalfFloat = GL_HALF_FLOAT,
 	Float   = GL_FLOAT
 )
 
@@ -120,6 +137,7 @@ constexpr size_t GetTexelComponentSize(PixelType type) {
 		return 1;
 	case PixelType::UShort:
 	case PixelType::Short:
+	case PixelType::HalfFloat:
 		return 2;
 	case PixelType::Int:
 	case PixelType::UInt:
@@ -195,6 +213,43 @@ constexpr size_t GetTexelSize(PixelFormat format, PixelType type) {
 	return GetTexelComponentSize(type) * GetTexelComponentCount(format);
 }
 
+/*
+ * Checks whether the given internal format is a block compressed format
+ * @param format The internal format to check
+ * @returns True if the format stores 4x4 compressed blocks
+ */
+constexpr bool IsCompressedFormat(InternalFormat format) {
+	switch (format) {
+		case InternalFormat::BC1:
+		case InternalFormat::BC3:
+		case InternalFormat::BC4:
+		case InternalFormat::BC5:
+		case InternalFormat::BC7:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+ * Gets the number of bytes used to store a single 4x4 block of the given compressed format
+ * @param format The compressed internal format
+ * @returns The size of a block in bytes, or 0 if the format is not compressed
+ */
+constexpr size_t GetCompressedBlockSize(InternalFormat format) {
+	switch (format) {
+		case InternalFormat::BC1:
+		case InternalFormat::BC4:
+			return 8;
+		case InternalFormat::BC3:
+		case InternalFormat::BC5:
+		case InternalFormat::BC7:
+			return 16;
+		default:
+			return 0;
+	}
+}
+
 
 /*
 	* Represents the type of data used in a shader in a more useful format for us
@@ -751,7 +806,8 @@ ENUM(BlendEquation, uint32_t,
 ENUM(BufferType, GLenum,
 	Vertex  = GL_ARRAY_BUFFER,
 	Index   = GL_ELEMENT_ARRAY_BUFFER,
-	Uniform = GL_UNIFORM_BUFFER
+	Uniform = GL_UNIFORM_BUFFER,
+	PixelUnpack = GL_PIXEL_UNPACK_BUFFER
 )
 
 /// <summary>
@@ -815,6 +871,8 @@ ENUM(AttributeType, GLenum,
 	 UInt    = GL_UNSIGNED_INT,
 	 Float   = GL_FLOAT,
 	 Double  = GL_DOUBLE,
+	 HalfFloat = GL_HALF_FLOAT,
+	 Int2_10_10_10_Rev = GL_INT_2_10_10_10_REV, // 3 10 bit signed values and a 2 bit signed value packed into 4 bytes
 	 Unknown = GL_NONE
 )
 
@@ -0,0 +1,65 @@
+#include "GpuTimer.h"
+
+GpuTimer::GpuTimer() :
+	_queries(),
+	_pending(),
+	_current(0),
+	_active(false),
+	_lastResult(0.0f)
+{
+	glCreateQueries(GL_TIME_ELAPSED, QUERY_COUNT, _queries);
+}
+
+GpuTimer::~GpuTimer() {
+	glDeleteQueries(QUERY_COUNT, _queries);
+}
+
+void GpuTimer::Begin() {
+	_Poll();
+
+	// If every query is still in flight we skip this measurement rather than stall
+	if (_pending[_current]) {
+		_active = false;
+		return;
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, _queries[_current]);
+	_active = true;
+}
+
+void GpuTimer::End() {
+	if (!_active) {
+		return;
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+	_pending[_current] = true;
+	_current = (_current + 1) % QUERY_COUNT;
+	_active = false;
+}
+
+float GpuTimer::GetMilliseconds() {
+	_Poll();
+	return _lastResult;
+}
+
+void GpuTimer::_Poll() {
+	// Walk from the oldest query to the newest, so the last result we read is the most recent
+	for (int ix = 0; ix < QUERY_COUNT; ix++) {
+		int index = (_current + ix) % QUERY_COUNT;
+		if (!_pending[index]) {
+			continue;
+		}
+
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(_queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == GL_FALSE) {
+			break;
+		}
+
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(_queries[index], GL_QUERY_RESULT, &nanoseconds);
+		_lastResult = nanoseconds / 1000000.0f;
+		_pending[index] = false;
+	}
+}
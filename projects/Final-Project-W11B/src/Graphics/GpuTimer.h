@@ -0,0 +1,48 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Measures how long the GPU spends on a range of commands using GL_TIME_ELAPSED queries.
+/// A small ring of queries is used so that reading results never waits on the GPU, which
+/// means results lag a few frames behind the commands they measure
+/// </summary>
+class GpuTimer {
+public:
+	MAKE_PTRS(GpuTimer);
+	NO_COPY(GpuTimer);
+	NO_MOVE(GpuTimer);
+
+	static const int QUERY_COUNT = 4;
+
+	GpuTimer();
+	~GpuTimer();
+
+	/// <summary>
+	/// Starts timing commands, only one timer may be active at a time
+	/// </summary>
+	void Begin();
+	/// <summary>
+	/// Stops timing commands
+	/// </summary>
+	void End();
+
+	/// <summary>
+	/// Gets the most recent available result, in milliseconds
+	/// </summary>
+	float GetMilliseconds();
+
+protected:
+	GLuint _queries[QUERY_COUNT];
+	bool   _pending[QUERY_COUNT];
+	int    _current;
+	bool   _active;
+	float  _lastResult;
+
+	/// <summary>
+	/// Collects the results of any queries that the GPU has finished with
+	/// </summary>
+	void _Poll();
+};
@@ -2,8 +2,6 @@
 #include <GLM/gtc/matrix_transform.hpp>
 #include <GLM/gtc/matrix_inverse.hpp>
 #include "Utils/ResourceManager/ResourceManager.h"
-#include <locale>
-#include <codecvt>
 
 
 std::unordered_map<Texture2D*, GuiBatcher::MeshData> GuiBatcher::_meshBuilders;
@@ -15,14 +13,36 @@ Texture2D::Sptr GuiBatcher::__defaultUITexture = nullptr;
 int GuiBatcher::__defaultEdgeRadius = 0;
 
 VertexBuffer::Sptr GuiBatcher::__vbo = nullptr;
+PersistentVertexBuffer::Sptr GuiBatcher::__retainedVbo = nullptr;
+VertexArrayObject::Sptr GuiBatcher::__retainedVao = nullptr;
+std::vector<GuiBatcher::DrawCommand> GuiBatcher::__commands = std::vector<GuiBatcher::DrawCommand>();
+GuiGeometryCache* GuiBatcher::__recording = nullptr;
+uint32_t GuiBatcher::__generation = 0;
+glm::ivec4 GuiBatcher::__scissor = glm::ivec4(0);
 ShaderProgram::Sptr GuiBatcher::__shader = nullptr;
 ShaderProgram::Sptr GuiBatcher::__fontShader = nullptr;
+ShaderProgram::Sptr GuiBatcher::__distanceFieldShader = nullptr;
 glm::ivec2 GuiBatcher::__windowSize = {0, 0};
 glm::mat4 GuiBatcher::__projection = glm::mat4(1.0f);
 glm::mat3 GuiBatcher::__model = glm::mat3(1.0f);
 std::vector<glm::mat3> GuiBatcher::__modelTransformStack = std::vector<glm::mat3>();
 std::vector<GuiBatcher::IRect> GuiBatcher::__scissorRects = std::vector<GuiBatcher::IRect>();
 
+GuiGeometryCache::GuiGeometryCache() :
+	_vertices(),
+	_segments(),
+	_model(glm::mat3(1.0f)),
+	_revision(0),
+	_generation(0),
+	_offset(PersistentVertexBuffer::INVALID_OFFSET),
+	_count(0),
+	_dirty(true)
+{ }
+
+GuiGeometryCache::~GuiGeometryCache() {
+	GuiBatcher::__ReleaseCache(*this);
+}
+
 void GuiBatcher::PushRect(const glm::vec2& min, const glm::vec2& max, const glm::vec4& color, const Texture2D::Sptr& tex, const glm::vec2 uvMin, const glm::vec2 uvMax) {
 	// Create vertices and transform positions
 	VertexPosColTex verts[4];
@@ -30,16 +50,10 @@ void GuiBatcher::PushRect(const glm::vec2& min, const glm::vec2& max, const glm:
 	verts[1].Position = __model * glm::vec3(min.x, max.y, 1.0f);
 	verts[2].Position = __model * glm::vec3(max.x, max.y, 1.0f);
 	verts[3].Position = __model * glm::vec3(max.x, min.y, 1.0f);
-		
-	// Grab mesh info for the texture batch
-	MeshData& mesh = _meshBuilders[tex.get()];
-	// We can use the vertex count for depth, so that things drawn later have a bit of spacing
-	float depth = mesh.Builder.GetVertexCount() / 1000.0f;
 
-	// Copy in all color and set depth 
+	// Copy in all color
 	for (int ix = 0; ix < 4; ix++) {
 		verts[ix].Color = color;
-		verts[ix].Position.z = depth;
 	}
 
 	// Copy over UV coords
@@ -48,10 +62,7 @@ void GuiBatcher::PushRect(const glm::vec2& min, const glm::vec2& max, const glm:
 	verts[2].UV = glm::vec2(uvMax.x, uvMin.y);
 	verts[3].UV = glm::vec2(uvMax.x, uvMax.y);
 
-	// Add vertices and indices to range
-	uint32_t ix = mesh.Builder.AddVertexRange(verts, 4);
-	mesh.Builder.AddIndexTri(ix + 0, ix + 2, ix + 1);
-	mesh.Builder.AddIndexTri(ix + 0, ix + 3, ix + 2);
+	__AddQuad(tex, GuiShaderMode::Texture, verts);
 }
 
 void GuiBatcher::PushRect(const glm::vec2& min, const glm::vec2& max, const glm::vec4& color, const Texture2D::Sptr& tex, int edgeRadius)
@@ -98,21 +109,22 @@ void GuiBatcher::SetProjection(const glm::mat4& projection) {
 }
 
 void GuiBatcher::RenderText(const std::wstring& text, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale /*= 1.0f*/) {
-	// How many characters we have
-	size_t length = text.size();
-
-	// Tracks the offset of the character
-	glm::vec2 offset = glm::vec2(0.0f);
+	static GlyphRun run;
+	font->LayoutText(text, run, scale);
+	RenderGlyphRun(run, font, position, color);
+}
 
-	// Transform the origin based off the model transform
-	glm::vec2 origin = position;
+void GuiBatcher::RenderText(const std::string& text, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale /*= 1.0f*/)
+{
+	static GlyphRun run;
+	font->LayoutText(text, run, scale);
+	RenderGlyphRun(run, font, position, color);
+}
 
+void GuiBatcher::RenderGlyphRun(const GlyphRun& run, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color) {
 	// Gets the texture used to render the font
 	Texture2D::Sptr atlas = font->GetAtlas();
-
-	// Grab the mesh builder and make sure it's a texture batch
-	MeshData& mesh = _meshBuilders[atlas.get()];
-	mesh.IsFont = true;
+	GuiShaderMode mode = font->IsDistanceField() ? GuiShaderMode::DistanceField : GuiShaderMode::Font;
 
 	// Allocate some space for the vertices
 	VertexPosColTex verts[4];
@@ -121,71 +133,89 @@ void GuiBatcher::RenderText(const std::wstring& text, const Font::Sptr& font, co
 	verts[2].Color = color;
 	verts[3].Color = color;
 
-	float depth = mesh.Builder.GetVertexCount() / 1000.0f;
+	// The glyphs are already positioned, we just need to offset and transform them
+	for (const GlyphRun::Glyph& glyph : run.Glyphs) {
+		for (int ix = 0; ix < 4; ix++) {
+			verts[ix].Position = __model * glm::vec3(position + glyph.Positions[ix], 1.0f);
+			verts[ix].UV = glyph.UVs[ix];
+		}
+		__AddQuad(atlas, mode, verts);
+	}
+}
 
-	// Iterate over all characters in string
-	for (int i = 0; i < length; i++) {
-		// Grab the glyph data for the character
-		GlyphInfo glyph = font->GetGlyph(text[i], offset.x, offset.y);
+bool GuiBatcher::BeginCached(GuiGeometryCache& cache, uint32_t revision /*= 0*/) {
+	__StaticInit();
+	LOG_ASSERT(__recording == nullptr, "Cached GUI geometry cannot be nested");
 
-		// A newline will advance to the next line and return to the start of the line
-		if (text[i] == '\n') {
-			offset.y  += font->GetLineHeight() * scale;
-			offset.x = 0;
-		}
-		// A return character simply returns to the start of the line
-		else if (text[i] == '\r') {
-			offset.x = 0;
-		}
-		// A tab character is 4 spaces
-		else if (text[i] == '\t') {
-			float xOffTemp{ 0 }, yOffTemp{ 0 };
-			glyph = font->GetGlyph(' ', xOffTemp, yOffTemp);
-			offset.x += glyph.OffsetX * 4;
+	// Nothing that feeds into the geometry has changed, we can re-use what's in the buffer
+	if (!cache._dirty && cache._revision == revision && cache._generation == __generation && cache._model == __model) {
+		return false;
+	}
+
+	cache._vertices.clear();
+	cache._segments.clear();
+	cache._model = __model;
+	cache._revision = revision;
+	cache._generation = __generation;
+	__recording = &cache;
+	return true;
+}
+
+void GuiBatcher::EndCached(GuiGeometryCache& cache) {
+	if (__recording == &cache) {
+		__recording = nullptr;
+		cache._dirty = false;
+
+		// The old range may still be read by frames in flight, so new geometry always goes to a fresh range
+		__retainedVbo->Free(cache._offset, cache._count);
+		cache._offset = PersistentVertexBuffer::INVALID_OFFSET;
+		cache._count = static_cast<uint32_t>(cache._vertices.size());
+	}
+
+	if (cache._count == 0) {
+		return;
+	}
+
+	// Copy the geometry to the GPU, this will also retry caches that did not fit in previous frames
+	if (cache._offset == PersistentVertexBuffer::INVALID_OFFSET) {
+		cache._offset = __retainedVbo->Allocate(cache._count);
+		if (cache._offset != PersistentVertexBuffer::INVALID_OFFSET) {
+			memcpy(__retainedVbo->GetElementPtr(cache._offset), cache._vertices.data(), sizeof(VertexPosColTex) * cache._count);
 		}
-		// All other characters get rendered
-		else {
-			verts[0].Position = __model * glm::vec3(origin + (offset + glyph.Positions[0]) * scale, 1.0f);
-			verts[1].Position = __model * glm::vec3(origin + (offset + glyph.Positions[1]) * scale, 1.0f);
-			verts[2].Position = __model * glm::vec3(origin + (offset + glyph.Positions[2]) * scale, 1.0f);
-			verts[3].Position = __model * glm::vec3(origin + (offset + glyph.Positions[3]) * scale, 1.0f);
-			verts[0].UV = glyph.UVs[0];
-			verts[1].UV = glyph.UVs[1];
-			verts[2].UV = glyph.UVs[2];
-			verts[3].UV = glyph.UVs[3];
-
-			verts[0].Position.z = verts[1].Position.z = verts[2].Position.z = verts[3].Position.z = depth;
-
-			uint32_t ix = mesh.Builder.AddVertexRange(verts, 4);
-			mesh.Builder.AddIndexTri(ix + 0, ix + 1, ix + 2);
-			mesh.Builder.AddIndexTri(ix + 0, ix + 2, ix + 3);
-
-			// Advance the offset based on the size of the glyph
-			offset.x = glyph.OffsetX;
-			offset.y = glyph.OffsetY;
-
-			// If we have more characters, see if there's any kerning between the
-			// current and next character and add it to the x offset
-			if (i < length - 1) {
-				float kerning = font->GetKerning(text[i], text[i + 1]);
-				offset.x += kerning;
+	}
+
+	// Out of room in the retained buffer, push the geometry through the per-frame batch instead
+	if (cache._offset == PersistentVertexBuffer::INVALID_OFFSET) {
+		for (const auto& segment : cache._segments) {
+			MeshData& mesh = _meshBuilders[segment.Texture.get()];
+			if (segment.Mode != GuiShaderMode::Texture) {
+				mesh.Mode = segment.Mode;
+			}
+			for (uint32_t ix = 0; ix < segment.Count; ix += 3) {
+				uint32_t first = mesh.Builder.AddVertexRange(&cache._vertices[segment.First + ix], 3);
+				mesh.Builder.AddIndexTri(first + 0, first + 1, first + 2);
 			}
 		}
-
+		return;
 	}
 
-}
+	// Uncached geometry is batched by texture, so it needs to be drawn now to keep our draw order
+	if (__HasImmediateData()) {
+		Flush();
+	}
 
-void GuiBatcher::RenderText(const std::string& text, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale /*= 1.0f*/)
-{
-	static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-	RenderText(converter.from_bytes(text), font, position, color, scale);
+	for (const auto& segment : cache._segments) {
+		__commands.push_back({ segment.Texture.get(), segment.Mode, (GLint)(cache._offset + segment.First), (GLsizei)segment.Count, __scissor });
+	}
 }
 
 void GuiBatcher::Flush()
 {
 	__StaticInit();
 
+	// Cached geometry is queued in draw order, and always comes before any uncached geometry
+	__FlushRetained();
+
 	// Iterate over each texture and it's mesh
 	for (auto&[key, value] : _meshBuilders) {
 		Texture2D* tex = key;
@@ -198,7 +228,7 @@ void GuiBatcher::Flush()
 
 			// Bind texture, send uniforms to shader
 			tex->Bind(0);
-			ShaderProgram::Sptr shader = value.IsFont ? __fontShader : __shader;
+			ShaderProgram* shader = __GetShader(value.Mode);
 			shader->Bind();
 			shader->SetUniformMatrix(0, &__projection, 1, false);
 
@@ -209,22 +239,152 @@ void GuiBatcher::Flush()
 			value.Builder.Reset();
 		}
 	}
+
+	// Any ranges released since the last flush can be recycled once these draws complete
+	__retainedVbo->Fence();
+}
+
+void GuiBatcher::__AddQuad(const Texture2D::Sptr& tex, GuiShaderMode mode, VertexPosColTex* verts) {
+	// Cached geometry is drawn as a plain triangle list, since it does not need indices
+	if (__recording != nullptr) {
+		std::vector<GuiGeometryCache::Segment>& segments = __recording->_segments;
+		std::vector<VertexPosColTex>& vertices = __recording->_vertices;
+		if (segments.empty() || segments.back().Texture != tex || segments.back().Mode != mode) {
+			segments.push_back({ tex, mode, static_cast<uint32_t>(vertices.size()), 0 });
+		}
+
+		static const int order[6] = { 0, 1, 2, 0, 2, 3 };
+		for (int ix : order) {
+			vertices.push_back(verts[ix]);
+			vertices.back().Position.z = 0.0f;
+		}
+		segments.back().Count += 6;
+	}
+	else {
+		// Grab mesh info for the texture batch
+		MeshData& mesh = _meshBuilders[tex.get()];
+		if (mode != GuiShaderMode::Texture) {
+			mesh.Mode = mode;
+		}
+
+		// We can use the vertex count for depth, so that things drawn later have a bit of spacing
+		float depth = mesh.Builder.GetVertexCount() / 1000.0f;
+		for (int ix = 0; ix < 4; ix++) {
+			verts[ix].Position.z = depth;
+		}
+
+		// Add vertices and indices to range
+		uint32_t ix = mesh.Builder.AddVertexRange(verts, 4);
+		mesh.Builder.AddIndexTri(ix + 0, ix + 1, ix + 2);
+		mesh.Builder.AddIndexTri(ix + 0, ix + 2, ix + 3);
+	}
+}
+
+ShaderProgram* GuiBatcher::__GetShader(GuiShaderMode mode) {
+	switch (mode) {
+		case GuiShaderMode::Font:          return __fontShader.get();
+		case GuiShaderMode::DistanceField: return __distanceFieldShader.get();
+		default:                           return __shader.get();
+	}
+}
+
+bool GuiBatcher::__HasImmediateData() {
+	for (const auto& [key, value] : _meshBuilders) {
+		if (value.Builder.GetIndexCount() > 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void GuiBatcher::__FlushRetained() {
+	if (__commands.empty()) {
+		return;
+	}
+
+	static std::vector<GLint> firsts;
+	static std::vector<GLsizei> counts;
+
+	__retainedVao->Bind();
+
+	glm::ivec4 scissor = __scissor;
+	ShaderProgram* boundShader = nullptr;
+
+	size_t ix = 0;
+	while (ix < __commands.size()) {
+		const DrawCommand& command = __commands[ix];
+
+		// Gather all the following commands that share our state into a single draw, merging adjacent ranges
+		firsts.clear();
+		counts.clear();
+		for (; ix < __commands.size(); ix++) {
+			const DrawCommand& next = __commands[ix];
+			if (next.Texture != command.Texture || next.Mode != command.Mode || next.Scissor != command.Scissor) {
+				break;
+			}
+			if (!counts.empty() && firsts.back() + counts.back() == next.First) {
+				counts.back() += next.Count;
+			} else {
+				firsts.push_back(next.First);
+				counts.push_back(next.Count);
+			}
+		}
+
+		if (command.Scissor != scissor) {
+			scissor = command.Scissor;
+			glScissor(scissor.x, scissor.y, scissor.z, scissor.w);
+		}
+
+		ShaderProgram* shader = __GetShader(command.Mode);
+		if (shader != boundShader) {
+			shader->Bind();
+			shader->SetUniformMatrix(0, &__projection, 1, false);
+			boundShader = shader;
+		}
+
+		command.Texture->Bind(0);
+		glMultiDrawArrays(GL_TRIANGLES, firsts.data(), counts.data(), static_cast<GLsizei>(counts.size()));
+	}
+
+	// Restore the scissor for anything drawn after
+	if (scissor != __scissor) {
+		glScissor(__scissor.x, __scissor.y, __scissor.z, __scissor.w);
+	}
+
+	VertexArrayObject::Unbind();
+	__commands.clear();
+}
+
+void GuiBatcher::__ReleaseCache(GuiGeometryCache& cache) {
+	if (__recording == &cache) {
+		__recording = nullptr;
+	}
+	if (__retainedVbo != nullptr) {
+		__retainedVbo->Free(cache._offset, cache._count);
+	}
+	cache._offset = PersistentVertexBuffer::INVALID_OFFSET;
+	cache._count = 0;
 }
 
 void GuiBatcher::PushModelTransform(const glm::mat3& transform) {
-	__modelTransformStack.push_back(transform);
+	// We store the previous transform rather than inverting on pop, so the model matrix is
+	// exactly the same every frame and cached geometry is not rebuilt due to drift
+	__modelTransformStack.push_back(__model);
 	__model = __model * transform;
 }
 
 void GuiBatcher::PopModelTransform()
 {
 	LOG_ASSERT(__modelTransformStack.size() > 0, "Transform push/pop mismatch");
-	__model = __model * glm::inverse(__modelTransformStack.back());
+	__model = __modelTransformStack.back();
 	__modelTransformStack.pop_back();
 }
 
 void GuiBatcher::SetWindowSize(const glm::ivec2& size) {
 	__windowSize = size;
+	if (__scissorRects.empty()) {
+		__scissor = glm::ivec4(0, 0, size.x, size.y);
+	}
 }
 
 void GuiBatcher::__StaticInit()
@@ -298,6 +458,44 @@ void GuiBatcher::__StaticInit()
 
 		__fontShader->Link();
 
+		__distanceFieldShader = ShaderProgram::Create();
+		__distanceFieldShader->LoadShaderPart(R"LIT(#version 460
+					layout(location = 0) in vec3 inPos;
+					layout(location = 1) in vec4 inColor;
+					layout(location = 3) in vec2 inUV;
+
+					layout(location = 0) out vec4 outColor;
+					layout(location = 1) out vec2 outUV;
+
+					layout(location = 0) uniform mat4 u_Projection;
+
+					void main() {
+						outColor = inColor;
+						outUV = inUV;
+						gl_Position = u_Projection * vec4(inPos, 1);
+					}
+				)LIT", ShaderPartType::Vertex);
+
+		__distanceFieldShader->LoadShaderPart(R"LIT(#version 460
+					layout(location = 0) in vec4 inColor;
+					layout(location = 1) in vec2 inUV;
+
+					layout(location = 0) out vec4 outColor;
+
+					uniform layout(binding=0) sampler2D s_Texture;
+
+					void main() {
+						// The edge of the glyph is at 0.5, we smooth over about a pixel in screen space so
+						// the edge stays crisp at any scale
+						float dist = texture(s_Texture, inUV).r;
+						float width = max(fwidth(dist), 0.0001);
+						float alpha = smoothstep(0.5 - width, 0.5 + width, dist);
+						outColor = vec4(inColor.rgb, alpha);
+					}
+				)LIT" , ShaderPartType::Fragment);
+
+		__distanceFieldShader->Link();
+
 		__vbo = VertexBuffer::Create(BufferUsage::DynamicDraw);
 		__ibo = IndexBuffer::Create(BufferUsage::DynamicDraw, IndexType::UInt);
 
@@ -305,6 +503,10 @@ void GuiBatcher::__StaticInit()
 		__vao->AddVertexBuffer(__vbo, VertexPosColTex::V_DECL);
 		__vao->SetIndexBuffer(__ibo);
 
+		__retainedVbo = std::make_shared<PersistentVertexBuffer>(static_cast<uint32_t>(sizeof(VertexPosColTex)), RETAINED_CAPACITY);
+		__retainedVao = VertexArrayObject::Create();
+		__retainedVao->AddVertexBuffer(__retainedVbo, VertexPosColTex::V_DECL);
+
 		// Generate a simple white texture with a black border
 		if (__defaultUITexture == nullptr) {
 			Texture2DDescription desc = Texture2DDescription();
@@ -353,9 +555,12 @@ void GuiBatcher::PushScissorRect(const glm::vec2& min, const glm::vec2& max) {
 	int width  = glm::max(maxWin.x, minWin.x) - glm::min(maxWin.x, minWin.x);
 	int height = glm::max(maxWin.y, minWin.y) - glm::min(maxWin.y, minWin.y);
 
-	// Draw current geo with the current scissor, then update it
-	Flush();
-	glScissor(minWin.x, maxWin.y, width, height);
+	// Draw uncached geo with the current scissor, then update it. Cached geo stores the scissor with each draw
+	if (__HasImmediateData()) {
+		Flush();
+	}
+	__scissor = glm::ivec4(minWin.x, maxWin.y, width, height);
+	glScissor(__scissor.x, __scissor.y, __scissor.z, __scissor.w);
 }
 
 void GuiBatcher::PopScissorRect() {
@@ -369,13 +574,17 @@ void GuiBatcher::PopScissorRect() {
 	int width  = glm::max(bounds.Min.x, bounds.Max.x) - glm::min(bounds.Min.x, bounds.Max.x);
 	int height = glm::max(bounds.Min.y, bounds.Max.y) - glm::min(bounds.Min.y, bounds.Max.y);
 
-	// Draw current geo with the current scissor, then update it
-	Flush();
-	glScissor(glm::min(bounds.Min.x, bounds.Max.x), glm::min(bounds.Min.y, bounds.Max.y), width, height);
+	// Draw uncached geo with the current scissor, then update it. Cached geo stores the scissor with each draw
+	if (__HasImmediateData()) {
+		Flush();
+	}
+	__scissor = glm::ivec4(glm::min(bounds.Min.x, bounds.Max.x), glm::min(bounds.Min.y, bounds.Max.y), width, height);
+	glScissor(__scissor.x, __scissor.y, __scissor.z, __scissor.w);
 }
 
 void GuiBatcher::SetDefaultTexture(const Texture2D::Sptr& value) {
 	__defaultUITexture = value;
+	__generation++;
 }
 
 const Texture2D::Sptr& GuiBatcher::GetDefaultTexture() {
@@ -384,6 +593,7 @@ const Texture2D::Sptr& GuiBatcher::GetDefaultTexture() {
 
 void GuiBatcher::SetDefaultBorderRadius(int value) {
 	__defaultEdgeRadius = value;
+	__generation++;
 }
 
 int GuiBatcher::GetDefaultBorderRadius() {
@@ -5,11 +5,61 @@
 #include "Graphics/Textures/Texture2D.h"
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/Buffers/PersistentVertexBuffer.h"
 #include "Graphics/VertexTypes.h"
 #include "Graphics/Font.h"
 #include "Utils/MeshBuilder.h"
 #include <unordered_map>
 
+	/// <summary>
+	/// Selects the shader used to draw a batch of GUI geometry
+	/// </summary>
+	enum class GuiShaderMode : uint8_t {
+		Texture       = 0, // Texture multiplied by vertex color
+		Font          = 1, // Red channel of the texture is coverage
+		DistanceField = 2  // Red channel of the texture is a signed distance to the glyph edge
+	};
+
+	/// <summary>
+	/// Stores GUI geometry that is generated once and re-used across frames until it is
+	/// invalidated. The geometry lives in a persistently mapped buffer owned by the GUI
+	/// batcher, so drawing an unchanged cache does not upload anything
+	/// </summary>
+	/// <see>GuiBatcher::BeginCached</see>
+	class GuiGeometryCache {
+	public:
+		NO_COPY(GuiGeometryCache);
+		NO_MOVE(GuiGeometryCache);
+
+		GuiGeometryCache();
+		~GuiGeometryCache();
+
+		/// <summary>
+		/// Marks the geometry as needing to be regenerated the next time it is drawn
+		/// </summary>
+		void Invalidate() { _dirty = true; }
+
+	private:
+		friend class GuiBatcher;
+
+		// A run of vertices that share a texture and shader
+		struct Segment {
+			Texture2D::Sptr Texture;
+			GuiShaderMode   Mode;
+			uint32_t        First;
+			uint32_t        Count;
+		};
+
+		std::vector<VertexPosColTex> _vertices;
+		std::vector<Segment>         _segments;
+		glm::mat3                    _model;
+		uint32_t                     _revision;
+		uint32_t                     _generation;
+		uint32_t                     _offset;
+		uint32_t                     _count;
+		bool                         _dirty;
+	};
+
 	/// <summary>
 	/// The GUI Batcher class provides utilities for drawing rectangles and
 	/// fonts to the screen in a 2D fashion
@@ -55,6 +105,31 @@
 		/// <param name="color">The color of the text</param>
 		/// <param name="scale">The scaling to apply to the text</param>
 		static void RenderText(const std::string& text, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color, float scale = 1.0f);
+		/// <summary>
+		/// Renders text that has already been laid out using Font::LayoutText
+		/// </summary>
+		/// <param name="run">The glyphs to render</param>
+		/// <param name="font">The font that the glyphs were laid out with</param>
+		/// <param name="position">The position of the text in model space</param>
+		/// <param name="color">The color of the text</param>
+		static void RenderGlyphRun(const GlyphRun& run, const Font::Sptr& font, const glm::vec2& position, const glm::vec4& color);
+
+		/// <summary>
+		/// Begins drawing geometry that is cached between frames. If this returns true, the cache
+		/// is out of date and the caller should push it's rects and text, which will be recorded
+		/// into the cache instead of the per-frame batch. Either way EndCached must be called
+		/// afterwards to draw the cache. The cache is regenerated when it has been invalidated,
+		/// when the model transform changes, or when the revision does not match the last build
+		/// </summary>
+		/// <param name="cache">The cache to draw</param>
+		/// <param name="revision">A caller defined version number for the inputs to the geometry</param>
+		/// <returns>True if the geometry must be regenerated</returns>
+		static bool BeginCached(GuiGeometryCache& cache, uint32_t revision = 0);
+		/// <summary>
+		/// Finishes recording a cache if it was being regenerated, and queues it for drawing
+		/// </summary>
+		/// <param name="cache">The cache passed to BeginCached</param>
+		static void EndCached(GuiGeometryCache& cache);
 
 		/// <summary>
 		/// Sets the projection matrix to use for rendering, should ideally be an orthographic
@@ -83,13 +158,14 @@
 
 		/// <summary>
 		/// Sets a new scissor region in model space. Note that this will invoke a 
-		/// flush
+		/// flush if there is any uncached geometry waiting to be drawn
 		/// </summary>
 		/// <param name="min">The minimum bounds of the scissor rectangle</param>
 		/// <param name="min">The maximum bounds of the scissor rectangle</param>
 		static void PushScissorRect(const glm::vec2& min, const glm::vec2& max);
 		/// <summary>
-		/// Pops the last scissor region, not that this will invoke a flush
+		/// Pops the last scissor region, note that this will invoke a flush if there
+		/// is any uncached geometry waiting to be drawn
 		/// </summary>
 		static void PopScissorRect();
 
@@ -113,6 +189,11 @@
 		static int GetDefaultBorderRadius();
 
 	private:
+		friend class GuiGeometryCache;
+
+		// The maximum number of vertices that all cached GUI geometry can use
+		static const uint32_t RETAINED_CAPACITY = 128 * 1024;
+
 		struct IRect {
 			glm::ivec2 Min;
 			glm::ivec2 Max;
@@ -120,7 +201,16 @@
 
 		struct MeshData {
 			MeshBuilder<VertexPosColTex> Builder;
-			bool IsFont;
+			GuiShaderMode Mode;
+		};
+
+		// A draw of a range within the retained buffer
+		struct DrawCommand {
+			Texture2D* Texture;
+			GuiShaderMode Mode;
+			GLint      First;
+			GLsizei    Count;
+			glm::ivec4 Scissor;
 		};
 
 		static glm::ivec2 __windowSize;
@@ -130,13 +220,26 @@
 		static std::vector<IRect> __scissorRects;
 		static ShaderProgram::Sptr __shader;
 		static ShaderProgram::Sptr __fontShader;
+		static ShaderProgram::Sptr __distanceFieldShader;
 		static std::unordered_map<Texture2D*, MeshData> _meshBuilders;
 		static VertexArrayObject::Sptr __vao;
 		static VertexBuffer::Sptr __vbo;
 		static IndexBuffer::Sptr __ibo;
 
+		static PersistentVertexBuffer::Sptr __retainedVbo;
+		static VertexArrayObject::Sptr __retainedVao;
+		static std::vector<DrawCommand> __commands;
+		static GuiGeometryCache* __recording;
+		static uint32_t __generation;
+		static glm::ivec4 __scissor;
+
 		static Texture2D::Sptr __defaultUITexture;
 		static int __defaultEdgeRadius;
 
 		static void __StaticInit();
+		static void __AddQuad(const Texture2D::Sptr& tex, GuiShaderMode mode, VertexPosColTex* verts);
+		static ShaderProgram* __GetShader(GuiShaderMode mode);
+		static bool __HasImmediateData();
+		static void __FlushRetained();
+		static void __ReleaseCache(GuiGeometryCache& cache);
 	};
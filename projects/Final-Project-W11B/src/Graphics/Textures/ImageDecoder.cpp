@@ -0,0 +1,87 @@
+#include "Graphics/Textures/ImageDecoder.h"
+#include <stb_image.h>
+
+#include "Utils/ThreadPool.h"
+#include "Logging.h"
+
+std::mutex ImageDecoder::_prefetchMutex;
+std::unordered_map<std::string, ImageDecoder::Future> ImageDecoder::_prefetched;
+
+DecodedImage::~DecodedImage() {
+	if (Data != nullptr) {
+		stbi_image_free(Data);
+		Data = nullptr;
+	}
+}
+
+ImageDecoder::Future ImageDecoder::LoadAsync(const std::string& filename, int targetChannels) {
+	Future result;
+	if (_TakePrefetched(_GetKey(filename, targetChannels), result)) {
+		return result;
+	}
+	return ThreadPool::Enqueue([filename, targetChannels]() { return _Decode(filename, targetChannels); }).share();
+}
+
+DecodedImage::Sptr ImageDecoder::Load(const std::string& filename, int targetChannels) {
+	Future result;
+	if (_TakePrefetched(_GetKey(filename, targetChannels), result)) {
+		return result.get();
+	}
+	return _Decode(filename, targetChannels);
+}
+
+void ImageDecoder::Prefetch(const std::string& filename, int targetChannels) {
+	std::string key = _GetKey(filename, targetChannels);
+
+	std::unique_lock<std::mutex> lock(_prefetchMutex);
+	if (_prefetched.find(key) == _prefetched.end()) {
+		_prefetched[key] = ThreadPool::Enqueue([filename, targetChannels]() { return _Decode(filename, targetChannels); }).share();
+	}
+}
+
+void ImageDecoder::ClearPrefetched() {
+	std::unordered_map<std::string, Future> prefetched;
+	{
+		std::unique_lock<std::mutex> lock(_prefetchMutex);
+		prefetched.swap(_prefetched);
+	}
+	// Jobs that are still decoding own their result until they finish, so we don't need to wait on them
+	if (!prefetched.empty()) {
+		LOG_INFO("Discarding {} prefetched images that were never used", prefetched.size());
+	}
+}
+
+std::string ImageDecoder::_GetKey(const std::string& filename, int targetChannels) {
+	return filename + "#" + std::to_string(targetChannels);
+}
+
+bool ImageDecoder::_TakePrefetched(const std::string& key, Future& result) {
+	std::unique_lock<std::mutex> lock(_prefetchMutex);
+	auto it = _prefetched.find(key);
+	if (it == _prefetched.end()) {
+		return false;
+	}
+
+	// Prefetched images are only used once, the texture owns the GPU copy after that
+	result = it->second;
+	_prefetched.erase(it);
+	return true;
+}
+
+DecodedImage::Sptr ImageDecoder::_Decode(const std::string& filename, int targetChannels) {
+	// The flip flag is global in STBI, so we set it once up front instead of on every (possibly concurrent) call
+	static std::once_flag flipFlag;
+	std::call_once(flipFlag, []() { stbi_set_flip_vertically_on_load(true); });
+
+	DecodedImage::Sptr result = std::make_shared<DecodedImage>();
+	result->Data = stbi_load(filename.c_str(), &result->Width, &result->Height, &result->FileChannels, targetChannels);
+
+	// If we could not load any data, warn and return null
+	if (result->Data == nullptr) {
+		LOG_WARN("STBI Failed to load image from \"{}\"", filename);
+		return nullptr;
+	}
+
+	result->Channels = targetChannels != 0 ? targetChannels : result->FileChannels;
+	return result;
+}
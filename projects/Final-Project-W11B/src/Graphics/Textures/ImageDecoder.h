@@ -0,0 +1,79 @@
+#pragma once
+#include <string>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Stores the pixels of an image that has been decoded from disk
+/// </summary>
+struct DecodedImage {
+	MAKE_PTRS(DecodedImage);
+	NO_COPY(DecodedImage);
+	NO_MOVE(DecodedImage);
+
+	int      Width;
+	int      Height;
+	/// <summary>
+	/// The number of channels in the file on disk
+	/// </summary>
+	int      FileChannels;
+	/// <summary>
+	/// The number of channels stored in Data (may differ from FileChannels if a channel count was requested)
+	/// </summary>
+	int      Channels;
+	uint8_t* Data;
+
+	DecodedImage() : Width(0), Height(0), FileChannels(0), Channels(0), Data(nullptr) { }
+	~DecodedImage();
+};
+
+/// <summary>
+/// Decodes images using STBI on the shared thread pool. Images can be prefetched (ex: when
+/// preloading a manifest), in which case the texture will pick up the already decoded image
+/// instead of decoding it on the main thread
+/// </summary>
+class ImageDecoder {
+public:
+	typedef std::shared_future<DecodedImage::Sptr> Future;
+
+	ImageDecoder() = delete;
+
+	/// <summary>
+	/// Starts decoding an image on the thread pool, or returns the pending prefetch for the image
+	/// </summary>
+	/// <param name="filename">The path of the image to load</param>
+	/// <param name="targetChannels">The number of channels to expand the image to, or 0 to keep the file's channels</param>
+	/// <returns>A future containing the decoded image, or nullptr if the image failed to load</returns>
+	static Future LoadAsync(const std::string& filename, int targetChannels = 0);
+	/// <summary>
+	/// Decodes an image, will use a prefetched image if one is available, otherwise the image is decoded on
+	/// the calling thread
+	/// </summary>
+	/// <param name="filename">The path of the image to load</param>
+	/// <param name="targetChannels">The number of channels to expand the image to, or 0 to keep the file's channels</param>
+	/// <returns>The decoded image, or nullptr if the image failed to load</returns>
+	static DecodedImage::Sptr Load(const std::string& filename, int targetChannels = 0);
+
+	/// <summary>
+	/// Starts decoding an image in the background, so that a later call to Load or LoadAsync
+	/// with the same arguments can use the result
+	/// </summary>
+	/// <param name="filename">The path of the image to load</param>
+	/// <param name="targetChannels">The number of channels to expand the image to, or 0 to keep the file's channels</param>
+	static void Prefetch(const std::string& filename, int targetChannels = 0);
+	/// <summary>
+	/// Drops any prefetched images that were never used, images that are still decoding are freed once they finish
+	/// </summary>
+	static void ClearPrefetched();
+
+protected:
+	static std::mutex _prefetchMutex;
+	static std::unordered_map<std::string, Future> _prefetched;
+
+	static std::string _GetKey(const std::string& filename, int targetChannels);
+	static bool _TakePrefetched(const std::string& key, Future& result);
+	static DecodedImage::Sptr _Decode(const std::string& filename, int targetChannels);
+};
@@ -1,9 +1,11 @@
 #include "Texture2D.h"
-#include <stb_image.h>
 #include <Logging.h>
+#include "Graphics/Textures/ImageDecoder.h"
+#include "Graphics/Buffers/PixelUploadBuffer.h"
 #include "GLM/glm.hpp"
 #include "Utils/JsonGlmHelpers.h"
-#include "Utils/Base64.h"
+#include "Utils/BlobSidecar.h"
+#include "Utils/TextureCooker.h"
 
 /// <summary>
 /// Get the number of mipmap levels required for a texture of the given size
@@ -23,6 +25,7 @@ nlohmann::json Texture2D::ToJson() const {
 		{ "filter_mag",       ~_description.MagnificationFilter },
 		{ "anisotropic",       _description.MaxAnisotropic },
 		{ "generate_mipmaps",  _description.GenerateMipMaps },
+		{ "use_cooked",        _description.UseCookedIfAvailable },
 	};
 
 	if (!_description.Filename.empty()) {
@@ -30,42 +33,58 @@ nlohmann::json Texture2D::ToJson() const {
 	}
 	else if (_pixelType != PixelType::Unknown) {
 		result["size_x"] = _description.Width;
-		result["size_y"] = _description.Width;
+		result["size_y"] = _description.Height;
 
 		result["format"] = ~_description.FormatHint;
+		result["internal_format"] = ~_description.Format;
 		result["pixel_type"] = ~_pixelType;
 		if (_description.Width * _description.Height > 0 && _description.FormatHint != PixelFormat::Unknown) {
 			size_t dataSize = GetTexelSize(_description.FormatHint, _pixelType) * _description.Width * _description.Height;
-			uint8_t* dataStore = new uint8_t[dataSize];
-			glGetTextureImage(_rendererId, 0, *_description.FormatHint, *_pixelType, dataSize, dataStore);
-			result["data"] = Base64::Encode(dataStore, dataSize);
+			std::vector<uint8_t> dataStore(dataSize);
+			glGetTextureImage(_rendererId, 0, *_description.FormatHint, *_pixelType, dataSize, dataStore.data());
+			// Large textures go into the manifest's sidecar file when one is being written
+			BlobSidecar::Store(result, "data", dataStore.data(), dataSize);
 		}
 	}
 
 	return result;
 }
 
-Texture2D::Sptr Texture2D::FromJson(const nlohmann::json& data)
+Texture2DDescription Texture2D::_DescriptionFromJson(const nlohmann::json& data)
 {
 	Texture2DDescription descr = Texture2DDescription();
-	descr.Filename = data["filename"];
+	descr.Filename = JsonGet<std::string>(data, "filename", "");
 	descr.HorizontalWrap = JsonParseEnum(WrapMode, data, "wrap_s", WrapMode::ClampToEdge);
 	descr.VerticalWrap   = JsonParseEnum(WrapMode, data, "wrap_t", WrapMode::ClampToEdge);
 	descr.MinificationFilter  = JsonParseEnum(MinFilter, data, "filter_min", MinFilter::NearestMipNearest);
 	descr.MagnificationFilter = JsonParseEnum(MagFilter, data, "filter_mag", MagFilter::Linear);
 	descr.MaxAnisotropic      = JsonGet(data, "anisotropic", 0.0f);
 	descr.GenerateMipMaps     = JsonGet(data, "generate_mipmaps", false);
+	descr.UseCookedIfAvailable = JsonGet(data, "use_cooked", true);
+	// Generated textures need their storage described up front, so that the embedded data can be uploaded
+	if (descr.Filename.empty()) {
+		descr.Width      = JsonGet(data, "size_x", 0u);
+		descr.Height     = JsonGet(data, "size_y", 0u);
+		descr.Format     = JsonParseEnum(InternalFormat, data, "internal_format", InternalFormat::RGBA8);
+		descr.FormatHint = JsonParseEnum(PixelFormat, data, "format", PixelFormat::RGBA);
+	}
+	return descr;
+}
 
+Texture2D::Sptr Texture2D::FromJson(const nlohmann::json& data)
+{
+	Texture2DDescription descr = _DescriptionFromJson(data);
 	Texture2D::Sptr result = std::make_shared<Texture2D>(descr);
 
-	// If we embedded data into the JSON, load it now
-	if (descr.Filename.empty() && data.contains("data") && data["data"].is_string()) {
+	// If we embedded data into the JSON (or it's sidecar), load it now
+	if (descr.Filename.empty() && data.contains("data")) {
 		PixelType type = JsonParseEnum(PixelType, data, "pixel_type", PixelType::Unknown);
-		try {
-			std::string rawData = Base64::Decode(data['data'].get<std::string>());
+
+		std::vector<uint8_t> rawData;
+		if (BlobSidecar::Load(data["data"], rawData) && rawData.size() >= GetTexelSize(descr.FormatHint, type) * descr.Width * descr.Height) {
 			result->LoadData(descr.Width, descr.Height, descr.FormatHint, type, rawData.data());
 		}
-		catch (std::runtime_error()) {
+		else {
 			LOG_WARN("JSON blob had data, but failed to load to texture");
 		}
 	}
@@ -73,6 +92,21 @@ Texture2D::Sptr Texture2D::FromJson(const nlohmann::json& data)
 	return result;
 }
 
+void Texture2D::PrefetchFromJson(const nlohmann::json& data) {
+	Texture2DDescription descr = _DescriptionFromJson(data);
+	if (descr.Filename.empty()) {
+		return;
+	}
+
+	// Cooked textures don't need decoding, they're uploaded straight from the mapped file
+	if (descr.UseCookedIfAvailable && TextureCooker::HasCookedFile(descr.Filename)) {
+		return;
+	}
+
+	// Matches the channel count that _LoadDataFromFile will request
+	ImageDecoder::Prefetch(descr.Filename, GetTexelComponentCount(descr.FormatHint));
+}
+
 Texture2D::Texture2D(const Texture2DDescription& description) : 
 	ITexture(TextureType::_2D),
 	_description(description),
@@ -118,7 +152,8 @@ void Texture2D::SetAnisoLevel(float value) {
 		_description.MaxAnisotropic = glm::clamp(value, 1.0f, ITexture::GetLimits().MAX_ANISOTROPY);
 		glTextureParameterf(_rendererId, GL_TEXTURE_MAX_ANISOTROPY, _description.MaxAnisotropic);
 
-		if (_description.GenerateMipMaps) {
+		// Compressed textures come with their mip chain pre-built
+		if (_description.GenerateMipMaps && !IsCompressedFormat(_description.Format)) {
 			glGenerateTextureMipmap(_rendererId);
 		}
 	}
@@ -129,6 +164,11 @@ void Texture2D::LoadData(uint32_t width, uint32_t height, PixelFormat format, Pi
 	LOG_ASSERT((width + offsetX) <= _description.Width, "Pixel bounds are outside of the X extents of the image!");
 	LOG_ASSERT((height + offsetY) <= _description.Height, "Pixel bounds are outside of the Y extents of the image!");
 
+	if (IsCompressedFormat(_description.Format)) {
+		LOG_WARN("Cannot load uncompressed pixel data into compressed texture \"{}\"", _description.Filename);
+		return;
+	}
+
 	_description.FormatHint = format;
 	_pixelType = type;
 
@@ -137,8 +177,11 @@ void Texture2D::LoadData(uint32_t width, uint32_t height, PixelFormat format, Pi
 	int componentSize = (GLint)GetTexelComponentSize(type);
 	glPixelStorei(GL_PACK_ALIGNMENT, componentSize);
 
-	// Upload our data to our image
-	glTextureSubImage2D(_rendererId, 0, offsetX, offsetY, width, height, (GLenum)format, (GLenum)type, data);
+	// Upload our data to our image, streaming it through the shared PBO ring so we don't stall waiting for the driver to copy it
+	size_t rowSize = GetTexelSize(format, type) * width;
+	PixelUploadBuffer::GetShared()->Upload(data, rowSize, height, [&](const void* pixels) {
+		glTextureSubImage2D(_rendererId, 0, offsetX, offsetY, width, height, (GLenum)format, (GLenum)type, pixels);
+	});
 
 	// If requested, generate mip-maps for our texture
 	if (_description.GenerateMipMaps) {
@@ -150,25 +193,26 @@ void Texture2D::_LoadDataFromFile() {
 	LOG_ASSERT(_description.Width + _description.Height == 0, "This texture has already been configured with a size! Cannot re-allocate memory!");
 
 	if (!_description.Filename.empty()) {
-		// Variables that will store properties about our image
-		int width, height, numChannels;
+		// Prefer the cooked version of the image if we have one, it's already compressed and mipped
+		if (_description.UseCookedIfAvailable && TextureCooker::HasCookedFile(_description.Filename) && _LoadCookedFile()) {
+			SetDebugName(_description.Filename);
+			return;
+		}
+
 		const int targetChannels = GetTexelComponentCount(_description.FormatHint);
 
-		// Use STBI to load the image
-		stbi_set_flip_vertically_on_load(true);
-		uint8_t* data = stbi_load(_description.Filename.c_str(), &width, &height, &numChannels, targetChannels);
+		// Decode the image, this will use the prefetched image if the manifest was preloaded
+		DecodedImage::Sptr image = ImageDecoder::Load(_description.Filename, targetChannels);
 
-		// If we could not load any data, warn and return null
-		if (data == nullptr) {
-			LOG_WARN("STBI Failed to load image from \"{}\"", _description.Filename);
+		// If we could not load any data, the decoder will have warned us
+		if (image == nullptr) {
 			return ;
 		}
 
 		// We should estimate a good format for our data
-
-		// numChannels will store the number of channels in the image on disk, if we overrode that we should use the override value
-		if (targetChannels != 0)
-			numChannels = targetChannels;
+		int width = image->Width;
+		int height = image->Height;
+		int numChannels = image->Channels;
 
 		// We'll determine a recommended format for the image based on number of channels
 		// We hinted that we wanted a certain number of channels, but we're not guaranteed
@@ -189,16 +233,38 @@ void Texture2D::_LoadDataFromFile() {
 		// Allocates our memory
 		_SetTextureParams();
 
-		// Upload data to our texture
-		LoadData(width, height, image_format, PixelType::UByte, data);
-
-		// We now have data in the image, we can clear the STBI data
-		stbi_image_free(data);
+		// Upload data to our texture, the decoded image will be freed once it goes out of scope
+		LoadData(width, height, image_format, PixelType::UByte, image->Data);
 	}
 	
 	SetDebugName(_description.Filename);
 }
 
+bool Texture2D::_LoadCookedFile() {
+	TextureCooker::CookedTexture cooked;
+	if (!TextureCooker::LoadCookedFile(TextureCooker::GetCookedPath(_description.Filename), cooked)) {
+		return false;
+	}
+
+	// Update our description to match what we loaded
+	_description.Format = cooked.Format;
+	_description.Width  = cooked.Width;
+	_description.Height = cooked.Height;
+	_pixelType = PixelType::Unknown;
+
+	// Allocates our memory, the cooked file contains the entire mip chain so we will allocate the same number of levels
+	_SetTextureParams();
+
+	// If mips are disabled, we only need the top level
+	size_t numLevels = _description.GenerateMipMaps ? cooked.Levels.size() : 1;
+	for (size_t ix = 0; ix < numLevels; ix++) {
+		const TextureCooker::Level& level = cooked.Levels[ix];
+		glCompressedTextureSubImage2D(_rendererId, (GLint)ix, 0, 0, level.Width, level.Height, *cooked.Format, (GLsizei)level.Size, level.Data);
+	}
+
+	return true;
+}
+
 void Texture2D::_SetTextureParams() {
 	// If we have a multisampled texture, and the current type is 2D, change it to 2D multisampled
 	if (_description.MultisampleCount > 1 && _type == TextureType::_2D) {
@@ -62,6 +62,12 @@ struct Texture2DDescription {
 	/// </summary>
 	PixelFormat    FormatHint;
 
+	/// <summary>
+	/// True if a cooked (block compressed) version of the file should be loaded in place of
+	/// the source image when one exists, default true. See TextureCooker
+	/// </summary>
+	bool           UseCookedIfAvailable;
+
 	Texture2DDescription() :
 		Width(0), Height(0),
 		Format(InternalFormat::Unknown),
@@ -74,7 +80,8 @@ struct Texture2DDescription {
 		MultisampleCount(1),
 		Filename(""),
 		FormatHint(PixelFormat::RGBA),
-		EnableShadowSampling(false)
+		EnableShadowSampling(false),
+		UseCookedIfAvailable(true)
 	{ }
 };
 
@@ -146,17 +153,34 @@ public:
 
 	virtual nlohmann::json ToJson() const override;
 	static Texture2D::Sptr FromJson(const nlohmann::json& data);
+	/// <summary>
+	/// Starts decoding the image referenced by a manifest entry in the background,
+	/// so that the following call to FromJson can skip decoding
+	/// </summary>
+	static void PrefetchFromJson(const nlohmann::json& data);
 
 protected:
 	Texture2DDescription _description;
 	PixelType _pixelType;
 
+	/// <summary>
+	/// Reads the description of a texture from it's manifest entry, shared by FromJson and PrefetchFromJson
+	/// so that prefetched images are decoded exactly as the texture will request them
+	/// </summary>
+	static Texture2DDescription _DescriptionFromJson(const nlohmann::json& data);
+
 	/// <summary>
 	/// Loads this texture from the file specified in the description
 	/// Will overwrite description size
 	/// </summary>
 	void _LoadDataFromFile();
 	/// <summary>
+	/// Loads this texture from the cooked version of the file specified in the description,
+	/// uploading the pre-compressed mip chain directly
+	/// </summary>
+	/// <returns>True if the cooked file was loaded</returns>
+	bool _LoadCookedFile();
+	/// <summary>
 	/// Allocates our texture's memory and sets sampling / filtering parameters
 	/// </summary>
 	void _SetTextureParams();
@@ -2,16 +2,40 @@
 #include "Utils/Base64.h"
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/StringUtils.h"
+#include "Utils/MemoryMappedFile.h"
 #include <Logging.h>
-#include <stb_image.h>
 #include <iostream>
 #include <fstream>
 #include <filesystem>
+#include <charconv>
+#include <string_view>
+#include <GLM/gtc/packing.hpp>
+
+const char LUT_HEADER_BYTES[4] = { 'B', 'L', 'U', 'T' };
+const std::string lutCacheExtension = ".lut";
 
 inline int CalcRequiredMipLevels(int width, int height, int depth) {
 	return (1 + floor(log2(std::max(width, std::max(height, depth)))));
 }
 
+/// <summary>
+/// Advances the cursor past any spaces and tabs, and optionally line breaks
+/// </summary>
+inline const char* SkipWhitespace(const char* cursor, const char* end, bool skipNewLines) {
+	while (cursor < end && (*cursor == ' ' || *cursor == '\t' || (skipNewLines && (*cursor == '\r' || *cursor == '\n')))) {
+		cursor++;
+	}
+	return cursor;
+}
+
+inline bool IsNumberStart(char c) {
+	return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.';
+}
+
+inline bool StartsWith(std::string_view line, std::string_view token) {
+	return line.size() >= token.size() && line.compare(0, token.size(), token) == 0;
+}
+
 Texture3D::Texture3D(const std::string& filePath) : 
 	ITexture(TextureType::_3D),
 	_description(Texture3DDescription()),
@@ -55,10 +79,15 @@ void Texture3D::LoadData(uint32_t width, uint32_t height, uint32_t depth, PixelF
 	// See https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glPixelStore.xhtml
 	int componentSize = (GLint)GetTexelComponentSize(type);
 	glPixelStorei(GL_PACK_ALIGNMENT, componentSize);
+	// Our data is tightly packed, so we need to relax the unpack alignment for RGB data (ex: 33^3 LUTs)
+	glPixelStorei(GL_UNPACK_ALIGNMENT, componentSize);
 
 	// Upload our data to our image
 	glTextureSubImage3D(_rendererId, 0, offsetX, offsetY, offsetZ, width, height, depth, (GLenum)format, (GLenum)type, data);
 
+	// Restore the default unpack alignment so we don't affect other uploads
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
 	// If requested, generate mip-maps for our texture
 	if (_description.GenerateMipMaps) {
 		glGenerateTextureMipmap(_rendererId); 
@@ -74,6 +103,8 @@ nlohmann::json Texture3D::ToJson() const
 		{ "filter_min",       ~_description.MinificationFilter },
 		{ "filter_mag",       ~_description.MagnificationFilter },
 		{ "generate_mipmaps",  _description.GenerateMipMaps },
+		{ "internal_format",  ~_description.Format },
+		{ "use_cache",         _description.UseBinaryCache },
 	};
 
 	if (!_description.Filename.empty()) {
@@ -114,6 +145,8 @@ Texture3D::Sptr Texture3D::FromJson(const nlohmann::json& data)
 	description.MagnificationFilter = JsonParseEnum(MagFilter, data, "filter_mag", MagFilter::Linear);
 	description.GenerateMipMaps = JsonGet(data, "generate_mipmaps", false);
 	description.FormatHint = JsonParseEnum(PixelFormat, data, "format", PixelFormat::Unknown);
+	description.Format = JsonParseEnum(InternalFormat, data, "internal_format", InternalFormat::Unknown);
+	description.UseBinaryCache = JsonGet(data, "use_cache", true);
 
 	Texture3D::Sptr result = std::make_shared<Texture3D>(description);
 
@@ -149,125 +182,215 @@ void Texture3D::_LoadDataFromFile()
 
 void Texture3D::_LoadCubeFile()
 {
-	std::ifstream inFile(_description.Filename);
+	// Only RGB16F and RGB8 are supported for LUTs
+	if (_description.Format != InternalFormat::RGB16F) {
+		_description.Format = InternalFormat::RGB8;
+	}
+	const bool isHalf = _description.Format == InternalFormat::RGB16F;
+	const size_t texelSize = isHalf ? sizeof(glm::u16vec3) : sizeof(glm::u8vec3);
 
-	if (!inFile.is_open()) {
-		LOG_WARN("Failed to open file .cube file: {}", _description.Filename);
+	// If we have an up to date binary version of the LUT we can skip parsing entirely
+	std::string cachePath = std::filesystem::path(_description.Filename).replace_extension(lutCacheExtension).string();
+	if (_description.UseBinaryCache && _LoadLutCache(cachePath)) {
 		return;
 	}
 
-	glm::u8vec3* textureData = nullptr;
-	uint32_t lutSize{ 0 };
-	uint32_t ix{ 0 };
-	glm::vec3 rgb { 0, 0, 0 };
+	MemoryMappedFile file(_description.Filename);
+	if (!file.IsOpen()) {
+		LOG_WARN("Failed to open .cube file {}", _description.Filename);
+		return;
+	}
 
-	std::string line;
-	// Iterate as long as we have lines from the file
-	while (std::getline(inFile, line)) {
+	const char* cursor = reinterpret_cast<const char*>(file.GetData());
+	const char* end = cursor + file.GetSize();
 
-		// Trim whitespace from start and end of the line
-		StringTools::Trim(line);
+	std::vector<uint8_t> textureData;
+	std::string title;
+	uint32_t lutSize{ 0 };
+	size_t numTexels{ 0 };
+	size_t ix{ 0 };
+
+	// Iterate over the file one line at a time, without copying any of the lines
+	while (cursor < end) {
+		// Skip whitespace (and empty lines) before the line content
+		cursor = SkipWhitespace(cursor, end, true);
+		if (cursor >= end) {
+			break;
+		}
 
-		// Skip empty lines
-		if (line.empty()) {
-			continue;
+		const char* lineEnd = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+		if (lineEnd == nullptr) {
+			lineEnd = end;
 		}
+		std::string_view line(cursor, lineEnd - cursor);
+		cursor = lineEnd;
 
 		// Skip comments
-		else if (line[0] == '#') {
+		if (line[0] == '#') {
 			continue;
 		}
 
-		// Handle sizing the LUT
-		else if (line.find("LUT_3D_SIZE") != std::string::npos) {
+		// Reading data lines, these are by far the most common so we check them first
+		else if (IsNumberStart(line[0])) {
+			if (textureData.empty()) {
+				continue;
+			}
 
-			// Skip over the LUT_3D_SIZE text and read in the value
-			std::stringstream lReader(line.substr(12));
-			lReader >> lutSize;
+			// Make sure we don't case a write access violation
+			if (ix >= numTexels) {
+				LOG_ASSERT(false, "Attempting to write outside the bounds of the LUT");
+				break;
+			}
+
+			// Read RGB from the line
+			glm::vec3 rgb{ 0, 0, 0 };
+			const char* value = line.data();
+			const char* valueEnd = line.data() + line.size();
+			for (int c = 0; c < 3; c++) {
+				value = SkipWhitespace(value, valueEnd, false);
+				value = std::from_chars(value, valueEnd, rgb[c]).ptr;
+			}
+
+			rgb = glm::clamp(rgb, glm::vec3(0), glm::vec3(1));
+
+			// Store in the array, either as half floats or converting to the correct scale for bytes
+			if (isHalf) {
+				glm::u16vec3* texel = reinterpret_cast<glm::u16vec3*>(textureData.data()) + ix;
+				texel->r = glm::packHalf1x16(rgb.r);
+				texel->g = glm::packHalf1x16(rgb.g);
+				texel->b = glm::packHalf1x16(rgb.b);
+			} else {
+				glm::u8vec3* texel = reinterpret_cast<glm::u8vec3*>(textureData.data()) + ix;
+				texel->r = static_cast<uint8_t>(rgb.r * 255);
+				texel->g = static_cast<uint8_t>(rgb.g * 255);
+				texel->b = static_cast<uint8_t>(rgb.b * 255);
+			}
+
+			// Move to the next texel
+			ix++;
+		}
+
+		// Handle sizing the LUT
+		else if (StartsWith(line, "LUT_3D_SIZE")) {
+			const char* value = SkipWhitespace(line.data() + 11, line.data() + line.size(), false);
+			std::from_chars(value, line.data() + line.size(), lutSize);
 
 			// Update the description's size
 			_description.Width = _description.Height = _description.Depth = lutSize;
 
 			// If the size we read is non-zero, allocate our data!
 			if (lutSize > 0) {
-				// If we had data already, delete it
-				if (textureData != nullptr) {
-					delete[] textureData;
-				} 
-
-				// Allocate data to store texels in
-				textureData = new glm::u8vec3[(size_t)lutSize * lutSize * lutSize];
+				numTexels = (size_t)lutSize * lutSize * lutSize;
+				textureData.assign(numTexels * texelSize, 0);
 				ix = 0;
 			}
 		}
 
 		// We'll grab the title for our debug name, nice lil use of it
-		else if (line.find("TITLE") != std::string::npos) {
+		else if (StartsWith(line, "TITLE")) {
+			// Skip over the TITLE token and trim any excess whitespace
+			title = std::string(line.substr(5));
+			StringTools::Trim(title);
+
+			// We'll store this in the debug name
+			SetDebugName(title);
+		}
 
-			// Skip over the TITLE token and the space after it
-			std::string name = line.substr(6);
+		// DOMAIN_MIN, DOMAIN_MAX and LUT_1D_SIZE are ignored for now
+	}
 
-			// Trim any excess whitespace
-			StringTools::Trim(name);
+	if (!textureData.empty()) {
+		_UploadLut(lutSize, textureData.data());
 
-			// We'll store this in the debug name
-			SetDebugName(name);
+		if (_description.UseBinaryCache) {
+			_SaveLutCache(cachePath, title, textureData.data(), textureData.size());
 		}
+	}
+	else {
+		LOG_WARN("Failed to load cube file: \"{}\"", _description.Filename);
+	}
+}
 
-		else if (line.find("DOMAIN_MIN") != std::string::npos)
-		{ /* ignore for now */ }
+bool Texture3D::_LoadLutCache(const std::string& cachePath)
+{
+	// Make sure the cache exists and is at least as new as the source file
+	std::error_code error;
+	if (!std::filesystem::exists(cachePath, error) ||
+		std::filesystem::last_write_time(cachePath, error) < std::filesystem::last_write_time(_description.Filename, error)) {
+		return false;
+	}
 
-		else if (line.find("DOMAIN_MAX") != std::string::npos)
-		{ /* ignore for now */ }
+	MemoryMappedFile file(cachePath);
+	if (!file.IsOpen() || file.GetSize() < sizeof(LutCacheHeader)) {
+		return false;
+	}
 
-		else if (line.find("LUT_1D_SIZE") != std::string::npos)
-		{ /* ignore for now */ }
+	const LutCacheHeader* header = reinterpret_cast<const LutCacheHeader*>(file.GetData());
+	if (memcmp(header->HeaderBytes, LUT_HEADER_BYTES, 4) != 0 || header->Version != 0x01) {
+		LOG_WARN("\"{}\" is not a valid LUT cache, ignoring", cachePath);
+		return false;
+	}
 
-		// Reading data lines
-		else if (!line.empty() && textureData != nullptr) {
+	// The cache was generated for a different precision, we'll re-parse the LUT
+	if (header->Format != _description.Format) {
+		return false;
+	}
 
-			// Make sure we don't case a write access violation
-			if (ix >= (lutSize * lutSize * lutSize) && lutSize > 0) {
-				LOG_ASSERT(false, "Attempting to write outside the bounds of the LUT");
-			}
+	size_t texelSize = header->Format == InternalFormat::RGB16F ? sizeof(glm::u16vec3) : sizeof(glm::u8vec3);
+	size_t dataSize = texelSize * header->Size * header->Size * header->Size;
+	if (file.GetSize() < sizeof(LutCacheHeader) + header->TitleLength + dataSize) {
+		LOG_WARN("LUT cache \"{}\" is truncated, ignoring", cachePath);
+		return false;
+	}
 
-			// Read RGB from the line
-			std::stringstream lReader(line);
-			lReader >> rgb.r >> rgb.g >> rgb.b;
+	const char* title = reinterpret_cast<const char*>(file.GetData() + sizeof(LutCacheHeader));
+	if (header->TitleLength > 0) {
+		SetDebugName(std::string(title, header->TitleLength));
+	}
 
-			rgb = glm::clamp(rgb, glm::vec3(0), glm::vec3(1));
+	_description.Width = _description.Height = _description.Depth = header->Size;
+	_UploadLut(header->Size, file.GetData() + sizeof(LutCacheHeader) + header->TitleLength);
+	return true;
+}
 
-			// Store in the array, converting to the correct scale for bytes
-			textureData[ix].r = static_cast<uint8_t>(rgb.r * 255);
-			textureData[ix].g = static_cast<uint8_t>(rgb.g * 255);
-			textureData[ix].b = static_cast<uint8_t>(rgb.b * 255);
+void Texture3D::_SaveLutCache(const std::string& cachePath, const std::string& title, const void* data, size_t dataSize)
+{
+	std::ofstream file(cachePath, std::ios::binary);
+	if (!file) {
+		LOG_WARN("Failed to write LUT cache \"{}\"", cachePath);
+		return;
+	}
 
-			// Move to the next texel
-			ix++;
-		}
-	} 
+	LutCacheHeader header = LutCacheHeader();
+	header.Version     = 0x01; // This is version 1! Update this and implement different readers if changes to format are made
+	header.TitleLength = static_cast<uint16_t>(title.size());
+	header.Size        = _description.Width;
+	header.Format      = _description.Format;
 
-	if (textureData != nullptr) {
-		// Set the pixel format
-		_description.Format = InternalFormat::RGB8;
-		// We need to clamp to edge for LUTS
-		_description.WrapS = _description.WrapT = _description.WrapR = WrapMode::ClampToEdge;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(LutCacheHeader));
+	file.write(title.data(), header.TitleLength);
+	file.write(reinterpret_cast<const char*>(data), dataSize);
+}
 
-		// Allocate data and configure params
-		_SetTextureParams();
-		// Load data
-		LoadData(lutSize, lutSize, lutSize, PixelFormat::RGB, PixelType::UByte, textureData);
+void Texture3D::_UploadLut(uint32_t lutSize, const void* data)
+{
+	// We need to clamp to edge for LUTS
+	_description.WrapS = _description.WrapT = _description.WrapR = WrapMode::ClampToEdge;
 
-		// Clean up after ourselves
-		delete[] textureData;
-	}
-	else {
-		LOG_WARN("Failed to load cube file: \"{}\"", _description.Filename);
-	}
+	// Allocate data and configure params
+	_SetTextureParams();
+	// Load data
+	PixelType type = _description.Format == InternalFormat::RGB16F ? PixelType::HalfFloat : PixelType::UByte;
+	LoadData(lutSize, lutSize, lutSize, PixelFormat::RGB, type, const_cast<void*>(data));
 }
 
 void Texture3D::_SetTextureParams()
 {
+	// Make sure the size is greater than zero and that we have a format specified before trying to allocate
+	if ((_description.Width * _description.Height * _description.Depth) == 0 || _description.Format == InternalFormat::Unknown) {
+		return;
+	}
+
 	// Calculate how many layers of storage to allocate based on whether mipmaps are enabled or not
 	int layers = _description.GenerateMipMaps ? CalcRequiredMipLevels(_description.Width, _description.Height, _description.Depth) : 1;
 	// Allocates the memory for our texture
@@ -59,6 +59,12 @@ struct Texture3DDescription {
 	/// </summary>
 	PixelFormat    FormatHint;
 
+	/// <summary>
+	/// True if LUTs loaded from .cube files should be cached in a binary file beside the source,
+	/// which can be uploaded directly on the next load, default true
+	/// </summary>
+	bool           UseBinaryCache;
+
 	Texture3DDescription() :
 		Width(0), Height(0), Depth(0),
 		Format(InternalFormat::Unknown),
@@ -69,7 +75,8 @@ struct Texture3DDescription {
 		MagnificationFilter(MagFilter::Linear),
 		GenerateMipMaps(true),
 		Filename(""),
-		FormatHint(PixelFormat::RGBA)
+		FormatHint(PixelFormat::RGBA),
+		UseBinaryCache(true)
 	{ }
 };
 
@@ -156,10 +163,38 @@ protected:
 	/// </summary>
 	void _LoadDataFromFile();
 	/// <summary>
-	/// Loads a 3D LUT from a .cube file
+	/// Loads a 3D LUT from a .cube file. If the description's format is RGB16F the LUT will be stored
+	/// as half floats, otherwise it will be quantized to RGB8
 	/// </summary>
 	void _LoadCubeFile();
 	/// <summary>
+	/// Loads a LUT from the binary cache file, if it is up to date and matches our format
+	/// </summary>
+	/// <returns>True if the cache was loaded</returns>
+	bool _LoadLutCache(const std::string& cachePath);
+	/// <summary>
+	/// Saves a parsed LUT to the binary cache file
+	/// </summary>
+	void _SaveLutCache(const std::string& cachePath, const std::string& title, const void* data, size_t dataSize);
+	/// <summary>
+	/// Allocates a cubic LUT with the description's format and uploads the texel data to it
+	/// </summary>
+	void _UploadLut(uint32_t lutSize, const void* data);
+
+	// Will be put at the start of the binary LUT cache, contains info about the contents of the file
+	struct LutCacheHeader {
+		// A check value so we can ensure that we're loading in the right file type
+		char           HeaderBytes[4] = { 'B', 'L', 'U', 'T' };
+		// The version code, we can use this to create different loaders if our format changes
+		uint16_t       Version = 0;
+		// The number of characters in the LUT's title, the title follows the header
+		uint16_t       TitleLength = 0;
+		// The size of the LUT along each axis
+		uint32_t       Size = 0;
+		// The format of the texels, either RGB8 or RGB16F
+		InternalFormat Format = InternalFormat::Unknown;
+	};
+	/// <summary>
 	/// Allocates our texture's memory and sets sampling / filtering parameters
 	/// </summary>
 	void _SetTextureParams();
@@ -1,7 +1,28 @@
 #include "TextureCube.h"
 #include <filesystem>
-#include "stb_image.h"
 #include "Utils/JsonGlmHelpers.h"
+#include "Utils/TextureCooker.h"
+#include "Graphics/Textures/ImageDecoder.h"
+#include "Graphics/Buffers/PixelUploadBuffer.h"
+
+/// <summary>
+/// Reads the cubemap description properties from a manifest entry
+/// </summary>
+inline TextureCubeDescription ParseDescription(const nlohmann::json& data) {
+	TextureCubeDescription descr = TextureCubeDescription();
+	descr.MinificationFilter  = JsonParseEnum(MinFilter, data, "filter_min", MinFilter::NearestMipNearest);
+	descr.MagnificationFilter = JsonParseEnum(MagFilter, data, "filter_mag", MagFilter::Linear);
+	descr.Filename       = JsonGet<std::string>(data, "base_filename", "");
+	if (data.contains("face_filenames") && data["face_filenames"].is_object()) {
+		for (auto& [key, value] : data["face_filenames"].items()) {
+			CubeMapFace face = ParseCubeMapFace(key, CubeMapFace::Unknown);
+			if (face != CubeMapFace::Unknown) {
+				descr.FaceFileNames[face] = value;
+			}
+		}
+	}
+	return descr;
+}
 
 TextureCube::TextureCube(const std::string& baseFilename) :
 	ITexture(TextureType::Cubemap),
@@ -46,27 +67,30 @@ nlohmann::json TextureCube::ToJson() const
 
 TextureCube::Sptr TextureCube::FromJson(const nlohmann::json& data)
 {
-	TextureCubeDescription descr = TextureCubeDescription();
-	descr.MinificationFilter  = JsonParseEnum(MinFilter, data, "filter_min", MinFilter::NearestMipNearest);
-	descr.MagnificationFilter = JsonParseEnum(MagFilter, data, "filter_mag", MagFilter::Linear);
-	descr.Filename       = JsonGet<std::string>(data, "base_filename", "");
-	if (data.contains("face_filenames") && data["face_filenames"].is_object()) {
-		for (auto& [key, value] : data["face_filenames"].items()) {
-			CubeMapFace face = ParseCubeMapFace(key, CubeMapFace::Unknown);
-			if (face != CubeMapFace::Unknown) {
-				descr.FaceFileNames[face] = value;
+	return std::make_shared<TextureCube>(ParseDescription(data));
+}
+
+void TextureCube::PrefetchFromJson(const nlohmann::json& data)
+{
+	TextureCubeDescription descr = ParseDescription(data);
+	_ResolveFaceFilenames(descr);
+
+	if (descr.FaceFileNames.size() == 6) {
+		for (const auto& [face, filename] : descr.FaceFileNames) {
+			// Cooked faces are uploaded straight from the mapped file
+			if (!TextureCooker::HasCookedFile(filename)) {
+				ImageDecoder::Prefetch(filename, 0);
 			}
 		}
 	}
-	return std::make_shared<TextureCube>(descr);
 }
 
-void TextureCube::_LoadFromDescription()
+void TextureCube::_ResolveFaceFilenames(TextureCubeDescription& description)
 {
 	// If we weren't passed face filenames but WERE passed a base filename, try and get the 6 face files
-	if (_description.FaceFileNames.empty() && !_description.Filename.empty()) {
+	if (description.FaceFileNames.empty() && !description.Filename.empty()) {
 		// Get the file path and it's directory to extract the root file name w/o extension
-		std::filesystem::path baseName = std::filesystem::absolute(std::filesystem::path(_description.Filename));
+		std::filesystem::path baseName = std::filesystem::absolute(std::filesystem::path(description.Filename));
 		std::filesystem::path directory = baseName.parent_path();
 		std::filesystem::path rootFileName = directory / baseName.stem();
 
@@ -83,10 +107,15 @@ void TextureCube::_LoadFromDescription()
 
 			// If the file exists, store it in the description
 			if (std::filesystem::exists(targetPath)) {
-				_description.FaceFileNames[face] = targetPath.string();
+				description.FaceFileNames[face] = targetPath.string();
 			}
 		}
 	}
+}
+
+void TextureCube::_LoadFromDescription()
+{
+	_ResolveFaceFilenames(_description);
 
 	// If we don't have 6 faces for our cube, something has gone horribly wrong (or the files don't exist)
 	if (_description.FaceFileNames.size() != 6) {
@@ -100,70 +129,49 @@ void TextureCube::_LoadFromDescription()
 
 void TextureCube::_LoadImages(const std::unordered_map<CubeMapFace, std::string>& faceFilenames)
 {
-	// Will store all of our texture data, back to back in memory
-	uint8_t* datastore = nullptr;
-	// The size of a single face's texture, in bytes
-	size_t textureDataSize = 0;
+	// If all the faces have been cooked, we can skip decoding entirely
+	if (_LoadCookedImages(faceFilenames)) {
+		return;
+	}
 
-	// The number of channels that we're expecting
-	int numChannels = 0;
+	// Kick off decoding for all 6 faces at once, they'll decode in parallel on the thread pool
+	ImageDecoder::Future pending[6];
+	for (int ix = 0; ix < 6; ix++) {
+		pending[ix] = ImageDecoder::LoadAsync(faceFilenames.at((CubeMapFace)ix), 0);
+	}
 
-	// Load all 6 faces
+	// Wait for all the faces, and make sure they're all compatible
+	DecodedImage::Sptr faces[6];
 	for (int ix = 0; ix < 6; ix++) {
-		CubeMapFace face = (CubeMapFace)ix;
-		
-		const std::string& filename = _description.FaceFileNames[face];
-		int fileWidth, fileHeight, fileNumChannels;
-
-		// Use STBI to load the image
-		stbi_set_flip_vertically_on_load(true);
-		uint8_t* data = stbi_load(filename.c_str(), &fileWidth, &fileHeight, &fileNumChannels, 0);
-
-		// If we could not load any data, warn and return null
-		if (data == nullptr) {
-			if (data != nullptr) { delete[] datastore; }
-			LOG_ERROR("STBI Failed to load image from \"{}\"", filename);
+		const std::string& filename = faceFilenames.at((CubeMapFace)ix);
+		faces[ix] = pending[ix].get();
+
+		// If we could not load any data, the decoder will have warned us
+		if (faces[ix] == nullptr) {
+			LOG_ERROR("Failed to load cubemap face from \"{}\"", filename);
 			return;
 		}
 		// If the texture is not square, warn and abort
-		if (fileWidth != fileHeight) {
-			if (data != nullptr) { delete[] datastore; }
+		if (faces[ix]->Width != faces[ix]->Height) {
 			LOG_ERROR("Image loaded from \"{}\" was not square", filename);
-			stbi_image_free(data);
 			return;
 		}
-		// If the dataStore is empty, this is the first texture we loaded
-		if (datastore == nullptr) {
-			// Store the size and number of channels
-			_description.Size = fileWidth;
-			numChannels = fileNumChannels;
-
-			// Get the format and pixel format for the number of channels
-			_description.Format = GetInternalFormatForChannels8(numChannels);
-			_description.FormatHint = GetPixelFormatForChannels(numChannels);
-
-			// Determine how many bytes we'll need to store a single face worth of data
-			textureDataSize = ((size_t)_description.Size * _description.Size * GetTexelSize(_description.FormatHint, PixelType::Byte));
-
-			// This is one of those poorly documented things in OpenGL
-			if ((GetTexelSize(_description.FormatHint, PixelType::Byte) * _description.Size) % 4 != 0) {
-				LOG_WARN("The alignment of a horizontal line is not a multiple of 4, this will require a call to glPixelStorei(GL_PACK_ALIGNMENT)");
-			}
-
-			// Allocate the data store for our image data
-			datastore = new uint8_t[textureDataSize * 6];
-		}
-		// If this is NOT the first image, and it does not match previous images, abort
-		else if (fileWidth != _description.Size || fileNumChannels != numChannels) {
-			delete[] datastore;
+		// If it does not match the first face, abort
+		if (faces[ix]->Width != faces[0]->Width || faces[ix]->Channels != faces[0]->Channels) {
 			LOG_WARN("Image \"{}\" did not match size or format of texture cube", filename);
-			stbi_image_free(data);
 			return;
 		}
+	}
+
+	// Store the size, and get the format and pixel format for the number of channels
+	_description.Size = faces[0]->Width;
+	_description.Format = GetInternalFormatForChannels8(faces[0]->Channels);
+	_description.FormatHint = GetPixelFormatForChannels(faces[0]->Channels);
 
-		// Copy the data we loaded into the corresponding location in the data store
-		memcpy(datastore + textureDataSize * ix, data, textureDataSize);
-		stbi_image_free(data);
+	// This is one of those poorly documented things in OpenGL
+	size_t rowSize = GetTexelSize(_description.FormatHint, PixelType::UByte) * _description.Size;
+	if (rowSize % 4 != 0) {
+		LOG_WARN("The alignment of a horizontal line is not a multiple of 4, this will require a call to glPixelStorei(GL_PACK_ALIGNMENT)");
 	}
 
 	// Allocate memory and set up initial parameters
@@ -172,9 +180,45 @@ void TextureCube::_LoadImages(const std::unordered_map<CubeMapFace, std::string>
 	// Set our pixel alignment to a single byte so we don't get banding
 	glPixelStorei(GL_PACK_ALIGNMENT, 1);
 
-	// Upload our data to our image (note that the custom enum tools let us convert to base type [GLenum] with the * operator)
-	glTextureSubImage3D(_rendererId, 0, 0, 0, 0, _description.Size, _description.Size, 6, *_description.FormatHint, *PixelType::UByte, datastore);
-	delete[] datastore;
+	// Upload each face to its layer of the cube, streaming through the shared PBO ring (note that the custom enum tools
+	// let us convert to base type [GLenum] with the * operator)
+	for (int ix = 0; ix < 6; ix++) {
+		PixelUploadBuffer::GetShared()->Upload(faces[ix]->Data, rowSize, _description.Size, [&](const void* pixels) {
+			glTextureSubImage3D(_rendererId, 0, 0, 0, ix, _description.Size, _description.Size, 1, *_description.FormatHint, *PixelType::UByte, pixels);
+		});
+	}
+}
+
+bool TextureCube::_LoadCookedImages(const std::unordered_map<CubeMapFace, std::string>& faceFilenames)
+{
+	TextureCooker::CookedTexture faces[6];
+
+	for (int ix = 0; ix < 6; ix++) {
+		const std::string& filename = faceFilenames.at((CubeMapFace)ix);
+		if (!TextureCooker::HasCookedFile(filename) || !TextureCooker::LoadCookedFile(TextureCooker::GetCookedPath(filename), faces[ix])) {
+			return false;
+		}
+
+		// All faces must be square, and match the first face
+		if (faces[ix].Width != faces[ix].Height || faces[ix].Width != faces[0].Width || faces[ix].Format != faces[0].Format) {
+			LOG_WARN("Cooked image for \"{}\" did not match size or format of texture cube, falling back to source images", filename);
+			return false;
+		}
+	}
+
+	_description.Size = faces[0].Width;
+	_description.Format = faces[0].Format;
+
+	// Allocate memory and set up initial parameters
+	_SetTextureParams();
+
+	// Cubemaps only use the top level, so we only upload the first level of each face
+	for (int ix = 0; ix < 6; ix++) {
+		const TextureCooker::Level& level = faces[ix].Levels[0];
+		glCompressedTextureSubImage3D(_rendererId, 0, 0, 0, ix, level.Width, level.Height, 1, *_description.Format, (GLsizei)level.Size, level.Data);
+	}
+
+	return true;
 }
 
 void TextureCube::_SetTextureParams(){
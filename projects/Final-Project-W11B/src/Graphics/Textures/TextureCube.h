@@ -110,12 +110,27 @@ public:
 
 	virtual nlohmann::json ToJson() const override;
 	static TextureCube::Sptr FromJson(const nlohmann::json& data);
+	/// <summary>
+	/// Starts decoding the faces referenced by a manifest entry in the background,
+	/// so that the following call to FromJson can skip decoding
+	/// </summary>
+	static void PrefetchFromJson(const nlohmann::json& data);
 
 protected:
 	TextureCubeDescription _description;
 
 	virtual void _LoadFromDescription();
+	/// <summary>
+	/// If the description has a base filename but no face filenames, searches for the
+	/// 6 face files and stores them in the description
+	/// </summary>
+	static void _ResolveFaceFilenames(TextureCubeDescription& description);
 	virtual void _LoadImages(const std::unordered_map<CubeMapFace, std::string>& faceFilenames);
+	/// <summary>
+	/// Attempts to load all 6 faces from their cooked (block compressed) files
+	/// </summary>
+	/// <returns>True if every face had a valid cooked file and was uploaded</returns>
+	bool _LoadCookedImages(const std::unordered_map<CubeMapFace, std::string>& faceFilenames);
 
 	/// <summary>
 	/// Allocates our texture's memory and sets sampling / filtering parameters
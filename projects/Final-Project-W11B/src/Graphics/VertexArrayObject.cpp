@@ -2,13 +2,23 @@
 #include "Buffers/IndexBuffer.h"
 #include "Buffers/VertexBuffer.h"
 #include "Logging.h"
+#include "Graphics/VertexParamMap.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
 
 VertexArrayObject::VertexArrayObject() :
 	_indexBuffer(nullptr),
 	_handle(0),
 	_vertexCount(0),
 	_elementCount(0),
-	_vertexBuffers(std::vector<VertexBufferBinding*>())
+	_vertexBuffers(std::vector<VertexBufferBinding*>()),
+	_enabledSlots(0),
+	_positionDequantize(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)),
+	_boundsMin(glm::vec3(0.0f)),
+	_boundsMax(glm::vec3(0.0f)),
+	_hasBounds(false)
 {
 	glCreateVertexArrays(1, &_handle);
 }
@@ -24,6 +34,8 @@ VertexArrayObject::~VertexArrayObject()
 void VertexArrayObject::SetIndexBuffer(const IndexBuffer::Sptr& ibo) {
 	// TODO: What if we already have a buffer? should we delete it? who owns the buffer?
 	_indexBuffer = ibo;
+	// Levels of detail are ranges of the old buffer, so they no longer apply
+	_lods.clear();
 	Bind();
 	if (_indexBuffer != nullptr) {
 		_indexBuffer->Bind();
@@ -58,6 +70,7 @@ VertexArrayObject::VertexBufferBinding* VertexArrayObject::AddVertexBuffer(const
 	buffer->Bind();
 	for (const BufferAttribute& attrib : attributes) {
 		glEnableVertexArrayAttrib(_handle, attrib.Slot);
+		_enabledSlots |= 1u << attrib.Slot;
 		glVertexAttribPointer(attrib.Slot, attrib.Size, (GLenum)attrib.Type, attrib.Normalized, attrib.Stride,
 							  (void*)attrib.Offset);
 
@@ -89,6 +102,7 @@ void VertexArrayObject::ReplaceVertexBuffer(VertexBufferBinding* binding, const
 		buffer->Bind();
 		for (const BufferAttribute& attrib : binding->Attributes) {
 			glEnableVertexArrayAttrib(_handle, attrib.Slot);
+			_enabledSlots |= 1u << attrib.Slot;
 			glVertexAttribPointer(attrib.Slot, attrib.Size, (GLenum)attrib.Type, attrib.Normalized, attrib.Stride,
 				(void*)attrib.Offset);
 
@@ -103,6 +117,7 @@ void VertexArrayObject::ReplaceVertexBuffer(VertexBufferBinding* binding, const
 
 void VertexArrayObject::Draw(DrawMode mode) {
 	Bind();
+	_ApplyConstantAttributes();
 	if (_indexBuffer == nullptr) {
 		uint32_t elements = _elementCount == 0 ? _vertexBuffers[0]->Buffer->GetElementCount() : _elementCount;
 		glDrawArrays((GLenum)mode, 0, elements);
@@ -113,9 +128,26 @@ void VertexArrayObject::Draw(DrawMode mode) {
 	Unbind();
 }
 
+void VertexArrayObject::DrawLod(uint32_t lod, DrawMode mode /*= DrawMode::TriangleList*/) {
+	// Level 0 is always the regular draw
+	if (lod == 0 || lod >= _lods.size() || _indexBuffer == nullptr) {
+		Draw(mode);
+		return;
+	}
+
+	const LodLevel& level = _lods[lod];
+	size_t byteOffset = level.IndexOffset * GetIndexTypeSize(_indexBuffer->GetElementType());
+
+	Bind();
+	_ApplyConstantAttributes();
+	glDrawElements((GLenum)mode, level.IndexCount, (GLenum)_indexBuffer->GetElementType(), (void*)byteOffset);
+	Unbind();
+}
+
 void VertexArrayObject::DrawInstanced(uint32_t instanceCount, DrawMode mode /*= DrawMode::TriangleList*/)
 {
 	Bind();
+	_ApplyConstantAttributes();
 	if (_indexBuffer == nullptr) {
 		uint32_t elements = _elementCount == 0 ? _vertexBuffers[0]->Buffer->GetElementCount() : _elementCount;
 		glDrawArraysInstanced((GLenum)mode, 0, elements, instanceCount);
@@ -177,7 +209,72 @@ VertexArrayObject::Sptr VertexArrayObject::Clone() const
 	}
 
 	result->SetVDecl(_vDecl);
+	result->SetPositionDequantize(_positionDequantize);
+	if (_hasBounds) {
+		result->SetBounds(_boundsMin, _boundsMax);
+	}
+	if (!_lods.empty()) {
+		result->SetLods(_lods);
+	}
 
 	return result;
 }
 
+void VertexArrayObject::SetLods(const std::vector<LodLevel>& lods) {
+	LOG_ASSERT(lods.empty() || _indexBuffer != nullptr, "Levels of detail require an index buffer");
+	_lods = lods;
+
+	// Regular draws and anything reading the mesh back (such as colliders) only use the full detail level
+	if (!_lods.empty()) {
+		_elementCount = _lods[0].IndexCount;
+	}
+}
+
+uint32_t VertexArrayObject::SelectLod(float maxError) const {
+	// Levels are ordered by error, so we walk forward until we find one that's too coarse
+	uint32_t result = 0;
+	for (uint32_t ix = 1; ix < _lods.size() && _lods[ix].Error <= maxError; ix++) {
+		result = ix;
+	}
+	return result;
+}
+
+void VertexArrayObject::SetBounds(const glm::vec3& min, const glm::vec3& max) {
+	_boundsMin = min;
+	_boundsMax = max;
+	_hasBounds = true;
+}
+
+void VertexArrayObject::CalculateBounds(const void* vertexData, uint32_t vertexCount, const VertexDeclaration& vDecl) {
+	VertexParamMap vMap(vDecl);
+	vMap.PositionDequantize = _positionDequantize;
+	if (!vMap.HasPosition() || vertexData == nullptr || vertexCount == 0) {
+		return;
+	}
+
+	const uint8_t* data = static_cast<const uint8_t*>(vertexData);
+	size_t stride = vDecl[0].Stride;
+	glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+	for (uint32_t ix = 0; ix < vertexCount; ix++) {
+		glm::vec3 position = vMap.GetPosition(data[ix * stride]);
+		min = glm::min(min, position);
+		max = glm::max(max, position);
+	}
+	SetBounds(min, max);
+}
+
+
+void VertexArrayObject::_ApplyConstantAttributes() const {
+	// Attributes without an array read from the context's current attribute values, so every draw sets the
+	// values it needs. This is how packed meshes get their dequantization without needing per-object uniforms
+	glVertexAttrib4fv(DEQUANTIZE_SLOT, &_positionDequantize.x);
+
+	// Packed meshes drop constant white colors and rebuild the bitangent in the shader, which is signalled by a zero bitangent
+	if ((_enabledSlots & (1u << 1)) == 0) {
+		glVertexAttrib4f(1, 1.0f, 1.0f, 1.0f, 1.0f);
+	}
+	if ((_enabledSlots & (1u << 5)) == 0) {
+		glVertexAttrib4f(5, 0.0f, 0.0f, 0.0f, 0.0f);
+	}
+}
@@ -4,6 +4,7 @@
 #include <vector>
 #include <memory>
 #include <EnumToString.h>
+#include <GLM/glm.hpp>
 
 #include "Graphics/Buffers/VertexBuffer.h"
 #include "Graphics/Buffers/IndexBuffer.h"
@@ -126,6 +127,14 @@ public:
 	/// <param name="mode">The draw mode for primitives in this VAO</param>
 	void Draw(DrawMode mode = DrawMode::TriangleList);
 
+	/// <summary>
+	/// Renders a single level of detail of this VAO, using the specified draw mode. Levels that
+	/// don't exist fall back to the full detail mesh
+	/// </summary>
+	/// <param name="lod">The index of the level of detail to draw, where 0 is full detail</param>
+	/// <param name="mode">The draw mode for primitives in this VAO</param>
+	void DrawLod(uint32_t lod, DrawMode mode = DrawMode::TriangleList);
+
 	/// <summary>
 	/// Renders this VAO with the given instance count, using the specified draw mode. 
 	/// Internally this will call glDrawArraysInstanced or glDrawElementsInstanced
@@ -151,6 +160,71 @@ public:
 	void SetVDecl(const VertexDeclaration& vDecl);
 	const VertexDeclaration& GetVDecl();
 
+	/// <summary>
+	/// Sets the object space bounding box of this mesh's vertices, used for spatial queries
+	/// </summary>
+	void SetBounds(const glm::vec3& min, const glm::vec3& max);
+	/// <summary>
+	/// Calculates this mesh's bounds from a CPU side copy of it's vertices, using the position
+	/// attribute from the given vertex declaration. Packed positions are decoded with the current
+	/// position dequantization. Does nothing if there's no position attribute
+	/// </summary>
+	/// <param name="vertexData">The vertex data, interleaved as described by vDecl</param>
+	/// <param name="vertexCount">The number of vertices in the data</param>
+	/// <param name="vDecl">The vertex declaration describing the data</param>
+	void CalculateBounds(const void* vertexData, uint32_t vertexCount, const VertexDeclaration& vDecl);
+	/// <summary>
+	/// Returns true if bounds have been calculated or set for this mesh
+	/// </summary>
+	bool HasBounds() const { return _hasBounds; }
+	const glm::vec3& GetBoundsMin() const { return _boundsMin; }
+	const glm::vec3& GetBoundsMax() const { return _boundsMax; }
+
+	/// <summary>
+	/// The vertex attribute slot that receives the position dequantization parameters as a constant
+	/// attribute, this is the last slot that every GL 4 implementation guarantees
+	/// </summary>
+	static const GLuint DEQUANTIZE_SLOT = 15;
+
+	/// <summary>
+	/// Sets the parameters for turning packed unorm16 positions back into object space, xyz is the
+	/// offset and w is the scale. These are passed to the vertex shader whenever this VAO is drawn,
+	/// and should be left as (0, 0, 0, 1) for float positions
+	/// </summary>
+	void SetPositionDequantize(const glm::vec4& value) { _positionDequantize = value; }
+	const glm::vec4& GetPositionDequantize() const { return _positionDequantize; }
+
+	/// <summary>
+	/// A level of detail for this mesh, which is a range of the index buffer that draws
+	/// a simplified version of the mesh with the same vertices
+	/// </summary>
+	struct LodLevel {
+		// The first index of this level in the index buffer
+		uint32_t IndexOffset = 0;
+		// The number of indices in this level
+		uint32_t IndexCount  = 0;
+		// The largest object space distance between this level and the full detail mesh
+		float    Error       = 0.0f;
+	};
+
+	/// <summary>
+	/// Sets the levels of detail stored in this VAO's index buffer, ordered from most to least detailed,
+	/// where level 0 is the full detail mesh. Must be called after the index buffer has been set
+	/// </summary>
+	/// <param name="lods">The levels of detail, with increasing error</param>
+	void SetLods(const std::vector<LodLevel>& lods);
+	const std::vector<LodLevel>& GetLods() const { return _lods; }
+	/// <summary>
+	/// Returns the number of levels of detail in this mesh, which is always at least 1
+	/// </summary>
+	uint32_t GetLodCount() const { return _lods.empty() ? 1 : static_cast<uint32_t>(_lods.size()); }
+	/// <summary>
+	/// Selects the least detailed level whose error is within the given limit
+	/// </summary>
+	/// <param name="maxError">The largest object space error that is acceptable</param>
+	/// <returns>The index of the level of detail to draw</returns>
+	uint32_t SelectLod(float maxError) const;
+
 protected:
 	
 	// The index buffer bound to this VAO
@@ -165,9 +239,24 @@ protected:
 	uint32_t _vertexCount;
 	uint32_t _elementCount;
 
+	// Bitmask of the vertex attribute slots that have data in this VAO
+	uint32_t  _enabledSlots;
+	glm::vec4 _positionDequantize;
+
+	// The levels of detail in the index buffer, empty if the mesh only has full detail
+	std::vector<LodLevel> _lods;
+
+	// The object space bounds of our positions, if known
+	glm::vec3 _boundsMin;
+	glm::vec3 _boundsMax;
+	bool      _hasBounds;
+
 	// The underlying OpenGL handle that this class is wrapping around
 	GLuint _handle;
 
 	// Inherited via IGraphicsResource
 	virtual GlResourceType GetResourceClass() const override;
+
+	// Sets the constant values for attributes that packed meshes leave out
+	void _ApplyConstantAttributes() const;
 };
@@ -0,0 +1,114 @@
+#include "Graphics/VertexPacker.h"
+
+#include <limits>
+
+#include "Graphics/VertexParamMap.h"
+#include "Logging.h"
+
+PackedVertexData VertexPacker::Pack(const void* vertices, uint32_t vertexCount, const VertexArrayObject::VertexDeclaration& vDecl) {
+	PackedVertexData result;
+	VertexParamMap source(vDecl);
+	LOG_ASSERT(source.HasPosition(), "Cannot pack vertices without a position");
+
+	const uint8_t* data = static_cast<const uint8_t*>(vertices);
+	uint32_t stride = vDecl.empty() ? 0 : vDecl[0].Stride;
+	auto getVertex = [&](uint32_t ix) -> const uint8_t& { return data[(size_t)ix * stride]; };
+
+	// Work out which of the optional attributes actually carry information
+	glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+	bool hasUVs = false;
+	bool hasColors = false;
+	for (uint32_t ix = 0; ix < vertexCount; ix++) {
+		glm::vec3 position = source.GetPosition(getVertex(ix));
+		min = glm::min(min, position);
+		max = glm::max(max, position);
+
+		hasUVs |= source.HasTexture() && source.GetTexture(getVertex(ix)) != glm::vec2(0.0f);
+		// Anything that would round to white in 8 bits is white
+		hasColors |= source.HasColor() && glm::any(glm::lessThan(source.GetColor(getVertex(ix)), glm::vec4(1.0f - 0.5f / 255.0f)));
+	}
+	if (vertexCount == 0) {
+		min = max = glm::vec3(0.0f);
+	}
+	bool hasNormals = source.HasNormal();
+	// Tangents are only used for normal mapping, which needs UVs
+	bool hasTangents = hasUVs && source.HasTangent();
+
+	// Build the packed layout, using the same slots as our float vertex types so that shaders don't care which they get
+	uint32_t offset = 0;
+	auto addAttribute = [&](uint32_t slot, uint32_t size, AttributeType type, uint32_t bytes, AttribUsage usage) {
+		result.VDecl.push_back(BufferAttribute(slot, size, type, 0, offset, usage, true));
+		offset += bytes;
+	};
+	// unorm16 x3, padded to 8 bytes to keep everything after it aligned
+	addAttribute(0, 3, AttributeType::UShort, 8, AttribUsage::Position);
+	if (hasNormals)  { addAttribute(2, 4, AttributeType::Int2_10_10_10_Rev, 4, AttribUsage::Normal); }
+	if (hasUVs)      { addAttribute(3, 2, AttributeType::HalfFloat, 4, AttribUsage::Texture); }
+	if (hasTangents) { addAttribute(4, 4, AttributeType::Int2_10_10_10_Rev, 4, AttribUsage::Tangent); }
+	if (hasColors)   { addAttribute(1, 4, AttributeType::UByte, 4, AttribUsage::Color); }
+	for (auto& attrib : result.VDecl) {
+		attrib.Stride = offset;
+		// Half floats are converted exactly, normalizing only applies to the integer formats
+		attrib.Normalized = attrib.Type != AttributeType::HalfFloat;
+	}
+
+	// Positions are quantized uniformly over the largest axis of the bounds, so that the dequantization fits into a single vec4
+	float extent = glm::max(glm::max(max.x - min.x, max.y - min.y), max.z - min.z);
+	result.PositionDequantize = glm::vec4(min, extent > 0.0f ? extent : 1.0f);
+	result.BoundsMin = min;
+	result.BoundsMax = max;
+	result.Stride = offset;
+	result.VertexCount = vertexCount;
+	result.Data.resize((size_t)offset * vertexCount, 0);
+
+	VertexParamMap target(result.VDecl);
+	target.PositionDequantize = result.PositionDequantize;
+	for (uint32_t ix = 0; ix < vertexCount; ix++) {
+		const uint8_t& in = getVertex(ix);
+		uint8_t& out = result.Data[(size_t)ix * offset];
+
+		target.SetPosition(out, source.GetPosition(in));
+
+		glm::vec3 normal = source.GetNormal(in);
+		normal = glm::dot(normal, normal) > 0.0f ? glm::normalize(normal) : glm::vec3(0.0f, 0.0f, 1.0f);
+		target.SetNormal(out, normal);
+		target.SetTexture(out, source.GetTexture(in));
+		target.SetColor(out, source.GetColor(in));
+
+		if (hasTangents) {
+			glm::vec3 tangent = source.GetTangent(in);
+			tangent = glm::dot(tangent, tangent) > 0.0f ? glm::normalize(tangent) : glm::vec3(1.0f, 0.0f, 0.0f);
+			// Mirrored UVs flip the bitangent, which is the only thing we need to remember about it
+			float sign = source.HasBiTangent() && glm::dot(glm::cross(normal, tangent), source.GetBiTangent(in)) < 0.0f ? -1.0f : 1.0f;
+			target.SetTangent(out, tangent, sign);
+		}
+	}
+
+	return result;
+}
+
+VertexArrayObject::Sptr VertexPacker::Bake(const PackedVertexData& data, const uint32_t* indices, size_t indexCount) {
+	VertexBuffer::Sptr vbo = VertexBuffer::Create();
+	vbo->LoadData(data.Data.data(), data.Stride, data.VertexCount);
+
+	IndexBuffer::Sptr ebo = nullptr;
+	if (indices != nullptr && indexCount > 0) {
+		ebo = IndexBuffer::Create();
+		if (data.VertexCount < 65536) {
+			std::vector<uint16_t> shortIndices(indices, indices + indexCount);
+			ebo->LoadData(shortIndices.data(), sizeof(uint16_t), (uint32_t)indexCount, IndexType::UShort);
+		} else {
+			ebo->LoadData(indices, sizeof(uint32_t), (uint32_t)indexCount, IndexType::UInt);
+		}
+	}
+
+	VertexArrayObject::Sptr result = VertexArrayObject::Create();
+	result->AddVertexBuffer(vbo, data.VDecl);
+	result->SetIndexBuffer(ebo);
+	result->SetVDecl(data.VDecl);
+	result->SetPositionDequantize(data.PositionDequantize);
+	result->SetBounds(data.BoundsMin, data.BoundsMax);
+
+	return result;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <GLM/glm.hpp>
+
+#include "Graphics/VertexArrayObject.h"
+
+/// <summary>
+/// Vertex data that has been packed into a compact format by the VertexPacker
+/// </summary>
+struct PackedVertexData {
+	// The interleaved vertex data
+	std::vector<uint8_t> Data;
+	// The layout of the data, always using the same slots as our float vertex types
+	VertexArrayObject::VertexDeclaration VDecl;
+	// The size of a single packed vertex in bytes
+	uint32_t  Stride = 0;
+	uint32_t  VertexCount = 0;
+	// xyz is the offset and w is the scale that takes the unorm16 positions back to object space
+	glm::vec4 PositionDequantize = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	// The object space bounds of the positions
+	glm::vec3 BoundsMin = glm::vec3(0.0f);
+	glm::vec3 BoundsMax = glm::vec3(0.0f);
+};
+
+/// <summary>
+/// Converts meshes from our float vertex types into compact, quantized vertices. Only the attributes
+/// that the mesh actually needs are kept:
+///    Position  - unorm16 x3, quantized to the mesh's bounds (8 bytes, including padding)
+///    Normal    - snorm 10:10:10:2 (4 bytes)
+///    UV        - half float x2 (4 bytes), dropped if every UV is 0
+///    Tangent   - snorm 10:10:10:2, with the sign of the bitangent in w (4 bytes), dropped without UVs
+///    Color     - RGBA8 (4 bytes), dropped if every vertex is white
+///
+/// The bitangent is never stored, shaders rebuild it from the normal, tangent and sign. A full
+/// VertexPosNormTexColTangents is 76 bytes, the packed version is 20 bytes (24 with colors)
+///
+/// Packed meshes must be drawn with shaders that include fragments/vs_common.glsl, which decodes positions
+/// using the mesh's dequantization parameters (see VertexArrayObject::SetPositionDequantize)
+/// </summary>
+class VertexPacker {
+public:
+	/// <summary>
+	/// Packs a set of vertices into the smallest format that can hold them
+	/// </summary>
+	/// <param name="vertices">The vertex data to pack</param>
+	/// <param name="vertexCount">The number of vertices in the data</param>
+	/// <param name="vDecl">The vertex declaration describing the input data</param>
+	static PackedVertexData Pack(const void* vertices, uint32_t vertexCount, const VertexArrayObject::VertexDeclaration& vDecl);
+
+	/// <summary>
+	/// Creates a VAO from packed vertices, using 16 bit indices when the mesh is small enough
+	/// </summary>
+	/// <param name="data">The packed vertex data</param>
+	/// <param name="indices">The index data, or nullptr for non-indexed meshes</param>
+	/// <param name="indexCount">The number of indices</param>
+	static VertexArrayObject::Sptr Bake(const PackedVertexData& data, const uint32_t* indices, size_t indexCount);
+
+protected:
+	VertexPacker() = default;
+	~VertexPacker() = default;
+};
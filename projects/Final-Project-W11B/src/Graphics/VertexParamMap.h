@@ -1,12 +1,19 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 #include <vector>
 #include <GLM/glm.hpp>
+#include <GLM/gtc/type_ptr.hpp>
+#include <GLM/gtc/packing.hpp>
 #include "Graphics/VertexArrayObject.h"
 
 /// <summary>
 /// Structure for mapping and setting a Vertex's attribute based on a vertex declaration
+///
+/// Along with plain float attributes, this understands the packed formats made by the VertexPacker:
+/// unorm16 positions (dequantized with PositionDequantize), 10:10:10:2 normals and tangents,
+/// half float UVs and RGBA8 colors
 /// </summary>
 struct VertexParamMap {
 	uint32_t PositionOffset;
@@ -17,6 +24,15 @@ struct VertexParamMap {
 	uint32_t TangentOffset;
 	uint32_t BiTangentOffset;
 
+	AttributeType PositionType;
+	AttributeType NormalType;
+	AttributeType TextureType;
+	AttributeType ColorType;
+	AttributeType TangentType;
+
+	// For packed positions, xyz is the offset and w is the scale that takes the unorm values back to object space
+	glm::vec4 PositionDequantize;
+
 	VertexParamMap() :
 		PositionOffset(-1),
 		NormalOffset(-1),
@@ -24,140 +40,229 @@ struct VertexParamMap {
 		ColorOffset(-1),
 		ColorSize(0),
 		TangentOffset(-1),
-		BiTangentOffset(-1) {}
+		BiTangentOffset(-1),
+		PositionType(AttributeType::Unknown),
+		NormalType(AttributeType::Unknown),
+		TextureType(AttributeType::Unknown),
+		ColorType(AttributeType::Unknown),
+		TangentType(AttributeType::Unknown),
+		PositionDequantize(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)) {}
 
 	VertexParamMap(const std::vector<BufferAttribute>& vDecl) : VertexParamMap() {
 		// Loop over all the vertex type's attributes
 		for (int ix = 0; ix < vDecl.size(); ix++) {
-			// If the attribute is a float3 position, store it's byte offset
-			if (vDecl[ix].Usage == AttribUsage::Position && vDecl[ix].Size == 3 && vDecl[ix].Type == AttributeType::Float) {
-				PositionOffset = vDecl[ix].Offset;
+			const BufferAttribute& attrib = vDecl[ix];
+
+			// If the attribute is a float3 or unorm16 position, store it's byte offset
+			if (attrib.Usage == AttribUsage::Position && attrib.Size >= 3 &&
+				(attrib.Type == AttributeType::Float || (attrib.Type == AttributeType::UShort && attrib.Normalized))) {
+				PositionOffset = attrib.Offset;
+				PositionType   = attrib.Type;
 			}
-			// If the attribute is a float3 normal, store it's byte offset
-			else if (vDecl[ix].Usage == AttribUsage::Normal && vDecl[ix].Size == 3 && vDecl[ix].Type == AttributeType::Float) {
-				NormalOffset = vDecl[ix].Offset;
+			// If the attribute is a float3 or 10:10:10:2 normal, store it's byte offset
+			else if (attrib.Usage == AttribUsage::Normal && _IsDirection(attrib)) {
+				NormalOffset = attrib.Offset;
+				NormalType   = attrib.Type;
 			}
-			// If the attribute is a float2 texture UV, store it's byte offset
-			else if (vDecl[ix].Usage == AttribUsage::Texture && vDecl[ix].Size == 2 && vDecl[ix].Type == AttributeType::Float) {
-				TextureOffset = vDecl[ix].Offset;
+			// If the attribute is a float2 or half2 texture UV, store it's byte offset
+			else if (attrib.Usage == AttribUsage::Texture && attrib.Size == 2 &&
+				(attrib.Type == AttributeType::Float || attrib.Type == AttributeType::HalfFloat)) {
+				TextureOffset = attrib.Offset;
+				TextureType   = attrib.Type;
 			}
-			// If the attribute is a float2 texture UV, store it's byte offset
-			else if (vDecl[ix].Usage == AttribUsage::Color && vDecl[ix].Type == AttributeType::Float) {
-				ColorOffset = vDecl[ix].Offset;
-				ColorSize   = vDecl[ix].Size;
+			// If the attribute is a float or RGBA8 color, store it's byte offset
+			else if (attrib.Usage == AttribUsage::Color &&
+				(attrib.Type == AttributeType::Float || (attrib.Type == AttributeType::UByte && attrib.Normalized && attrib.Size == 4))) {
+				ColorOffset = attrib.Offset;
+				ColorSize   = attrib.Size;
+				ColorType   = attrib.Type;
 			}
-			// If the attribute is a float3 tangent, store it's byte offset
-			else if (vDecl[ix].Usage == AttribUsage::Tangent && vDecl[ix].Size == 3 && vDecl[ix].Type == AttributeType::Float) {
-				TangentOffset = vDecl[ix].Offset;
+			// If the attribute is a float3 or 10:10:10:2 tangent, store it's byte offset
+			else if (attrib.Usage == AttribUsage::Tangent && _IsDirection(attrib)) {
+				TangentOffset = attrib.Offset;
+				TangentType   = attrib.Type;
 			}
 			// If the attribute is a float3 bitangent, store it's byte offset
-			else if (vDecl[ix].Usage == AttribUsage::BiTangent && vDecl[ix].Size == 3 && vDecl[ix].Type == AttributeType::Float) {
-				BiTangentOffset = vDecl[ix].Offset;
+			else if (attrib.Usage == AttribUsage::BiTangent && attrib.Size == 3 && attrib.Type == AttributeType::Float) {
+				BiTangentOffset = attrib.Offset;
 			}
 		}
 	}
 
+	bool HasPosition() const { return PositionOffset != (uint32_t)-1; }
+	bool HasNormal() const { return NormalOffset != (uint32_t)-1; }
+	bool HasTexture() const { return TextureOffset != (uint32_t)-1; }
+	bool HasColor() const { return ColorOffset != (uint32_t)-1; }
+	bool HasTangent() const { return TangentOffset != (uint32_t)-1; }
+	bool HasBiTangent() const { return BiTangentOffset != (uint32_t)-1; }
+
 	template <typename Vertex>
 	void SetPosition(Vertex& vertex, const glm::vec3& value) const {
 		if (PositionOffset != (uint32_t)-1) {
-			memcpy(GetPtrOffset(vertex, PositionOffset), glm::value_ptr(value), sizeof(glm::vec3));
+			if (PositionType == AttributeType::Float) {
+				_Write(vertex, PositionOffset, value);
+			} else {
+				glm::vec3 normalized = (value - glm::vec3(PositionDequantize)) / PositionDequantize.w;
+				_Write(vertex, PositionOffset, glm::packUnorm<uint16_t>(normalized));
+			}
 		}
 	}
 
 	template <typename Vertex>
 	void SetNormal(Vertex& vertex, const glm::vec3& value) const {
 		if (NormalOffset != (uint32_t)-1) {
-			memcpy(GetPtrOffset(vertex, NormalOffset), glm::value_ptr(value), sizeof(glm::vec3));
+			_WriteDirection(vertex, NormalOffset, NormalType, glm::vec4(value, 0.0f));
 		}
 	}
 
 	template <typename Vertex>
 	void SetTexture(Vertex& vertex, const glm::vec2& value) const {
 		if (TextureOffset != (uint32_t)-1) {
-			memcpy(GetPtrOffset(vertex, TextureOffset), glm::value_ptr(value), sizeof(glm::vec2));
+			if (TextureType == AttributeType::Float) {
+				_Write(vertex, TextureOffset, value);
+			} else {
+				_Write(vertex, TextureOffset, glm::packHalf2x16(value));
+			}
 		}
 	}
 
 	template <typename Vertex>
 	void SetColor(Vertex& vertex, const glm::vec4& value) const {
 		if (ColorOffset != (uint32_t)-1) {
-			memcpy(GetPtrOffset(vertex, ColorOffset), glm::value_ptr(value), sizeof(float) * ColorSize);
+			if (ColorType == AttributeType::Float) {
+				memcpy(_Ptr(vertex, ColorOffset), glm::value_ptr(value), sizeof(float) * ColorSize);
+			} else {
+				_Write(vertex, ColorOffset, glm::packUnorm4x8(value));
+			}
 		}
 	}
 
+	/// <summary>
+	/// Sets the tangent of a vertex. For packed tangents, w is the sign of the bitangent, which
+	/// the shader uses to rebuild the bitangent from the normal and tangent
+	/// </summary>
 	template <typename Vertex>
-	void SetTangent(Vertex& vertex, const glm::vec3& value) const {
+	void SetTangent(Vertex& vertex, const glm::vec3& value, float bitangentSign = 1.0f) const {
 		if (TangentOffset != (uint32_t)-1) {
-			memcpy(GetPtrOffset(vertex, TangentOffset), glm::value_ptr(value), sizeof(glm::vec3));
+			_WriteDirection(vertex, TangentOffset, TangentType, glm::vec4(value, bitangentSign < 0.0f ? -1.0f : 1.0f));
 		}
 	}
 
 	template <typename Vertex>
 	void SetBiTangent(Vertex& vertex, const glm::vec3& value) const {
 		if (BiTangentOffset != (uint32_t)-1) {
-			memcpy(GetPtrOffset(vertex, BiTangentOffset), glm::value_ptr(value), sizeof(glm::vec3));
+			_Write(vertex, BiTangentOffset, value);
 		}
 	}
 
 
 	template <typename Vertex>
-	glm::vec3 GetPosition(Vertex& vertex) const {
+	glm::vec3 GetPosition(const Vertex& vertex) const {
 		if (PositionOffset != (uint32_t)-1) {
-			return *GetPtrOffset<Vertex, glm::vec3>(vertex, PositionOffset);
+			if (PositionType == AttributeType::Float) {
+				return _Read<glm::vec3>(vertex, PositionOffset);
+			}
+			glm::vec3 normalized = glm::unpackUnorm<float>(_Read<glm::u16vec3>(vertex, PositionOffset));
+			return normalized * PositionDequantize.w + glm::vec3(PositionDequantize);
 		}
 		return glm::vec3(0.0f);
 	}
 
 	template <typename Vertex>
-	glm::vec3 GetNormal(Vertex& vertex) const {
+	glm::vec3 GetNormal(const Vertex& vertex) const {
 		if (NormalOffset != (uint32_t)-1) {
-			return *GetPtrOffset<Vertex, glm::vec3>(vertex, NormalOffset);
+			return glm::vec3(_ReadDirection(vertex, NormalOffset, NormalType));
 		}
 		return glm::vec3(0.0f);
 	}
 
 	template <typename Vertex>
-	glm::vec2 GetTexture(Vertex& vertex) const {
+	glm::vec2 GetTexture(const Vertex& vertex) const {
 		if (TextureOffset != (uint32_t)-1) {
-			return *GetPtrOffset<Vertex, glm::vec2>(vertex, TextureOffset);
+			if (TextureType == AttributeType::Float) {
+				return _Read<glm::vec2>(vertex, TextureOffset);
+			}
+			return glm::unpackHalf2x16(_Read<uint32_t>(vertex, TextureOffset));
 		}
 		return glm::vec2(0.0f);
 	}
 
 	template <typename Vertex>
-	glm::vec4 GetColor(Vertex& vertex) const {
+	glm::vec4 GetColor(const Vertex& vertex) const {
 		if (ColorOffset != (uint32_t)-1) {
+			if (ColorType == AttributeType::UByte) {
+				return glm::unpackUnorm4x8(_Read<uint32_t>(vertex, ColorOffset));
+			}
 			switch (ColorSize) {
 				case 2:
-					return glm::vec4(*GetPtrOffset<Vertex, glm::vec2>(vertex, ColorOffset), 0, 1);
+					return glm::vec4(_Read<glm::vec2>(vertex, ColorOffset), 0, 1);
 				case 3:
-					return glm::vec4(*GetPtrOffset<Vertex, glm::vec3>(vertex, ColorOffset), 1);
+					return glm::vec4(_Read<glm::vec3>(vertex, ColorOffset), 1);
 				case 4:
-					return *GetPtrOffset<Vertex, glm::vec4>(vertex, ColorOffset);
+					return _Read<glm::vec4>(vertex, ColorOffset);
 			}
 		}
 		return glm::vec4(1.0f);
 	}
 
 	template <typename Vertex>
-	glm::vec3 GetTangent(Vertex& vertex) const {
+	glm::vec3 GetTangent(const Vertex& vertex) const {
 		if (TangentOffset != (uint32_t)-1) {
-			return *GetPtrOffset<Vertex, glm::vec3>(vertex, TangentOffset);
+			return glm::vec3(_ReadDirection(vertex, TangentOffset, TangentType));
 		}
 		return glm::vec3(0.0f);
 	}
 
+	/// <summary>
+	/// Gets the bitangent of a vertex, rebuilding it from the normal and tangent sign for packed vertices
+	/// </summary>
 	template <typename Vertex>
-	glm::vec3 GetBiTangent(Vertex& vertex) const {
+	glm::vec3 GetBiTangent(const Vertex& vertex) const {
 		if (BiTangentOffset != (uint32_t)-1) {
-			return *GetPtrOffset<Vertex, glm::vec3>(vertex, BiTangentOffset);
+			return _Read<glm::vec3>(vertex, BiTangentOffset);
+		}
+		if (TangentOffset != (uint32_t)-1 && TangentType == AttributeType::Int2_10_10_10_Rev) {
+			glm::vec4 tangent = _ReadDirection(vertex, TangentOffset, TangentType);
+			return glm::cross(GetNormal(vertex), glm::vec3(tangent)) * tangent.w;
 		}
 		return glm::vec3(0.0f);
 	}
 
 private:
-	template <typename Vertex, typename EndType = void>
-	EndType* GetPtrOffset(Vertex& vert, uint32_t offset) const {
-		return reinterpret_cast<EndType*>(reinterpret_cast<uint8_t*>(&vert) + offset);
+	static bool _IsDirection(const BufferAttribute& attrib) {
+		return (attrib.Size == 3 && attrib.Type == AttributeType::Float) ||
+			(attrib.Size == 4 && attrib.Type == AttributeType::Int2_10_10_10_Rev && attrib.Normalized);
+	}
+
+	// Attributes aren't guaranteed to be aligned within the vertex, so we copy rather than casting
+	template <typename Vertex>
+	static uint8_t* _Ptr(Vertex& vert, uint32_t offset) {
+		return reinterpret_cast<uint8_t*>(&vert) + offset;
+	}
+	template <typename T, typename Vertex>
+	static T _Read(const Vertex& vert, uint32_t offset) {
+		T result;
+		memcpy(&result, reinterpret_cast<const uint8_t*>(&vert) + offset, sizeof(T));
+		return result;
+	}
+	template <typename Vertex, typename T>
+	static void _Write(Vertex& vert, uint32_t offset, const T& value) {
+		memcpy(_Ptr(vert, offset), &value, sizeof(T));
+	}
+
+	template <typename Vertex>
+	static void _WriteDirection(Vertex& vert, uint32_t offset, AttributeType type, const glm::vec4& value) {
+		if (type == AttributeType::Float) {
+			_Write(vert, offset, glm::vec3(value));
+		} else {
+			_Write(vert, offset, glm::packSnorm3x10_1x2(value));
+		}
+	}
+	template <typename Vertex>
+	static glm::vec4 _ReadDirection(const Vertex& vert, uint32_t offset, AttributeType type) {
+		if (type == AttributeType::Float) {
+			return glm::vec4(_Read<glm::vec3>(vert, offset), 1.0f);
+		}
+		return glm::unpackSnorm3x10_1x2(_Read<uint32_t>(vert, offset));
 	}
-};
\ No newline at end of file
+};
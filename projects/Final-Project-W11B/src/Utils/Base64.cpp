@@ -1,6 +1,20 @@
 #include "Base64.h"
+#include <array>
+#include <cstring>
 #include <stdexcept>
 
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+	#define BASE64_X86
+	#include <immintrin.h>
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#include <intrin.h>
+		// MSVC will emit any instruction set from intrinsics, so we don't need to tag functions
+		#define BASE64_TARGET(isa)
+	#else
+		#define BASE64_TARGET(isa) __attribute__((target(isa)))
+	#endif
+#endif
+
 const char* Base64::LookupTables[2] = {
 	"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
 	"abcdefghijklmnopqrstuvwxyz"
@@ -11,109 +25,399 @@ const char* Base64::LookupTables[2] = {
 	"0123456789-_."
 };
 
-uint32_t CharPos(const char input) {
-	if (input >= 'A' && input <= 'Z') return input - 'A';
-	else if (input >= 'a' && input <= 'z') return input - 'Z';
-	else if (input == '+' || input == '-') return 62;
-	else if (input == '/' || input == '_') return 63;
-	else if (input == '=' || input == '.') return 64;
-	else
-		throw std::runtime_error("Not a valid Base64 character");
+// Marks characters in DecodeTable that are not part of either alphabet
+static constexpr uint8_t InvalidChar = 0xFF;
+
+/// <summary>
+/// Maps characters from both alphabets to their 6 bit values, so that decoding and validating
+/// a character is a single lookup
+/// </summary>
+static const std::array<uint8_t, 256> DecodeTable = []() {
+	std::array<uint8_t, 256> result;
+	result.fill(InvalidChar);
+	for (uint8_t ix = 0; ix < 64; ix++) {
+		result[static_cast<uint8_t>(Base64::LookupTables[0][ix])] = ix;
+		result[static_cast<uint8_t>(Base64::LookupTables[1][ix])] = ix;
+	}
+	return result;
+}();
+
+inline bool IsPadding(const char c) {
+	return c == '=' || c == '.';
 }
 
-std::string Base64::Encode(void* data, size_t sizeBytes, bool urlEncode, bool includeTrailing)
-{
-	// Determine the size of the output
-	size_t encodedLength = ((sizeBytes + 2) / 3) * 4;
+/// <summary>
+/// Gets the length of the input without any trailing padding characters, or SIZE_MAX if
+/// the input has more padding than is allowed
+/// </summary>
+inline size_t StripPadding(const char* input, size_t length) {
+	size_t padding = 0;
+	while (length > 0 && IsPadding(input[length - 1])) {
+		length--;
+		padding++;
+	}
+	return padding > 2 ? SIZE_MAX : length;
+}
+
+#ifdef BASE64_X86
+enum class SimdLevel {
+	None,
+	SSSE3,
+	AVX2
+};
+
+/// <summary>
+/// Checks which instruction sets the CPU (and OS for AVX) support
+/// </summary>
+static SimdLevel DetectSimdLevel() {
+	#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	if (maxLeaf < 1) {
+		return SimdLevel::None;
+	}
+	__cpuid(info, 1);
+	bool ssse3   = (info[2] & (1 << 9))  != 0;
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx     = (info[2] & (1 << 28)) != 0;
+	if (maxLeaf >= 7 && osxsave && avx) {
+		// Make sure the OS is saving the YMM registers for us
+		if ((_xgetbv(0) & 0x6) == 0x6) {
+			__cpuidex(info, 7, 0);
+			if ((info[1] & (1 << 5)) != 0) {
+				return SimdLevel::AVX2;
+			}
+		}
+	}
+	return ssse3 ? SimdLevel::SSSE3 : SimdLevel::None;
+	#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return SimdLevel::AVX2;
+	}
+	return __builtin_cpu_supports("ssse3") ? SimdLevel::SSSE3 : SimdLevel::None;
+	#endif
+}
+
+static SimdLevel GetSimdLevel() {
+	static const SimdLevel level = DetectSimdLevel();
+	return level;
+}
+
+/// <summary>
+/// Stores the low 12 bytes of a register, without touching the 4 bytes after them
+/// </summary>
+inline void Store12(uint8_t* output, __m128i value) {
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(output), value);
+	uint32_t tail = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(value, 8)));
+	memcpy(output + 8, &tail, sizeof(uint32_t));
+}
+
+/*
+ * The vector paths follow Mula and Lemire's approach, see "Faster Base64 Encoding and Decoding using AVX2 Instructions"
+ *
+ * Encoding shuffles each 3 byte group into 4 bytes, and then uses multiplies to shift the 6 bit indices into their
+ * own bytes. The indices are mapped to characters by adding an offset based on which range they fall in
+ *
+ * Decoding finds the range each character falls in to get it's value and validate it at the same time, and then
+ * uses multiply-adds to pack 4 six bit values into 3 bytes
+ */
+
+BASE64_TARGET("ssse3")
+static size_t EncodeSSSE3(const uint8_t* data, size_t sizeBytes, char* output, const char* lut) {
+	const __m128i shuffle  = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+	const __m128i adjust62 = _mm_set1_epi8(static_cast<char>(lut[62] - 58));
+	const __m128i adjust63 = _mm_set1_epi8(static_cast<char>(lut[63] - 59));
+
+	size_t pos = 0;
+	// We load 16 bytes but only use 12, so make sure we don't read past the end
+	for (; pos + 16 <= sizeBytes; pos += 12, output += 16) {
+		__m128i in = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos)), shuffle);
+
+		__m128i indices = _mm_or_si128(
+			_mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040)),
+			_mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010))
+		);
+
+		// Everything starts in A-Z, and we adjust the offset for indices in the other ranges
+		__m128i offset = _mm_set1_epi8('A');
+		offset = _mm_add_epi8(offset, _mm_and_si128(_mm_cmpgt_epi8(indices, _mm_set1_epi8(25)), _mm_set1_epi8(6)));
+		offset = _mm_add_epi8(offset, _mm_and_si128(_mm_cmpgt_epi8(indices, _mm_set1_epi8(51)), _mm_set1_epi8(-75)));
+		offset = _mm_add_epi8(offset, _mm_and_si128(_mm_cmpeq_epi8(indices, _mm_set1_epi8(62)), adjust62));
+		offset = _mm_add_epi8(offset, _mm_and_si128(_mm_cmpeq_epi8(indices, _mm_set1_epi8(63)), adjust63));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_add_epi8(indices, offset));
+	}
+	return pos;
+}
+
+BASE64_TARGET("avx2")
+static size_t EncodeAVX2(const uint8_t* data, size_t sizeBytes, char* output, const char* lut) {
+	const __m256i shuffle  = _mm256_setr_epi8(
+		1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+		1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+	const __m256i adjust62 = _mm256_set1_epi8(static_cast<char>(lut[62] - 58));
+	const __m256i adjust63 = _mm256_set1_epi8(static_cast<char>(lut[63] - 59));
+
+	size_t pos = 0;
+	// Each lane handles 12 bytes, and the upper lane's load reads 16 bytes starting at pos + 12
+	for (; pos + 28 <= sizeBytes; pos += 24, output += 32) {
+		__m256i in = _mm256_inserti128_si256(
+			_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos))),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 12)), 1);
+		in = _mm256_shuffle_epi8(in, shuffle);
+
+		__m256i indices = _mm256_or_si256(
+			_mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040)),
+			_mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010))
+		);
+
+		__m256i offset = _mm256_set1_epi8('A');
+		offset = _mm256_add_epi8(offset, _mm256_and_si256(_mm256_cmpgt_epi8(indices, _mm256_set1_epi8(25)), _mm256_set1_epi8(6)));
+		offset = _mm256_add_epi8(offset, _mm256_and_si256(_mm256_cmpgt_epi8(indices, _mm256_set1_epi8(51)), _mm256_set1_epi8(-75)));
+		offset = _mm256_add_epi8(offset, _mm256_and_si256(_mm256_cmpeq_epi8(indices, _mm256_set1_epi8(62)), adjust62));
+		offset = _mm256_add_epi8(offset, _mm256_and_si256(_mm256_cmpeq_epi8(indices, _mm256_set1_epi8(63)), adjust63));
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(output), _mm256_add_epi8(indices, offset));
+	}
+	return pos;
+}
+
+BASE64_TARGET("ssse3")
+static size_t DecodeSSSE3(const char* input, size_t length, uint8_t* output) {
+	const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+	size_t pos = 0;
+	for (; pos + 16 <= length; pos += 16, output += 12) {
+		__m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + pos));
+
+		// Find which range each character falls in, characters >= 0x80 are negative so they never match
+		__m128i upper = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('A' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), chars));
+		__m128i lower = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('a' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), chars));
+		__m128i digit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), chars));
+		__m128i plus  = _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('+')), _mm_cmpeq_epi8(chars, _mm_set1_epi8('-')));
+		__m128i slash = _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('/')), _mm_cmpeq_epi8(chars, _mm_set1_epi8('_')));
+
+		__m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(_mm_or_si128(digit, plus), slash));
+		// Let the scalar path deal with (and report) the invalid characters
+		if (_mm_movemask_epi8(valid) != 0xFFFF) {
+			break;
+		}
+
+		__m128i shift = _mm_or_si128(
+			_mm_and_si128(upper, _mm_set1_epi8(-'A')),
+			_mm_or_si128(_mm_and_si128(lower, _mm_set1_epi8(26 - 'a')), _mm_and_si128(digit, _mm_set1_epi8(52 - '0'))));
+		__m128i values = _mm_or_si128(
+			_mm_andnot_si128(_mm_or_si128(plus, slash), _mm_add_epi8(chars, shift)),
+			_mm_or_si128(_mm_and_si128(plus, _mm_set1_epi8(62)), _mm_and_si128(slash, _mm_set1_epi8(63))));
+
+		// aaaaaa bbbbbb -> 0000aaaa aabbbbbb, then the pairs of 12 bits into 24 bits
+		__m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+		merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+
+		Store12(output, _mm_shuffle_epi8(merged, pack));
+	}
+	return pos;
+}
+
+BASE64_TARGET("avx2")
+static size_t DecodeAVX2(const char* input, size_t length, uint8_t* output) {
+	const __m256i pack = _mm256_setr_epi8(
+		2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+		2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+	size_t pos = 0;
+	for (; pos + 32 <= length; pos += 32, output += 24) {
+		__m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + pos));
 
-	// Allocate space for output
-	std::string result;
-	result.reserve(encodedLength);
+		__m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), chars));
+		__m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), chars));
+		__m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), chars));
+		__m256i plus  = _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('+')), _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('-')));
+		__m256i slash = _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('/')), _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('_')));
 
+		__m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(_mm256_or_si256(digit, plus), slash));
+		if (static_cast<uint32_t>(_mm256_movemask_epi8(valid)) != 0xFFFFFFFFu) {
+			break;
+		}
+
+		__m256i shift = _mm256_or_si256(
+			_mm256_and_si256(upper, _mm256_set1_epi8(-'A')),
+			_mm256_or_si256(_mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a')), _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0'))));
+		__m256i values = _mm256_or_si256(
+			_mm256_andnot_si256(_mm256_or_si256(plus, slash), _mm256_add_epi8(chars, shift)),
+			_mm256_or_si256(_mm256_and_si256(plus, _mm256_set1_epi8(62)), _mm256_and_si256(slash, _mm256_set1_epi8(63))));
+
+		__m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+		merged = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+		merged = _mm256_shuffle_epi8(merged, pack);
+
+		// The shuffle works per lane, so each lane has 12 bytes of output
+		Store12(output, _mm256_castsi256_si128(merged));
+		Store12(output + 12, _mm256_extracti128_si256(merged, 1));
+	}
+	return pos;
+}
+#endif
+
+size_t Base64::GetEncodedLength(size_t sizeBytes, bool includeTrailing) {
+	if (includeTrailing) {
+		return ((sizeBytes + 2) / 3) * 4;
+	}
+	// Without padding, the last 1 or 2 bytes only take up 2 or 3 characters
+	return (sizeBytes / 3) * 4 + ((sizeBytes % 3) * 4 + 2) / 3;
+}
+
+size_t Base64::GetMaxDecodedLength(size_t length) {
+	return (length / 4) * 3 + ((length % 4) * 3) / 4;
+}
+
+size_t Base64::EncodeTo(const void* data, size_t sizeBytes, char* output, bool urlEncode, bool includeTrailing)
+{
 	// Grab shorthands to various things we'll need
-	uint8_t* dataPtr = reinterpret_cast<uint8_t*>(data);
+	const uint8_t* dataPtr = reinterpret_cast<const uint8_t*>(data);
 	const char* lut = LookupTables[urlEncode ? 1 : 0];
-	char paddingChar = lut[64];
-
-	// Iterate over all bytes in the data
-	for (size_t pos = 0; pos < sizeBytes; pos++) {
-		result.push_back(lut[(dataPtr[pos] & 0xfc) >> 2]); // 0b11111100 >> 2
-
-		if (pos + 1 < sizeBytes) {
-			// 0b00000011 << 4 + 0b11110000 >> 4
-			result.push_back(lut[((dataPtr[pos] & 0x03) << 4) + ((dataPtr[pos + 1] & 0xf0) >> 4)]);
-			
-			if (pos + 2 < sizeBytes) {
-				// 0b00001111 << 2 + 0b11000000 >> 6
-				result.push_back(lut[((dataPtr[pos + 1] & 0x0f) << 2) + ((dataPtr[pos + 2] & 0xc0) >> 6)]);
-				result.push_back(lut[dataPtr[pos + 2] & 0x3f]); // 0b00111111
-			}
-			else {
-				result.push_back(lut[(dataPtr[pos + 1] & 0x0f) << 2]); // 0b00001111 << 2
-				if (includeTrailing) {
-					result.push_back(paddingChar);
-				}
-			}
+	char* outPtr = output;
+	size_t pos = 0;
+
+	#ifdef BASE64_X86
+	switch (GetSimdLevel()) {
+		case SimdLevel::AVX2:
+			pos = EncodeAVX2(dataPtr, sizeBytes, outPtr, lut);
+			break;
+		case SimdLevel::SSSE3:
+			pos = EncodeSSSE3(dataPtr, sizeBytes, outPtr, lut);
+			break;
+		default:
+			break;
+	}
+	outPtr += (pos / 3) * 4;
+	#endif
+
+	// Handle whatever the vector path didn't, 3 bytes at a time
+	for (; pos + 3 <= sizeBytes; pos += 3, outPtr += 4) {
+		uint32_t group = (dataPtr[pos] << 16) | (dataPtr[pos + 1] << 8) | dataPtr[pos + 2];
+		outPtr[0] = lut[(group >> 18) & 0x3f];
+		outPtr[1] = lut[(group >> 12) & 0x3f];
+		outPtr[2] = lut[(group >>  6) & 0x3f];
+		outPtr[3] = lut[group & 0x3f];
+	}
+
+	// The last 1 or 2 bytes, if any
+	size_t remaining = sizeBytes - pos;
+	if (remaining > 0) {
+		uint32_t group = (dataPtr[pos] << 16) | (remaining > 1 ? (dataPtr[pos + 1] << 8) : 0);
+		*outPtr++ = lut[(group >> 18) & 0x3f];
+		*outPtr++ = lut[(group >> 12) & 0x3f];
+		if (remaining > 1) {
+			*outPtr++ = lut[(group >> 6) & 0x3f];
 		}
-		else {
-			result.push_back(lut[(dataPtr[pos] & 0x03) << 4]); // 0b00000011 << 4
-			if (includeTrailing) {
-				result.push_back(paddingChar);
-				result.push_back(paddingChar);
+		if (includeTrailing) {
+			*outPtr++ = lut[64];
+			if (remaining == 1) {
+				*outPtr++ = lut[64];
 			}
 		}
 	}
 
-	return result;
+	return outPtr - output;
 }
 
-std::string Base64::Decode(const std::string& input)
+bool Base64::DecodeTo(const char* input, size_t length, uint8_t* output, size_t& outLength)
 {
-	if (input.empty()) return std::string();
+	outLength = 0;
+	length = StripPadding(input, length);
+	// A single character left over can't encode a full byte
+	if (length == SIZE_MAX || length % 4 == 1) {
+		return false;
+	}
 
-	if (!IsBase64(input)) {
-		throw std::runtime_error("Input is not a base 64 string!");
+	size_t quadLength = length - (length % 4);
+	uint8_t* outPtr = output;
+	size_t pos = 0;
+
+	#ifdef BASE64_X86
+	switch (GetSimdLevel()) {
+		case SimdLevel::AVX2:
+			pos = DecodeAVX2(input, quadLength, outPtr);
+			break;
+		case SimdLevel::SSSE3:
+			pos = DecodeSSSE3(input, quadLength, outPtr);
+			break;
+		default:
+			break;
 	}
+	outPtr += (pos / 4) * 3;
+	#endif
 
-	size_t inLength = input.length();
-	size_t approxOutLength = (inLength / 4) * 3;
+	const uint8_t* chars = reinterpret_cast<const uint8_t*>(input);
+	for (; pos < quadLength; pos += 4, outPtr += 3) {
+		uint32_t a = DecodeTable[chars[pos]];
+		uint32_t b = DecodeTable[chars[pos + 1]];
+		uint32_t c = DecodeTable[chars[pos + 2]];
+		uint32_t d = DecodeTable[chars[pos + 3]];
+		// Invalid characters have their top bit set, so we can check all 4 at once
+		if ((a | b | c | d) & 0x80) {
+			return false;
+		}
+		uint32_t group = (a << 18) | (b << 12) | (c << 6) | d;
+		outPtr[0] = static_cast<uint8_t>(group >> 16);
+		outPtr[1] = static_cast<uint8_t>(group >> 8);
+		outPtr[2] = static_cast<uint8_t>(group);
+	}
 
-	std::string result;
-	result.reserve(approxOutLength);
+	// The last 2 or 3 characters, if any
+	size_t remaining = length - pos;
+	if (remaining > 0) {
+		uint32_t a = DecodeTable[chars[pos]];
+		uint32_t b = DecodeTable[chars[pos + 1]];
+		uint32_t c = remaining > 2 ? DecodeTable[chars[pos + 2]] : 0;
+		if ((a | b | c) & 0x80) {
+			return false;
+		}
+		uint32_t group = (a << 18) | (b << 12) | (c << 6);
+		*outPtr++ = static_cast<uint8_t>(group >> 16);
+		if (remaining > 2) {
+			*outPtr++ = static_cast<uint8_t>(group >> 8);
+		}
+	}
 
-	for (size_t pos = 0; pos < inLength; pos += 4) {
-		size_t charPos1 = CharPos(input[pos + 1]);
+	outLength = outPtr - output;
+	return true;
+}
 
-		result.push_back(static_cast<std::string::value_type>( ( CharPos(input[pos]) << 2 ) + ( (charPos1 & 0x30) >> 4) ) );
+std::string Base64::Encode(const void* data, size_t sizeBytes, bool urlEncode, bool includeTrailing)
+{
+	std::string result(GetEncodedLength(sizeBytes, includeTrailing), '\0');
+	EncodeTo(data, sizeBytes, result.data(), urlEncode, includeTrailing);
+	return result;
+}
 
-		if (
-			(pos + 2 < inLength) &&
-			input[pos + 2] != '=' &&
-			input[pos + 2] != '.'
-		) {
-			size_t charPos2 = CharPos(input[pos + 2]);
-			result.push_back(static_cast<std::string::value_type>(((charPos1 & 0x0f) << 4) + ( (charPos2 & 0x3c) >> 2)));
+std::string Base64::Decode(const std::string& input)
+{
+	if (input.empty()) return std::string();
 
-			if (
-				(pos + 3 < inLength) &&
-				input[pos + 3] != '=' &&
-				input[pos + 3] != '.'
-			) {
-				size_t charPos3 = CharPos(input[pos + 3]);
-				result.push_back(static_cast<std::string::value_type>(((charPos2 & 0x03) << 6) + charPos3));
-			}
-		}
+	std::string result(GetMaxDecodedLength(input.length()), '\0');
+	size_t decodedLength = 0;
+	if (!DecodeTo(input.data(), input.length(), reinterpret_cast<uint8_t*>(result.data()), decodedLength)) {
+		throw std::runtime_error("Input is not a base 64 string!");
 	}
+	result.resize(decodedLength);
 
 	return result;
 }
 
 bool Base64::IsBase64(const std::string& input)
 {
-	for (const char c : input) {
-		if (!(isalnum(c) || (c == '-') || (c == '_') || (c == '=') || (c == '.')))
+	size_t length = StripPadding(input.data(), input.length());
+	if (length == SIZE_MAX || length % 4 == 1) {
+		return false;
+	}
+	for (size_t ix = 0; ix < length; ix++) {
+		if (DecodeTable[static_cast<uint8_t>(input[ix])] == InvalidChar) {
 			return false;
+		}
 	}
 	return true;
 }
-
@@ -1,12 +1,60 @@
 #pragma once
 
-#include <string>;
+#include <string>
+#include <cstdint>
 
+/// <summary>
+/// Encodes and decodes Base64 strings, using SSSE3 or AVX2 when the CPU supports them
+///
+/// Decoding accepts both the standard (+/=) and URL safe (-_.) alphabets, and the trailing
+/// padding characters are optional
+/// </summary>
 class Base64 {
 public:
-	static std::string Encode(void* data, size_t sizeBytes, bool urlEncode = true, bool includeTrailing = false);
+	/// <summary>
+	/// Gets the number of characters that encoding the given number of bytes will produce
+	/// </summary>
+	/// <param name="sizeBytes">The size of the data to encode, in bytes</param>
+	/// <param name="includeTrailing">True if the output will be padded to a multiple of 4 characters</param>
+	static size_t GetEncodedLength(size_t sizeBytes, bool includeTrailing = false);
+	/// <summary>
+	/// Gets the maximum number of bytes that decoding a string of the given length can produce
+	/// </summary>
+	/// <param name="length">The length of the Base64 string, in characters</param>
+	static size_t GetMaxDecodedLength(size_t length);
+
+	/// <summary>
+	/// Encodes data into a preallocated buffer, which must have room for at least GetEncodedLength characters.
+	/// The output is not null terminated
+	/// </summary>
+	/// <param name="data">The data to encode</param>
+	/// <param name="sizeBytes">The size of the data in bytes</param>
+	/// <param name="output">The buffer to write the characters to</param>
+	/// <param name="urlEncode">True to use the URL safe alphabet</param>
+	/// <param name="includeTrailing">True to pad the output to a multiple of 4 characters</param>
+	/// <returns>The number of characters that were written</returns>
+	static size_t EncodeTo(const void* data, size_t sizeBytes, char* output, bool urlEncode = true, bool includeTrailing = false);
+	/// <summary>
+	/// Validates and decodes a Base64 string into a preallocated buffer in a single pass. The buffer must have room
+	/// for at least GetMaxDecodedLength bytes
+	/// </summary>
+	/// <param name="input">The characters to decode</param>
+	/// <param name="length">The number of characters to decode</param>
+	/// <param name="output">The buffer to write the decoded bytes to</param>
+	/// <param name="outLength">Will be set to the number of bytes that were decoded</param>
+	/// <returns>True if the input was valid Base64, false if not (in which case output is undefined)</returns>
+	static bool DecodeTo(const char* input, size_t length, uint8_t* output, size_t& outLength);
+
+	static std::string Encode(const void* data, size_t sizeBytes, bool urlEncode = true, bool includeTrailing = false);
+	/// <summary>
+	/// Decodes a Base64 string, throwing a std::runtime_error if the input is not valid Base64
+	/// </summary>
 	static std::string Decode(const std::string& input);
 	static bool IsBase64(const std::string& input);
 
 	static const char* LookupTables[2];
-};
\ No newline at end of file
+
+protected:
+	Base64() = default;
+	~Base64() = default;
+};
@@ -0,0 +1,269 @@
+#include "Utils/BlobSidecar.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <Logging.h>
+
+#include "Utils/Base64.h"
+
+std::string   BlobSidecar::_directory;
+std::string   BlobSidecar::_writeDirectory;
+std::string   BlobSidecar::_writePath;
+std::string   BlobSidecar::_writeReferencePath;
+std::ofstream BlobSidecar::_writeStream;
+size_t        BlobSidecar::_threshold = 0;
+uint64_t      BlobSidecar::_writeOffset = 0;
+std::unordered_multimap<uint64_t, BlobSidecar::Reference> BlobSidecar::_written;
+std::unordered_map<std::string, MemoryMappedFile::Sptr> BlobSidecar::_mappedFiles;
+
+/// <summary>
+/// Gets the path that we write a sidecar to before moving it into place
+/// </summary>
+inline std::string GetTempPath(const std::string& path) {
+	return path + ".tmp";
+}
+
+// These are templated since the manifest is an ordered_json, while resources use json
+
+template <typename JsonType>
+void WriteReference(JsonType& output, const std::string& path, uint64_t offset, uint64_t size, uint64_t hash) {
+	output = JsonType::object();
+	output["sidecar"] = path;
+	output["offset"]  = offset;
+	output["size"]    = size;
+	output["hash"]    = hash;
+}
+
+template <typename JsonType>
+bool IsReference(const JsonType& value) {
+	return value.is_object() && value.contains("sidecar") && value["sidecar"].is_string() &&
+		value.contains("offset") && value.contains("size") && value.contains("hash");
+}
+
+void BlobSidecar::SetDirectory(const std::string& directory) {
+	_directory = directory;
+}
+
+void BlobSidecar::BeginWrite(const std::string& manifestPath, size_t threshold) {
+	LOG_ASSERT(!IsWriting(), "Already writing blob sidecar \"{}\"", _writePath);
+
+	std::filesystem::path path = std::filesystem::path(manifestPath).replace_extension(".bin");
+	_writeStream.open(GetTempPath(path.string()), std::ios::binary | std::ios::trunc);
+	if (!_writeStream.is_open()) {
+		LOG_WARN("Failed to open \"{}\" for writing, blobs will be stored inline", GetTempPath(path.string()));
+		return;
+	}
+
+	// The sidecar always sits beside the manifest, so it's file name is the path relative to the manifest
+	_writeDirectory     = path.parent_path().string();
+	_writePath          = path.string();
+	_writeReferencePath = path.filename().generic_string();
+	_threshold          = threshold;
+	_writeOffset = 0;
+	_written.clear();
+}
+
+bool BlobSidecar::EndWrite() {
+	if (!IsWriting()) {
+		return false;
+	}
+
+	_writeStream.close();
+	bool success = !_writeStream.fail();
+	std::string tempPath = GetTempPath(_writePath);
+
+	std::error_code error;
+	if (success && _writeOffset > 0) {
+		// We can't replace the old file while we have it mapped, every blob we still need has been copied by now
+		_mappedFiles.clear();
+		std::filesystem::rename(tempPath, _writePath, error);
+		if (error) {
+			LOG_WARN("Failed to replace blob sidecar \"{}\": {}", _writePath, error.message());
+			success = false;
+		}
+	}
+	// Nothing references the sidecar if it is empty, so we don't need to replace the existing one
+	std::filesystem::remove(tempPath, error);
+
+	// The manifest's references are now relative to where it is being saved
+	_directory = _writeDirectory;
+	_writeDirectory.clear();
+	_writePath.clear();
+	_writeReferencePath.clear();
+	_written.clear();
+	return success;
+}
+
+bool BlobSidecar::IsWriting() {
+	return _writeStream.is_open();
+}
+
+void BlobSidecar::Store(nlohmann::json& output, const std::string& key, const void* data, size_t sizeBytes) {
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	if (!IsWriting() || sizeBytes < _threshold) {
+		output[key] = Base64::Encode(bytes, sizeBytes);
+		return;
+	}
+
+	Reference reference = _Append(bytes, sizeBytes, _Hash(bytes, sizeBytes));
+	WriteReference(output[key], reference.Path, reference.Offset, reference.Size, reference.Hash);
+}
+
+bool BlobSidecar::Load(const nlohmann::json& value, std::vector<uint8_t>& result) {
+	// Inline blobs can be decoded straight into the result
+	if (value.is_string()) {
+		const std::string& text = value.get_ref<const std::string&>();
+		result.resize(Base64::GetMaxDecodedLength(text.size()));
+		size_t length = 0;
+		if (!Base64::DecodeTo(text.data(), text.size(), result.data(), length)) {
+			LOG_WARN("Inline blob is not a valid Base64 string");
+			result.clear();
+			return false;
+		}
+		result.resize(length);
+		return true;
+	}
+
+	if (!IsReference(value)) {
+		LOG_WARN("Blob is not a Base64 string or sidecar reference");
+		return false;
+	}
+
+	Reference reference;
+	reference.Path   = value["sidecar"].get<std::string>();
+	reference.Offset = value["offset"].get<uint64_t>();
+	reference.Size   = value["size"].get<uint64_t>();
+	reference.Hash   = value["hash"].get<uint64_t>();
+
+	const uint8_t* data = _Read(reference);
+	if (data == nullptr) {
+		return false;
+	}
+	result.assign(data, data + reference.Size);
+	return true;
+}
+
+void BlobSidecar::Relink(nlohmann::ordered_json& manifest) {
+	if (!IsWriting()) {
+		return;
+	}
+
+	if (IsReference(manifest)) {
+		Reference reference;
+		reference.Path   = manifest["sidecar"].get<std::string>();
+		reference.Offset = manifest["offset"].get<uint64_t>();
+		reference.Size   = manifest["size"].get<uint64_t>();
+		reference.Hash   = manifest["hash"].get<uint64_t>();
+
+		// References written while saving are already in the new sidecar
+		if (reference.Path == _writeReferencePath) {
+			auto [begin, end] = _written.equal_range(reference.Hash);
+			for (auto it = begin; it != end; it++) {
+				if (it->second.Offset == reference.Offset && it->second.Size == reference.Size) {
+					return;
+				}
+			}
+		}
+
+		const uint8_t* data = _Read(reference);
+		if (data == nullptr) {
+			LOG_WARN("Could not copy blob from \"{}\" into the new sidecar, the reference will be left as-is", reference.Path);
+			return;
+		}
+		Reference relinked = _Append(data, reference.Size, reference.Hash);
+		WriteReference(manifest, relinked.Path, relinked.Offset, relinked.Size, relinked.Hash);
+	}
+	else if (manifest.is_structured()) {
+		for (auto& [key, child] : manifest.items()) {
+			Relink(child);
+		}
+	}
+}
+
+void BlobSidecar::Release() {
+	_mappedFiles.clear();
+}
+
+uint64_t BlobSidecar::_Hash(const uint8_t* data, size_t sizeBytes) {
+	// Word at a time so that hashing keeps up with writing the blob, this only needs to catch
+	// mismatched sidecars and duplicates, not be cryptographically secure
+	uint64_t hash = 0xcbf29ce484222325ull ^ sizeBytes;
+	size_t ix = 0;
+	for (; ix + sizeof(uint64_t) <= sizeBytes; ix += sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, data + ix, sizeof(uint64_t));
+		hash = (hash ^ word) * 0x9e3779b97f4a7c15ull;
+		hash ^= hash >> 29;
+	}
+	for (; ix < sizeBytes; ix++) {
+		hash = (hash ^ data[ix]) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+std::string BlobSidecar::_Resolve(const std::string& path) {
+	return (std::filesystem::path(_directory) / path).string();
+}
+
+BlobSidecar::Reference BlobSidecar::_Append(const uint8_t* data, size_t sizeBytes, uint64_t hash) {
+	auto [begin, end] = _written.equal_range(hash);
+	for (auto it = begin; it != end; it++) {
+		if (it->second.Size == sizeBytes && _MatchesWritten(it->second, data)) {
+			return it->second;
+		}
+	}
+
+	Reference reference;
+	reference.Path   = _writeReferencePath;
+	reference.Offset = _writeOffset;
+	reference.Size   = sizeBytes;
+	reference.Hash   = hash;
+
+	_writeStream.write(reinterpret_cast<const char*>(data), sizeBytes);
+	_writeOffset += sizeBytes;
+	_written.emplace(hash, reference);
+	return reference;
+}
+
+bool BlobSidecar::_MatchesWritten(const Reference& written, const uint8_t* data) {
+	// The blob is still in the temporary file, so we read it back in chunks rather than mapping it
+	_writeStream.flush();
+	std::ifstream file(GetTempPath(_writePath), std::ios::binary);
+	if (!file.is_open() || !file.seekg(written.Offset)) {
+		return false;
+	}
+
+	char buffer[64 * 1024];
+	for (uint64_t offset = 0; offset < written.Size; offset += sizeof(buffer)) {
+		size_t chunkSize = static_cast<size_t>(std::min<uint64_t>(sizeof(buffer), written.Size - offset));
+		if (!file.read(buffer, chunkSize) || memcmp(buffer, data + offset, chunkSize) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+const uint8_t* BlobSidecar::_Read(const Reference& reference) {
+	std::string path = _Resolve(reference.Path);
+	MemoryMappedFile::Sptr& file = _mappedFiles[path];
+	if (file == nullptr || !file->IsOpen()) {
+		file = std::make_shared<MemoryMappedFile>(path);
+		if (!file->IsOpen()) {
+			LOG_WARN("Failed to open blob sidecar \"{}\"", path);
+			_mappedFiles.erase(path);
+			return nullptr;
+		}
+	}
+
+	if (reference.Offset > file->GetSize() || reference.Size > file->GetSize() - reference.Offset) {
+		LOG_WARN("Blob at {} ({} bytes) is outside of sidecar \"{}\"", reference.Offset, reference.Size, reference.Path);
+		return nullptr;
+	}
+
+	const uint8_t* data = file->GetData() + reference.Offset;
+	if (_Hash(data, reference.Size) != reference.Hash) {
+		LOG_WARN("Blob at {} in sidecar \"{}\" does not match it's hash, the sidecar may be from a different save", reference.Offset, reference.Path);
+		return nullptr;
+	}
+	return data;
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <json.hpp>
+
+#include "Utils/MemoryMappedFile.h"
+
+/// <summary>
+/// Stores binary blobs for resources that embed their data in the manifest (ex: the pixels of
+/// textures generated at runtime). Blobs are stored inline as Base64 by default, but while a
+/// sidecar is being written, blobs at or above it's threshold are appended to a binary file
+/// beside the manifest instead, and the JSON gets a reference to them:
+///
+///   "data": { "sidecar": "scene-manifest.bin", "offset": 0, "size": 1048576, "hash": 1234 }
+///
+/// Sidecar paths are relative to the manifest's directory, so that manifests can be moved along
+/// with their sidecars. Sidecar files are memory mapped when loading, so reading a blob is a single copy
+/// </summary>
+class BlobSidecar {
+public:
+	/// <summary>
+	/// Sets the directory that sidecar paths are resolved against, this should be the directory
+	/// of the manifest that references are being loaded from
+	/// </summary>
+	/// <param name="directory">The directory containing the manifest</param>
+	static void SetDirectory(const std::string& directory);
+
+	/// <summary>
+	/// Starts writing a sidecar file beside a manifest, blobs are written to a temporary file until
+	/// EndWrite is called so that blobs in an existing sidecar at the same path can still be read
+	/// </summary>
+	/// <param name="manifestPath">The path of the manifest that will reference the sidecar</param>
+	/// <param name="threshold">The size in bytes at which blobs are moved out of the JSON</param>
+	static void BeginWrite(const std::string& manifestPath, size_t threshold);
+	/// <summary>
+	/// Finishes writing the sidecar, replacing any existing file at the path. References are
+	/// resolved against the new manifest's directory from then on
+	/// </summary>
+	/// <returns>True if the sidecar was written</returns>
+	static bool EndWrite();
+	/// <summary>
+	/// Returns true if we are between BeginWrite and EndWrite
+	/// </summary>
+	static bool IsWriting();
+
+	/// <summary>
+	/// Stores a blob into output[key], either inline as Base64 or as a reference into the sidecar that's being written
+	/// </summary>
+	/// <param name="output">The JSON object to store the blob in</param>
+	/// <param name="key">The key to store the blob under</param>
+	/// <param name="data">The data to store</param>
+	/// <param name="sizeBytes">The size of the data in bytes</param>
+	static void Store(nlohmann::json& output, const std::string& key, const void* data, size_t sizeBytes);
+	/// <summary>
+	/// Loads a blob that was stored with Store
+	/// </summary>
+	/// <param name="value">The inline Base64 string or sidecar reference</param>
+	/// <param name="result">The vector to store the blob's data in</param>
+	/// <returns>True if the blob was loaded, false if it was invalid or the sidecar is missing</returns>
+	static bool Load(const nlohmann::json& value, std::vector<uint8_t>& result);
+
+	/// <summary>
+	/// Copies any blobs referenced by the manifest that have not been written to the current sidecar into
+	/// it (ex: the blobs of resources that were not loaded when the manifest was saved), since the existing
+	/// sidecar will be replaced when we finish writing
+	/// </summary>
+	/// <param name="manifest">The manifest to update the references in</param>
+	static void Relink(nlohmann::ordered_json& manifest);
+
+	/// <summary>
+	/// Unmaps any sidecar files that we have open for reading
+	/// </summary>
+	static void Release();
+
+protected:
+	BlobSidecar() = default;
+	~BlobSidecar() = default;
+
+	struct Reference {
+		std::string Path;
+		uint64_t    Offset;
+		uint64_t    Size;
+		uint64_t    Hash;
+	};
+
+	static std::string   _directory;
+	static std::string   _writeDirectory;
+	static std::string   _writePath;
+	static std::string   _writeReferencePath;
+	static std::ofstream _writeStream;
+	static size_t        _threshold;
+	static uint64_t      _writeOffset;
+	// Maps the hashes of blobs in the sidecar being written to their references, so identical blobs are only stored once
+	static std::unordered_multimap<uint64_t, Reference> _written;
+	static std::unordered_map<std::string, MemoryMappedFile::Sptr> _mappedFiles;
+
+	static uint64_t _Hash(const uint8_t* data, size_t sizeBytes);
+	// Gets the path of a sidecar file from the path stored in a reference
+	static std::string _Resolve(const std::string& path);
+	// Appends a blob to the sidecar being written, or finds an identical one that is already in it
+	static Reference _Append(const uint8_t* data, size_t sizeBytes, uint64_t hash);
+	// Compares a blob against one that has already been written to the sidecar, since different blobs can share a hash
+	static bool _MatchesWritten(const Reference& written, const uint8_t* data);
+	// Gets a pointer to a blob in a sidecar file, or nullptr if the sidecar is missing or does not match the reference
+	static const uint8_t* _Read(const Reference& reference);
+};
@@ -0,0 +1,559 @@
+#include "Utils/CollisionCooker.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <LinearMath/btConvexHullComputer.h>
+
+#include "Logging.h"
+
+namespace fs = std::filesystem;
+
+const char* CollisionCooker::CACHE_EXTENSION = ".hull";
+
+namespace {
+	const char HEADER_BYTES[4] = { 'H', 'U', 'L', 'L' };
+	// The number of cutting planes we try along each axis when splitting a part
+	const int SPLIT_CANDIDATES = 7;
+	// Limits for reading cache files, so that a corrupt file can't make us allocate everything
+	const uint32_t MAX_CACHED_HULLS = 1024;
+	const uint32_t MAX_CACHED_HULL_VERTICES = 65536;
+
+	// The vertices, outward facing planes and volume of a convex hull
+	struct HullInfo {
+		std::vector<glm::vec3> Vertices;
+		std::vector<glm::vec4> Planes;
+		float                  Volume = 0.0f;
+	};
+
+	// Computes the convex hull of a set of points, returns false if there are no points
+	bool ComputeHull(const std::vector<glm::vec3>& points, HullInfo& result) {
+		result = HullInfo();
+		if (points.empty()) {
+			return false;
+		}
+
+		btConvexHullComputer computer;
+		computer.compute(&points[0].x, sizeof(glm::vec3), static_cast<int>(points.size()), 0.0f, 0.0f);
+		if (computer.vertices.size() == 0) {
+			return false;
+		}
+
+		result.Vertices.reserve(computer.vertices.size());
+		glm::vec3 centroid = glm::vec3(0.0f);
+		for (int ix = 0; ix < computer.vertices.size(); ix++) {
+			const btVector3& vertex = computer.vertices[ix];
+			result.Vertices.push_back(glm::vec3(vertex.x(), vertex.y(), vertex.z()));
+			centroid += result.Vertices.back();
+		}
+		centroid /= static_cast<float>(result.Vertices.size());
+
+		// Faces are planar n-gons, we use Newell's method for their normals and fan them out for the volume
+		for (int ix = 0; ix < computer.faces.size(); ix++) {
+			const btConvexHullComputer::Edge* first = &computer.edges[computer.faces[ix]];
+			const btConvexHullComputer::Edge* edge = first;
+			glm::vec3 start = result.Vertices[first->getSourceVertex()];
+			glm::vec3 normal = glm::vec3(0.0f);
+			do {
+				glm::vec3 a = result.Vertices[edge->getSourceVertex()];
+				glm::vec3 b = result.Vertices[edge->getTargetVertex()];
+				normal += glm::cross(a, b);
+				result.Volume += glm::abs(glm::dot(start - centroid, glm::cross(a - centroid, b - centroid))) / 6.0f;
+				edge = edge->getNextEdgeOfFace();
+			} while (edge != first);
+
+			float length = glm::length(normal);
+			if (length > 0.0f) {
+				normal /= length;
+				float distance = glm::dot(normal, start);
+				// Make sure the plane faces away from the middle of the hull
+				if (glm::dot(normal, centroid) > distance) {
+					normal = -normal;
+					distance = -distance;
+				}
+				result.Planes.push_back(glm::vec4(normal, distance));
+			}
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Reduces the convex hull of a set of points to a vertex budget. We start from the extremes along each axis, then keep
+	/// adding whichever vertex sticks out furthest from the hull of the vertices we've kept so far. The result is always
+	/// inside of the exact hull, and the largest distance between the two shrinks with every vertex
+	/// </summary>
+	std::vector<glm::vec3> ReduceHull(const std::vector<glm::vec3>& points, uint32_t maxVertices) {
+		HullInfo full;
+		if (!ComputeHull(points, full)) {
+			return {};
+		}
+		maxVertices = std::max(maxVertices, 4u);
+		if (full.Vertices.size() <= maxVertices) {
+			return full.Vertices;
+		}
+
+		std::vector<bool> used(full.Vertices.size(), false);
+		std::vector<glm::vec3> kept;
+		auto keep = [&](size_t ix) {
+			if (!used[ix] && kept.size() < maxVertices) {
+				used[ix] = true;
+				kept.push_back(full.Vertices[ix]);
+			}
+		};
+		for (int axis = 0; axis < 3; axis++) {
+			auto compare = [axis](const glm::vec3& a, const glm::vec3& b) { return a[axis] < b[axis]; };
+			keep(std::min_element(full.Vertices.begin(), full.Vertices.end(), compare) - full.Vertices.begin());
+			keep(std::max_element(full.Vertices.begin(), full.Vertices.end(), compare) - full.Vertices.begin());
+		}
+
+		while (kept.size() < maxVertices) {
+			HullInfo partial;
+			ComputeHull(kept, partial);
+
+			float bestDistance = 0.0f;
+			size_t best = full.Vertices.size();
+			for (size_t ix = 0; ix < full.Vertices.size(); ix++) {
+				if (used[ix]) {
+					continue;
+				}
+				// How far outside of the kept hull the vertex is, if the kept vertices don't have any faces yet we use
+				// the distance to the closest one
+				float distance = std::numeric_limits<float>::max();
+				if (!partial.Planes.empty()) {
+					distance = std::numeric_limits<float>::lowest();
+					for (const glm::vec4& plane : partial.Planes) {
+						distance = glm::max(distance, glm::dot(glm::vec3(plane), full.Vertices[ix]) - plane.w);
+					}
+				} else {
+					for (const glm::vec3& point : kept) {
+						distance = glm::min(distance, glm::distance(point, full.Vertices[ix]));
+					}
+				}
+				if (distance > bestDistance) {
+					bestDistance = distance;
+					best = ix;
+				}
+			}
+
+			// Everything left is already inside
+			if (best == full.Vertices.size()) {
+				break;
+			}
+			keep(best);
+		}
+
+		return kept;
+	}
+
+	// A solid voxelization of a mesh
+	struct VoxelGrid {
+		glm::vec3  Origin;
+		float      Size;
+		glm::ivec3 Dims;
+		// For each voxel, the index of the part that it belongs to, or -1 if it's outside of the mesh
+		std::vector<int> Owner;
+
+		size_t Index(const glm::ivec3& cell) const {
+			return ((size_t)cell.z * Dims.y + cell.y) * Dims.x + cell.x;
+		}
+		glm::ivec3 Cell(const glm::vec3& position) const {
+			return glm::clamp(glm::ivec3(glm::floor((position - Origin) / Size)), glm::ivec3(0), Dims - 1);
+		}
+		glm::vec3 Corner(const glm::ivec3& cell) const {
+			return Origin + glm::vec3(cell) * Size;
+		}
+	};
+
+	// A point on the surface of the mesh, and the voxel it lies in
+	struct SurfaceSample {
+		glm::vec3 Position;
+		size_t    Voxel;
+	};
+
+	// A convex piece of the mesh being decomposed
+	struct Part {
+		std::vector<glm::ivec3> Voxels;
+		glm::ivec3              Min;
+		glm::ivec3              Max;
+		float                   Concavity = 0.0f;
+	};
+
+	/// <summary>
+	/// Gets the points whose hull matches the hull of a set of voxels. Inside of each row of voxels along X, the voxels
+	/// between the first and last one can't affect the hull, so we only need the outer faces of the ends
+	/// </summary>
+	template <typename Filter>
+	std::vector<glm::vec3> GetHullPoints(const VoxelGrid& grid, const Part& part, const Filter& filter) {
+		glm::ivec3 size = part.Max - part.Min + 1;
+		std::vector<glm::ivec2> rows((size_t)size.y * size.z, glm::ivec2(std::numeric_limits<int>::max(), std::numeric_limits<int>::lowest()));
+		for (const glm::ivec3& voxel : part.Voxels) {
+			if (filter(voxel)) {
+				glm::ivec2& row = rows[(size_t)(voxel.z - part.Min.z) * size.y + (voxel.y - part.Min.y)];
+				row.x = glm::min(row.x, voxel.x);
+				row.y = glm::max(row.y, voxel.x);
+			}
+		}
+
+		std::vector<glm::vec3> result;
+		for (int z = 0; z < size.z; z++) {
+			for (int y = 0; y < size.y; y++) {
+				const glm::ivec2& row = rows[(size_t)z * size.y + y];
+				if (row.x <= row.y) {
+					for (int corner = 0; corner < 4; corner++) {
+						glm::ivec3 offset = glm::ivec3(0, corner & 1, corner >> 1);
+						result.push_back(grid.Corner(glm::ivec3(row.x, part.Min.y + y, part.Min.z + z) + offset));
+						result.push_back(grid.Corner(glm::ivec3(row.y + 1, part.Min.y + y, part.Min.z + z) + offset));
+					}
+				}
+			}
+		}
+		return result;
+	}
+
+	// Finds how much of a part's hull is empty, as a fraction of the whole mesh's volume
+	float GetConcavity(const VoxelGrid& grid, const Part& part, float totalVolume) {
+		HullInfo hull;
+		ComputeHull(GetHullPoints(grid, part, [](const glm::ivec3&) { return true; }), hull);
+		float volume = part.Voxels.size() * grid.Size * grid.Size * grid.Size;
+		return glm::max(hull.Volume - volume, 0.0f) / totalVolume;
+	}
+
+	void UpdateBounds(Part& part) {
+		part.Min = glm::ivec3(std::numeric_limits<int>::max());
+		part.Max = glm::ivec3(std::numeric_limits<int>::lowest());
+		for (const glm::ivec3& voxel : part.Voxels) {
+			part.Min = glm::min(part.Min, voxel);
+			part.Max = glm::max(part.Max, voxel);
+		}
+	}
+
+	/// <summary>
+	/// Splits a part in two along the axis aligned plane that leaves the smallest total hull volume, returning false if the part
+	/// can't be split
+	/// </summary>
+	bool SplitPart(const VoxelGrid& grid, const Part& part, Part& outA, Part& outB) {
+		float bestCost = std::numeric_limits<float>::max();
+		int bestAxis = -1;
+		int bestCut = 0;
+
+		for (int axis = 0; axis < 3; axis++) {
+			int extent = part.Max[axis] - part.Min[axis] + 1;
+			int lastCut = std::numeric_limits<int>::min();
+			for (int ix = 1; ix <= SPLIT_CANDIDATES; ix++) {
+				// Voxels before the cut go on side A
+				int cut = part.Min[axis] + (extent * ix + SPLIT_CANDIDATES / 2) / (SPLIT_CANDIDATES + 1);
+				if (cut <= part.Min[axis] || cut > part.Max[axis] || cut == lastCut) {
+					continue;
+				}
+				lastCut = cut;
+
+				HullInfo hullA, hullB;
+				ComputeHull(GetHullPoints(grid, part, [&](const glm::ivec3& voxel) { return voxel[axis] < cut; }), hullA);
+				ComputeHull(GetHullPoints(grid, part, [&](const glm::ivec3& voxel) { return voxel[axis] >= cut; }), hullB);
+				float cost = hullA.Volume + hullB.Volume;
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestCut = cut;
+				}
+			}
+		}
+
+		if (bestAxis < 0) {
+			return false;
+		}
+
+		outA = Part();
+		outB = Part();
+		for (const glm::ivec3& voxel : part.Voxels) {
+			(voxel[bestAxis] < bestCut ? outA : outB).Voxels.push_back(voxel);
+		}
+		if (outA.Voxels.empty() || outB.Voxels.empty()) {
+			return false;
+		}
+		UpdateBounds(outA);
+		UpdateBounds(outB);
+		return true;
+	}
+
+	/// <summary>
+	/// Splits a mesh into convex parts, returning the points to wrap each part's hull around
+	/// </summary>
+	std::vector<std::vector<glm::vec3>> Decompose(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, const CollisionCookSettings& settings) {
+		glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+		glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+		for (const glm::vec3& position : positions) {
+			min = glm::min(min, position);
+			max = glm::max(max, position);
+		}
+		glm::vec3 extents = max - min;
+		float longest = glm::max(glm::max(extents.x, extents.y), extents.z);
+		if (longest <= 0.0f) {
+			return {};
+		}
+
+		// The grid has a layer of empty voxels around the mesh, so that the outside is all connected
+		VoxelGrid grid;
+		grid.Size = longest / std::max(settings.VoxelResolution, 1u);
+		grid.Origin = min - grid.Size;
+		grid.Dims = glm::ivec3(glm::floor(extents / grid.Size)) + 3;
+		grid.Owner.assign((size_t)grid.Dims.x * grid.Dims.y * grid.Dims.z, -1);
+
+		// Sample each triangle densely enough that it can't pass through a voxel without marking it
+		std::vector<SurfaceSample> samples;
+		std::vector<bool> isSurface(grid.Owner.size(), false);
+		float spacing = grid.Size * 0.5f;
+		for (size_t ix = 0; ix + 2 < indices.size(); ix += 3) {
+			glm::vec3 a = positions[indices[ix]], b = positions[indices[ix + 1]], c = positions[indices[ix + 2]];
+			float longestEdge = glm::max(glm::max(glm::distance(a, b), glm::distance(b, c)), glm::distance(c, a));
+			int steps = glm::max(static_cast<int>(glm::ceil(longestEdge / spacing)), 1);
+			for (int u = 0; u <= steps; u++) {
+				for (int v = 0; v <= steps - u; v++) {
+					glm::vec3 position = a + (b - a) * (u / (float)steps) + (c - a) * (v / (float)steps);
+					size_t voxel = grid.Index(grid.Cell(position));
+					isSurface[voxel] = true;
+					samples.push_back({ position, voxel });
+				}
+			}
+		}
+
+		// Flood the outside of the mesh from the edges of the grid, anything we can't reach is inside. Holes in the mesh that
+		// are bigger than a voxel will let the flood in, in which case we only keep the surface
+		std::vector<bool> isOutside(grid.Owner.size(), false);
+		std::deque<glm::ivec3> queue;
+		auto visit = [&](const glm::ivec3& cell) {
+			if (glm::all(glm::greaterThanEqual(cell, glm::ivec3(0))) && glm::all(glm::lessThan(cell, grid.Dims))) {
+				size_t index = grid.Index(cell);
+				if (!isOutside[index] && !isSurface[index]) {
+					isOutside[index] = true;
+					queue.push_back(cell);
+				}
+			}
+		};
+		visit(glm::ivec3(0));
+		while (!queue.empty()) {
+			glm::ivec3 cell = queue.front();
+			queue.pop_front();
+			for (int axis = 0; axis < 3; axis++) {
+				glm::ivec3 offset = glm::ivec3(0);
+				offset[axis] = 1;
+				visit(cell + offset);
+				visit(cell - offset);
+			}
+		}
+
+		std::vector<Part> parts(1);
+		for (int z = 0; z < grid.Dims.z; z++) {
+			for (int y = 0; y < grid.Dims.y; y++) {
+				for (int x = 0; x < grid.Dims.x; x++) {
+					if (!isOutside[grid.Index(glm::ivec3(x, y, z))]) {
+						parts[0].Voxels.push_back(glm::ivec3(x, y, z));
+					}
+				}
+			}
+		}
+		if (parts[0].Voxels.empty()) {
+			return {};
+		}
+		UpdateBounds(parts[0]);
+
+		float totalVolume = parts[0].Voxels.size() * grid.Size * grid.Size * grid.Size;
+		parts[0].Concavity = GetConcavity(grid, parts[0], totalVolume);
+
+		// Keep splitting whichever part has the most empty space in it's hull
+		while (parts.size() < settings.MaxHulls) {
+			auto worst = std::max_element(parts.begin(), parts.end(), [](const Part& a, const Part& b) { return a.Concavity < b.Concavity; });
+			if (worst->Concavity <= settings.MaxConcavity) {
+				break;
+			}
+
+			Part a, b;
+			if (!SplitPart(grid, *worst, a, b)) {
+				// Stop trying to split this part
+				worst->Concavity = 0.0f;
+				continue;
+			}
+			a.Concavity = GetConcavity(grid, a, totalVolume);
+			b.Concavity = GetConcavity(grid, b, totalVolume);
+			*worst = std::move(a);
+			parts.push_back(std::move(b));
+		}
+
+		for (int ix = 0; ix < parts.size(); ix++) {
+			for (const glm::ivec3& voxel : parts[ix].Voxels) {
+				grid.Owner[grid.Index(voxel)] = ix;
+			}
+		}
+
+		// Wrap each part around the surface of the mesh inside of it, so the hulls hug the mesh rather than the voxels. Samples
+		// next to a cut are shared with the part across it, otherwise there would be gaps between the hulls
+		std::vector<std::vector<glm::vec3>> result(parts.size());
+		for (const SurfaceSample& sample : samples) {
+			int owner = grid.Owner[sample.Voxel];
+			if (owner < 0) {
+				continue;
+			}
+			result[owner].push_back(sample.Position);
+
+			glm::ivec3 cell = grid.Cell(sample.Position);
+			for (int axis = 0; axis < 3; axis++) {
+				for (int direction = -1; direction <= 1; direction += 2) {
+					glm::ivec3 neighbour = cell;
+					neighbour[axis] += direction;
+					// The grid is padded, so the neighbours of solid voxels are always inside of it
+					int neighbourOwner = grid.Owner[grid.Index(neighbour)];
+					if (neighbourOwner >= 0 && neighbourOwner != owner) {
+						result[neighbourOwner].push_back(sample.Position);
+					}
+				}
+			}
+		}
+		// Parts that are entirely inside of the mesh (or are too thin to have a hull) fall back to their voxels
+		for (int ix = 0; ix < parts.size(); ix++) {
+			HullInfo hull;
+			if (!ComputeHull(result[ix], hull) || hull.Volume <= 0.0f) {
+				result[ix] = GetHullPoints(grid, parts[ix], [](const glm::ivec3&) { return true; });
+			}
+		}
+		return result;
+	}
+
+	template <typename T>
+	void Write(std::ofstream& file, const T& value) {
+		file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	void Read(std::ifstream& file, T& value) {
+		file.read(reinterpret_cast<char*>(&value), sizeof(T));
+	}
+}
+
+CookedCollisionShape::Sptr CollisionCooker::Cook(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, const CollisionCookSettings& settings) {
+	// Meshes without indices are triangle lists in vertex order
+	std::vector<uint32_t> triangles = indices;
+	if (triangles.empty()) {
+		triangles.resize(positions.size() / 3 * 3);
+		for (uint32_t ix = 0; ix < triangles.size(); ix++) {
+			triangles[ix] = ix;
+		}
+	}
+
+	std::vector<std::vector<glm::vec3>> pieces;
+	if (settings.MaxHulls > 1) {
+		pieces = Decompose(positions, triangles, settings);
+	}
+	if (pieces.empty()) {
+		pieces.push_back(positions);
+	}
+
+	CookedCollisionShape::Sptr result = std::make_shared<CookedCollisionShape>();
+	result->Settings = settings;
+	for (const std::vector<glm::vec3>& piece : pieces) {
+		std::vector<glm::vec3> hull = ReduceHull(piece, settings.MaxHullVertices);
+		if (!hull.empty()) {
+			result->Hulls.emplace_back();
+			for (const glm::vec3& point : hull) {
+				result->Hulls.back().push_back(btVector3(point.x, point.y, point.z));
+			}
+		}
+	}
+
+	return result->Hulls.empty() ? nullptr : result;
+}
+
+std::string CollisionCooker::GetCachePath(const std::string& meshFilename, int meshIndex) {
+	fs::path result = fs::path(meshFilename);
+	if (meshIndex != 0) {
+		result.replace_extension();
+		result += "_" + std::to_string(meshIndex);
+	}
+	return result.replace_extension(CACHE_EXTENSION).string();
+}
+
+bool CollisionCooker::SaveToFile(const CookedCollisionShape& shape, const std::string& filename) {
+	std::ofstream file(filename, std::ios::binary);
+	if (!file) {
+		LOG_WARN("Failed to open \"{}\" for writing collision hulls", filename);
+		return false;
+	}
+
+	file.write(HEADER_BYTES, sizeof(HEADER_BYTES));
+	uint16_t version = CACHE_VERSION;
+	Write(file, version);
+	Write(file, shape.Settings.MaxHullVertices);
+	Write(file, shape.Settings.MaxHulls);
+	Write(file, shape.Settings.MaxConcavity);
+	Write(file, shape.Settings.VoxelResolution);
+
+	Write(file, static_cast<uint32_t>(shape.Hulls.size()));
+	for (const std::vector<btVector3>& hull : shape.Hulls) {
+		Write(file, static_cast<uint32_t>(hull.size()));
+		for (const btVector3& point : hull) {
+			Write(file, glm::vec3(point.x(), point.y(), point.z()));
+		}
+	}
+
+	return file.good();
+}
+
+CookedCollisionShape::Sptr CollisionCooker::LoadFromFile(const std::string& filename, const CollisionCookSettings& settings, const std::string& sourceFilename) {
+	std::error_code error;
+	if (!fs::exists(filename, error)) {
+		return nullptr;
+	}
+	// If the mesh has been changed since we cooked it, the cache is out of date
+	if (!sourceFilename.empty() && fs::exists(sourceFilename, error) &&
+		fs::last_write_time(sourceFilename, error) > fs::last_write_time(filename, error)) {
+		return nullptr;
+	}
+
+	std::ifstream file(filename, std::ios::binary);
+	if (!file) {
+		return nullptr;
+	}
+
+	char header[sizeof(HEADER_BYTES)];
+	uint16_t version = 0;
+	file.read(header, sizeof(header));
+	Read(file, version);
+	if (!file || memcmp(header, HEADER_BYTES, sizeof(HEADER_BYTES)) != 0 || version != CACHE_VERSION) {
+		return nullptr;
+	}
+
+	CookedCollisionShape::Sptr result = std::make_shared<CookedCollisionShape>();
+	Read(file, result->Settings.MaxHullVertices);
+	Read(file, result->Settings.MaxHulls);
+	Read(file, result->Settings.MaxConcavity);
+	Read(file, result->Settings.VoxelResolution);
+	if (!file || result->Settings != settings) {
+		return nullptr;
+	}
+
+	uint32_t hullCount = 0;
+	Read(file, hullCount);
+	if (!file || hullCount > MAX_CACHED_HULLS) {
+		LOG_WARN("Collision cache \"{}\" is corrupt", filename);
+		return nullptr;
+	}
+	result->Hulls.resize(hullCount);
+	for (std::vector<btVector3>& hull : result->Hulls) {
+		uint32_t pointCount = 0;
+		Read(file, pointCount);
+		if (!file || pointCount > MAX_CACHED_HULL_VERTICES) {
+			LOG_WARN("Collision cache \"{}\" is corrupt", filename);
+			return nullptr;
+		}
+		hull.reserve(pointCount);
+		for (uint32_t ix = 0; ix < pointCount; ix++) {
+			glm::vec3 point;
+			Read(file, point);
+			hull.push_back(btVector3(point.x, point.y, point.z));
+		}
+	}
+
+	return file ? result : nullptr;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <GLM/glm.hpp>
+#include <LinearMath/btVector3.h>
+
+/// <summary>
+/// Controls how a mesh is turned into convex collision hulls
+/// </summary>
+struct CollisionCookSettings {
+	// The most vertices any one hull may have, more vertices fit the mesh closer but take longer to collide
+	uint32_t MaxHullVertices = 32;
+	// The most hulls a concave mesh may be split into, 1 wraps the whole mesh in a single hull
+	uint32_t MaxHulls = 1;
+	// Splitting stops once the empty space inside the hulls is below this fraction of the mesh's volume
+	float    MaxConcavity = 0.05f;
+	// The number of voxels along the longest side of the mesh's bounds when splitting
+	uint32_t VoxelResolution = 48;
+
+	bool operator==(const CollisionCookSettings& other) const {
+		return MaxHullVertices == other.MaxHullVertices && MaxHulls == other.MaxHulls &&
+			MaxConcavity == other.MaxConcavity && VoxelResolution == other.VoxelResolution;
+	}
+	bool operator!=(const CollisionCookSettings& other) const { return !(*this == other); }
+};
+
+/// <summary>
+/// The convex hulls cooked from a mesh, in the mesh's object space. These are stored as bullet
+/// vectors so that collision shapes can point straight at them instead of keeping their own copies
+/// </summary>
+struct CookedCollisionShape {
+	typedef std::shared_ptr<CookedCollisionShape> Sptr;
+
+	// The settings that the hulls were cooked with
+	CollisionCookSettings               Settings;
+	// The vertices of each hull
+	std::vector<std::vector<btVector3>> Hulls;
+};
+
+/// <summary>
+/// Builds simplified convex collision hulls from triangle meshes, so that physics doesn't need to test
+/// against every triangle of the render mesh.
+///
+/// A single hull is the exact convex hull reduced to a vertex budget, by repeatedly keeping the hull
+/// vertex that sticks out furthest from the hull of the vertices kept so far. Concave meshes can
+/// instead be split into several hulls, similar to V-HACD: the mesh is voxelized, then the part whose
+/// hull has the most empty space is cut along the axis aligned plane that shrinks the hulls the most,
+/// until the hulls are tight enough or we run out of hulls. Each part is then wrapped around the
+/// surface of the mesh inside of it.
+///
+/// Results can be cached next to the mesh's file, since cooking is too slow to do on every load
+/// </summary>
+class CollisionCooker {
+public:
+	// The file extension of our cached hulls
+	static const char* CACHE_EXTENSION;
+	// The cache format version that we write, older files are re-cooked
+	static const uint16_t CACHE_VERSION = 0x01;
+
+	/// <summary>
+	/// Cooks the collision hulls for a triangle mesh
+	/// </summary>
+	/// <param name="positions">The object space positions of the mesh's vertices</param>
+	/// <param name="indices">The mesh's triangle list, or empty to treat every 3 vertices as a triangle</param>
+	/// <param name="settings">The settings to cook with</param>
+	/// <returns>The cooked hulls, or nullptr if the mesh has no volume</returns>
+	static CookedCollisionShape::Sptr Cook(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, const CollisionCookSettings& settings = CollisionCookSettings());
+
+	/// <summary>
+	/// Gets the path that the cooked hulls for a mesh file are cached at
+	/// </summary>
+	/// <param name="meshFilename">The path to the mesh file (ex: an OBJ or it's baked .bin file)</param>
+	/// <param name="meshIndex">For files with multiple meshes (ex: glTF), the index of the mesh</param>
+	static std::string GetCachePath(const std::string& meshFilename, int meshIndex = 0);
+
+	/// <summary>
+	/// Writes cooked hulls to a cache file
+	/// </summary>
+	/// <returns>True if the file was written</returns>
+	static bool SaveToFile(const CookedCollisionShape& shape, const std::string& filename);
+
+	/// <summary>
+	/// Loads cooked hulls from a cache file, as long as they were cooked with the given settings and the file is
+	/// not older than the mesh file it was cooked from
+	/// </summary>
+	/// <param name="filename">The cache file to load</param>
+	/// <param name="settings">The settings that the hulls must have been cooked with</param>
+	/// <param name="sourceFilename">If not empty, the mesh file the hulls were cooked from</param>
+	/// <returns>The cached hulls, or nullptr if the cache is missing or out of date</returns>
+	static CookedCollisionShape::Sptr LoadFromFile(const std::string& filename, const CollisionCookSettings& settings, const std::string& sourceFilename = "");
+
+protected:
+	CollisionCooker() = default;
+	~CollisionCooker() = default;
+};
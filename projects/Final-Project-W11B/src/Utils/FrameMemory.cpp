@@ -0,0 +1,90 @@
+#include "Utils/FrameMemory.h"
+
+#include <cstdlib>
+#include <new>
+
+std::atomic<uint64_t> FrameMemory::_heapAllocations = 0;
+std::atomic<uint64_t> FrameMemory::_heapBytes = 0;
+std::atomic<uint64_t> FrameMemory::_poolAllocations = 0;
+FrameMemoryStats      FrameMemory::_lastFrame;
+
+/// <summary>
+/// Forwards to a synchronized pool, counting the allocations that are made from it
+/// </summary>
+class CountingPoolResource final : public std::pmr::memory_resource {
+public:
+	CountingPoolResource(std::atomic<uint64_t>& counter) :
+		_counter(counter),
+		_pool(_Options())
+	{ }
+
+protected:
+	std::atomic<uint64_t>&                  _counter;
+	std::pmr::synchronized_pool_resource    _pool;
+
+	static std::pmr::pool_options _Options() {
+		std::pmr::pool_options options;
+		// Anything bigger than this isn't worth pooling, and goes straight to the heap
+		options.largest_required_pool_block = 1024;
+		options.max_blocks_per_chunk = 256;
+		return options;
+	}
+
+	virtual void* do_allocate(size_t bytes, size_t alignment) override {
+		_counter.fetch_add(1, std::memory_order_relaxed);
+		return _pool.allocate(bytes, alignment);
+	}
+	virtual void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+		_pool.deallocate(ptr, bytes, alignment);
+	}
+	virtual bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+		return this == &other;
+	}
+};
+
+LinearAllocator& FrameMemory::Frame() {
+	static LinearAllocator allocator(256 * 1024);
+	return allocator;
+}
+
+std::pmr::memory_resource* FrameMemory::Objects() {
+	// Intentionally never destroyed, since objects can be released by static destructors
+	// after this function's statics would have been torn down
+	static CountingPoolResource* pool = new CountingPoolResource(_poolAllocations);
+	return pool;
+}
+
+void FrameMemory::EndFrame() {
+	LinearAllocator& frame = Frame();
+
+	_lastFrame.HeapAllocations  = _heapAllocations.exchange(0, std::memory_order_relaxed);
+	_lastFrame.HeapBytes        = _heapBytes.exchange(0, std::memory_order_relaxed);
+	_lastFrame.PoolAllocations  = _poolAllocations.exchange(0, std::memory_order_relaxed);
+	_lastFrame.FrameAllocations = frame.GetAllocationCount();
+	_lastFrame.FrameBytes       = frame.GetBytesUsed();
+	_lastFrame.FrameCapacity    = frame.GetCapacity();
+
+	frame.Reset();
+}
+
+// We replace the global new and delete so that we can count heap allocations. The array and nothrow
+// versions are implemented in terms of these by the standard library, so they are counted as well
+
+void* operator new(size_t size) {
+	FrameMemory::_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+	FrameMemory::_heapBytes.fetch_add(size, std::memory_order_relaxed);
+
+	void* result = std::malloc(size != 0 ? size : 1);
+	if (result == nullptr) {
+		throw std::bad_alloc();
+	}
+	return result;
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t size) noexcept {
+	std::free(ptr);
+}
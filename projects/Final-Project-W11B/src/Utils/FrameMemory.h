@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+
+#include "Utils/LinearAllocator.h"
+
+/// <summary>
+/// The allocation counts for a single frame
+/// </summary>
+struct FrameMemoryStats {
+	// Calls to the global operator new, from any thread
+	uint64_t HeapAllocations = 0;
+	uint64_t HeapBytes       = 0;
+	// Allocations made from the frame allocator
+	uint64_t FrameAllocations = 0;
+	uint64_t FrameBytes       = 0;
+	// The size of the frame allocator's buffer
+	uint64_t FrameCapacity    = 0;
+	// Allocations made from the object pools (game objects and components)
+	uint64_t PoolAllocations  = 0;
+};
+
+/// <summary>
+/// Owns the engine's shared memory resources:
+///   - A frame allocator for scratch memory that only needs to live until the end of the
+///     frame, which is reset at the end of every iteration of the game loop
+///   - Fixed size pools that game objects and components are allocated from, these live
+///     for the whole application since weak references to objects can outlive their scenes
+/// 
+/// Also counts every heap allocation made during a frame, so that allocation regressions
+/// show up in the profiler and benchmark reports
+/// </summary>
+class FrameMemory final {
+public:
+	FrameMemory() = delete;
+
+	/// <summary>
+	/// Gets the frame allocator, allocations from it are released at the end of the frame.
+	/// NOTE: this must only be used from the main thread
+	/// </summary>
+	static LinearAllocator& Frame();
+	/// <summary>
+	/// Gets the pooled resource that game objects and components are allocated from, this is
+	/// safe to use from any thread
+	/// </summary>
+	static std::pmr::memory_resource* Objects();
+
+	/// <summary>
+	/// Resets the frame allocator and the per frame counters, should be called at the very end of
+	/// the game loop, once nothing is holding on to frame memory
+	/// </summary>
+	static void EndFrame();
+
+	/// <summary>
+	/// Gets the counts for the frame that has most recently ended
+	/// </summary>
+	static const FrameMemoryStats& GetLastFrameStats() { return _lastFrame; }
+
+protected:
+	friend void* operator new(size_t size);
+
+	static std::atomic<uint64_t> _heapAllocations;
+	static std::atomic<uint64_t> _heapBytes;
+	static std::atomic<uint64_t> _poolAllocations;
+	static FrameMemoryStats      _lastFrame;
+};
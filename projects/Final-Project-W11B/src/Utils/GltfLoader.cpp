@@ -0,0 +1,694 @@
+#include "Utils/GltfLoader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <GLM/gtc/type_ptr.hpp>
+#include <tiny_gltf.h>
+
+#include "Graphics/VertexTypes.h"
+#include "Utils/MeshBuilder.h"
+#include "Utils/MeshFactory.h"
+#include "Utils/StringUtils.h"
+#include "Logging.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+	// The glTF attributes that we load, and the vertex shader slots they feed
+	struct AttributeMapping {
+		const char* Name;
+		uint32_t    Slot;
+		AttribUsage Usage;
+	};
+	const AttributeMapping ATTRIBUTES[] = {
+		{ "POSITION",   0, AttribUsage::Position },
+		{ "COLOR_0",    1, AttribUsage::Color },
+		{ "NORMAL",     2, AttribUsage::Normal },
+		{ "TEXCOORD_0", 3, AttribUsage::Texture },
+		{ "TANGENT",    4, AttribUsage::Tangent },
+	};
+
+	// An attribute of a primitive that we can upload without converting it
+	struct DirectAttribute {
+		const AttributeMapping*   Mapping;
+		const tinygltf::Accessor* Accessor;
+	};
+
+	// Images are loaded through our texture classes, so we don't want tinygltf spending time decoding them
+	bool SkipImage(tinygltf::Image*, const int, std::string*, std::string*, int, int, const unsigned char*, int, void*) {
+		return true;
+	}
+
+	bool ParseFile(const std::string& filename, tinygltf::Model& model) {
+		std::string extension = fs::path(filename).extension().string();
+		StringTools::ToLower(extension);
+
+		tinygltf::TinyGLTF loader;
+		loader.SetImageLoader(SkipImage, nullptr);
+
+		std::string error, warning;
+		bool success = extension == ".glb" ?
+			loader.LoadBinaryFromFile(&model, &error, &warning, filename) :
+			loader.LoadASCIIFromFile(&model, &error, &warning, filename);
+
+		if (!warning.empty()) {
+			LOG_WARN("While loading \"{}\": {}", filename, warning);
+		}
+		if (!success) {
+			LOG_ERROR("Failed to load \"{}\": {}", filename, error);
+		}
+		return success;
+	}
+
+	// Checks that every element of an accessor lies within it's buffer, since we read them without any further checks
+	bool IsInBounds(const tinygltf::Model& model, const tinygltf::Accessor& accessor) {
+		if (accessor.bufferView < 0) {
+			return true;
+		}
+		if (accessor.bufferView >= model.bufferViews.size()) {
+			return false;
+		}
+		const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
+		if (view.buffer < 0 || view.buffer >= model.buffers.size()) {
+			return false;
+		}
+		int stride = accessor.ByteStride(view);
+		int componentSize = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+		int components = tinygltf::GetNumComponentsInType(accessor.type);
+		if (stride <= 0 || componentSize <= 0 || components <= 0) {
+			return false;
+		}
+		if (accessor.count == 0) {
+			return true;
+		}
+		size_t bufferSize = model.buffers[view.buffer].data.size();
+		if (view.byteOffset > bufferSize || view.byteLength > bufferSize - view.byteOffset || accessor.byteOffset > view.byteLength) {
+			return false;
+		}
+		// Divide rather than multiply so that huge counts or offsets can't overflow past the check
+		size_t available = view.byteLength - accessor.byteOffset;
+		size_t elementSize = (size_t)componentSize * components;
+		return elementSize <= available && accessor.count - 1 <= (available - elementSize) / (size_t)stride;
+	}
+
+	// Checks that a tightly packed range of a buffer view lies within both the view and it's buffer
+	bool IsRangeInBounds(const tinygltf::Model& model, int viewIx, size_t byteOffset, size_t count, size_t elementSize) {
+		if (viewIx < 0 || viewIx >= model.bufferViews.size()) {
+			return false;
+		}
+		const tinygltf::BufferView& view = model.bufferViews[viewIx];
+		if (view.buffer < 0 || view.buffer >= model.buffers.size()) {
+			return false;
+		}
+		size_t bufferSize = model.buffers[view.buffer].data.size();
+		if (view.byteOffset > bufferSize || view.byteLength > bufferSize - view.byteOffset || byteOffset > view.byteLength) {
+			return false;
+		}
+		// Divide rather than multiply so that huge counts can't overflow past the check
+		return elementSize > 0 && count <= (view.byteLength - byteOffset) / elementSize;
+	}
+
+	const uint8_t* GetAccessorData(const tinygltf::Model& model, const tinygltf::Accessor& accessor) {
+		const tinygltf::BufferView& view = model.bufferViews[accessor.bufferView];
+		return model.buffers[view.buffer].data.data() + view.byteOffset + accessor.byteOffset;
+	}
+
+	// Reads a single component as a float, applying glTF's rules for normalized integers
+	float ReadComponent(const uint8_t* data, int componentType, bool normalized) {
+		switch (componentType) {
+			case TINYGLTF_COMPONENT_TYPE_BYTE: {
+				int8_t value; memcpy(&value, data, sizeof(value));
+				return normalized ? glm::max(value / 127.0f, -1.0f) : value;
+			}
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
+				uint8_t value; memcpy(&value, data, sizeof(value));
+				return normalized ? value / 255.0f : value;
+			}
+			case TINYGLTF_COMPONENT_TYPE_SHORT: {
+				int16_t value; memcpy(&value, data, sizeof(value));
+				return normalized ? glm::max(value / 32767.0f, -1.0f) : value;
+			}
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+				uint16_t value; memcpy(&value, data, sizeof(value));
+				return normalized ? value / 65535.0f : value;
+			}
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT: {
+				uint32_t value; memcpy(&value, data, sizeof(value));
+				return static_cast<float>(value);
+			}
+			case TINYGLTF_COMPONENT_TYPE_FLOAT: {
+				float value; memcpy(&value, data, sizeof(value));
+				return value;
+			}
+			default:
+				return 0.0f;
+		}
+	}
+
+	uint32_t ReadIndex(const uint8_t* data, int componentType) {
+		switch (componentType) {
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:  { uint8_t value;  memcpy(&value, data, sizeof(value)); return value; }
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: { uint16_t value; memcpy(&value, data, sizeof(value)); return value; }
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:   { uint32_t value; memcpy(&value, data, sizeof(value)); return value; }
+			default: return 0;
+		}
+	}
+
+	// Checks that the sparse indices and values of an accessor lie within their buffers, and that every index targets an element of the accessor
+	bool IsSparseInBounds(const tinygltf::Model& model, const tinygltf::Accessor& accessor) {
+		if (!accessor.sparse.isSparse) {
+			return true;
+		}
+		const auto& indices = accessor.sparse.indices;
+		const auto& values = accessor.sparse.values;
+		if (accessor.sparse.count < 0 || (indices.componentType != TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE &&
+			indices.componentType != TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT && indices.componentType != TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)) {
+			return false;
+		}
+		int componentSize = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+		int components = tinygltf::GetNumComponentsInType(accessor.type);
+		if (componentSize <= 0 || components <= 0) {
+			return false;
+		}
+		size_t count = static_cast<size_t>(accessor.sparse.count);
+		size_t indexSize = tinygltf::GetComponentSizeInBytes(indices.componentType);
+		size_t valueSize = (size_t)componentSize * components;
+		if (!IsRangeInBounds(model, indices.bufferView, indices.byteOffset, count, indexSize) ||
+			!IsRangeInBounds(model, values.bufferView, values.byteOffset, count, valueSize)) {
+			return false;
+		}
+
+		const tinygltf::BufferView& indexView = model.bufferViews[indices.bufferView];
+		const uint8_t* indexData = model.buffers[indexView.buffer].data.data() + indexView.byteOffset + indices.byteOffset;
+		for (size_t ix = 0; ix < count; ix++) {
+			if (ReadIndex(indexData + ix * indexSize, indices.componentType) >= accessor.count) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Decodes every element of an accessor to floats, including any sparse substitutions. Components that the
+	/// accessor doesn't have are taken from defaultValue
+	/// </summary>
+	/// <returns>False if the accessor or it's sparse values run outside of their buffers, in which case result is empty</returns>
+	bool DecodeAccessor(const tinygltf::Model& model, int accessorIx, const glm::vec4& defaultValue, std::vector<glm::vec4>& result) {
+		result.clear();
+		if (accessorIx < 0 || accessorIx >= model.accessors.size()) {
+			LOG_WARN("Accessor {} does not exist", accessorIx);
+			return false;
+		}
+		const tinygltf::Accessor& accessor = model.accessors[accessorIx];
+		if (!IsInBounds(model, accessor)) {
+			LOG_WARN("Accessor {} runs outside of it's buffer", accessorIx);
+			return false;
+		}
+		if (!IsSparseInBounds(model, accessor)) {
+			LOG_WARN("Sparse values for accessor {} run outside of their buffers or target elements outside of the accessor", accessorIx);
+			return false;
+		}
+		result.assign(accessor.count, defaultValue);
+
+		int components = glm::min(tinygltf::GetNumComponentsInType(accessor.type), 4);
+		int componentSize = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+		auto readElement = [&](const uint8_t* data, glm::vec4& out) {
+			for (int ix = 0; ix < components; ix++) {
+				out[ix] = ReadComponent(data + ix * componentSize, accessor.componentType, accessor.normalized);
+			}
+		};
+
+		// Accessors without a buffer view are all zeros, unless sparse values are substituted in
+		if (accessor.bufferView >= 0) {
+			const uint8_t* data = GetAccessorData(model, accessor);
+			size_t stride = accessor.ByteStride(model.bufferViews[accessor.bufferView]);
+			for (size_t ix = 0; ix < accessor.count; ix++) {
+				readElement(data + ix * stride, result[ix]);
+			}
+		} else {
+			for (glm::vec4& element : result) {
+				for (int ix = 0; ix < components; ix++) {
+					element[ix] = 0.0f;
+				}
+			}
+		}
+
+		if (accessor.sparse.isSparse) {
+			const tinygltf::BufferView& indexView = model.bufferViews[accessor.sparse.indices.bufferView];
+			const tinygltf::BufferView& valueView = model.bufferViews[accessor.sparse.values.bufferView];
+			const std::vector<unsigned char>& indexBuffer = model.buffers[indexView.buffer].data;
+			const std::vector<unsigned char>& valueBuffer = model.buffers[valueView.buffer].data;
+			size_t indexStart = indexView.byteOffset + accessor.sparse.indices.byteOffset;
+			size_t valueStart = valueView.byteOffset + accessor.sparse.values.byteOffset;
+			size_t indexSize = tinygltf::GetComponentSizeInBytes(accessor.sparse.indices.componentType);
+			size_t valueSize = (size_t)tinygltf::GetNumComponentsInType(accessor.type) * componentSize;
+			size_t count = static_cast<size_t>(accessor.sparse.count);
+
+			// IsSparseInBounds has already checked both ranges and every target index
+			for (size_t ix = 0; ix < count; ix++) {
+				uint32_t target = ReadIndex(indexBuffer.data() + indexStart + ix * indexSize, accessor.sparse.indices.componentType);
+				readElement(valueBuffer.data() + valueStart + ix * valueSize, result[target]);
+			}
+		}
+
+		return true;
+	}
+
+	// Returns true if the shaders can read an attribute exactly as it's stored in the file
+	bool IsDirectFormat(const AttributeMapping& mapping, const tinygltf::Accessor& accessor) {
+		bool isFloat = accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT;
+		bool isUnorm = accessor.normalized &&
+			(accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE || accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT);
+		switch (mapping.Usage) {
+			case AttribUsage::Position:
+			case AttribUsage::Normal:
+				return isFloat && accessor.type == TINYGLTF_TYPE_VEC3;
+			case AttribUsage::Tangent:
+				return isFloat && accessor.type == TINYGLTF_TYPE_VEC4;
+			case AttribUsage::Texture:
+				return (isFloat || isUnorm) && accessor.type == TINYGLTF_TYPE_VEC2;
+			case AttribUsage::Color:
+				return (isFloat || isUnorm) && (accessor.type == TINYGLTF_TYPE_VEC3 || accessor.type == TINYGLTF_TYPE_VEC4);
+			default:
+				return false;
+		}
+	}
+
+	/// <summary>
+	/// Converts an attribute in place from glTF conventions to ours. glTF puts the UV origin at the top left, but
+	/// we flip our textures when loading them, so V needs to be flipped, which also mirrors the bitangent
+	/// </summary>
+	void FixupAttribute(uint8_t* data, size_t stride, size_t count, const tinygltf::Accessor& accessor, AttribUsage usage) {
+		for (size_t ix = 0; ix < count; ix++) {
+			uint8_t* element = data + ix * stride;
+			if (usage == AttribUsage::Texture) {
+				uint8_t* v = element + tinygltf::GetComponentSizeInBytes(accessor.componentType);
+				if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) {
+					float value; memcpy(&value, v, sizeof(value));
+					value = 1.0f - value;
+					memcpy(v, &value, sizeof(value));
+				} else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
+					uint16_t value; memcpy(&value, v, sizeof(value));
+					value = 0xFFFF - value;
+					memcpy(v, &value, sizeof(value));
+				} else {
+					*v = 0xFF - *v;
+				}
+			} else if (usage == AttribUsage::Tangent) {
+				float sign; memcpy(&sign, element + 3 * sizeof(float), sizeof(sign));
+				sign = -sign;
+				memcpy(element + 3 * sizeof(float), &sign, sizeof(sign));
+			}
+		}
+	}
+
+	/// <summary>
+	/// Uploads a primitive's buffer views straight to the GPU, interleaved or not, without decoding any elements. Returns
+	/// nullptr if the primitive is missing attributes we need or uses formats the shaders can't read, so that it can be
+	/// converted instead
+	/// </summary>
+	VertexArrayObject::Sptr LoadDirect(const tinygltf::Model& model, const tinygltf::Primitive& primitive) {
+		if (primitive.mode != TINYGLTF_MODE_TRIANGLES) {
+			return nullptr;
+		}
+
+		// Lighting needs normals, and normal mapping needs tangents, so if either is missing we need to generate them
+		bool hasUVs = primitive.attributes.count("TEXCOORD_0") > 0;
+		if (primitive.attributes.count("POSITION") == 0 || primitive.attributes.count("NORMAL") == 0 ||
+			(hasUVs && primitive.attributes.count("TANGENT") == 0)) {
+			return nullptr;
+		}
+
+		// Collect the attributes we use, position is always first since our bounds and colliders expect it to be
+		std::vector<DirectAttribute> attributes;
+		size_t vertexCount = model.accessors[primitive.attributes.at("POSITION")].count;
+		for (const AttributeMapping& mapping : ATTRIBUTES) {
+			auto it = primitive.attributes.find(mapping.Name);
+			if (it == primitive.attributes.end()) {
+				continue;
+			}
+			const tinygltf::Accessor& accessor = model.accessors[it->second];
+			if (!IsDirectFormat(mapping, accessor) || accessor.bufferView < 0 || accessor.sparse.isSparse ||
+				accessor.count != vertexCount || !IsInBounds(model, accessor)) {
+				return nullptr;
+			}
+			attributes.push_back({ &mapping, &accessor });
+		}
+
+		// Index buffers must be tightly packed, and use one of the types GL can draw with
+		IndexType indexType = IndexType::Unknown;
+		const tinygltf::Accessor* indices = primitive.indices >= 0 ? &model.accessors[primitive.indices] : nullptr;
+		if (indices != nullptr) {
+			if (indices->bufferView < 0 || indices->sparse.isSparse || indices->type != TINYGLTF_TYPE_SCALAR || !IsInBounds(model, *indices)) {
+				return nullptr;
+			}
+			int indexSize = tinygltf::GetComponentSizeInBytes(indices->componentType);
+			if (indices->ByteStride(model.bufferViews[indices->bufferView]) != indexSize) {
+				return nullptr;
+			}
+			switch (indices->componentType) {
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:  indexType = IndexType::UByte;  break;
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: indexType = IndexType::UShort; break;
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:   indexType = IndexType::UInt;   break;
+				default: return nullptr;
+			}
+
+			// GL doesn't check the indices we draw with, so any past the last vertex would read outside of our buffers.
+			// Conversion drops triangles with bad indices, so we fall back to that
+			const uint8_t* indexData = GetAccessorData(model, *indices);
+			for (size_t ix = 0; ix < indices->count; ix++) {
+				if (ReadIndex(indexData + ix * indexSize, indices->componentType) >= vertexCount) {
+					return nullptr;
+				}
+			}
+		}
+
+		// Attributes interleaved in the same buffer view become a single vertex buffer. Tightly packed views
+		// can hold several attributes one after another, so each of those gets it's own buffer
+		std::vector<std::vector<DirectAttribute>> groups;
+		for (const DirectAttribute& attribute : attributes) {
+			const tinygltf::BufferView& view = model.bufferViews[attribute.Accessor->bufferView];
+			auto it = std::find_if(groups.begin(), groups.end(), [&](const std::vector<DirectAttribute>& group) {
+				return view.byteStride != 0 && group[0].Accessor->bufferView == attribute.Accessor->bufferView;
+			});
+			if (it != groups.end()) {
+				it->push_back(attribute);
+			} else {
+				groups.push_back({ attribute });
+			}
+		}
+
+		VertexArrayObject::Sptr result = VertexArrayObject::Create();
+		VertexArrayObject::VertexDeclaration vDecl;
+		for (const std::vector<DirectAttribute>& group : groups) {
+			const tinygltf::BufferView& view = model.bufferViews[group[0].Accessor->bufferView];
+			const std::vector<unsigned char>& buffer = model.buffers[view.buffer].data;
+			size_t stride = group[0].Accessor->ByteStride(view);
+
+			// Only upload from the first attribute we use, rather than from the start of the view
+			size_t start = group[0].Accessor->byteOffset;
+			for (const DirectAttribute& attribute : group) {
+				start = glm::min(start, attribute.Accessor->byteOffset);
+			}
+
+			// Attribute offsets are relative to the start of their own buffer
+			VertexArrayObject::VertexDeclaration bufferDecl;
+			bool needsFixup = false;
+			for (const DirectAttribute& attribute : group) {
+				const tinygltf::Accessor& accessor = *attribute.Accessor;
+				bufferDecl.push_back(BufferAttribute(attribute.Mapping->Slot, tinygltf::GetNumComponentsInType(accessor.type),
+					static_cast<AttributeType>(accessor.componentType), static_cast<GLsizei>(stride),
+					static_cast<GLsizei>(accessor.byteOffset - start), attribute.Mapping->Usage, accessor.normalized));
+				needsFixup |= attribute.Mapping->Usage == AttribUsage::Texture || attribute.Mapping->Usage == AttribUsage::Tangent;
+			}
+
+			// Most views are uploaded straight out of the file's buffer. We only need our own copy if the view holds
+			// attributes that need converting, or if the last vertex's padding would run off the end of the buffer
+			size_t begin = view.byteOffset + start;
+			size_t size = stride * vertexCount;
+			const uint8_t* data = buffer.data() + begin;
+			std::vector<uint8_t> staging;
+			if (needsFixup || begin + size > buffer.size()) {
+				staging.assign(size, 0);
+				memcpy(staging.data(), data, glm::min(size, buffer.size() - begin));
+				for (size_t ix = 0; ix < group.size(); ix++) {
+					FixupAttribute(staging.data() + bufferDecl[ix].Offset, stride, vertexCount, *group[ix].Accessor, group[ix].Mapping->Usage);
+				}
+				data = staging.data();
+			}
+
+			VertexBuffer::Sptr vbo = VertexBuffer::Create();
+			vbo->LoadData(data, static_cast<uint32_t>(stride), static_cast<uint32_t>(vertexCount));
+			result->AddVertexBuffer(vbo, bufferDecl);
+			vDecl.insert(vDecl.end(), bufferDecl.begin(), bufferDecl.end());
+		}
+
+		if (indices != nullptr) {
+			IndexBuffer::Sptr ebo = IndexBuffer::Create();
+			ebo->LoadData(GetAccessorData(model, *indices), tinygltf::GetComponentSizeInBytes(indices->componentType),
+				static_cast<uint32_t>(indices->count), indexType);
+			result->SetIndexBuffer(ebo);
+		}
+
+		result->SetVDecl(vDecl);
+
+		// glTF requires bounds on positions, but we'll calculate them if an exporter didn't bother
+		const tinygltf::Accessor& positions = *attributes[0].Accessor;
+		if (positions.minValues.size() == 3 && positions.maxValues.size() == 3) {
+			result->SetBounds(
+				glm::vec3(positions.minValues[0], positions.minValues[1], positions.minValues[2]),
+				glm::vec3(positions.maxValues[0], positions.maxValues[1], positions.maxValues[2]));
+		} else {
+			glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+			glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+			// Positions were bounds checked above and can't be sparse, so decoding them can't fail
+			std::vector<glm::vec4> decoded;
+			DecodeAccessor(model, primitive.attributes.at("POSITION"), glm::vec4(0.0f), decoded);
+			for (const glm::vec4& position : decoded) {
+				min = glm::min(min, glm::vec3(position));
+				max = glm::max(max, glm::vec3(position));
+			}
+			result->SetBounds(min, max);
+		}
+
+		return result;
+	}
+
+	/// <summary>
+	/// Decodes all of a mesh's triangle primitives into a single mesh, generating any normals and tangents that are
+	/// missing, and bakes it into a packed VAO
+	/// </summary>
+	VertexArrayObject::Sptr LoadConverted(const tinygltf::Model& model, const tinygltf::Mesh& mesh, const std::string& filename) {
+		std::vector<VertexPosNormTexColTangents> vertices;
+		std::vector<uint32_t> indices;
+		bool generateTangents = false;
+
+		for (const tinygltf::Primitive& primitive : mesh.primitives) {
+			auto position = primitive.attributes.find("POSITION");
+			if (primitive.mode != TINYGLTF_MODE_TRIANGLES || position == primitive.attributes.end()) {
+				LOG_WARN("Skipping a primitive of \"{}\" in \"{}\", only triangle lists with positions are supported", mesh.name, filename);
+				continue;
+			}
+
+			// Attributes the primitive doesn't have are left empty, but any that fail to decode invalidate the whole primitive
+			bool isValid = true;
+			auto decode = [&](const char* name, const glm::vec4& defaultValue) {
+				std::vector<glm::vec4> result;
+				auto it = primitive.attributes.find(name);
+				if (it != primitive.attributes.end()) {
+					isValid &= DecodeAccessor(model, it->second, defaultValue, result);
+				}
+				return result;
+			};
+			std::vector<glm::vec4> positions = decode("POSITION", glm::vec4(0.0f));
+			std::vector<glm::vec4> normals   = decode("NORMAL", glm::vec4(0.0f));
+			std::vector<glm::vec4> uvs       = decode("TEXCOORD_0", glm::vec4(0.0f));
+			std::vector<glm::vec4> colors    = decode("COLOR_0", glm::vec4(1.0f));
+			std::vector<glm::vec4> tangents  = decode("TANGENT", glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+			if (!isValid) {
+				LOG_WARN("Skipping a primitive of \"{}\" in \"{}\", it's attributes are invalid", mesh.name, filename);
+				continue;
+			}
+			size_t count = positions.size();
+			bool hasNormals = normals.size() == count;
+
+			uint32_t baseVertex = static_cast<uint32_t>(vertices.size());
+			vertices.resize(vertices.size() + count);
+			for (size_t ix = 0; ix < count; ix++) {
+				VertexPosNormTexColTangents& vertex = vertices[baseVertex + ix];
+				vertex.Position = positions[ix];
+				vertex.Color = colors.size() == count ? colors[ix] : glm::vec4(1.0f);
+				if (hasNormals) {
+					vertex.Normal = normals[ix];
+				}
+				if (uvs.size() == count) {
+					vertex.UV = glm::vec2(uvs[ix].x, 1.0f - uvs[ix].y);
+				}
+				if (tangents.size() == count && hasNormals) {
+					// Flipping V mirrors the bitangent
+					vertex.Tangent = tangents[ix];
+					vertex.BiTangent = glm::cross(vertex.Normal, vertex.Tangent) * -tangents[ix].w;
+				}
+			}
+
+			// Non-indexed primitives just use their vertices in order
+			size_t firstIndex = indices.size();
+			if (primitive.indices >= 0) {
+				const tinygltf::Accessor& accessor = model.accessors[primitive.indices];
+				if (accessor.bufferView < 0 || !IsInBounds(model, accessor)) {
+					LOG_WARN("Skipping a primitive of \"{}\" in \"{}\", it's indices are invalid", mesh.name, filename);
+					vertices.resize(baseVertex);
+					continue;
+				}
+				const uint8_t* data = GetAccessorData(model, accessor);
+				size_t stride = accessor.ByteStride(model.bufferViews[accessor.bufferView]);
+				for (size_t ix = 0; ix + 2 < accessor.count; ix += 3) {
+					uint32_t tri[3] = {
+						ReadIndex(data + (ix + 0) * stride, accessor.componentType),
+						ReadIndex(data + (ix + 1) * stride, accessor.componentType),
+						ReadIndex(data + (ix + 2) * stride, accessor.componentType)
+					};
+					if (tri[0] < count && tri[1] < count && tri[2] < count) {
+						indices.insert(indices.end(), { baseVertex + tri[0], baseVertex + tri[1], baseVertex + tri[2] });
+					}
+				}
+			} else {
+				for (uint32_t ix = 0; ix + 2 < count; ix += 3) {
+					indices.insert(indices.end(), { baseVertex + ix, baseVertex + ix + 1, baseVertex + ix + 2 });
+				}
+			}
+
+			// glTF says that missing normals should be flat, but smooth area weighted normals are much cheaper for us to store
+			if (!hasNormals) {
+				for (size_t ix = firstIndex; ix < indices.size(); ix += 3) {
+					glm::vec3 a = vertices[indices[ix]].Position, b = vertices[indices[ix + 1]].Position, c = vertices[indices[ix + 2]].Position;
+					glm::vec3 normal = glm::cross(b - a, c - a);
+					for (int corner = 0; corner < 3; corner++) {
+						vertices[indices[ix + corner]].Normal += normal;
+					}
+				}
+				for (size_t ix = baseVertex; ix < vertices.size(); ix++) {
+					float length = glm::length(vertices[ix].Normal);
+					vertices[ix].Normal = length > 0.0f ? vertices[ix].Normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+				}
+			}
+
+			generateTangents |= uvs.size() == count && (tangents.size() != count || !hasNormals);
+		}
+
+		if (vertices.empty() || indices.empty()) {
+			LOG_WARN("Mesh \"{}\" in \"{}\" has no triangles", mesh.name, filename);
+			return nullptr;
+		}
+
+		MeshBuilder<VertexPosNormTexColTangents> builder;
+		builder.AddVertexRange(vertices);
+		builder.ReserveIndexSpace(indices.size());
+		for (size_t ix = 0; ix < indices.size(); ix += 3) {
+			builder.AddIndexTri(indices[ix], indices[ix + 1], indices[ix + 2]);
+		}
+		if (generateTangents) {
+			MeshFactory::CalculateTBN(builder);
+		}
+		return builder.BakePacked();
+	}
+
+	VertexArrayObject::Sptr LoadMesh(const tinygltf::Model& model, int meshIndex, const std::string& filename) {
+		const tinygltf::Mesh& mesh = model.meshes[meshIndex];
+
+		// A single primitive can usually be uploaded as is, anything more complex gets merged and converted
+		VertexArrayObject::Sptr result = mesh.primitives.size() == 1 ? LoadDirect(model, mesh.primitives[0]) : nullptr;
+		if (result != nullptr) {
+			LOG_TRACE("Uploaded mesh \"{}\" from \"{}\" directly", mesh.name, filename);
+		} else {
+			result = LoadConverted(model, mesh, filename);
+			LOG_TRACE("Converted mesh \"{}\" from \"{}\"", mesh.name, filename);
+		}
+		return result;
+	}
+
+	GltfNode ConvertNode(const tinygltf::Node& node) {
+		GltfNode result;
+		result.Name = node.name;
+		result.Mesh = node.mesh;
+		result.Children = node.children;
+
+		if (node.matrix.size() == 16) {
+			glm::mat4 transform = glm::mat4(glm::make_mat4(node.matrix.data()));
+			result.Position = transform[3];
+			result.Scale = glm::vec3(glm::length(transform[0]), glm::length(transform[1]), glm::length(transform[2]));
+			// A mirroring transform can be represented by flipping one of the scale axes
+			if (glm::determinant(glm::mat3(transform)) < 0.0f) {
+				result.Scale.x = -result.Scale.x;
+			}
+			glm::mat3 rotation = glm::mat3(transform);
+			for (int ix = 0; ix < 3; ix++) {
+				rotation[ix] = result.Scale[ix] != 0.0f ? rotation[ix] / result.Scale[ix] : glm::vec3(0.0f);
+			}
+			result.Rotation = glm::normalize(glm::quat_cast(rotation));
+		} else {
+			if (node.translation.size() == 3) {
+				result.Position = glm::vec3(node.translation[0], node.translation[1], node.translation[2]);
+			}
+			// glTF stores quaternions as XYZW, GLM's constructor takes W first
+			if (node.rotation.size() == 4) {
+				result.Rotation = glm::quat((float)node.rotation[3], (float)node.rotation[0], (float)node.rotation[1], (float)node.rotation[2]);
+			}
+			if (node.scale.size() == 3) {
+				result.Scale = glm::vec3(node.scale[0], node.scale[1], node.scale[2]);
+			}
+		}
+		return result;
+	}
+}
+
+bool GltfLoader::IsGltfFile(const std::string& filename) {
+	std::string extension = fs::path(filename).extension().string();
+	StringTools::ToLower(extension);
+	return extension == ".gltf" || extension == ".glb";
+}
+
+VertexArrayObject::Sptr GltfLoader::LoadFromFile(const std::string& filename, int meshIndex) {
+	tinygltf::Model model;
+	if (!ParseFile(filename, model)) {
+		return nullptr;
+	}
+	if (meshIndex < 0 || meshIndex >= model.meshes.size()) {
+		LOG_WARN("\"{}\" does not have a mesh {} (it has {})", filename, meshIndex, model.meshes.size());
+		return nullptr;
+	}
+	return LoadMesh(model, meshIndex, filename);
+}
+
+bool GltfLoader::LoadModel(const std::string& filename, GltfModel& result) {
+	tinygltf::Model model;
+	if (!ParseFile(filename, model)) {
+		return false;
+	}
+
+	result.MeshNames.resize(model.meshes.size());
+	result.Meshes.resize(model.meshes.size());
+	for (int ix = 0; ix < model.meshes.size(); ix++) {
+		result.MeshNames[ix] = model.meshes[ix].name;
+		result.Meshes[ix] = LoadMesh(model, ix, filename);
+	}
+
+	result.Nodes.resize(model.nodes.size());
+	for (int ix = 0; ix < model.nodes.size(); ix++) {
+		result.Nodes[ix] = ConvertNode(model.nodes[ix]);
+		// Drop any references that would take us outside of the file
+		if (result.Nodes[ix].Mesh >= (int)model.meshes.size()) {
+			result.Nodes[ix].Mesh = -1;
+		}
+		auto& children = result.Nodes[ix].Children;
+		children.erase(std::remove_if(children.begin(), children.end(), [&](int child) {
+			return child < 0 || child >= (int)model.nodes.size();
+		}), children.end());
+	}
+
+	// Files without scenes are treated as having every node that isn't a child at the top level
+	if (!model.scenes.empty()) {
+		int scene = model.defaultScene >= 0 && model.defaultScene < model.scenes.size() ? model.defaultScene : 0;
+		for (int node : model.scenes[scene].nodes) {
+			if (node >= 0 && node < (int)model.nodes.size()) {
+				result.RootNodes.push_back(node);
+			}
+		}
+	} else {
+		std::vector<bool> isChild(model.nodes.size(), false);
+		for (const GltfNode& node : result.Nodes) {
+			for (int child : node.Children) {
+				isChild[child] = true;
+			}
+		}
+		for (int ix = 0; ix < model.nodes.size(); ix++) {
+			if (!isChild[ix]) {
+				result.RootNodes.push_back(ix);
+			}
+		}
+	}
+
+	return true;
+}
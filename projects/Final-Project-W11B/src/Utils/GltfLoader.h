@@ -0,0 +1,69 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <GLM/glm.hpp>
+#include <GLM/gtc/quaternion.hpp>
+
+#include "Graphics/VertexArrayObject.h"
+
+/// <summary>
+/// A node from a glTF file's scene graph, with it's transform relative to it's parent
+/// </summary>
+struct GltfNode {
+	std::string      Name;
+	// The index of the mesh in GltfModel::Meshes that this node draws, or -1 for none
+	int              Mesh = -1;
+	glm::vec3        Position = glm::vec3(0.0f);
+	glm::quat        Rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	glm::vec3        Scale = glm::vec3(1.0f);
+	// Indices of this node's children in GltfModel::Nodes
+	std::vector<int> Children;
+};
+
+/// <summary>
+/// All of the meshes and the scene graph loaded from a glTF file
+/// </summary>
+struct GltfModel {
+	std::vector<std::string>             MeshNames;
+	std::vector<VertexArrayObject::Sptr> Meshes;
+	std::vector<GltfNode>                Nodes;
+	// The nodes at the top of the default scene
+	std::vector<int>                     RootNodes;
+};
+
+/// <summary>
+/// Loads meshes from glTF 2.0 files (.gltf with external or embedded buffers, or binary .glb)
+///
+/// When a mesh's attributes are in formats that our shaders can read directly, the buffer views
+/// are uploaded as they are, interleaved or not, without decoding each element. Only views that
+/// hold UVs or tangents are copied first, since our textures are flipped on load and glTF's
+/// aren't. Anything else (multiple primitives, missing normals or tangents, sparse accessors)
+/// is decoded into a MeshBuilder and quantized like our OBJ files
+/// </summary>
+class GltfLoader {
+public:
+	/// <summary>
+	/// Returns true if the file has a .gltf or .glb extension
+	/// </summary>
+	static bool IsGltfFile(const std::string& filename);
+
+	/// <summary>
+	/// Loads a single mesh from a glTF file, combining all of it's primitives
+	/// </summary>
+	/// <param name="filename">The path to the .gltf or .glb file to load</param>
+	/// <param name="meshIndex">The index of the mesh within the file</param>
+	/// <returns>A VAO loaded from disk, or nullptr if the file or mesh could not be loaded</returns>
+	static VertexArrayObject::Sptr LoadFromFile(const std::string& filename, int meshIndex = 0);
+
+	/// <summary>
+	/// Loads every mesh and node from a glTF file
+	/// </summary>
+	/// <param name="filename">The path to the .gltf or .glb file to load</param>
+	/// <param name="result">The model to fill with the file's contents</param>
+	/// <returns>True if the file was loaded</returns>
+	static bool LoadModel(const std::string& filename, GltfModel& result);
+
+protected:
+	GltfLoader() = default;
+	~GltfLoader() = default;
+};
@@ -0,0 +1,83 @@
+#include "Utils/LinearAllocator.h"
+
+#include <algorithm>
+
+// All our blocks are aligned to this, which covers anything we'd reasonably put in them (including SIMD types)
+static const size_t BLOCK_ALIGNMENT = 16;
+
+LinearAllocator::LinearAllocator(size_t initialSize, std::pmr::memory_resource* upstream) :
+	_upstream(upstream),
+	_blocks(),
+	_offset(0),
+	_capacity(0),
+	_bytesUsed(0),
+	_allocationCount(0)
+{
+	_AddBlock(std::max<size_t>(initialSize, BLOCK_ALIGNMENT));
+}
+
+LinearAllocator::~LinearAllocator() {
+	_ReleaseBlocks();
+}
+
+void LinearAllocator::Reset() {
+	// If we overflowed, replace all our blocks with a single one that can hold all of them, so that
+	// next time around we don't need to chain blocks
+	if (_blocks.size() > 1) {
+		size_t size = _capacity;
+		_ReleaseBlocks();
+		_AddBlock(size);
+	}
+
+	_offset = 0;
+	_bytesUsed = 0;
+	_allocationCount = 0;
+}
+
+void LinearAllocator::_AddBlock(size_t size) {
+	Block block;
+	block.Data = static_cast<uint8_t*>(_upstream->allocate(size, BLOCK_ALIGNMENT));
+	block.Size = size;
+	_blocks.push_back(block);
+	_capacity += size;
+	_offset = 0;
+}
+
+void LinearAllocator::_ReleaseBlocks() {
+	for (const Block& block : _blocks) {
+		_upstream->deallocate(block.Data, block.Size, BLOCK_ALIGNMENT);
+	}
+	_blocks.clear();
+	_capacity = 0;
+}
+
+void* LinearAllocator::do_allocate(size_t bytes, size_t alignment) {
+	Block* block = &_blocks.back();
+
+	// Round our offset up to the requested alignment, relative to the actual address since
+	// alignments larger than the block alignment are allowed
+	uintptr_t address = reinterpret_cast<uintptr_t>(block->Data) + _offset;
+	size_t padding = (alignment - (address % alignment)) % alignment;
+
+	if (_offset + padding + bytes > block->Size) {
+		// Grow geometrically so that a large overflow doesn't chain dozens of blocks
+		_AddBlock(std::max(block->Size * 2, bytes + alignment));
+		block = &_blocks.back();
+		address = reinterpret_cast<uintptr_t>(block->Data);
+		padding = (alignment - (address % alignment)) % alignment;
+	}
+
+	void* result = block->Data + _offset + padding;
+	_offset += padding + bytes;
+	_bytesUsed += padding + bytes;
+	_allocationCount++;
+	return result;
+}
+
+void LinearAllocator::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+	// Memory is only ever released in bulk by Reset
+}
+
+bool LinearAllocator::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+	return this == &other;
+}
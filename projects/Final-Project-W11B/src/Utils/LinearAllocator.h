@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// A bump allocator that hands out memory by advancing an offset into a buffer, and frees
+/// everything at once when it is reset. Deallocating individual allocations does nothing.
+/// 
+/// When the buffer runs out we chain on another block rather than failing, and the next
+/// Reset replaces all the blocks with a single one big enough to hold everything that was
+/// allocated, so after a few resets allocation never touches the upstream resource.
+/// 
+/// NOTE: this is not thread safe, each allocator should only be used from a single thread
+/// </summary>
+class LinearAllocator final : public std::pmr::memory_resource {
+public:
+	NO_COPY(LinearAllocator);
+	NO_MOVE(LinearAllocator);
+
+	/// <summary>
+	/// Creates a new linear allocator
+	/// </summary>
+	/// <param name="initialSize">The size of the first block to allocate, in bytes</param>
+	/// <param name="upstream">The resource to allocate blocks from</param>
+	LinearAllocator(size_t initialSize = 64 * 1024, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+	~LinearAllocator();
+
+	/// <summary>
+	/// Releases all allocations made from this allocator, anything allocated from it
+	/// must not be used after this is called
+	/// </summary>
+	void Reset();
+
+	/// <summary>
+	/// Gets the number of bytes that have been handed out since the last reset, including alignment padding
+	/// </summary>
+	size_t GetBytesUsed() const { return _bytesUsed; }
+	/// <summary>
+	/// Gets the number of allocations that have been made since the last reset
+	/// </summary>
+	size_t GetAllocationCount() const { return _allocationCount; }
+	/// <summary>
+	/// Gets the total size of all the blocks that the allocator currently owns
+	/// </summary>
+	size_t GetCapacity() const { return _capacity; }
+	/// <summary>
+	/// Gets the number of blocks the allocator currently owns, if this is more than 1 the
+	/// allocator overflowed since the last reset
+	/// </summary>
+	size_t GetBlockCount() const { return _blocks.size(); }
+
+	/// <summary>
+	/// Allocates an uninitialized array of trivial types, which will be released on the next reset
+	/// </summary>
+	/// <typeparam name="T">The type of element to allocate, must be trivially destructible</typeparam>
+	/// <param name="count">The number of elements to allocate</param>
+	template <typename T>
+	T* AllocateArray(size_t count) {
+		static_assert(std::is_trivially_destructible_v<T>, "Linear allocations are never destroyed, T must be trivially destructible");
+		return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+	}
+
+protected:
+	struct Block {
+		uint8_t* Data;
+		size_t   Size;
+	};
+
+	std::pmr::memory_resource* _upstream;
+	std::vector<Block>         _blocks;
+	size_t                     _offset;
+	size_t                     _capacity;
+	size_t                     _bytesUsed;
+	size_t                     _allocationCount;
+
+	void _AddBlock(size_t size);
+	void _ReleaseBlocks();
+
+	virtual void* do_allocate(size_t bytes, size_t alignment) override;
+	virtual void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+	virtual bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
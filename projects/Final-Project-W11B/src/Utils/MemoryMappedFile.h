@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <cstdint>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// A read-only view of a file on disk that is mapped directly into our address space,
+/// letting us hand file contents to OpenGL without copying them into an intermediate buffer
+/// </summary>
+class MemoryMappedFile {
+public:
+	MAKE_PTRS(MemoryMappedFile);
+	NO_COPY(MemoryMappedFile);
+	NO_MOVE(MemoryMappedFile);
+
+	/// <summary>
+	/// Maps the given file into memory, check IsOpen to see if the mapping succeeded
+	/// </summary>
+	/// <param name="filename">The path of the file to map</param>
+	MemoryMappedFile(const std::string& filename);
+	~MemoryMappedFile();
+
+	/// <summary>
+	/// Returns true if the file was successfully mapped
+	/// </summary>
+	bool IsOpen() const { return _data != nullptr; }
+	/// <summary>
+	/// Gets a pointer to the start of the file's contents, or nullptr if the file is not mapped
+	/// </summary>
+	const uint8_t* GetData() const { return _data; }
+	/// <summary>
+	/// Gets the size of the mapped file in bytes
+	/// </summary>
+	size_t GetSize() const { return _size; }
+
+protected:
+	const uint8_t* _data;
+	size_t         _size;
+
+	#ifdef _WIN32
+	void* _fileHandle;
+	void* _mappingHandle;
+	#else
+	int   _fileDescriptor;
+	#endif
+};
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/VertexPacker.h"
 
 /// <summary>
 /// A utility class that lets us add vertices and indices, then bake it into a final mesh, using interleaved
@@ -138,8 +139,21 @@ public:
 		// Store our vertex type in the VAO's vertex declaration
 		result->SetVDecl(VertType::V_DECL);
 
+		// We still have the vertices on the CPU, so this is the cheapest place to work out the bounds
+		result->CalculateBounds(GetVertexDataPtr(), static_cast<uint32_t>(_vertices.size()), VertType::V_DECL);
+
 		return result;
 	}
+
+	/// <summary>
+	/// Creates and returns a VertexArrayObject from the current data, quantizing the vertices into the
+	/// compact format from VertexPacker. The mesh must be drawn with a shader that uses vs_common.glsl
+	/// </summary>
+	/// <returns>A VertexArrayObject</returns>
+	VertexArrayObject::Sptr BakePacked() {
+		PackedVertexData packed = VertexPacker::Pack(GetVertexDataPtr(), static_cast<uint32_t>(_vertices.size()), VertType::V_DECL);
+		return VertexPacker::Bake(packed, _indices.empty() ? nullptr : GetIndexDataPtr(), _indices.size());
+	}
 	
 	/// <summary>
 	/// Resets this mesh, removing all vertices and indices
@@ -166,6 +180,7 @@ public:
 	
 protected:
 	friend class MeshFactory;
+	friend class MeshOptimizer;
 	
 	std::vector<VertType> _vertices;
 	std::vector<uint32_t> _indices;
@@ -8,6 +8,7 @@
 #include "Graphics/VertexArrayObject.h"
 #include "Logging.h"
 #include "MeshFactory.h"
+#include "Utils/TangentSpace.h"
 #include "Utils/JsonGlmHelpers.h"
 #include "Graphics/VertexParamMap.h"
 
@@ -557,11 +558,11 @@ template <typename Vertex>
 void MeshFactory::CalculateTBN(MeshBuilder<Vertex>& mesh)
 {
 	VertexParamMap vMap = VertexParamMap(Vertex::V_DECL);
-	if (vMap.TangentOffset == -1 && vMap.BiTangentOffset == -1) {
+	if (!vMap.HasTangent() && !vMap.HasBiTangent()) {
 		LOG_WARN("Vertex type does not have tangent or bitangent attribute, aborting CalculateTBN");
 		return;
 	}
-	if (vMap.PositionOffset == -1 || vMap.TextureOffset == -1) {
+	if (!vMap.HasPosition() || !vMap.HasTexture()) {
 		LOG_WARN("Vertex type does not required position and texture attributes, aborting CalculateTBN");
 		return;
 	}
@@ -570,50 +571,26 @@ void MeshFactory::CalculateTBN(MeshBuilder<Vertex>& mesh)
 		return;
 	}
 
-	for (size_t i = 0; i < mesh._vertices.size(); i++) {
-		vMap.SetTangent(mesh._vertices[i], glm::vec3(0.0f));
-		vMap.SetBiTangent(mesh._vertices[i], glm::vec3(0.0f));
+	// Pull the attributes out into their own arrays so the generator doesn't need to know about our vertex types
+	size_t vertexCount = mesh._vertices.size();
+	std::vector<glm::vec3> positions(vertexCount);
+	std::vector<glm::vec3> normals(vMap.HasNormal() ? vertexCount : 0);
+	std::vector<glm::vec2> uvs(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++) {
+		positions[i] = vMap.GetPosition(mesh._vertices[i]);
+		uvs[i] = vMap.GetTexture(mesh._vertices[i]);
+		if (vMap.HasNormal()) {
+			normals[i] = vMap.GetNormal(mesh._vertices[i]);
+		}
 	}
 
-	// Iterate over all indices in the mesh, we'll assume that the mesh is indexed
-	for (size_t i = 0; i < mesh._indices.size(); i += 3) {
-		Vertex& v1 = mesh._vertices[mesh._indices[i + 0u]];
-		Vertex& v2 = mesh._vertices[mesh._indices[i + 1u]];
-		Vertex& v3 = mesh._vertices[mesh._indices[i + 2u]];
-
-		// Extract the positions from the mesh
-		glm::vec3 pos[3];
-		pos[0] = vMap.GetPosition(v1);
-		pos[1] = vMap.GetPosition(v2);
-		pos[2] = vMap.GetPosition(v3);
-
-		// Extract the UVs from the mesh
-		glm::vec2 uvs[3];
-		uvs[0] = vMap.GetTexture(v1);
-		uvs[1] = vMap.GetTexture(v2);
-		uvs[2] = vMap.GetTexture(v3);
-
-		// Calculate 2 corner vectors
-		glm::vec3 deltaP1 = pos[1] - pos[0];
-		glm::vec3 deltaP2 = pos[2] - pos[0];
-
-		// Calculate UV deltas
-		glm::vec2 deltaT1 = uvs[1] - uvs[0];
-		glm::vec2 deltaT2 = uvs[2] - uvs[0];
-
-		// Use the deltas in position and UV to calculate the tangent and bitangent
-		// https://learnopengl.com/Advanced-Lighting/Normal-Mapping
-		float r = 1.0f / (deltaT1.x * deltaT2.y - deltaT1.y * deltaT2.x);
-		glm::vec3 tangent = glm::normalize((deltaP1 * deltaT2.y - deltaP2 * deltaT1.y) * r);
-		glm::vec3 bitangent = glm::normalize((deltaP2 * deltaT1.x - deltaP1 * deltaT2.x) * r);
-
-		// Set attributes in the vertex
-		vMap.SetTangent(v1, glm::normalize((vMap.GetTangent(v1) + tangent) / 2.0f));
-		vMap.SetTangent(v2, glm::normalize((vMap.GetTangent(v2) + tangent) / 2.0f));
-		vMap.SetTangent(v3, glm::normalize((vMap.GetTangent(v3) + tangent) / 2.0f));
-
-		vMap.SetBiTangent(v1, glm::normalize((vMap.GetBiTangent(v1) + bitangent) / 2.0f));
-		vMap.SetBiTangent(v2, glm::normalize((vMap.GetBiTangent(v1) + bitangent) / 2.0f));
-		vMap.SetBiTangent(v3, glm::normalize((vMap.GetBiTangent(v1) + bitangent) / 2.0f));
+	std::vector<glm::vec4> tangents(vertexCount);
+	std::vector<glm::vec3> bitangents(vertexCount);
+	TangentSpace::Generate(positions.data(), normals.empty() ? nullptr : normals.data(), uvs.data(), vertexCount,
+		mesh._indices.data(), mesh._indices.size(), tangents.data(), bitangents.data());
+
+	for (size_t i = 0; i < vertexCount; i++) {
+		vMap.SetTangent(mesh._vertices[i], glm::vec3(tangents[i]), tangents[i].w);
+		vMap.SetBiTangent(mesh._vertices[i], bitangents[i]);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,352 @@
+#include "Utils/MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <GLM/glm.hpp>
+
+#include "Logging.h"
+
+namespace {
+	// The cache size that Forsyth's scoring function models
+	const int FORSYTH_CACHE_SIZE = 32;
+	const float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+	const float FORSYTH_LAST_TRI_SCORE = 0.75f;
+	const float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+	const float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+	// Valences above this all get the same (tiny) boost, so we can use a lookup table
+	const uint32_t FORSYTH_MAX_VALENCE = 64;
+
+	/// <summary>
+	/// Pushes a triangle's vertices through a simulated FIFO cache, where a vertex is in the cache if it
+	/// was added less than cacheSize insertions ago
+	/// </summary>
+	/// <returns>The number of vertices that missed the cache</returns>
+	uint32_t UpdateFifoCache(const uint32_t* tri, uint32_t cacheSize, uint32_t* timestamps, uint32_t& timestamp) {
+		uint32_t misses = 0;
+		for (int ix = 0; ix < 3; ix++) {
+			if (timestamp - timestamps[tri[ix]] > cacheSize) {
+				timestamps[tri[ix]] = timestamp++;
+				misses++;
+			}
+		}
+		return misses;
+	}
+}
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+	VertexCacheStats result;
+	if (indexCount < 3 || vertexCount == 0) {
+		return result;
+	}
+
+	// Timestamps start far enough in the past that every vertex starts outside of the cache
+	std::vector<uint32_t> timestamps(vertexCount, 0);
+	uint32_t timestamp = cacheSize + 1;
+	size_t misses = 0;
+	for (size_t ix = 0; ix + 2 < indexCount; ix += 3) {
+		misses += UpdateFifoCache(indices + ix, cacheSize, timestamps.data(), timestamp);
+	}
+
+	// Only count vertices that are actually used, otherwise unused vertices would make the ATVR look better
+	size_t usedVertices = std::count_if(timestamps.begin(), timestamps.end(), [](uint32_t value) { return value != 0; });
+
+	result.ACMR = static_cast<float>(misses) / static_cast<float>(indexCount / 3);
+	result.ATVR = usedVertices > 0 ? static_cast<float>(misses) / static_cast<float>(usedVertices) : 0.0f;
+	return result;
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount) {
+	size_t triCount = indexCount / 3;
+	if (triCount < 2 || vertexCount == 0) {
+		return;
+	}
+
+	// Precalculate the parts of the vertex score, so that scoring is just two lookups
+	float cacheScores[FORSYTH_CACHE_SIZE];
+	for (int ix = 0; ix < FORSYTH_CACHE_SIZE; ix++) {
+		if (ix < 3) {
+			// The vertices of the last triangle get a fixed score, so that we don't favour re-using the same edge over and over
+			cacheScores[ix] = FORSYTH_LAST_TRI_SCORE;
+		} else {
+			float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+			cacheScores[ix] = std::pow(1.0f - (ix - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+		}
+	}
+	float valenceScores[FORSYTH_MAX_VALENCE + 1];
+	valenceScores[0] = 0.0f;
+	for (uint32_t ix = 1; ix <= FORSYTH_MAX_VALENCE; ix++) {
+		// Boost vertices with few triangles left, so that we finish off areas instead of leaving lone triangles behind
+		valenceScores[ix] = FORSYTH_VALENCE_BOOST_SCALE * std::pow(static_cast<float>(ix), -FORSYTH_VALENCE_BOOST_POWER);
+	}
+
+	// Build vertex to triangle adjacency, the first Remaining[v] entries of each vertex's range are the triangles it has left
+	std::vector<uint32_t> remaining(vertexCount, 0);
+	for (size_t ix = 0; ix < triCount * 3; ix++) {
+		remaining[indices[ix]]++;
+	}
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		offsets[ix + 1] = offsets[ix] + remaining[ix];
+	}
+	std::vector<uint32_t> adjacency(offsets[vertexCount]);
+	std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+	for (size_t tri = 0; tri < triCount; tri++) {
+		for (int corner = 0; corner < 3; corner++) {
+			adjacency[fill[indices[tri * 3 + corner]]++] = static_cast<uint32_t>(tri);
+		}
+	}
+
+	std::vector<int>   cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount, 0.0f);
+	std::vector<float> triScores(triCount, 0.0f);
+	std::vector<bool>  emitted(triCount, false);
+
+	auto scoreVertex = [&](uint32_t vertex) {
+		uint32_t valence = remaining[vertex];
+		if (valence == 0) {
+			return -1.0f;
+		}
+		int cachePos = cachePositions[vertex];
+		float score = cachePos >= 0 ? cacheScores[cachePos] : 0.0f;
+		return score + valenceScores[std::min(valence, FORSYTH_MAX_VALENCE)];
+	};
+
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		vertexScores[ix] = scoreVertex(static_cast<uint32_t>(ix));
+	}
+
+	// Pick the best triangle to start with
+	int bestTri = 0;
+	for (size_t tri = 0; tri < triCount; tri++) {
+		const uint32_t* t = indices + tri * 3;
+		triScores[tri] = vertexScores[t[0]] + vertexScores[t[1]] + vertexScores[t[2]];
+		if (triScores[tri] > triScores[bestTri]) {
+			bestTri = static_cast<int>(tri);
+		}
+	}
+
+	// The cache can temporarily hold the 3 new vertices on top of the full cache
+	uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+	int cacheCount = 0;
+	uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+
+	std::vector<uint32_t> output;
+	output.reserve(triCount * 3);
+	size_t searchCursor = 0;
+
+	for (size_t outputTri = 0; outputTri < triCount; outputTri++) {
+		// If none of the triangles touching the cache are left, take the next triangle that we haven't emitted yet.
+		// This is what keeps the algorithm linear, since we never search the whole mesh
+		if (bestTri < 0) {
+			while (emitted[searchCursor]) {
+				searchCursor++;
+			}
+			bestTri = static_cast<int>(searchCursor);
+		}
+
+		const uint32_t* tri = indices + (size_t)bestTri * 3;
+		emitted[bestTri] = true;
+		output.insert(output.end(), tri, tri + 3);
+
+		// Remove the triangle from each of it's vertex's adjacency lists
+		for (int corner = 0; corner < 3; corner++) {
+			uint32_t vertex = tri[corner];
+			uint32_t* begin = adjacency.data() + offsets[vertex];
+			uint32_t* end = begin + remaining[vertex];
+			uint32_t* it = std::find(begin, end, static_cast<uint32_t>(bestTri));
+			LOG_ASSERT(it != end, "Vertex adjacency is corrupt");
+			std::swap(*it, *(end - 1));
+			remaining[vertex]--;
+		}
+
+		// The triangle's vertices go to the front of the cache, followed by everything else that was already there
+		int newCount = 0;
+		for (int corner = 0; corner < 3; corner++) {
+			// Degenerate triangles can repeat a vertex, which should only take up one slot
+			if ((corner < 1 || tri[corner] != tri[0]) && (corner < 2 || tri[corner] != tri[1])) {
+				newCache[newCount++] = tri[corner];
+			}
+		}
+		for (int ix = 0; ix < cacheCount; ix++) {
+			uint32_t vertex = cache[ix];
+			if (vertex != tri[0] && vertex != tri[1] && vertex != tri[2]) {
+				newCache[newCount++] = vertex;
+			}
+		}
+
+		// Update scores for everything that was touched, vertices past the end of the cache fall out of it
+		for (int ix = 0; ix < newCount; ix++) {
+			uint32_t vertex = newCache[ix];
+			cachePositions[vertex] = ix < FORSYTH_CACHE_SIZE ? ix : -1;
+			vertexScores[vertex] = scoreVertex(vertex);
+		}
+
+		// Find the best triangle among the triangles of the vertices still in the cache
+		bestTri = -1;
+		float bestScore = -1.0f;
+		for (int ix = 0; ix < newCount; ix++) {
+			uint32_t vertex = newCache[ix];
+			const uint32_t* adj = adjacency.data() + offsets[vertex];
+			for (uint32_t jx = 0; jx < remaining[vertex]; jx++) {
+				uint32_t adjTri = adj[jx];
+				const uint32_t* t = indices + (size_t)adjTri * 3;
+				float score = vertexScores[t[0]] + vertexScores[t[1]] + vertexScores[t[2]];
+				triScores[adjTri] = score;
+				if (score > bestScore) {
+					bestScore = score;
+					bestTri = static_cast<int>(adjTri);
+				}
+			}
+		}
+
+		cacheCount = std::min(newCount, FORSYTH_CACHE_SIZE);
+		std::copy(newCache, newCache + cacheCount, cache);
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+void MeshOptimizer::OptimizeOverdraw(uint32_t* indices, size_t indexCount, const void* positions, size_t vertexCount, size_t positionStride, float threshold) {
+	size_t triCount = indexCount / 3;
+	if (triCount < 2 || vertexCount == 0 || positions == nullptr) {
+		return;
+	}
+
+	const uint32_t cacheSize = STATS_CACHE_SIZE;
+	std::vector<uint32_t> timestamps(vertexCount, 0);
+	uint32_t timestamp = cacheSize + 1;
+
+	// Hard boundaries are where the cache order already starts fresh (all 3 vertices miss), so
+	// reordering at these points costs us nothing
+	std::vector<uint32_t> hardBoundaries;
+	for (size_t tri = 0; tri < triCount; tri++) {
+		uint32_t misses = UpdateFifoCache(indices + tri * 3, cacheSize, timestamps.data(), timestamp);
+		if (tri == 0 || misses == 3) {
+			hardBoundaries.push_back(static_cast<uint32_t>(tri));
+		}
+	}
+	hardBoundaries.push_back(static_cast<uint32_t>(triCount));
+
+	// Split hard clusters further, as long as each piece stays within threshold of the whole cluster's ACMR
+	std::vector<uint32_t> clusters;
+	for (size_t ix = 0; ix + 1 < hardBoundaries.size(); ix++) {
+		uint32_t start = hardBoundaries[ix];
+		uint32_t end = hardBoundaries[ix + 1];
+
+		timestamp += cacheSize + 1;
+		size_t clusterMisses = 0;
+		for (uint32_t tri = start; tri < end; tri++) {
+			clusterMisses += UpdateFifoCache(indices + (size_t)tri * 3, cacheSize, timestamps.data(), timestamp);
+		}
+		float clusterThreshold = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+		clusters.push_back(start);
+		timestamp += cacheSize + 1;
+		size_t runningMisses = 0;
+		size_t runningTris = 0;
+		for (uint32_t tri = start; tri < end; tri++) {
+			runningMisses += UpdateFifoCache(indices + (size_t)tri * 3, cacheSize, timestamps.data(), timestamp);
+			runningTris++;
+
+			if (static_cast<float>(runningMisses) / static_cast<float>(runningTris) <= clusterThreshold && tri + 1 < end) {
+				clusters.push_back(tri + 1);
+				timestamp += cacheSize + 1;
+				runningMisses = 0;
+				runningTris = 0;
+			}
+		}
+	}
+	clusters.push_back(static_cast<uint32_t>(triCount));
+	size_t clusterCount = clusters.size() - 1;
+
+	auto getPosition = [&](uint32_t vertex) {
+		glm::vec3 result;
+		memcpy(&result, static_cast<const uint8_t*>(positions) + vertex * positionStride, sizeof(glm::vec3));
+		return result;
+	};
+
+	// Work out the area weighted centroid and normal of every cluster, and of the mesh as a whole
+	std::vector<glm::vec3> centroids(clusterCount, glm::vec3(0.0f));
+	std::vector<glm::vec3> normals(clusterCount, glm::vec3(0.0f));
+	glm::vec3 meshCentroid = glm::vec3(0.0f);
+	float meshArea = 0.0f;
+	for (size_t cluster = 0; cluster < clusterCount; cluster++) {
+		float clusterArea = 0.0f;
+		for (uint32_t tri = clusters[cluster]; tri < clusters[cluster + 1]; tri++) {
+			glm::vec3 a = getPosition(indices[tri * 3 + 0]);
+			glm::vec3 b = getPosition(indices[tri * 3 + 1]);
+			glm::vec3 c = getPosition(indices[tri * 3 + 2]);
+			glm::vec3 normal = glm::cross(b - a, c - a);
+			float area = glm::length(normal);
+
+			centroids[cluster] += (a + b + c) * (area / 3.0f);
+			normals[cluster] += normal;
+			clusterArea += area;
+		}
+		meshCentroid += centroids[cluster];
+		meshArea += clusterArea;
+		centroids[cluster] = clusterArea > 0.0f ? centroids[cluster] / clusterArea : getPosition(indices[clusters[cluster] * 3]);
+	}
+	meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : glm::vec3(0.0f);
+
+	// Clusters that face away from the center of the mesh are more likely to be in front of other clusters, so they get drawn first
+	std::vector<float> sortKeys(clusterCount);
+	for (size_t cluster = 0; cluster < clusterCount; cluster++) {
+		float length = glm::length(normals[cluster]);
+		glm::vec3 normal = length > 0.0f ? normals[cluster] / length : glm::vec3(0.0f);
+		sortKeys[cluster] = glm::dot(centroids[cluster] - meshCentroid, normal);
+	}
+	std::vector<uint32_t> order(clusterCount);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<uint32_t> output;
+	output.reserve(triCount * 3);
+	for (uint32_t cluster : order) {
+		output.insert(output.end(), indices + (size_t)clusters[cluster] * 3, indices + (size_t)clusters[cluster + 1] * 3);
+	}
+	std::copy(output.begin(), output.end(), indices);
+}
+
+size_t MeshOptimizer::OptimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexSize, uint32_t* indices, size_t indexCount) {
+	// Assign new locations in the order vertices are first used
+	const uint32_t unassigned = UINT32_MAX;
+	std::vector<uint32_t> remap(vertexCount, unassigned);
+	uint32_t next = 0;
+	for (size_t ix = 0; ix < indexCount; ix++) {
+		uint32_t& target = remap[indices[ix]];
+		if (target == unassigned) {
+			target = next++;
+		}
+		indices[ix] = target;
+	}
+	size_t usedCount = next;
+
+	// Anything that isn't referenced goes to the end
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		if (remap[ix] == unassigned) {
+			remap[ix] = next++;
+		}
+	}
+
+	// Move the vertex data, we do this out of place since the remap is an arbitrary permutation
+	std::vector<uint8_t> reordered(vertexCount * vertexSize);
+	const uint8_t* source = static_cast<const uint8_t*>(vertices);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		memcpy(reordered.data() + remap[ix] * vertexSize, source + ix * vertexSize, vertexSize);
+	}
+	memcpy(vertices, reordered.data(), reordered.size());
+
+	return usedCount;
+}
+
+int MeshOptimizer::_FindPositionOffset(const std::vector<BufferAttribute>& vDecl) {
+	for (const BufferAttribute& attrib : vDecl) {
+		if (attrib.Usage == AttribUsage::Position && attrib.Type == AttributeType::Float && attrib.Size >= 3) {
+			return attrib.Offset;
+		}
+	}
+	return -1;
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Utils/MeshBuilder.h"
+#include "Graphics/VertexTypes.h"
+
+/// <summary>
+/// Statistics from simulating a FIFO post-transform vertex cache over an index buffer
+/// </summary>
+struct VertexCacheStats {
+	// Average cache miss ratio, the number of vertices transformed per triangle (0.5 is ideal, 3 is worst)
+	float ACMR = 0.0f;
+	// Average transform to vertex ratio, the number of times each vertex is transformed (1 is ideal)
+	float ATVR = 0.0f;
+};
+
+/// <summary>
+/// The results of running the mesh optimizer over a mesh
+/// </summary>
+struct MeshOptimizerStats {
+	VertexCacheStats Before;
+	VertexCacheStats After;
+};
+
+/// <summary>
+/// Reorders the triangles and vertices of indexed triangle meshes so that they render faster, by making
+/// better use of the GPU's post-transform vertex cache, reducing overdraw, and making vertex fetches
+/// more linear. None of these change what the mesh looks like, so this can be run on any mesh that
+/// doesn't depend on the order of it's triangles or vertices
+/// </summary>
+class MeshOptimizer {
+public:
+	// The cache size that we simulate when reporting stats, this is a conservative size for most GPUs
+	static const uint32_t STATS_CACHE_SIZE = 16;
+	// How much worse than the vertex cache optimized order we let the overdraw pass make the ACMR
+	static constexpr float DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+
+	/// <summary>
+	/// Simulates a FIFO vertex cache over an index buffer
+	/// </summary>
+	/// <param name="indices">The triangle list to analyze</param>
+	/// <param name="indexCount">The number of indices in the list</param>
+	/// <param name="vertexCount">The number of vertices the indices refer to</param>
+	/// <param name="cacheSize">The number of entries in the simulated cache</param>
+	static VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = STATS_CACHE_SIZE);
+
+	/// <summary>
+	/// Reorders triangles to improve vertex cache usage, using Tom Forsyth's linear-speed vertex cache optimization
+	/// </summary>
+	/// <param name="indices">The triangle list to reorder in place</param>
+	/// <param name="indexCount">The number of indices in the list</param>
+	/// <param name="vertexCount">The number of vertices the indices refer to</param>
+	static void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+	/// <summary>
+	/// Reorders clusters of triangles so that triangles that are likely to occlude others are drawn first,
+	/// should be run after OptimizeVertexCache. Clusters are split where the cache order already starts
+	/// over, or where the cache efficiency of the split stays within threshold of the input order
+	/// </summary>
+	/// <param name="indices">The triangle list to reorder in place</param>
+	/// <param name="indexCount">The number of indices in the list</param>
+	/// <param name="positions">A pointer to the first vertex's position</param>
+	/// <param name="vertexCount">The number of vertices</param>
+	/// <param name="positionStride">The number of bytes between each vertex's position</param>
+	/// <param name="threshold">How much the ACMR may grow to allow more clusters, 1.05 allows 5% worse</param>
+	static void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const void* positions, size_t vertexCount, size_t positionStride, float threshold = DEFAULT_OVERDRAW_THRESHOLD);
+
+	/// <summary>
+	/// Reorders vertices in the order they are first referenced by the index buffer, so that the vertex
+	/// fetch reads memory mostly linearly. Unreferenced vertices are moved to the end of the buffer
+	/// </summary>
+	/// <param name="vertices">The vertex data to reorder in place</param>
+	/// <param name="vertexCount">The number of vertices</param>
+	/// <param name="vertexSize">The size of a single vertex in bytes</param>
+	/// <param name="indices">The triangle list, will be updated to refer to the new vertex locations</param>
+	/// <param name="indexCount">The number of indices in the list</param>
+	/// <returns>The number of vertices that are referenced by the index buffer</returns>
+	static size_t OptimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexSize, uint32_t* indices, size_t indexCount);
+
+	/// <summary>
+	/// Runs all of the optimization passes on a mesh
+	/// </summary>
+	/// <typeparam name="Vertex">The type of vertex the mesh consists of, must have a Position attribute</typeparam>
+	/// <param name="mesh">The mesh to optimize</param>
+	/// <returns>The vertex cache stats from before and after optimizing</returns>
+	template <typename Vertex>
+	static MeshOptimizerStats Optimize(MeshBuilder<Vertex>& mesh);
+
+protected:
+	MeshOptimizer() = default;
+	~MeshOptimizer() = default;
+
+	// Finds the offset of the 3 component float position in a vertex declaration, or -1
+	static int _FindPositionOffset(const std::vector<BufferAttribute>& vDecl);
+};
+
+template <typename Vertex>
+MeshOptimizerStats MeshOptimizer::Optimize(MeshBuilder<Vertex>& mesh) {
+	MeshOptimizerStats result;
+
+	// We only handle indexed triangle lists
+	if (mesh._indices.empty() || mesh._indices.size() % 3 != 0) {
+		return result;
+	}
+
+	uint32_t* indices  = mesh._indices.data();
+	size_t indexCount  = mesh._indices.size();
+	size_t vertexCount = mesh._vertices.size();
+
+	result.Before = AnalyzeVertexCache(indices, indexCount, vertexCount);
+
+	OptimizeVertexCache(indices, indexCount, vertexCount);
+
+	// The overdraw pass needs positions, if the vertex has none we leave it in cache order
+	int positionOffset = _FindPositionOffset(Vertex::V_DECL);
+	if (positionOffset >= 0) {
+		const uint8_t* positions = reinterpret_cast<const uint8_t*>(mesh._vertices.data()) + positionOffset;
+		OptimizeOverdraw(indices, indexCount, positions, vertexCount, sizeof(Vertex));
+	}
+
+	// Remap vertices last, since it depends on the final triangle order
+	OptimizeVertexFetch(mesh._vertices.data(), vertexCount, sizeof(Vertex), indices, indexCount);
+
+	result.After = AnalyzeVertexCache(indices, indexCount, vertexCount);
+	return result;
+}
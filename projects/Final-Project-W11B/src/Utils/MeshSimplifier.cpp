@@ -0,0 +1,297 @@
+#include "Utils/MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_set>
+
+namespace {
+	// Collapses that rotate a triangle's normal by more than ~75 degrees are rejected
+	const float MAX_NORMAL_ROTATION_COS = 0.25f;
+
+	/// <summary>
+	/// The symmetric 4x4 matrix of a quadric error metric, which measures the sum of squared distances from a point
+	/// to a set of planes. We use doubles since the terms can get very large or very small before they cancel out
+	/// </summary>
+	struct Quadric {
+		double A00 = 0, A01 = 0, A02 = 0, A03 = 0;
+		double A11 = 0, A12 = 0, A13 = 0;
+		double A22 = 0, A23 = 0;
+		double A33 = 0;
+		// The total weight of all the planes, used to turn the sum into an average
+		double Weight = 0;
+
+		void AddPlane(const glm::dvec3& normal, double distance, double weight) {
+			A00 += weight * normal.x * normal.x;
+			A01 += weight * normal.x * normal.y;
+			A02 += weight * normal.x * normal.z;
+			A03 += weight * normal.x * distance;
+			A11 += weight * normal.y * normal.y;
+			A12 += weight * normal.y * normal.z;
+			A13 += weight * normal.y * distance;
+			A22 += weight * normal.z * normal.z;
+			A23 += weight * normal.z * distance;
+			A33 += weight * distance * distance;
+			Weight += weight;
+		}
+
+		void Add(const Quadric& other) {
+			A00 += other.A00; A01 += other.A01; A02 += other.A02; A03 += other.A03;
+			A11 += other.A11; A12 += other.A12; A13 += other.A13;
+			A22 += other.A22; A23 += other.A23;
+			A33 += other.A33;
+			Weight += other.Weight;
+		}
+
+		// Evaluates the weighted sum of squared distances from a point to the planes
+		double Evaluate(const glm::dvec3& p) const {
+			double result =
+				A00 * p.x * p.x + A11 * p.y * p.y + A22 * p.z * p.z +
+				2.0 * (A01 * p.x * p.y + A02 * p.x * p.z + A12 * p.y * p.z) +
+				2.0 * (A03 * p.x + A13 * p.y + A23 * p.z) +
+				A33;
+			// Rounding can push the result slightly below 0
+			return result > 0.0 ? result : 0.0;
+		}
+	};
+
+	/// <summary>
+	/// A candidate edge collapse, which moves one position onto the position of a neighbouring vertex
+	/// </summary>
+	struct Collapse {
+		// The position (canonical vertex) that is removed
+		uint32_t From;
+		// The vertex that replaces it in the index buffer
+		uint32_t To;
+		// The squared distance error of the collapse
+		float    Error;
+	};
+
+	uint64_t EdgeKey(uint32_t a, uint32_t b) {
+		return (static_cast<uint64_t>(a) << 32) | b;
+	}
+}
+
+std::vector<uint32_t> MeshSimplifier::Simplify(const uint32_t* indices, size_t indexCount, const void* positions, size_t vertexCount, size_t positionStride,
+	size_t targetIndexCount, float targetError, float* resultError)
+{
+	std::vector<uint32_t> result(indices, indices + (indexCount / 3 * 3));
+	float maxErrorSq = 0.0f;
+	if (resultError != nullptr) {
+		*resultError = 0.0f;
+	}
+	if (result.size() <= targetIndexCount || vertexCount == 0) {
+		return result;
+	}
+
+	// Attributes aren't guaranteed to be aligned within the vertex, so we copy rather than casting
+	std::vector<glm::vec3> points(vertexCount);
+	const uint8_t* positionData = static_cast<const uint8_t*>(positions);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		memcpy(&points[ix], positionData + ix * positionStride, sizeof(glm::vec3));
+	}
+
+	// Vertices that share a position (because of UV or normal seams) get mapped onto a single canonical
+	// vertex, so that we treat the mesh as one connected surface
+	std::vector<uint32_t> canonical(vertexCount);
+	std::vector<uint8_t>  locked(vertexCount, 0);
+	{
+		std::vector<uint32_t> order(vertexCount);
+		std::iota(order.begin(), order.end(), 0);
+		auto less = [&](uint32_t a, uint32_t b) {
+			const glm::vec3& pa = points[a];
+			const glm::vec3& pb = points[b];
+			return pa.x != pb.x ? pa.x < pb.x : (pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z);
+		};
+		std::sort(order.begin(), order.end(), less);
+		for (size_t start = 0; start < vertexCount;) {
+			size_t end = start + 1;
+			while (end < vertexCount && points[order[end]] == points[order[start]]) {
+				end++;
+			}
+			for (size_t ix = start; ix < end; ix++) {
+				canonical[order[ix]] = order[start];
+			}
+			// Seams are locked, moving only one side of a seam would tear the mesh open
+			if (end - start > 1) {
+				locked[order[start]] = 1;
+			}
+			start = end;
+		}
+	}
+
+	// Edges without a matching edge going the other way are on an open border, and edges used more than once in the same
+	// direction are non-manifold. We lock both, since collapsing them would change the outline of the mesh
+	{
+		std::unordered_set<uint64_t> edges;
+		std::unordered_set<uint64_t> duplicateEdges;
+		edges.reserve(result.size());
+		for (size_t ix = 0; ix < result.size(); ix++) {
+			uint32_t a = canonical[result[ix]];
+			uint32_t b = canonical[result[ix - ix % 3 + (ix + 1) % 3]];
+			if (!edges.insert(EdgeKey(a, b)).second) {
+				duplicateEdges.insert(EdgeKey(a, b));
+			}
+		}
+		for (size_t ix = 0; ix < result.size(); ix++) {
+			uint32_t a = canonical[result[ix]];
+			uint32_t b = canonical[result[ix - ix % 3 + (ix + 1) % 3]];
+			if (edges.count(EdgeKey(b, a)) == 0 || duplicateEdges.count(EdgeKey(a, b)) != 0) {
+				locked[a] = 1;
+				locked[b] = 1;
+			}
+		}
+	}
+
+	// Every position starts with the planes of the triangles around it, weighted by area so that slivers matter less
+	std::vector<Quadric> quadrics(vertexCount);
+	for (size_t ix = 0; ix < result.size(); ix += 3) {
+		uint32_t a = canonical[result[ix]], b = canonical[result[ix + 1]], c = canonical[result[ix + 2]];
+		glm::dvec3 p0 = points[a], p1 = points[b], p2 = points[c];
+		glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+		double length = glm::length(normal);
+		if (length <= 0.0) {
+			continue;
+		}
+		normal /= length;
+		double distance = -glm::dot(normal, p0);
+		quadrics[a].AddPlane(normal, distance, length * 0.5);
+		quadrics[b].AddPlane(normal, distance, length * 0.5);
+		quadrics[c].AddPlane(normal, distance, length * 0.5);
+	}
+
+	double errorLimitSq = static_cast<double>(targetError) * targetError;
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+	std::vector<uint32_t> adjacency;
+	std::vector<uint32_t> collapseTarget(vertexCount);
+	std::vector<uint8_t>  touched(vertexCount);
+	std::vector<Collapse> collapses;
+
+	// Each pass collapses as many independent edges as it can, cheapest first, then rewrites the index buffer
+	while (result.size() > targetIndexCount) {
+		size_t triCount = result.size() / 3;
+
+		// Build the list of triangles around each position
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+		for (uint32_t index : result) {
+			adjacencyOffsets[canonical[index] + 1]++;
+		}
+		std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+		adjacency.resize(result.size());
+		{
+			std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t ix = 0; ix < result.size(); ix++) {
+				adjacency[cursor[canonical[result[ix]]]++] = static_cast<uint32_t>(ix / 3);
+			}
+		}
+
+		// Score every edge in both directions, we can only move positions that aren't locked
+		collapses.clear();
+		for (size_t ix = 0; ix < result.size(); ix++) {
+			uint32_t fromVertex = result[ix];
+			uint32_t toVertex = result[ix - ix % 3 + (ix + 1) % 3];
+			uint32_t from = canonical[fromVertex], to = canonical[toVertex];
+			if (from == to) {
+				continue;
+			}
+			for (int direction = 0; direction < 2; direction++) {
+				if (!locked[from]) {
+					Quadric combined = quadrics[from];
+					combined.Add(quadrics[to]);
+					double error = combined.Weight > 0.0 ? combined.Evaluate(points[to]) / combined.Weight : 0.0;
+					if (error <= errorLimitSq) {
+						collapses.push_back({ from, toVertex, static_cast<float>(error) });
+					}
+				}
+				std::swap(from, to);
+				std::swap(fromVertex, toVertex);
+			}
+		}
+		if (collapses.empty()) {
+			break;
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.Error < b.Error; });
+
+		std::iota(collapseTarget.begin(), collapseTarget.end(), 0);
+		std::fill(touched.begin(), touched.end(), 0);
+		size_t remainingTris = triCount;
+		size_t performed = 0;
+		for (const Collapse& collapse : collapses) {
+			uint32_t to = canonical[collapse.To];
+			if (touched[collapse.From] || touched[to]) {
+				continue;
+			}
+
+			// Make sure that none of the triangles that survive the collapse get flipped over, or turned far enough that they're nearly edge on
+			bool flips = false;
+			size_t removedTris = 0;
+			for (uint32_t adj = adjacencyOffsets[collapse.From]; adj < adjacencyOffsets[collapse.From + 1] && !flips; adj++) {
+				const uint32_t* tri = &result[adjacency[adj] * 3];
+				uint32_t corners[3] = { canonical[tri[0]], canonical[tri[1]], canonical[tri[2]] };
+				if (corners[0] == to || corners[1] == to || corners[2] == to) {
+					removedTris++;
+					continue;
+				}
+				glm::vec3 before[3] = { points[corners[0]], points[corners[1]], points[corners[2]] };
+				glm::vec3 after[3] = { before[0], before[1], before[2] };
+				for (int corner = 0; corner < 3; corner++) {
+					if (corners[corner] == collapse.From) {
+						after[corner] = points[to];
+					}
+				}
+				glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+				glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+				flips = glm::dot(normalBefore, normalAfter) <= MAX_NORMAL_ROTATION_COS * glm::length(normalBefore) * glm::length(normalAfter);
+			}
+			if (flips) {
+				continue;
+			}
+
+			// Positions are only unlocked if they have a single vertex, so the collapse is just a remap of that vertex
+			collapseTarget[collapse.From] = collapse.To;
+			quadrics[to].Add(quadrics[collapse.From]);
+			maxErrorSq = glm::max(maxErrorSq, collapse.Error);
+			performed++;
+
+			// The neighbourhood has changed, so nothing around it can be collapsed until the adjacency is rebuilt
+			for (uint32_t adj = adjacencyOffsets[collapse.From]; adj < adjacencyOffsets[collapse.From + 1]; adj++) {
+				const uint32_t* tri = &result[adjacency[adj] * 3];
+				touched[canonical[tri[0]]] = 1;
+				touched[canonical[tri[1]]] = 1;
+				touched[canonical[tri[2]]] = 1;
+			}
+
+			remainingTris -= glm::min(removedTris, remainingTris);
+			if (remainingTris * 3 <= targetIndexCount) {
+				break;
+			}
+		}
+		if (performed == 0) {
+			break;
+		}
+
+		// Apply the collapses, and drop the triangles that have become degenerate
+		size_t writeIx = 0;
+		for (size_t ix = 0; ix < result.size(); ix += 3) {
+			uint32_t tri[3];
+			for (int corner = 0; corner < 3; corner++) {
+				uint32_t vertex = result[ix + corner];
+				uint32_t target = collapseTarget[canonical[vertex]];
+				tri[corner] = target != canonical[vertex] ? target : vertex;
+			}
+			uint32_t a = canonical[tri[0]], b = canonical[tri[1]], c = canonical[tri[2]];
+			if (a != b && b != c && a != c) {
+				result[writeIx++] = tri[0];
+				result[writeIx++] = tri[1];
+				result[writeIx++] = tri[2];
+			}
+		}
+		result.resize(writeIx);
+	}
+
+	if (resultError != nullptr) {
+		*resultError = sqrtf(maxErrorSq);
+	}
+	return result;
+}
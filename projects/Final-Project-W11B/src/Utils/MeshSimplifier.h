@@ -0,0 +1,117 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <GLM/glm.hpp>
+
+#include "Utils/MeshBuilder.h"
+#include "Utils/MeshOptimizer.h"
+#include "Graphics/VertexParamMap.h"
+
+/// <summary>
+/// A single simplified level of detail for a mesh, which shares the vertices of the full detail mesh
+/// </summary>
+struct MeshLodData {
+	// The triangle list for this level, indexing into the original vertices
+	std::vector<uint32_t> Indices;
+	// The largest object space distance that the simplified surface moved away from the original
+	float Error = 0.0f;
+};
+
+/// <summary>
+/// Simplifies indexed triangle meshes using quadric error metrics (Garland and Heckbert). Only edge
+/// collapses onto existing vertices are performed, so the simplified index buffers can share the
+/// vertex buffer of the full detail mesh.
+///
+/// Vertices on open borders and on attribute seams (UV or normal splits) are never moved, which keeps
+/// the silhouette of open meshes and stops textures from tearing
+/// </summary>
+class MeshSimplifier {
+public:
+	// The number of levels (including the full detail level) that GenerateLods will make by default
+	static const uint32_t DEFAULT_MAX_LODS = 4;
+	// How many triangles each level keeps from the level before it
+	static constexpr float DEFAULT_LOD_REDUCTION = 0.5f;
+	// The largest error we allow for any level, relative to the size of the mesh's bounds
+	static constexpr float DEFAULT_MAX_RELATIVE_ERROR = 0.05f;
+
+	/// <summary>
+	/// Simplifies a triangle list down towards a target number of indices, without exceeding an error limit
+	/// </summary>
+	/// <param name="indices">The triangle list to simplify</param>
+	/// <param name="indexCount">The number of indices in the list</param>
+	/// <param name="positions">A pointer to the first vertex's position (3 floats)</param>
+	/// <param name="vertexCount">The number of vertices</param>
+	/// <param name="positionStride">The number of bytes between each vertex's position</param>
+	/// <param name="targetIndexCount">The number of indices we would like to end up with</param>
+	/// <param name="targetError">The largest object space distance that the surface may move</param>
+	/// <param name="resultError">If not null, receives the error of the simplified mesh</param>
+	/// <returns>The simplified triangle list, which may have more indices than requested if the error limit was hit</returns>
+	static std::vector<uint32_t> Simplify(const uint32_t* indices, size_t indexCount, const void* positions, size_t vertexCount, size_t positionStride,
+		size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+	/// <summary>
+	/// Generates a chain of simplified levels of detail for a mesh, each optimized for the vertex cache. The chain
+	/// stops early when simplifying stops paying off
+	/// </summary>
+	/// <typeparam name="Vertex">The type of vertex the mesh consists of, must have a float Position attribute</typeparam>
+	/// <param name="mesh">The full detail mesh, which is level 0 and is not included in the result</param>
+	/// <param name="maxLods">The maximum number of levels, including level 0</param>
+	/// <param name="reduction">How many triangles each level keeps from the level before it</param>
+	/// <param name="maxRelativeError">The largest error we allow, relative to the size of the mesh's bounds</param>
+	/// <returns>The simplified levels, starting at level 1, with increasing error</returns>
+	template <typename Vertex>
+	static std::vector<MeshLodData> GenerateLods(const MeshBuilder<Vertex>& mesh, uint32_t maxLods = DEFAULT_MAX_LODS,
+		float reduction = DEFAULT_LOD_REDUCTION, float maxRelativeError = DEFAULT_MAX_RELATIVE_ERROR);
+
+protected:
+	MeshSimplifier() = default;
+	~MeshSimplifier() = default;
+};
+
+template <typename Vertex>
+std::vector<MeshLodData> MeshSimplifier::GenerateLods(const MeshBuilder<Vertex>& mesh, uint32_t maxLods, float reduction, float maxRelativeError) {
+	std::vector<MeshLodData> result;
+
+	VertexParamMap vMap(Vertex::V_DECL);
+	if (mesh.GetIndexCount() < 3 || !vMap.HasPosition() || vMap.PositionType != AttributeType::Float) {
+		return result;
+	}
+
+	const uint8_t* positions = reinterpret_cast<const uint8_t*>(mesh.GetVertexDataPtr()) + vMap.PositionOffset;
+	size_t vertexCount = mesh.GetVertexCount();
+
+	// Errors are limited relative to the size of the mesh, so that every model gets similar quality
+	glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		glm::vec3 position = vMap.GetPosition(mesh.GetVertexDataPtr()[ix]);
+		min = glm::min(min, position);
+		max = glm::max(max, position);
+	}
+	float errorLimit = glm::length(max - min) * maxRelativeError;
+
+	size_t previousCount = mesh.GetIndexCount();
+	float previousError = 0.0f;
+	for (uint32_t lod = 1; lod < maxLods; lod++) {
+		// Every level is simplified from the full detail mesh, so errors don't stack up between levels
+		size_t target = static_cast<size_t>(previousCount * reduction) / 3 * 3;
+		MeshLodData level;
+		level.Indices = Simplify(mesh.GetIndexDataPtr(), mesh.GetIndexCount(), positions, vertexCount, sizeof(Vertex), target, errorLimit, &level.Error);
+
+		// A level that barely removes anything costs memory without saving any time
+		if (level.Indices.empty() || level.Indices.size() > previousCount * 0.85f) {
+			break;
+		}
+
+		MeshOptimizer::OptimizeVertexCache(level.Indices.data(), level.Indices.size(), vertexCount);
+
+		// Selection expects the error to grow with each level
+		level.Error = glm::max(level.Error, previousError);
+		previousError = level.Error;
+		previousCount = level.Indices.size();
+		result.push_back(std::move(level));
+	}
+
+	return result;
+}
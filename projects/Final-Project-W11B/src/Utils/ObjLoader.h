@@ -18,6 +18,16 @@ public:
 	template <typename VertexType = VertexPosNormTexColTangents>
 	static VertexArrayObject::Sptr LoadFromFile(const std::string& filename, bool calcTangents = true);
 
+	/// <summary>
+	/// Loads an OBJ file into a mesh builder without creating any GL resources, so that the
+	/// mesh can be processed further on the CPU
+	/// </summary>
+	/// <param name="filename">The path to the OBJ file to load</param>
+	/// <param name="mesh">The empty mesh builder to load the vertices and indices into</param>
+	/// <param name="calcTangents">True if tangents and bitangents should be calculated</param>
+	template <typename VertexType>
+	static void LoadToBuilder(const std::string& filename, MeshBuilder<VertexType>& mesh, bool calcTangents = true);
+
 protected:
 	ObjLoader() = default;
 	~ObjLoader() = default;
@@ -26,6 +36,15 @@ protected:
 
 template <typename VertexType>
 VertexArrayObject::Sptr ObjLoader::LoadFromFile(const std::string& filename, bool calcTangents) {
+	MeshBuilder<VertexType> mesh = MeshBuilder<VertexType>();
+	LoadToBuilder(filename, mesh, calcTangents);
+
+	// Move our data into a packed VAO and return it, models are only drawn with the standard vertex shaders
+	return mesh.BakePacked();
+}
+
+template <typename VertexType>
+void ObjLoader::LoadToBuilder(const std::string& filename, MeshBuilder<VertexType>& mesh, bool calcTangents) {
 	// Open our file in binary mode
 	std::ifstream file;
 	file.open(filename, std::ios::binary);
@@ -52,10 +71,6 @@ VertexArrayObject::Sptr ObjLoader::LoadFromFile(const std::string& filename, boo
 	// has been added to the mesh already
 	std::unordered_map<uint64_t, uint32_t> vertexMap;
 
-	// We'll use the mesh builder since it supports easily adding
-	// vertices and indices
-	MeshBuilder<VertexType> mesh = MeshBuilder<VertexType>();
-
 	// Storage for temporary data
 	std::string line;
 	glm::vec3 vecData;
@@ -186,7 +201,4 @@ VertexArrayObject::Sptr ObjLoader::LoadFromFile(const std::string& filename, boo
 	// Calculate and trace out how long it took us to load
 	float endTime = static_cast<float>(glfwGetTime());
 	LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, endTime - startTime, mesh.GetVertexCount(), mesh.GetIndexCount());
-
-	// Move our data into a VAO and return it
-	return mesh.Bake();
 }
\ No newline at end of file
@@ -7,8 +7,10 @@
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <cstring>
 
 #include "Utils/StringUtils.h"
+#include "Utils/CollisionCooker.h"
 #include "GLFW/glfw3.h"
 #include "Logging.h"
 
@@ -27,9 +29,18 @@ VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& file
 	if (extension == ".obj") {
 		// Get the binary path
 		fs::path binPath = filePath.replace_extension(binaryExtension);
-		// If the file does not exist, convert the OBJ file to a binary file
-		if (!fs::exists(binPath)) {
-			ConvertToBinary(filename, binPath.string());
+		bool hasBinary = fs::exists(binPath);
+		// If the file does not exist or was made by an older version, convert the OBJ file to a binary file
+		if (!hasBinary || _ReadBinaryVersion(binPath.string()) < BINARY_VERSION) {
+			// Builds can ship with just the binary files, in which case we load whatever version we have
+			if (fs::exists(filename)) {
+				ConvertToBinary(filename, binPath.string());
+			} else if (hasBinary) {
+				LOG_WARN("\"{}\" was made by an older version and \"{}\" is missing, loading it as-is", binPath.string(), filename);
+			} else {
+				LOG_WARN("Cannot load model, neither \"{}\" or \"{}\" exist", filename, binPath.string());
+				return nullptr;
+			}
 		}
 		// Load the corresponding binary file
 		return _LoadFromBinFile(binPath.string());
@@ -51,6 +62,16 @@ void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::s
 
 	float startTime = static_cast<float>(glfwGetTime());
 
+	// Reorder the mesh for the GPU, this is slow-ish so we only do it when baking the binary file
+	MeshOptimizerStats stats = MeshOptimizer::Optimize(*mesh);
+	LOG_INFO("Optimized \"{}\": ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", inFile, stats.Before.ACMR, stats.After.ACMR, stats.Before.ATVR, stats.After.ATVR);
+
+	// Simplify the mesh into levels of detail, these share the vertices we just optimized
+	std::vector<MeshLodData> lods = MeshSimplifier::GenerateLods(*mesh);
+	for (size_t ix = 0; ix < lods.size(); ix++) {
+		LOG_INFO("Generated LOD {} for \"{}\": {} triangles, error {:.5f}", ix + 1, inFile, lods[ix].Indices.size() / 3, lods[ix].Error);
+	}
+
 	// If we didn't get an output path, just take the input and replace the extension
 	std::string outFileName = outFile;
 	if (outFileName.empty()) { 
@@ -63,7 +84,18 @@ void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::s
 	}
 
 	// Save the mesh to the file
-	SaveBinaryFile(*mesh, outFileName);
+	SaveBinaryFile(*mesh, outFileName, lods);
+
+	// Cook the default collision hull while we have the mesh data, so mesh colliders don't need to read it back from the GPU
+	std::vector<glm::vec3> positions(mesh->GetVertexCount());
+	for (size_t ix = 0; ix < positions.size(); ix++) {
+		positions[ix] = mesh->GetVertexDataPtr()[ix].Position;
+	}
+	std::vector<uint32_t> indices(mesh->GetIndexDataPtr(), mesh->GetIndexDataPtr() + mesh->GetIndexCount());
+	CookedCollisionShape::Sptr hulls = CollisionCooker::Cook(positions, indices);
+	if (hulls != nullptr) {
+		CollisionCooker::SaveToFile(*hulls, CollisionCooker::GetCachePath(outFileName));
+	}
 
 	float endTime = static_cast<float>(glfwGetTime());
 	LOG_TRACE("Converted OBJ file to binary \"{}\" in {} seconds ({} vertices, {} indices)", inFile, endTime - startTime, mesh->GetVertexCount(), mesh->GetIndexCount());
@@ -258,12 +290,17 @@ VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string&
 
 	// TODO: validate header
 
-	// Handle our version
-	if (header.Version == 0x01) {
+	// Handle our version, version 2 only changed what's in the buffers, version 3 adds the position dequantization
+	// and version 4 adds the levels of detail after the vertices
+	if (header.Version >= 0x01 && header.Version <= 0x04) {
+		bool hasDequantize = header.Version >= 0x03;
+		bool hasLods = header.Version >= 0x04;
+
 		// Determine how many bytes we need in the file
 		size_t requiredBytes =
 			sizeof(BinaryHeader) +
 			(header.NumAttributes * sizeof(BufferAttribute)) +
+			(hasDequantize ? sizeof(glm::vec4) : 0) +
 			(header.VertexStride * (size_t)header.NumVertices) +
 			(header.NumIndices * GetIndexTypeSize(header.IndicesType));
 
@@ -280,22 +317,21 @@ VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string&
 			file.read(reinterpret_cast<char*>(&vertexDeclaration[ix]), sizeof(BufferAttribute));
 		}
 
+		// Older versions only had float positions
+		glm::vec4 positionDequantize = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		if (hasDequantize) {
+			file.read(reinterpret_cast<char*>(&positionDequantize), sizeof(glm::vec4));
+		}
+
 		// These will have the buffer pointers
 		IndexBuffer::Sptr indices = nullptr;
 		VertexBuffer::Sptr vertices = nullptr;
 
-		// If we have index data, load it
+		// Read the index data, we hold on to it since the levels of detail get appended after the vertices
+		size_t indexSize = GetIndexTypeSize(header.IndicesType);
+		std::vector<uint8_t> indexData(header.NumIndices * indexSize);
 		if (header.NumIndices > 0) {
-			// Create index buffer
-			indices = IndexBuffer::Create(BufferUsage::StaticDraw);
-
-			// Create memory to store indices, then read from the file
-			void* dataStore = malloc(header.NumIndices * GetIndexTypeSize(header.IndicesType));
-			file.read(reinterpret_cast<char*>(dataStore), header.NumIndices * GetIndexTypeSize(header.IndicesType));
-			
-			// Load data into OpenGL and free the CPU memory we allocated
-			indices->LoadData(dataStore, GetIndexTypeSize(header.IndicesType), header.NumIndices, header.IndicesType);
-			free(dataStore);
+			file.read(reinterpret_cast<char*>(indexData.data()), indexData.size());
 		}
 
 		// Create a new VBO
@@ -305,24 +341,75 @@ VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string&
 		void* vertexStore = malloc(header.NumVertices * (size_t)header.VertexStride);
 		file.read(reinterpret_cast<char*>(vertexStore), header.NumVertices * (size_t)header.VertexStride);
 
-		// Load data into OpenGL and free the CPU copy
+		// Load data into OpenGL
 		vertices->LoadData(vertexStore, header.VertexStride, header.NumVertices);
-		free(vertexStore);
+
+		// Each level of detail is an error, an index count and it's indices, all levels share the full detail level's index type
+		std::vector<VertexArrayObject::LodLevel> lods;
+		if (hasLods && header.NumIndices > 0) {
+			uint32_t numLods = 0;
+			file.read(reinterpret_cast<char*>(&numLods), sizeof(uint32_t));
+
+			VertexArrayObject::LodLevel level;
+			level.IndexCount = header.NumIndices;
+			lods.push_back(level);
+			for (uint32_t ix = 0; ix < numLods && file; ix++) {
+				level.IndexOffset = static_cast<uint32_t>(indexData.size() / indexSize);
+				file.read(reinterpret_cast<char*>(&level.Error), sizeof(float));
+				file.read(reinterpret_cast<char*>(&level.IndexCount), sizeof(uint32_t));
+
+				// Make sure there's enough data in the file
+				if (!file || size - static_cast<size_t>(file.tellg()) < level.IndexCount * indexSize) {
+					LOG_WARN("Not enough data for level of detail {} in \"{}\", ignoring remaining levels", ix + 1, filename);
+					break;
+				}
+				indexData.resize(indexData.size() + level.IndexCount * indexSize);
+				file.read(reinterpret_cast<char*>(indexData.data() + level.IndexOffset * indexSize), level.IndexCount * indexSize);
+				lods.push_back(level);
+			}
+		}
+
+		// If we have index data, load it into a single buffer with all the levels of detail
+		if (!indexData.empty()) {
+			indices = IndexBuffer::Create(BufferUsage::StaticDraw);
+			indices->LoadData(indexData.data(), indexSize, static_cast<uint32_t>(indexData.size() / indexSize), header.IndicesType);
+		}
 
 		// Create the VAO and attach our index and vertex buffers
 		VertexArrayObject::Sptr result = VertexArrayObject::Create();
 		result->SetIndexBuffer(indices);
 		result->AddVertexBuffer(vertices, vertexDeclaration);
+		result->SetPositionDequantize(positionDequantize);
+		if (lods.size() > 1) {
+			result->SetLods(lods);
+		}
+
+		// Work out the bounds before we free the CPU copy
+		result->CalculateBounds(vertexStore, header.NumVertices, vertexDeclaration);
+		free(vertexStore);
 
 		// Copy in the vertex declaration we loaded
 		result->SetVDecl(vertexDeclaration);
 
 		// Calculate and trace out how long it took us to load
 		float endTime = static_cast<float>(glfwGetTime());
-		LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, endTime - startTime, header.NumVertices, header.NumIndices);
+		LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices, {} LODs)", filename, endTime - startTime, header.NumVertices, header.NumIndices, result->GetLodCount());
 
 		return result;
 	}
 
+	LOG_ERROR("Unsupported binary mesh version {} in \"{}\"", header.Version, filename);
 	return nullptr;
 }
+
+uint16_t OptimizedObjLoader::_ReadBinaryVersion(const std::string& filename) {
+	std::ifstream file(filename, std::ios::binary);
+	BinaryHeader header = BinaryHeader();
+	if (!file || !file.read(reinterpret_cast<char*>(&header), sizeof(BinaryHeader))) {
+		return 0;
+	}
+	if (memcmp(header.HeaderBytes, HEADER_BYTES, sizeof(HEADER_BYTES)) != 0) {
+		return 0;
+	}
+	return header.Version;
+}
@@ -12,6 +12,8 @@
 #include "Graphics/VertexTypes.h"
 
 #include "Utils/MeshBuilder.h"
+#include "Utils/MeshOptimizer.h"
+#include "Utils/MeshSimplifier.h"
 
 /// <summary>
 /// An optimized OBJ loader that can convert an OBJ file to a binary representation
@@ -39,8 +41,15 @@ public:
 	/// <typeparam name="VertexType"></typeparam>
 	/// <param name="mesh"></param>
 	/// <param name="outFilename"></param>
+	/// <param name="lods">Simplified levels of detail for the mesh, starting at level 1</param>
 	template <typename VertexType>
-	static void SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename);
+	static void SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename, const std::vector<MeshLodData>& lods = {});
+
+	// The binary format version that we write. Version 2 files have been run through the MeshOptimizer and may
+	// use 16 bit indices, version 3 files store packed vertices (see VertexPacker) followed by the position
+	// dequantization after the attributes, and version 4 files have a table of levels of detail after the vertices.
+	// Older files are still loaded but are re-converted when their OBJ file is available
+	static const uint16_t BINARY_VERSION = 0x04;
 
 protected:
 	// Will be put at the start of the binary file, contains info about the contents of the file
@@ -66,37 +75,69 @@ protected:
 
 	static MeshBuilder<VertexPosNormTexColTangents>* _LoadFromObjFile(const std::string& filename);
 	static VertexArrayObject::Sptr _LoadFromBinFile(const std::string& filename);
+	// Reads the version from a binary file's header, or 0 if the file is not a binary mesh
+	static uint16_t _ReadBinaryVersion(const std::string& filename);
 };
 
 template <typename VertexType>
-void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename) {
+void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename, const std::vector<MeshLodData>& lods) {
 	// Open the output file
 	std::ofstream file(outFilename, std::ios::binary);
 	if (!file) {
 		throw std::runtime_error("Failed to open output file");
 	}
 
+	// Indices that fit in 16 bits take half the memory and bandwidth
+	bool shortIndices = mesh.GetVertexCount() < 65536;
+
+	// Quantize the vertices, we store them exactly as they will be uploaded
+	PackedVertexData packed = VertexPacker::Pack(mesh.GetVertexDataPtr(), static_cast<uint32_t>(mesh.GetVertexCount()), VertexType::V_DECL);
+
 	// Create the fixed size header for our output file
 	BinaryHeader header  = BinaryHeader();
-	header.Version       = 0x01; // This is version 1! Update this and implement different readers if changes to format are made
+	header.Version       = BINARY_VERSION; // Update this and implement different readers if changes to format are made
 	header.NumIndices    = mesh.GetIndexCount();
-	header.IndicesType   = IndexType::UInt;
-	header.NumVertices   = mesh.GetVertexCount();
-	header.VertexStride  = sizeof(VertexType);
-	header.NumAttributes = VertexType::V_DECL.size();
+	header.IndicesType   = shortIndices ? IndexType::UShort : IndexType::UInt;
+	header.NumVertices   = packed.VertexCount;
+	header.VertexStride  = packed.Stride;
+	header.NumAttributes = packed.VDecl.size();
 
 	// Write header bytes to the stream
 	file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeader));
 
 	// Write which attributes we have to the stream
-	for (int ix = 0; ix < VertexType::V_DECL.size(); ix++) {
-		file.write(reinterpret_cast<const char*>(&VertexType::V_DECL[ix]), sizeof(BufferAttribute));
+	for (int ix = 0; ix < packed.VDecl.size(); ix++) {
+		file.write(reinterpret_cast<const char*>(&packed.VDecl[ix]), sizeof(BufferAttribute));
 	}
+	// Write how to turn the packed positions back into object space
+	file.write(reinterpret_cast<const char*>(&packed.PositionDequantize), sizeof(glm::vec4));
 	// Write any index data to the file
 	if (mesh.GetIndexCount() > 0) {
-		file.write(reinterpret_cast<const char*>(mesh.GetIndexDataPtr()), mesh.GetIndexCount() * sizeof(uint32_t));
+		if (shortIndices) {
+			std::vector<uint16_t> shortData(mesh.GetIndexDataPtr(), mesh.GetIndexDataPtr() + mesh.GetIndexCount());
+			file.write(reinterpret_cast<const char*>(shortData.data()), shortData.size() * sizeof(uint16_t));
+		} else {
+			file.write(reinterpret_cast<const char*>(mesh.GetIndexDataPtr()), mesh.GetIndexCount() * sizeof(uint32_t));
+		}
 	}
 
 	// Write vertex data to file
-	file.write(reinterpret_cast<const char*>(mesh.GetVertexDataPtr()), mesh.GetVertexCount() * sizeof(VertexType));
+	file.write(reinterpret_cast<const char*>(packed.Data.data()), packed.Data.size());
+
+	// Write the levels of detail, these use the same index type as the full detail mesh
+	if (mesh.GetIndexCount() > 0) {
+		uint32_t numLods = static_cast<uint32_t>(lods.size());
+		file.write(reinterpret_cast<const char*>(&numLods), sizeof(uint32_t));
+		for (const MeshLodData& lod : lods) {
+			uint32_t numIndices = static_cast<uint32_t>(lod.Indices.size());
+			file.write(reinterpret_cast<const char*>(&lod.Error), sizeof(float));
+			file.write(reinterpret_cast<const char*>(&numIndices), sizeof(uint32_t));
+			if (shortIndices) {
+				std::vector<uint16_t> shortData(lod.Indices.begin(), lod.Indices.end());
+				file.write(reinterpret_cast<const char*>(shortData.data()), shortData.size() * sizeof(uint16_t));
+			} else {
+				file.write(reinterpret_cast<const char*>(lod.Indices.data()), lod.Indices.size() * sizeof(uint32_t));
+			}
+		}
+	}
 }
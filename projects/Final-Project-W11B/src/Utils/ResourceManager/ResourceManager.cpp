@@ -1,14 +1,21 @@
 #include "Utils/ResourceManager/ResourceManager.h"
 
+#include <filesystem>
+
 #include "Utils/ObjLoader.h"
+#include "Utils/BlobSidecar.h"
 #include "Utils/FileHelpers.h"
 #include "Utils/StringUtils.h"
+#include "Graphics/Textures/ImageDecoder.h"
 
 std::map<std::type_index, std::map<Guid, IResource::Sptr>> ResourceManager::_resources;
 std::map<std::string, std::function<Guid(const nlohmann::json&)>> ResourceManager::_typeLoaders;
+std::map<std::string, std::function<void(const nlohmann::json&)>> ResourceManager::_typePrefetchers;
 
 nlohmann::ordered_json ResourceManager::_manifest;
 
+size_t ResourceManager::_sidecarThreshold = 256 * 1024;
+
 void ResourceManager::Init() {
 	// TODO: initialize the resource manager once it's a bit more complex
 	//_manifest["textures"]  = std::vector<nlohmann::json>();
@@ -25,8 +32,19 @@ void ResourceManager::LoadManifest(const std::string& path, bool preloadAssets)
 	std::string contents = FileHelpers::ReadFile(path);
 	nlohmann::ordered_json blob = nlohmann::ordered_json::parse(contents);
 	_manifest = blob;
+	BlobSidecar::SetDirectory(std::filesystem::path(path).parent_path().string());
 
 	if (preloadAssets) {
+		// Start any background work first (ex: decoding textures), so that it can overlap with loading
+		for (auto& [typeName, items] : blob.items()) {
+			auto it = _typePrefetchers.find(typeName);
+			if (it != _typePrefetchers.end()) {
+				for (auto& [guid, blob] : items.items()) {
+					it->second(blob);
+				}
+			}
+		}
+
 		for (auto& [typeName, items] : blob.items()) {
 			auto& func = _typeLoaders[typeName];
 			if (func) {
@@ -35,10 +53,19 @@ void ResourceManager::LoadManifest(const std::string& path, bool preloadAssets)
 				}
 			}
 		}
+
+		// Everything has been loaded, so we don't need to keep the sidecar mapped, or any images that no resource ended up using
+		BlobSidecar::Release();
+		ImageDecoder::ClearPrefetched();
 	}
 }
 
 void ResourceManager::SaveManifest(const std::string& path) {
+	bool useSidecar = _sidecarThreshold > 0;
+	if (useSidecar) {
+		BlobSidecar::BeginWrite(path, _sidecarThreshold);
+	}
+
 	// Update all resources in the manifest so they match their current representation
 	for (auto& [type, map] : _resources) {
 		std::string typeName = StringTools::SanitizeClassName(type.name());
@@ -49,12 +76,29 @@ void ResourceManager::SaveManifest(const std::string& path) {
 			}
 		}
 	}
+
+	if (useSidecar) {
+		// Resources that weren't loaded still point into the old sidecar, which we're about to replace
+		BlobSidecar::Relink(_manifest);
+		BlobSidecar::EndWrite();
+	}
+
 	FileHelpers::WriteContentsToFile(path, _manifest.dump(1,'\t'));
 }
 
+void ResourceManager::SetSidecarThreshold(size_t value) {
+	_sidecarThreshold = value;
+}
+
+size_t ResourceManager::GetSidecarThreshold() {
+	return _sidecarThreshold;
+}
+
 void ResourceManager::Cleanup() {
 	for (auto& [type, map] : _resources) {
 		map.clear();
 	}
+	BlobSidecar::Release();
+	ImageDecoder::ClearPrefetched();
 }
 
@@ -94,6 +94,13 @@ public:
 			return res->GetGUID();
 		};
 
+		// If the type can start loading it's data in the background, register a prefetcher for it as well
+		if constexpr (test_prefetch<T, const nlohmann::json&>::value) {
+			_typePrefetchers[typeName] = [](const nlohmann::json& data) {
+				T::PrefetchFromJson(data);
+			};
+		}
+
 		// Make sure we haven't registered the type yet, then add an empty object
 		// to the manifest to ensure it can be saved
 		if (!_manifest.contains(typeName)) {
@@ -131,17 +138,30 @@ public:
 	static const nlohmann::ordered_json& GetManifest();
 	/// <summary>
 	/// Loads a manifest file into the resource manager. Note that this will not perform load on the assets themselves 
-	/// unless preloadAssets is set to true
+	/// unless preloadAssets is set to true. When preloading, any types that define a static PrefetchFromJson will
+	/// have all their entries prefetched (ex: images decoded in parallel) before the assets are loaded
 	/// </summary>
 	/// <param name="path">The path to the JSON manifest file</param>
 	/// <param name="preloadAssets">True if all assets should be loaded into memory</param>
 	static void LoadManifest(const std::string& path, bool preloadAssets = false);
 	/// <summary>
-	/// Saves the manifest to the given JSON file
+	/// Saves the manifest to the given JSON file. Any embedded resource data larger than the sidecar
+	/// threshold is written to a binary file beside the manifest (with a .bin extension) instead of
+	/// being stored inline as Base64
 	/// </summary>
 	/// <param name="path">The path to the file to output</param>
 	static void SaveManifest(const std::string& path);
 
+	/// <summary>
+	/// Sets the size in bytes at which embedded resource data (ex: generated textures) is moved out of the
+	/// manifest and into the sidecar file when saving, or 0 to always store data inline. Default 256KB
+	/// </summary>
+	static void SetSidecarThreshold(size_t value);
+	/// <summary>
+	/// Gets the size in bytes at which embedded resource data is moved to the sidecar file
+	/// </summary>
+	static size_t GetSidecarThreshold();
+
 	/// <summary>
 	/// Releases all resources held by the resource manager
 	/// </summary>
@@ -158,10 +178,17 @@ protected:
 	/// This map stores registered types, so we can load them from JSON files
 	/// </summary>
 	static std::map<std::string, std::function<Guid(const nlohmann::json&)>> _typeLoaders;
+	/// <summary>
+	/// This map stores the optional prefetch functions for registered types, which can begin
+	/// loading data in the background before the resource is created
+	/// </summary>
+	static std::map<std::string, std::function<void(const nlohmann::json&)>> _typePrefetchers;
 
 	/// <summary>
 	/// We use an ORDERED JSON file to allow serializing types in the order they are registered.
 	/// This allows us to register dependencies before the dependent resource
 	/// </summary>
 	static nlohmann::ordered_json _manifest;
+
+	static size_t _sidecarThreshold;
 };
\ No newline at end of file
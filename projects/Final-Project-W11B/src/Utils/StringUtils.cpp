@@ -65,3 +65,15 @@ int StringTools::Split(const std::string& s, std::vector<std::string>& results,
 	results.push_back(s.substr(lastPos, seek));
 	return ++result;
 }
+
+int StringTools::ReplaceAll(std::string& s, const std::string& from, const std::string& to) {
+	int result = 0;
+	size_t seek = s.find(from, 0);
+	while (seek != std::string::npos) {
+		s.replace(seek, from.size(), to);
+		result++;
+		// Skip past the replacement so we don't match within it
+		seek = s.find(from, seek + to.size());
+	}
+	return result;
+}
\ No newline at end of file
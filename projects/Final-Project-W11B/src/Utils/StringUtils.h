@@ -115,4 +115,13 @@ public:
 	/// <param name="splitOn">The delimiter string to split on</param>
 	/// <returns>The number of tokens this command appended to the results</returns>
 	static int Split(const std::string& s, std::vector<std::string>& results, const std::string& splitOn = ",");
+
+	/// <summary>
+	/// Replaces all instances of a token within a string, in place
+	/// </summary>
+	/// <param name="s">A reference to the string to modify</param>
+	/// <param name="from">The token to search for, must not be empty</param>
+	/// <param name="to">The string to replace the token with</param>
+	/// <returns>The number of tokens that were replaced</returns>
+	static int ReplaceAll(std::string& s, const std::string& from, const std::string& to);
 };
\ No newline at end of file
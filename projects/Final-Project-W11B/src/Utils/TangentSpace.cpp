@@ -0,0 +1,266 @@
+#include "Utils/TangentSpace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Utils/ObjLoader.h"
+#include "Utils/StringUtils.h"
+#include "Utils/ThreadPool.h"
+#include "Logging.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+	/// <summary>
+	/// Runs func(begin, end) over [0, count) in chunks, on the calling thread and threadCount - 1 thread pool jobs
+	/// </summary>
+	template <typename Func>
+	void ParallelChunks(size_t count, uint32_t threadCount, const Func& func) {
+		size_t chunkCount = (count + TangentSpace::CHUNK_SIZE - 1) / TangentSpace::CHUNK_SIZE;
+
+		// Each worker grabs the next chunk until we run out
+		std::atomic<size_t> nextChunk(0);
+		auto worker = [&]() {
+			for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++) {
+				size_t begin = chunk * TangentSpace::CHUNK_SIZE;
+				func(begin, std::min(begin + TangentSpace::CHUNK_SIZE, count));
+			}
+		};
+
+		// We work through chunks while we wait, so jobs that start late just find nothing left to do
+		uint32_t numThreads = static_cast<uint32_t>(std::clamp<size_t>(threadCount, 1, std::max<size_t>(chunkCount, 1)));
+		std::vector<std::future<void>> jobs;
+		jobs.reserve(numThreads - 1);
+		for (uint32_t ix = 1; ix < numThreads; ix++) {
+			jobs.push_back(ThreadPool::Enqueue(worker));
+		}
+		worker();
+		for (auto& job : jobs) {
+			job.wait();
+		}
+	}
+
+	// Finds any unit vector perpendicular to the given unit vector
+	glm::vec3 AnyPerpendicular(const glm::vec3& normal) {
+		glm::vec3 axis = glm::abs(normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		return glm::normalize(glm::cross(axis, normal));
+	}
+
+	// Returns the largest angle in degrees between matching tangents, and the number of flipped handedness signs
+	std::pair<float, size_t> CompareTangents(const std::vector<glm::vec4>& a, const std::vector<glm::vec4>& b) {
+		float maxAngle = 0.0f;
+		size_t flippedSigns = 0;
+		for (size_t ix = 0; ix < a.size(); ix++) {
+			float cosAngle = glm::clamp(glm::dot(glm::vec3(a[ix]), glm::vec3(b[ix])), -1.0f, 1.0f);
+			maxAngle = glm::max(maxAngle, glm::degrees(acosf(cosAngle)));
+			flippedSigns += a[ix].w != b[ix].w ? 1 : 0;
+		}
+		return { maxAngle, flippedSigns };
+	}
+}
+
+void TangentSpace::Generate(const glm::vec3* positions, const glm::vec3* normals, const glm::vec2* uvs, size_t vertexCount,
+	const uint32_t* indices, size_t indexCount, glm::vec4* outTangents, glm::vec3* outBitangents, uint32_t threadCount)
+{
+	size_t triCount = indexCount / 3;
+	if (threadCount == 0) {
+		// Every pool worker plus the calling thread
+		ThreadPool::Init();
+		threadCount = triCount >= PARALLEL_THRESHOLD ? ThreadPool::GetThreadCount() + 1 : 1;
+	}
+
+	// Per triangle frames, stored as separate arrays so that each pass only touches what it needs
+	std::vector<glm::vec3> faceTangents(triCount);
+	std::vector<glm::vec3> faceBitangents(triCount);
+	std::vector<glm::vec3> faceNormals(triCount);
+	std::vector<float>     cornerWeights(triCount * 3);
+
+	ParallelChunks(triCount, threadCount, [&](size_t begin, size_t end) {
+		for (size_t tri = begin; tri < end; tri++) {
+			const uint32_t* corners = indices + tri * 3;
+			glm::vec3 p[3] = { positions[corners[0]], positions[corners[1]], positions[corners[2]] };
+			glm::vec2 t[3] = { uvs[corners[0]], uvs[corners[1]], uvs[corners[2]] };
+
+			glm::vec3 deltaP1 = p[1] - p[0];
+			glm::vec3 deltaP2 = p[2] - p[0];
+			glm::vec2 deltaT1 = t[1] - t[0];
+			glm::vec2 deltaT2 = t[2] - t[0];
+
+			// Use the deltas in position and UV to calculate the tangent and bitangent
+			// https://learnopengl.com/Advanced-Lighting/Normal-Mapping
+			// We skip the 1 / determinant, since we only want directions and the sign is handled below
+			glm::vec3 tangent = deltaP1 * deltaT2.y - deltaP2 * deltaT1.y;
+			glm::vec3 bitangent = deltaP2 * deltaT1.x - deltaP1 * deltaT2.x;
+			float determinant = deltaT1.x * deltaT2.y - deltaT1.y * deltaT2.x;
+			if (determinant < 0.0f) {
+				tangent = -tangent;
+				bitangent = -bitangent;
+			}
+
+			// Triangles with no UV area (or no area at all) don't tell us anything about the tangent
+			float tangentLength = glm::length(tangent);
+			float bitangentLength = glm::length(bitangent);
+			bool validUVs = determinant != 0.0f && tangentLength > 0.0f && bitangentLength > 0.0f;
+			faceTangents[tri] = validUVs ? tangent / tangentLength : glm::vec3(0.0f);
+			faceBitangents[tri] = validUVs ? bitangent / bitangentLength : glm::vec3(0.0f);
+
+			glm::vec3 normal = glm::cross(deltaP1, deltaP2);
+			float normalLength = glm::length(normal);
+			faceNormals[tri] = normalLength > 0.0f ? normal / normalLength : glm::vec3(0.0f);
+
+			// Weight each corner by it's angle
+			for (int corner = 0; corner < 3; corner++) {
+				glm::vec3 e1 = p[(corner + 1) % 3] - p[corner];
+				glm::vec3 e2 = p[(corner + 2) % 3] - p[corner];
+				float lengths = glm::length(e1) * glm::length(e2);
+				cornerWeights[tri * 3 + corner] = lengths > 0.0f ? acosf(glm::clamp(glm::dot(e1, e2) / lengths, -1.0f, 1.0f)) : 0.0f;
+			}
+		}
+	});
+
+	// Build the list of corners that touch each vertex, in index order, so that every vertex sums its
+	// triangles in the same order no matter how the work is split up
+	std::vector<uint32_t> cornerOffsets(vertexCount + 1, 0);
+	for (size_t ix = 0; ix < triCount * 3; ix++) {
+		cornerOffsets[indices[ix] + 1]++;
+	}
+	std::partial_sum(cornerOffsets.begin(), cornerOffsets.end(), cornerOffsets.begin());
+	std::vector<uint32_t> vertexCorners(triCount * 3);
+	{
+		std::vector<uint32_t> cursor(cornerOffsets.begin(), cornerOffsets.end() - 1);
+		for (size_t ix = 0; ix < triCount * 3; ix++) {
+			vertexCorners[cursor[indices[ix]]++] = static_cast<uint32_t>(ix);
+		}
+	}
+
+	ParallelChunks(vertexCount, threadCount, [&](size_t begin, size_t end) {
+		for (size_t vertex = begin; vertex < end; vertex++) {
+			glm::vec3 tangentSum = glm::vec3(0.0f);
+			glm::vec3 bitangentSum = glm::vec3(0.0f);
+			glm::vec3 normalSum = glm::vec3(0.0f);
+			for (uint32_t ix = cornerOffsets[vertex]; ix < cornerOffsets[vertex + 1]; ix++) {
+				uint32_t corner = vertexCorners[ix];
+				float weight = cornerWeights[corner];
+				tangentSum += faceTangents[corner / 3] * weight;
+				bitangentSum += faceBitangents[corner / 3] * weight;
+				normalSum += faceNormals[corner / 3] * weight;
+			}
+
+			// Prefer the vertex's own normal, since that's what gets used for lighting
+			glm::vec3 normal = normals != nullptr ? normals[vertex] : glm::vec3(0.0f);
+			if (glm::dot(normal, normal) <= 0.0f) {
+				normal = normalSum;
+			}
+			normal = glm::dot(normal, normal) > 0.0f ? glm::normalize(normal) : glm::vec3(0.0f, 0.0f, 1.0f);
+
+			// Gram-Schmidt the tangent against the normal, falling back to the bitangent if the tangent is degenerate
+			glm::vec3 tangent = tangentSum - normal * glm::dot(normal, tangentSum);
+			if (glm::dot(tangent, tangent) < 1e-12f) {
+				tangent = glm::cross(bitangentSum, normal);
+			}
+			tangent = glm::dot(tangent, tangent) >= 1e-12f ? glm::normalize(tangent) : AnyPerpendicular(normal);
+
+			// The sign tells the shader whether the UVs are mirrored
+			glm::vec3 bitangent = glm::cross(normal, tangent);
+			float sign = glm::dot(bitangent, bitangentSum) < 0.0f ? -1.0f : 1.0f;
+
+			outTangents[vertex] = glm::vec4(tangent, sign);
+			if (outBitangents != nullptr) {
+				outBitangents[vertex] = bitangent * sign;
+			}
+		}
+	});
+}
+
+nlohmann::json TangentSpace::RunBenchmark(const std::string& directory, uint32_t iterations) {
+	using Clock = std::chrono::high_resolution_clock;
+
+	nlohmann::json report = nlohmann::json::array();
+	std::error_code error;
+	if (!fs::is_directory(directory, error)) {
+		LOG_WARN("\"{}\" is not a directory", directory);
+		return report;
+	}
+
+	uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	iterations = std::max(iterations, 1u);
+
+	for (const auto& entry : fs::recursive_directory_iterator(directory, error)) {
+		std::string extension = entry.path().extension().string();
+		StringTools::ToLower(extension);
+		if (!entry.is_regular_file() || extension != ".obj") {
+			continue;
+		}
+		std::string path = entry.path().string();
+
+		MeshBuilder<VertexPosNormTexColTangents> mesh;
+		ObjLoader::LoadToBuilder(path, mesh, false);
+		size_t vertexCount = mesh.GetVertexCount();
+
+		std::vector<glm::vec3> positions(vertexCount), normals(vertexCount);
+		std::vector<glm::vec2> uvs(vertexCount);
+		for (size_t ix = 0; ix < vertexCount; ix++) {
+			const VertexPosNormTexColTangents& vertex = mesh.GetVertexDataPtr()[ix];
+			positions[ix] = vertex.Position;
+			normals[ix] = vertex.Normal;
+			uvs[ix] = vertex.UV;
+		}
+		std::vector<uint32_t> indices(mesh.GetIndexDataPtr(), mesh.GetIndexDataPtr() + mesh.GetIndexCount());
+
+		// Times generating the tangents, returning the average milliseconds and the output of the last run
+		std::vector<glm::vec4> tangents(vertexCount);
+		auto time = [&](const std::vector<uint32_t>& tris, uint32_t threads) {
+			auto start = Clock::now();
+			for (uint32_t ix = 0; ix < iterations; ix++) {
+				Generate(positions.data(), normals.data(), uvs.data(), vertexCount, tris.data(), tris.size(), tangents.data(), nullptr, threads);
+			}
+			return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+		};
+
+		double serialMs = time(indices, 1);
+		std::vector<glm::vec4> serial = tangents;
+		double parallelMs = time(indices, hardwareThreads);
+		std::vector<glm::vec4> parallel = tangents;
+
+		// The old blending depended on triangle order, so we make sure the new one doesn't by shuffling the triangles
+		std::vector<uint32_t> shuffled(indices.size());
+		{
+			std::vector<size_t> order(indices.size() / 3);
+			std::iota(order.begin(), order.end(), 0);
+			std::shuffle(order.begin(), order.end(), std::mt19937(1234));
+			for (size_t ix = 0; ix < order.size(); ix++) {
+				std::copy_n(indices.begin() + order[ix] * 3, 3, shuffled.begin() + ix * 3);
+			}
+		}
+		time(shuffled, 1);
+		std::vector<glm::vec4> reordered = tangents;
+
+		auto threadDiff = CompareTangents(serial, parallel);
+		auto orderDiff = CompareTangents(serial, reordered);
+
+		LOG_INFO("{}: {} vertices, {} triangles, {:.3f}ms (1 thread) {:.3f}ms ({} threads), max reorder error {:.4f} degrees",
+			path, vertexCount, indices.size() / 3, serialMs, parallelMs, hardwareThreads, orderDiff.first);
+
+		report.push_back({
+			{ "file", path },
+			{ "vertices", vertexCount },
+			{ "triangles", indices.size() / 3 },
+			{ "iterations", iterations },
+			{ "serial_ms", serialMs },
+			{ "parallel_ms", parallelMs },
+			{ "threads", hardwareThreads },
+			{ "thread_max_angle_deg", threadDiff.first },
+			{ "thread_sign_flips", threadDiff.second },
+			{ "reorder_max_angle_deg", orderDiff.first },
+			{ "reorder_sign_flips", orderDiff.second }
+		});
+	}
+
+	return report;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <GLM/glm.hpp>
+#include <json.hpp>
+
+/// <summary>
+/// Generates per vertex tangent frames for normal mapping from positions, normals and UVs.
+///
+/// Each triangle's tangent and bitangent are found from it's UV gradients, then every vertex
+/// sums the (normalized) frames of the triangles around it, weighted by the angle of the corner
+/// the vertex sits in. This makes the result independent of triangle order and of how finely
+/// a surface happens to be tessellated. The sums are then orthonormalized against the vertex
+/// normal, with the handedness of the UVs kept as a sign.
+///
+/// Large meshes are processed in chunks on the thread pool. Every vertex gathers from it's
+/// triangles in the same order regardless of threading, so the output is identical for any
+/// number of threads
+/// </summary>
+class TangentSpace {
+public:
+	// Meshes with fewer triangles than this aren't worth splitting into jobs for
+	static const size_t PARALLEL_THRESHOLD = 16384;
+	// The number of triangles or vertices each thread grabs at a time
+	static const size_t CHUNK_SIZE = 4096;
+
+	/// <summary>
+	/// Generates the tangent frames for an indexed triangle list
+	/// </summary>
+	/// <param name="positions">The position of each vertex</param>
+	/// <param name="normals">The normal of each vertex, or nullptr to use the normals of the surrounding triangles</param>
+	/// <param name="uvs">The texture coordinates of each vertex</param>
+	/// <param name="vertexCount">The number of vertices</param>
+	/// <param name="indices">The triangle list</param>
+	/// <param name="indexCount">The number of indices in the list</param>
+	/// <param name="outTangents">Receives the unit tangent of each vertex in xyz, and the bitangent sign (+-1) in w</param>
+	/// <param name="outBitangents">If not null, receives the unit bitangent of each vertex</param>
+	/// <param name="threadCount">The number of threads to use, or 0 to pick automatically based on the mesh size</param>
+	static void Generate(const glm::vec3* positions, const glm::vec3* normals, const glm::vec2* uvs, size_t vertexCount,
+		const uint32_t* indices, size_t indexCount, glm::vec4* outTangents, glm::vec3* outBitangents = nullptr, uint32_t threadCount = 0);
+
+	/// <summary>
+	/// Benchmarks tangent generation on every OBJ file under a directory. Reports the time taken with
+	/// one thread and with all hardware threads, and how stable the output is, comparing threaded
+	/// to single threaded results and results from a shuffled triangle order
+	/// </summary>
+	/// <param name="directory">The directory to search for OBJ files</param>
+	/// <param name="iterations">The number of times to generate each mesh's tangents for timing</param>
+	/// <returns>A JSON report with an entry per OBJ file</returns>
+	static nlohmann::json RunBenchmark(const std::string& directory, uint32_t iterations = 20);
+
+protected:
+	TangentSpace() = default;
+	~TangentSpace() = default;
+};
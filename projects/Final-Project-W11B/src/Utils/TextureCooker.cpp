@@ -0,0 +1,603 @@
+#include "Utils/TextureCooker.h"
+
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <cfloat>
+#include <climits>
+
+#include <stb_image.h>
+#include "GLFW/glfw3.h"
+#include "Utils/StringUtils.h"
+#include "Logging.h"
+
+const char COOKED_HEADER_BYTES[4] = { 'C', 'T', 'E', 'X' };
+const std::string cookedExtension = ".ctex";
+
+namespace fs = std::filesystem;
+
+#pragma region Block Encoders
+
+/// <summary>
+/// Copies a 4x4 block of RGBA8 texels out of an image, clamping reads at the edges of the image
+/// </summary>
+inline void FetchBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t block[64]) {
+	for (uint32_t y = 0; y < 4; y++) {
+		uint32_t srcY = std::min(blockY * 4 + y, height - 1);
+		for (uint32_t x = 0; x < 4; x++) {
+			uint32_t srcX = std::min(blockX * 4 + x, width - 1);
+			memcpy(block + (y * 4 + x) * 4, rgba + (srcY * width + srcX) * 4, 4);
+		}
+	}
+}
+
+/// <summary>
+/// Finds the two colors at the extremes of the block's principal axis, then insets them slightly
+/// so that the interpolated palette entries land closer to the actual texel values
+/// </summary>
+/// <param name="block">The 16 RGBA8 texels of the block</param>
+/// <param name="channels">The number of channels to consider (3 for RGB, 4 for RGBA)</param>
+inline void FindEndpoints(const uint8_t block[64], int channels, float low[4], float high[4]) {
+	float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	float minVal[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+	float maxVal[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int ix = 0; ix < 16; ix++) {
+		for (int c = 0; c < channels; c++) {
+			float value = block[ix * 4 + c];
+			mean[c] += value;
+			minVal[c] = std::min(minVal[c], value);
+			maxVal[c] = std::max(maxVal[c], value);
+		}
+	}
+	for (int c = 0; c < channels; c++) {
+		mean[c] /= 16.0f;
+	}
+
+	// Build the covariance matrix of the block
+	float covariance[4][4] = {};
+	for (int ix = 0; ix < 16; ix++) {
+		float delta[4];
+		for (int c = 0; c < channels; c++) {
+			delta[c] = block[ix * 4 + c] - mean[c];
+		}
+		for (int a = 0; a < channels; a++) {
+			for (int b = 0; b < channels; b++) {
+				covariance[a][b] += delta[a] * delta[b];
+			}
+		}
+	}
+
+	// Power iteration to find the principal axis, seeded with the bounding box diagonal
+	float axis[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int c = 0; c < channels; c++) {
+		axis[c] = maxVal[c] - minVal[c];
+	}
+	for (int iteration = 0; iteration < 8; iteration++) {
+		float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float largest = 0.0f;
+		for (int a = 0; a < channels; a++) {
+			for (int b = 0; b < channels; b++) {
+				next[a] += covariance[a][b] * axis[b];
+			}
+			largest = std::max(largest, std::abs(next[a]));
+		}
+		if (largest <= 0.0f) {
+			break;
+		}
+		for (int c = 0; c < channels; c++) {
+			axis[c] = next[c] / largest;
+		}
+	}
+
+	float lengthSq = 0.0f;
+	for (int c = 0; c < channels; c++) {
+		lengthSq += axis[c] * axis[c];
+	}
+
+	// Solid color block, both endpoints are just the mean
+	if (lengthSq <= 0.0f) {
+		for (int c = 0; c < channels; c++) {
+			low[c] = high[c] = mean[c];
+		}
+		return;
+	}
+
+	// Project all the texels onto the axis to find the extents
+	float minT = FLT_MAX, maxT = -FLT_MAX;
+	for (int ix = 0; ix < 16; ix++) {
+		float t = 0.0f;
+		for (int c = 0; c < channels; c++) {
+			t += (block[ix * 4 + c] - mean[c]) * axis[c];
+		}
+		minT = std::min(minT, t);
+		maxT = std::max(maxT, t);
+	}
+	minT /= lengthSq;
+	maxT /= lengthSq;
+
+	for (int c = 0; c < channels; c++) {
+		float lo = mean[c] + axis[c] * minT;
+		float hi = mean[c] + axis[c] * maxT;
+		float inset = (hi - lo) / 16.0f;
+		low[c]  = std::clamp(lo + inset, 0.0f, 255.0f);
+		high[c] = std::clamp(hi - inset, 0.0f, 255.0f);
+	}
+}
+
+inline uint16_t PackRGB565(const float color[3]) {
+	int r = std::clamp(static_cast<int>(color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+	int g = std::clamp(static_cast<int>(color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+	int b = std::clamp(static_cast<int>(color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+	return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+inline void UnpackRGB565(uint16_t value, int color[3]) {
+	int r = (value >> 11) & 31;
+	int g = (value >> 5) & 63;
+	int b = value & 31;
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+}
+
+/// <summary>
+/// Encodes an RGB block into 8 bytes of BC1 (DXT1) data, always using the 4 color mode
+/// </summary>
+inline void EncodeBC1(const uint8_t block[64], uint8_t* out) {
+	float low[4], high[4];
+	FindEndpoints(block, 3, low, high);
+
+	uint16_t color0 = PackRGB565(high);
+	uint16_t color1 = PackRGB565(low);
+	// color0 > color1 selects the 4 color mode
+	if (color0 < color1) {
+		std::swap(color0, color1);
+	}
+
+	uint32_t indices = 0;
+	if (color0 != color1) {
+		int palette[4][3];
+		UnpackRGB565(color0, palette[0]);
+		UnpackRGB565(color1, palette[1]);
+		for (int c = 0; c < 3; c++) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		for (int ix = 0; ix < 16; ix++) {
+			int bestIndex = 0;
+			int bestError = INT_MAX;
+			for (int p = 0; p < 4; p++) {
+				int error = 0;
+				for (int c = 0; c < 3; c++) {
+					int delta = block[ix * 4 + c] - palette[p][c];
+					error += delta * delta;
+				}
+				if (error < bestError) {
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+			indices |= static_cast<uint32_t>(bestIndex) << (ix * 2);
+		}
+	}
+
+	out[0] = color0 & 0xFF;
+	out[1] = color0 >> 8;
+	out[2] = color1 & 0xFF;
+	out[3] = color1 >> 8;
+	for (int ix = 0; ix < 4; ix++) {
+		out[4 + ix] = (indices >> (ix * 8)) & 0xFF;
+	}
+}
+
+/// <summary>
+/// Encodes a single channel of a block into 8 bytes of BC4 data, always using the 8 value mode
+/// </summary>
+inline void EncodeBC4(const uint8_t block[64], int channel, uint8_t* out) {
+	int low = 255, high = 0;
+	for (int ix = 0; ix < 16; ix++) {
+		low  = std::min<int>(low, block[ix * 4 + channel]);
+		high = std::max<int>(high, block[ix * 4 + channel]);
+	}
+
+	uint64_t indices = 0;
+	if (high != low) {
+		int palette[8];
+		palette[0] = high;
+		palette[1] = low;
+		for (int p = 2; p < 8; p++) {
+			palette[p] = ((8 - p) * high + (p - 1) * low) / 7;
+		}
+
+		for (int ix = 0; ix < 16; ix++) {
+			int value = block[ix * 4 + channel];
+			int bestIndex = 0;
+			int bestError = INT_MAX;
+			for (int p = 0; p < 8; p++) {
+				int error = std::abs(value - palette[p]);
+				if (error < bestError) {
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+			indices |= static_cast<uint64_t>(bestIndex) << (ix * 3);
+		}
+	}
+
+	out[0] = static_cast<uint8_t>(high);
+	out[1] = static_cast<uint8_t>(low);
+	for (int ix = 0; ix < 6; ix++) {
+		out[2 + ix] = (indices >> (ix * 8)) & 0xFF;
+	}
+}
+
+/// <summary>
+/// Writes the lowest count bits of value into a little-endian bit stream
+/// </summary>
+inline void WriteBits(uint8_t* out, uint32_t& offset, uint32_t value, uint32_t count) {
+	for (uint32_t ix = 0; ix < count; ix++, offset++) {
+		if (value & (1u << ix)) {
+			out[offset >> 3] |= 1 << (offset & 7);
+		}
+	}
+}
+
+/// <summary>
+/// Quantizes an RGBA endpoint to 7 bits per channel plus a shared p-bit, picking
+/// whichever p-bit gives the lowest error
+/// </summary>
+inline void QuantizeBC7Endpoint(const float color[4], int quantized[4], int& pBit) {
+	int bestError = INT_MAX;
+	for (int p = 0; p < 2; p++) {
+		int candidate[4];
+		int error = 0;
+		for (int c = 0; c < 4; c++) {
+			candidate[c] = std::clamp(static_cast<int>((color[c] - p) / 2.0f + 0.5f), 0, 127);
+			int delta = static_cast<int>(color[c] + 0.5f) - ((candidate[c] << 1) | p);
+			error += delta * delta;
+		}
+		if (error < bestError) {
+			bestError = error;
+			pBit = p;
+			memcpy(quantized, candidate, sizeof(candidate));
+		}
+	}
+}
+
+/// <summary>
+/// Encodes an RGBA block into 16 bytes of BC7 data using mode 6 (single subset, 7777.1 endpoints, 4 bit indices)
+/// </summary>
+inline void EncodeBC7(const uint8_t block[64], uint8_t* out) {
+	static const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	float low[4], high[4];
+	FindEndpoints(block, 4, low, high);
+
+	int endpoints[2][4];
+	int pBits[2];
+	QuantizeBC7Endpoint(low, endpoints[0], pBits[0]);
+	QuantizeBC7Endpoint(high, endpoints[1], pBits[1]);
+
+	int palette[16][4];
+	for (int c = 0; c < 4; c++) {
+		int e0 = (endpoints[0][c] << 1) | pBits[0];
+		int e1 = (endpoints[1][c] << 1) | pBits[1];
+		for (int p = 0; p < 16; p++) {
+			palette[p][c] = ((64 - weights[p]) * e0 + weights[p] * e1 + 32) >> 6;
+		}
+	}
+
+	int indices[16];
+	for (int ix = 0; ix < 16; ix++) {
+		int bestError = INT_MAX;
+		for (int p = 0; p < 16; p++) {
+			int error = 0;
+			for (int c = 0; c < 4; c++) {
+				int delta = block[ix * 4 + c] - palette[p][c];
+				error += delta * delta;
+			}
+			if (error < bestError) {
+				bestError = error;
+				indices[ix] = p;
+			}
+		}
+	}
+
+	// The high bit of the first index is implicitly 0, swap the endpoints if needed
+	if (indices[0] & 8) {
+		std::swap(endpoints[0], endpoints[1]);
+		std::swap(pBits[0], pBits[1]);
+		for (int ix = 0; ix < 16; ix++) {
+			indices[ix] = 15 - indices[ix];
+		}
+	}
+
+	memset(out, 0, 16);
+	uint32_t offset = 0;
+	WriteBits(out, offset, 1 << 6, 7);
+	for (int c = 0; c < 4; c++) {
+		WriteBits(out, offset, endpoints[0][c], 7);
+		WriteBits(out, offset, endpoints[1][c], 7);
+	}
+	WriteBits(out, offset, pBits[0], 1);
+	WriteBits(out, offset, pBits[1], 1);
+	WriteBits(out, offset, indices[0], 3);
+	for (int ix = 1; ix < 16; ix++) {
+		WriteBits(out, offset, indices[ix], 4);
+	}
+}
+
+inline void EncodeBlock(const uint8_t block[64], InternalFormat format, uint8_t* out) {
+	switch (format) {
+		case InternalFormat::BC1:
+			EncodeBC1(block, out);
+			break;
+		case InternalFormat::BC3:
+			EncodeBC4(block, 3, out);
+			EncodeBC1(block, out + 8);
+			break;
+		case InternalFormat::BC4:
+			EncodeBC4(block, 0, out);
+			break;
+		case InternalFormat::BC5:
+			EncodeBC4(block, 0, out);
+			EncodeBC4(block, 1, out + 8);
+			break;
+		case InternalFormat::BC7:
+			EncodeBC7(block, out);
+			break;
+		default:
+			LOG_ASSERT(false, "Unsupported compressed format: {}", format);
+			break;
+	}
+}
+
+#pragma endregion
+
+/// <summary>
+/// Generates the next mip level of an RGBA8 image using a 2x2 box filter
+/// </summary>
+inline std::vector<uint8_t> Downsample(const std::vector<uint8_t>& source, uint32_t width, uint32_t height, uint32_t& outWidth, uint32_t& outHeight) {
+	outWidth  = std::max(1u, width / 2);
+	outHeight = std::max(1u, height / 2);
+
+	std::vector<uint8_t> result(outWidth * outHeight * 4);
+	for (uint32_t y = 0; y < outHeight; y++) {
+		uint32_t y0 = std::min(y * 2, height - 1);
+		uint32_t y1 = std::min(y * 2 + 1, height - 1);
+		for (uint32_t x = 0; x < outWidth; x++) {
+			uint32_t x0 = std::min(x * 2, width - 1);
+			uint32_t x1 = std::min(x * 2 + 1, width - 1);
+			for (uint32_t c = 0; c < 4; c++) {
+				uint32_t sum =
+					source[(y0 * width + x0) * 4 + c] + source[(y0 * width + x1) * 4 + c] +
+					source[(y1 * width + x0) * 4 + c] + source[(y1 * width + x1) * 4 + c];
+				result[(y * outWidth + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+			}
+		}
+	}
+	return result;
+}
+
+std::string TextureCooker::GetCookedPath(const std::string& sourceFile) {
+	return fs::path(sourceFile).replace_extension(cookedExtension).string();
+}
+
+bool TextureCooker::HasCookedFile(const std::string& sourceFile) {
+	std::error_code error;
+	fs::path cookedPath = GetCookedPath(sourceFile);
+	if (!fs::exists(cookedPath, error)) {
+		return false;
+	}
+	// If the source is missing we can still use the cooked file (ex: shipping only cooked assets)
+	if (!fs::exists(sourceFile, error)) {
+		return true;
+	}
+	return fs::last_write_time(cookedPath, error) >= fs::last_write_time(sourceFile, error);
+}
+
+bool TextureCooker::CookFile(const std::string& inFile, const std::string& outFile, InternalFormat format) {
+	float startTime = static_cast<float>(glfwGetTime());
+
+	// Load the source image, always expanding to RGBA to keep the encoders simple. We flip
+	// the image the same way Texture2D does so that UVs line up
+	int width, height, numChannels;
+	stbi_set_flip_vertically_on_load(true);
+	uint8_t* data = stbi_load(inFile.c_str(), &width, &height, &numChannels, 4);
+	if (data == nullptr) {
+		LOG_WARN("STBI Failed to load image from \"{}\"", inFile);
+		return false;
+	}
+
+	// Pick a format if none was specified, BC3 if any texel is translucent, BC1 otherwise
+	if (format == InternalFormat::Unknown) {
+		format = InternalFormat::BC1;
+		if (numChannels == 2 || numChannels == 4) {
+			for (int ix = 0; ix < width * height; ix++) {
+				if (data[ix * 4 + 3] != 255) {
+					format = InternalFormat::BC3;
+					break;
+				}
+			}
+		}
+	}
+
+	if (!IsCompressedFormat(format)) {
+		LOG_WARN("Cannot cook \"{}\", {} is not a block compressed format", inFile, format);
+		stbi_image_free(data);
+		return false;
+	}
+
+	std::vector<uint8_t> level(data, data + (width * height * 4));
+	stbi_image_free(data);
+
+	// Compress every level of the mip chain
+	std::vector<LevelHeader> levels;
+	std::vector<std::vector<uint8_t>> levelData;
+	uint32_t levelWidth = width, levelHeight = height;
+	while (true) {
+		levelData.push_back(_Compress(level.data(), levelWidth, levelHeight, format));
+
+		LevelHeader levelHeader = LevelHeader();
+		levelHeader.Width  = levelWidth;
+		levelHeader.Height = levelHeight;
+		levelHeader.Size   = levelData.back().size();
+		levels.push_back(levelHeader);
+
+		if (levelWidth == 1 && levelHeight == 1) {
+			break;
+		}
+		level = Downsample(level, levelWidth, levelHeight, levelWidth, levelHeight);
+	}
+
+	// Level data is packed directly after the level table
+	uint64_t offset = sizeof(CookedHeader) + sizeof(LevelHeader) * levels.size();
+	for (auto& levelHeader : levels) {
+		levelHeader.Offset = offset;
+		offset += levelHeader.Size;
+	}
+
+	std::string outFileName = outFile.empty() ? GetCookedPath(inFile) : outFile;
+	std::ofstream file(outFileName, std::ios::binary);
+	if (!file) {
+		LOG_WARN("Failed to open output file \"{}\"", outFileName);
+		return false;
+	}
+
+	CookedHeader header = CookedHeader();
+	header.Version   = 0x01; // This is version 1! Update this and implement different readers if changes to format are made
+	header.Format    = format;
+	header.Width     = width;
+	header.Height    = height;
+	header.NumLevels = static_cast<uint32_t>(levels.size());
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(CookedHeader));
+	file.write(reinterpret_cast<const char*>(levels.data()), sizeof(LevelHeader) * levels.size());
+	for (const auto& blob : levelData) {
+		file.write(reinterpret_cast<const char*>(blob.data()), blob.size());
+	}
+
+	float endTime = static_cast<float>(glfwGetTime());
+	LOG_INFO("Cooked \"{}\" as {} in {} seconds ({}x{}, {} levels, {} bytes)", inFile, format, endTime - startTime, width, height, levels.size(), offset);
+	return true;
+}
+
+int TextureCooker::CookDirectory(const std::string& directory, InternalFormat format, bool force) {
+	static const char* extensions[] = { ".png", ".jpg", ".jpeg", ".tga", ".bmp" };
+
+	std::error_code error;
+	if (!fs::is_directory(directory, error)) {
+		LOG_WARN("\"{}\" is not a directory", directory);
+		return 0;
+	}
+
+	int count = 0;
+	for (const auto& entry : fs::recursive_directory_iterator(directory, error)) {
+		if (!entry.is_regular_file()) {
+			continue;
+		}
+
+		std::string extension = entry.path().extension().string();
+		StringTools::ToLower(extension);
+		if (std::find(std::begin(extensions), std::end(extensions), extension) == std::end(extensions)) {
+			continue;
+		}
+
+		std::string path = entry.path().string();
+		if (!force && HasCookedFile(path)) {
+			LOG_TRACE("Skipping \"{}\", cooked file is up to date", path);
+			continue;
+		}
+
+		if (CookFile(path, "", format)) {
+			count++;
+		}
+	}
+	return count;
+}
+
+bool TextureCooker::LoadCookedFile(const std::string& filename, CookedTexture& result) {
+	MemoryMappedFile::Sptr file = std::make_shared<MemoryMappedFile>(filename);
+	if (!file->IsOpen()) {
+		return false;
+	}
+
+	const uint8_t* data = file->GetData();
+	const CookedHeader* header = reinterpret_cast<const CookedHeader*>(data);
+	if (file->GetSize() < sizeof(CookedHeader) || memcmp(header->HeaderBytes, COOKED_HEADER_BYTES, 4) != 0) {
+		LOG_WARN("\"{}\" is not a cooked texture file", filename);
+		return false;
+	}
+	if (header->Version != 0x01) {
+		LOG_WARN("Unsupported cooked texture version {} in \"{}\"", header->Version, filename);
+		return false;
+	}
+	if (!IsCompressedFormat(header->Format) || header->NumLevels == 0) {
+		LOG_WARN("Cooked texture \"{}\" has an invalid format or no levels", filename);
+		return false;
+	}
+
+	size_t tableEnd = sizeof(CookedHeader) + sizeof(LevelHeader) * header->NumLevels;
+	if (file->GetSize() < tableEnd) {
+		LOG_WARN("Cooked texture \"{}\" is truncated", filename);
+		return false;
+	}
+
+	const LevelHeader* levels = reinterpret_cast<const LevelHeader*>(data + sizeof(CookedHeader));
+	result.Levels.clear();
+	result.Levels.reserve(header->NumLevels);
+	for (uint32_t ix = 0; ix < header->NumLevels; ix++) {
+		if (levels[ix].Offset + levels[ix].Size > file->GetSize()) {
+			LOG_WARN("Cooked texture \"{}\" is truncated", filename);
+			return false;
+		}
+		Level level;
+		level.Width  = levels[ix].Width;
+		level.Height = levels[ix].Height;
+		level.Size   = static_cast<size_t>(levels[ix].Size);
+		level.Data   = data + levels[ix].Offset;
+		result.Levels.push_back(level);
+	}
+
+	result.Format = header->Format;
+	result.Width  = header->Width;
+	result.Height = header->Height;
+	result.Source = file;
+	return true;
+}
+
+std::vector<uint8_t> TextureCooker::_Compress(const uint8_t* rgba, uint32_t width, uint32_t height, InternalFormat format) {
+	const uint32_t blocksX = (width + 3) / 4;
+	const uint32_t blocksY = (height + 3) / 4;
+	const size_t blockSize = GetCompressedBlockSize(format);
+
+	std::vector<uint8_t> result(blocksX * blocksY * blockSize);
+
+	// Each worker grabs the next row of blocks until we run out
+	std::atomic<uint32_t> nextRow(0);
+	auto worker = [&]() {
+		uint8_t block[64];
+		for (uint32_t row = nextRow++; row < blocksY; row = nextRow++) {
+			for (uint32_t column = 0; column < blocksX; column++) {
+				FetchBlock(rgba, width, height, column, row, block);
+				EncodeBlock(block, format, result.data() + (row * blocksX + column) * blockSize);
+			}
+		}
+	};
+
+	uint32_t numThreads = std::clamp(std::thread::hardware_concurrency(), 1u, blocksY);
+	std::vector<std::thread> threads;
+	for (uint32_t ix = 1; ix < numThreads; ix++) {
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	return result;
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "Graphics/GlEnums.h"
+#include "Utils/MemoryMappedFile.h"
+
+/// <summary>
+/// Converts source images (png, jpg, etc...) into a cooked texture file that stores a full
+/// chain of block compressed mip levels. Cooked textures can be uploaded straight to the GPU
+/// without decoding, and take 4-8x less video memory than their RGBA8 equivalents
+/// 
+/// The cooked file will be stored beside the source image with a .ctex extension, and will
+/// be picked up automatically by Texture2D and TextureCube when present
+/// </summary>
+class TextureCooker {
+public:
+	/// <summary>
+	/// Describes a single mip level within a cooked texture
+	/// </summary>
+	struct Level {
+		uint32_t       Width;
+		uint32_t       Height;
+		size_t         Size;
+		const uint8_t* Data;
+	};
+
+	/// <summary>
+	/// A cooked texture that has been mapped into memory, the level data pointers
+	/// remain valid for as long as this object is alive
+	/// </summary>
+	struct CookedTexture {
+		InternalFormat         Format = InternalFormat::Unknown;
+		uint32_t               Width  = 0;
+		uint32_t               Height = 0;
+		std::vector<Level>     Levels;
+		MemoryMappedFile::Sptr Source;
+	};
+
+	TextureCooker() = delete;
+
+	/// <summary>
+	/// Gets the path that the cooked version of a source image will be stored at
+	/// </summary>
+	/// <param name="sourceFile">The path to the source image</param>
+	static std::string GetCookedPath(const std::string& sourceFile);
+
+	/// <summary>
+	/// Checks whether a cooked texture exists for the given source image, and that it is
+	/// at least as new as the source image
+	/// </summary>
+	/// <param name="sourceFile">The path to the source image</param>
+	static bool HasCookedFile(const std::string& sourceFile);
+
+	/// <summary>
+	/// Compresses a single image into a cooked texture file
+	/// </summary>
+	/// <param name="inFile">The path to the source image to cook</param>
+	/// <param name="outFile">The output path, or empty to use GetCookedPath(inFile)</param>
+	/// <param name="format">The compressed format to use, or Unknown to select BC1 or BC3 based on the image's alpha channel</param>
+	/// <returns>True if the image was cooked successfully</returns>
+	static bool CookFile(const std::string& inFile, const std::string& outFile = "", InternalFormat format = InternalFormat::Unknown);
+
+	/// <summary>
+	/// Recursively cooks all images within a directory
+	/// </summary>
+	/// <param name="directory">The root directory to search for images</param>
+	/// <param name="format">The compressed format to use, or Unknown to select per image</param>
+	/// <param name="force">True to re-cook images that already have an up-to-date cooked file</param>
+	/// <returns>The number of images that were cooked</returns>
+	static int CookDirectory(const std::string& directory, InternalFormat format = InternalFormat::Unknown, bool force = false);
+
+	/// <summary>
+	/// Maps a cooked texture file into memory and validates its contents
+	/// </summary>
+	/// <param name="filename">The path to the .ctex file to load</param>
+	/// <param name="result">The structure to store the texture info in</param>
+	/// <returns>True if the file was a valid cooked texture</returns>
+	static bool LoadCookedFile(const std::string& filename, CookedTexture& result);
+
+protected:
+	// Will be put at the start of the cooked file, contains info about the contents of the file
+	struct CookedHeader {
+		// A check value so we can ensure that we're loading in the right file type
+		char           HeaderBytes[4] = { 'C', 'T', 'E', 'X' };
+		// The version code, we can use this to create different loaders if our format changes
+		uint16_t       Version = 0;
+		// The compressed format that all levels are stored in
+		InternalFormat Format = InternalFormat::Unknown;
+		// The size of the top level of the texture
+		uint32_t       Width = 0;
+		uint32_t       Height = 0;
+		// The number of mip levels, each level is described by a LevelHeader following this header
+		uint32_t       NumLevels = 0;
+	};
+
+	// Describes where a single mip level lives within the cooked file
+	struct LevelHeader {
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		uint64_t Offset = 0;
+		uint64_t Size = 0;
+	};
+
+	/// <summary>
+	/// Compresses a single RGBA8 image into the given format, using all available hardware threads
+	/// </summary>
+	static std::vector<uint8_t> _Compress(const uint8_t* rgba, uint32_t width, uint32_t height, InternalFormat format);
+};
@@ -0,0 +1,102 @@
+#include "Utils/ThreadPool.h"
+#include "Logging.h"
+#include "Application/Profiler.h"
+
+std::vector<std::thread>          ThreadPool::_workers;
+std::queue<std::function<void()>> ThreadPool::_jobs;
+std::mutex                        ThreadPool::_mutex;
+std::condition_variable           ThreadPool::_condition;
+bool                              ThreadPool::_isRunning = false;
+bool                              ThreadPool::_isShuttingDown = false;
+
+void ThreadPool::Init(uint32_t numThreads) {
+	std::unique_lock<std::mutex> lock(_mutex);
+	if (_isShuttingDown) {
+		LOG_WARN("Cannot start the thread pool while it is shutting down");
+		return;
+	}
+	if (!_isRunning) {
+		_StartWorkers(numThreads);
+	}
+}
+
+void ThreadPool::_StartWorkers(uint32_t numThreads) {
+	// Leave a core free for the main thread by default
+	if (numThreads == 0) {
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		numThreads = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	_isRunning = true;
+	for (uint32_t ix = 0; ix < numThreads; ix++) {
+		_workers.emplace_back([ix]() {
+			Profiler::SetThreadName("Worker " + std::to_string(ix));
+			_WorkerLoop();
+		});
+	}
+
+	LOG_INFO("Started thread pool with {} workers", numThreads);
+}
+
+void ThreadPool::Shutdown() {
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		if (!_isRunning) {
+			return;
+		}
+		_isRunning = false;
+		_isShuttingDown = true;
+	}
+
+	// Workers will drain the queue before exiting, nothing can start new workers until we're done
+	_condition.notify_all();
+	for (auto& worker : _workers) {
+		worker.join();
+	}
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_workers.clear();
+	_isShuttingDown = false;
+}
+
+uint32_t ThreadPool::GetThreadCount() {
+	std::unique_lock<std::mutex> lock(_mutex);
+	return static_cast<uint32_t>(_workers.size());
+}
+
+void ThreadPool::_Push(std::function<void()>&& job) {
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		// The workers may already have finished draining the queue, so run the job here rather than lose it
+		if (_isShuttingDown) {
+			lock.unlock();
+			LOG_WARN("Job was enqueued while the thread pool is shutting down, running it on the calling thread");
+			job();
+			return;
+		}
+		if (!_isRunning) {
+			_StartWorkers(0);
+		}
+		_jobs.push(std::move(job));
+	}
+	_condition.notify_one();
+}
+
+void ThreadPool::_WorkerLoop() {
+	while (true) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_condition.wait(lock, []() { return !_isRunning || !_jobs.empty(); });
+
+			if (_jobs.empty()) {
+				return;
+			}
+
+			job = std::move(_jobs.front());
+			_jobs.pop();
+		}
+		PROFILE_SCOPE("Job");
+		job();
+	}
+}
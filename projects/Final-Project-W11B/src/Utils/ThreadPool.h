@@ -0,0 +1,68 @@
+#pragma once
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+/// <summary>
+/// A simple shared pool of worker threads that we can hand off CPU heavy jobs to
+/// (ex: decoding images), so that they can run in parallel with each other and
+/// with the main thread
+/// 
+/// NOTE: jobs must NOT make any OpenGL calls, the GL context only lives on the main thread
+/// </summary>
+class ThreadPool {
+public:
+	ThreadPool() = delete;
+
+	/// <summary>
+	/// Starts up the worker threads, if the pool has not been initialized this will be
+	/// called the first time a job is enqueued
+	/// </summary>
+	/// <param name="numThreads">The number of workers to spawn, or 0 to use one less than the number of hardware threads</param>
+	static void Init(uint32_t numThreads = 0);
+	/// <summary>
+	/// Finishes all pending jobs and joins all the worker threads
+	/// </summary>
+	static void Shutdown();
+
+	/// <summary>
+	/// Gets the number of worker threads in the pool
+	/// </summary>
+	static uint32_t GetThreadCount();
+
+	/// <summary>
+	/// Queues a job to run on one of the worker threads
+	/// </summary>
+	/// <typeparam name="Func">The type of the callable to invoke</typeparam>
+	/// <param name="func">The job to run, can return a value</param>
+	/// <returns>A future that will contain the result of the job once it completes</returns>
+	template <typename Func>
+	static auto Enqueue(Func&& func) -> std::future<decltype(func())> {
+		using ReturnType = decltype(func());
+
+		// std::function requires copyable callables, so we wrap the task in a shared pointer
+		auto task = std::make_shared<std::packaged_task<ReturnType()>>(std::forward<Func>(func));
+		std::future<ReturnType> result = task->get_future();
+		_Push([task]() { (*task)(); });
+		return result;
+	}
+
+protected:
+	static std::vector<std::thread>          _workers;
+	static std::queue<std::function<void()>> _jobs;
+	static std::mutex                        _mutex;
+	static std::condition_variable           _condition;
+	static bool                              _isRunning;
+	// True while Shutdown is joining the workers, new jobs run inline and the pool can't be restarted
+	static bool                              _isShuttingDown;
+
+	// Spawns the workers, the caller must hold _mutex
+	static void _StartWorkers(uint32_t numThreads);
+	static void _Push(std::function<void()>&& job);
+	static void _WorkerLoop();
+};
@@ -1,5 +1,13 @@
 #define GLM_SWIZZLE 
 #include "Application/Application.h"
+#include "Utils/TextureCooker.h"
+#include "Utils/TangentSpace.h"
+#include "Utils/FileHelpers.h"
+#include "Utils/ThreadPool.h"
+#include "Application/Benchmark.h"
+#include "Gameplay/Physics/PhysicsBenchmark.h"
+#include <GLFW/glfw3.h>
+#include <cstring>
 
 extern "C" {
 	__declspec(dllexport) unsigned long NvOptimusEnablement = 0x01;
@@ -9,7 +17,81 @@ extern "C" {
 int main(int argc, char** args) { 
 	Logger::Init();
 
-	// TODO: parse arguments?
+	// Offline texture cooking, ex: --cook-textures textures BC7 --force
+	// Compresses every image under the directory into a .ctex file beside it, then exits
+	if (argc >= 3 && strcmp(args[1], "--cook-textures") == 0) {
+		InternalFormat format = InternalFormat::Unknown;
+		bool force = false;
+		for (int ix = 3; ix < argc; ix++) {
+			if (strcmp(args[ix], "--force") == 0) {
+				force = true;
+			} else {
+				format = ParseInternalFormat(args[ix], InternalFormat::Unknown);
+			}
+		}
+
+		// We don't need a window, but GLFW gives us our timer
+		glfwInit();
+		int count = TextureCooker::CookDirectory(args[2], format, force);
+		LOG_INFO("Cooked {} textures", count);
+		glfwTerminate();
+
+		Logger::Uninitialize();
+		return 0;
+	}
+
+	// Offline tangent generation benchmark, ex: --benchmark-tangents meshes --iterations 50 --out tangents.json
+	// Times and compares tangent frames for every OBJ under the directory, then exits
+	if (argc >= 3 && strcmp(args[1], "--benchmark-tangents") == 0) {
+		uint32_t iterations = 20;
+		std::string outPath = "tangents_benchmark.json";
+		for (int ix = 3; ix + 1 < argc; ix++) {
+			if (strcmp(args[ix], "--iterations") == 0) {
+				iterations = static_cast<uint32_t>(std::max(atoi(args[++ix]), 1));
+			} else if (strcmp(args[ix], "--out") == 0) {
+				outPath = args[++ix];
+			}
+		}
+
+		nlohmann::json result = TangentSpace::RunBenchmark(args[2], iterations);
+		FileHelpers::WriteContentsToFile(outPath, result.dump(1, '\t'));
+		LOG_INFO("Benchmarked tangents for {} meshes, results written to {}", result.size(), outPath);
+
+		Logger::Uninitialize();
+		return 0;
+	}
+
+	// Physics world stress test, ex: --benchmark-physics --bodies 4000 --frames 600 --out physics.json
+	// Drops a pile of boxes with each physics configuration and times the steps, then exits
+	if (argc >= 2 && strcmp(args[1], "--benchmark-physics") == 0) {
+		uint32_t bodies = 4000;
+		uint32_t frames = 600;
+		std::string outPath = "physics_benchmark.json";
+		for (int ix = 2; ix + 1 < argc; ix++) {
+			if (strcmp(args[ix], "--bodies") == 0) {
+				bodies = static_cast<uint32_t>(std::max(atoi(args[++ix]), 1));
+			} else if (strcmp(args[ix], "--frames") == 0) {
+				frames = static_cast<uint32_t>(std::max(atoi(args[++ix]), 1));
+			} else if (strcmp(args[ix], "--out") == 0) {
+				outPath = args[++ix];
+			}
+		}
+
+		nlohmann::json result = Gameplay::Physics::PhysicsBenchmark::Run(bodies, frames);
+		FileHelpers::WriteContentsToFile(outPath, result.dump(1, '\t'));
+		LOG_INFO("Benchmarked {} physics configurations, results written to {}", result.size(), outPath);
+
+		ThreadPool::Shutdown();
+		Logger::Uninitialize();
+		return 0;
+	}
+
+	// Headless benchmarking, ex: --benchmark scene.json --frames 600 --out results.json
+	// See Benchmark.h for all the options
+	Benchmark::Settings benchmark;
+	if (Benchmark::ParseArguments(argc, args, benchmark)) {
+		Benchmark::Begin(benchmark);
+	}
 
 	Application::Start(argc, args);
 
@@ -0,0 +1,108 @@
+"""
+Compares two benchmark reports written by the --benchmark mode, and flags regressions
+
+Usage:
+    python compare_benchmarks.py baseline.json candidate.json [--threshold 5] [--min-ms 0.05]
+
+Exits with a non-zero code if any frame time percentile or scope got slower by more than
+the threshold (in percent), so it can be used to fail a CI job
+"""
+import argparse
+import json
+import sys
+
+FRAME_STATS = ["mean", "p50", "p90", "p95", "p99"]
+
+
+def percent_change(old, new):
+    if old == 0:
+        return 0.0 if new == 0 else float("inf")
+    return (new - old) / old * 100.0
+
+
+def compare_frames(name, old, new, threshold, regressions):
+    if old is None or new is None:
+        print(f"{name}: missing from one of the reports, skipping")
+        return
+    print(f"{name}")
+    for stat in FRAME_STATS:
+        change = percent_change(old[stat], new[stat])
+        flag = ""
+        if change > threshold:
+            flag = "  <-- REGRESSION"
+            regressions.append(f"{name} {stat} {change:+.1f}%")
+        print(f"  {stat:>5}: {old[stat]:9.3f} -> {new[stat]:9.3f} ms ({change:+6.1f}%){flag}")
+
+
+def compare_scopes(name, old, new, threshold, min_ms, regressions):
+    print(f"{name}")
+    for path in sorted(set(old) | set(new)):
+        if path not in old or path not in new:
+            state = "added" if path not in old else "removed"
+            print(f"  {path}: {state}")
+            continue
+
+        old_ms = old[path]["mean_ms"]
+        new_ms = new[path]["mean_ms"]
+        # Tiny scopes are too noisy to be worth flagging
+        if max(old_ms, new_ms) < min_ms:
+            continue
+
+        change = percent_change(old_ms, new_ms)
+        flag = ""
+        if change > threshold:
+            flag = "  <-- REGRESSION"
+            regressions.append(f"{name} {path} {change:+.1f}%")
+        print(f"  {path}: {old_ms:.3f} -> {new_ms:.3f} ms ({change:+.1f}%){flag}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two benchmark reports")
+    parser.add_argument("baseline")
+    parser.add_argument("candidate")
+    parser.add_argument("--threshold", type=float, default=5.0, help="Percent slowdown that counts as a regression")
+    parser.add_argument("--min-ms", type=float, default=0.05, help="Ignore scopes faster than this in both reports")
+    args = parser.parse_args()
+
+    with open(args.baseline) as f:
+        old = json.load(f)
+    with open(args.candidate) as f:
+        new = json.load(f)
+
+    for key in ["scene", "resolution", "delta_time", "renderer"]:
+        if old.get(key) != new.get(key):
+            print(f"WARNING: {key} differs ({old.get(key)} vs {new.get(key)}), results may not be comparable")
+
+    regressions = []
+    compare_frames("CPU frame time", old.get("cpu_frame_ms"), new.get("cpu_frame_ms"), args.threshold, regressions)
+    compare_frames("GPU frame time", old.get("gpu_frame_ms"), new.get("gpu_frame_ms"), args.threshold, regressions)
+    compare_scopes("CPU scopes", old.get("cpu_scopes", {}), new.get("cpu_scopes", {}), args.threshold, args.min_ms, regressions)
+    compare_scopes("GPU scopes", old.get("gpu_scopes", {}), new.get("gpu_scopes", {}), args.threshold, args.min_ms, regressions)
+
+    old_mem = old.get("memory", {}).get("peak_working_set_mb", 0)
+    new_mem = new.get("memory", {}).get("peak_working_set_mb", 0)
+    print(f"Peak working set: {old_mem:.1f} -> {new_mem:.1f} MB ({percent_change(old_mem, new_mem):+.1f}%)")
+
+    # Allocation counts are deterministic with a fixed timestep, so any growth is worth flagging
+    old_allocs = old.get("allocations", {}).get("heap_per_frame")
+    new_allocs = new.get("allocations", {}).get("heap_per_frame")
+    if old_allocs is not None and new_allocs is not None:
+        change = percent_change(old_allocs, new_allocs)
+        flag = ""
+        if change > args.threshold:
+            flag = "  <-- REGRESSION"
+            regressions.append(f"Heap allocations per frame {change:+.1f}%")
+        print(f"Heap allocations per frame: {old_allocs:.1f} -> {new_allocs:.1f} ({change:+.1f}%){flag}")
+
+    if regressions:
+        print(f"\n{len(regressions)} regression(s) over {args.threshold}%:")
+        for r in regressions:
+            print(f"  {r}")
+        return 1
+
+    print("\nNo regressions")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())